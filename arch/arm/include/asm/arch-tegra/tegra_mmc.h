@@ -79,6 +79,7 @@ struct tegra_mmc {
 
 #define TEGRA_MMC_TRNMOD_DMA_ENABLE				(1 << 0)
 #define TEGRA_MMC_TRNMOD_BLOCK_COUNT_ENABLE			(1 << 1)
+#define TEGRA_MMC_TRNMOD_AUTO_CMD12_ENABLE			(1 << 2)
 #define TEGRA_MMC_TRNMOD_DATA_XFER_DIR_SEL_WRITE		(0 << 4)
 #define TEGRA_MMC_TRNMOD_DATA_XFER_DIR_SEL_READ			(1 << 4)
 #define TEGRA_MMC_TRNMOD_MULTI_BLOCK_SELECT			(1 << 5)
@@ -121,6 +122,20 @@ struct tegra_mmc {
 
 #define TEGRA_MMC_NORINTSIGEN_XFER_COMPLETE			(1 << 1)
 
+/* ADMA2 descriptor attributes, 32-bit address format */
+#define TEGRA_MMC_ADMA_VALID					(1 << 0)
+#define TEGRA_MMC_ADMA_END					(1 << 1)
+#define TEGRA_MMC_ADMA_INT					(1 << 2)
+#define TEGRA_MMC_ADMA_ACT_TRAN					(2 << 4)
+/* Bytes moved by one descriptor, must fit in its 16-bit length field */
+#define TEGRA_MMC_ADMA_MAX_LEN					(32 * 1024)
+
+struct tegra_mmc_adma_desc {
+	u16 attr;
+	u16 len;
+	u32 addr;
+} __packed;
+
 /* SDMMC1/3 settings from section 24.6 of T30 TRM */
 #define MEMCOMP_PADCTRL_VREF	7
 #define AUTO_CAL_ENABLED	(1 << 29)
@@ -138,6 +153,10 @@ struct mmc_host {
 	struct fdt_gpio_state wp_gpio;		/* Write Protect GPIO */
 	unsigned int version;	/* SDHCI spec. version */
 	unsigned int clock;	/* Current clock (MHz) */
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	struct tegra_mmc_adma_desc *adma_desc;	/* ADMA2 descriptor table */
+	unsigned int adma_count;	/* number of entries in adma_desc */
+#endif
 };
 
 void pad_init_mmc(struct mmc_host *host);
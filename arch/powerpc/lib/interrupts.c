@@ -11,6 +11,10 @@
 #include <common.h>
 #include <asm/processor.h>
 #include <watchdog.h>
+#ifdef CONFIG_SAMPLE_PROFILE
+#include <errno.h>
+#include <profile.h>
+#endif
 #ifdef CONFIG_STATUS_LED
 #include <status_led.h>
 #endif
@@ -97,6 +101,52 @@ int interrupt_init (void)
 
 static volatile ulong timestamp = 0;
 
+#ifdef CONFIG_SAMPLE_PROFILE
+DECLARE_GLOBAL_DATA_PTR;
+
+static ulong profile_divider;	/* timer ticks per sample, 0 if stopped */
+static int profile_depth;
+
+int profile_timer_start(uint hz, int depth)
+{
+	if (!hz || hz > CONFIG_SYS_HZ)
+		return -EINVAL;
+	profile_depth = min(depth, CONFIG_SAMPLE_PROFILE_DEPTH);
+	profile_divider = CONFIG_SYS_HZ / hz;
+
+	return 0;
+}
+
+void profile_timer_stop(void)
+{
+	profile_divider = 0;
+}
+
+/*
+ * Record the interrupted PC and follow the stack back chain, which the
+ * PowerPC ABI always maintains. Each frame's caller saves the return
+ * address in the word after its back chain pointer. A leaf function which
+ * has not yet saved its link register is reported as its caller.
+ */
+static void profile_tick(struct pt_regs *regs)
+{
+	ulong frames[CONFIG_SAMPLE_PROFILE_DEPTH];
+	ulong sp = regs->gpr[1];
+	int count = 0;
+
+	frames[count++] = regs->nip;
+	while (count < profile_depth) {
+		ulong next = *(ulong *)sp;
+
+		if (next <= sp || next >= gd->start_addr_sp || (next & 3))
+			break;
+		frames[count++] = ((ulong *)next)[1];
+		sp = next;
+	}
+	profile_sample(frames, count);
+}
+#endif
+
 void timer_interrupt (struct pt_regs *regs)
 {
 	/* call cpu specific function from $(CPU)/interrupts.c */
@@ -119,6 +169,11 @@ void timer_interrupt (struct pt_regs *regs)
 #ifdef CONFIG_SHOW_ACTIVITY
 	board_show_activity (timestamp);
 #endif /* CONFIG_SHOW_ACTIVITY */
+
+#ifdef CONFIG_SAMPLE_PROFILE
+	if (profile_divider && (timestamp % profile_divider) == 0)
+		profile_tick (regs);
+#endif /* CONFIG_SAMPLE_PROFILE */
 }
 
 ulong get_timer (ulong base)
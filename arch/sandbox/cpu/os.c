@@ -3,15 +3,22 @@
  * SPDX-License-Identifier:	GPL-2.0+
  */
 
+/* for the register names in ucontext_t */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
 #include <time.h>
+#include <ucontext.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -131,9 +138,20 @@ void *os_malloc(size_t length)
 			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 }
 
+void os_free(void *ptr, size_t length)
+{
+	munmap(ptr, length);
+}
+
 void os_usleep(unsigned long usec)
 {
-	usleep(usec);
+	struct timespec req;
+
+	/* Carry on after a signal, such as the profile timer's */
+	req.tv_sec = usec / 1000000;
+	req.tv_nsec = (usec % 1000000) * 1000;
+	while (nanosleep(&req, &req) && errno == EINTR)
+		;
 }
 
 u64 __attribute__((no_instrument_function)) os_get_nsec(void)
@@ -155,6 +173,98 @@ u64 __attribute__((no_instrument_function)) os_get_nsec(void)
 #endif
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+/* Most frames we will pass to the profile callback */
+#define OS_PROFILE_MAX_DEPTH	32
+
+/* Top of the initial stack, which U-Boot runs on */
+extern void *__libc_stack_end;
+
+static void (*os_profile_func)(const unsigned long *frames, int count);
+static int os_profile_depth;
+
+static void os_profile_handler(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+	unsigned long frames[OS_PROFILE_MAX_DEPTH];
+	unsigned long sp, fp, top;
+	int count = 0;
+
+#if defined(__x86_64__)
+	frames[count++] = uc->uc_mcontext.gregs[REG_RIP];
+	sp = uc->uc_mcontext.gregs[REG_RSP];
+	fp = uc->uc_mcontext.gregs[REG_RBP];
+#else
+	frames[count++] = uc->uc_mcontext.gregs[REG_EIP];
+	sp = uc->uc_mcontext.gregs[REG_ESP];
+	fp = uc->uc_mcontext.gregs[REG_EBP];
+#endif
+
+	/*
+	 * Follow the chain of saved frame pointers. Code built without
+	 * frame pointers (including the C library) may leave anything in
+	 * the register, so only trust frames which lie on the stack above
+	 * the interrupted stack pointer and move steadily towards its top.
+	 */
+	top = (unsigned long)__libc_stack_end;
+	while (count < os_profile_depth && fp >= sp &&
+	       fp < top - 2 * sizeof(long) && !(fp & (sizeof(long) - 1))) {
+		unsigned long *frame = (unsigned long *)fp;
+
+		if (!frame[1])
+			break;
+		frames[count++] = frame[1];
+		if (frame[0] <= fp)
+			break;
+		fp = frame[0];
+	}
+	os_profile_func(frames, count);
+}
+#endif
+
+int os_profile_timer_start(unsigned int hz, int depth,
+			   void (*func)(const unsigned long *frames, int count))
+{
+#if defined(__x86_64__) || defined(__i386__)
+	struct sigaction act;
+	struct itimerval timer;
+	unsigned long usec = hz ? 1000000 / hz : 1000000;
+
+	os_profile_func = func;
+	os_profile_depth = depth < OS_PROFILE_MAX_DEPTH ? depth :
+		OS_PROFILE_MAX_DEPTH;
+	memset(&act, '\0', sizeof(act));
+	act.sa_sigaction = os_profile_handler;
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	if (sigaction(SIGALRM, &act, NULL))
+		return -errno;
+
+	if (!usec)
+		usec = 1;
+	timer.it_interval.tv_sec = usec / 1000000;
+	timer.it_interval.tv_usec = usec % 1000000;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_REAL, &timer, NULL))
+		return -errno;
+
+	return 0;
+#else
+	return -ENOSYS;
+#endif
+}
+
+void os_profile_timer_stop(void)
+{
+	struct itimerval timer;
+
+	memset(&timer, '\0', sizeof(timer));
+	setitimer(ITIMER_REAL, &timer, NULL);
+
+	/* The default action for SIGALRM is to exit, so ignore stragglers */
+	signal(SIGALRM, SIG_IGN);
+}
+
 static char *short_opts;
 static struct option *long_opts;
 
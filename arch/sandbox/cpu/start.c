@@ -4,6 +4,7 @@
  */
 
 #include <common.h>
+#include <hush.h>
 #include <asm/getopt.h>
 #include <asm/sections.h>
 #include <asm/state.h>
@@ -74,6 +75,10 @@ int sandbox_main_loop_init(void)
 
 	/* Execute command if required */
 	if (state->cmd) {
+#ifdef CONFIG_SYS_HUSH_PARSER
+		/* main_loop() is not reached, so set up the shell here */
+		u_boot_hush_start();
+#endif
 		run_command_list(state->cmd, -1, 0);
 		os_exit(state->exit_type);
 	}
@@ -95,6 +100,13 @@ static int sb_cmdline_cb_fdt(struct sandbox_state *state, const char *arg)
 }
 SB_CMDLINE_OPT_SHORT(fdt, 'd', 1, "Specify U-Boot's control FDT");
 
+static int sb_cmdline_cb_spi_sf(struct sandbox_state *state, const char *arg)
+{
+	state->spi_sf = arg;
+	return 0;
+}
+SB_CMDLINE_OPT(spi_sf, 1, "Emulate a SPI flash: <bus>:<cs>:<file>");
+
 int main(int argc, char *argv[])
 {
 	struct sandbox_state *state;
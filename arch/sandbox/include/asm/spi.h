@@ -0,0 +1,55 @@
+/*
+ * Interface between the sandbox SPI controller and the devices it emulates
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __ASM_SANDBOX_SPI_H
+#define __ASM_SANDBOX_SPI_H
+
+/**
+ * Set up the emulated SPI flash for a chip select, if there is one
+ *
+ * The flash to emulate is given on the command line with --spi_sf.
+ *
+ * @param privp	Returns the emulator's private data
+ * @param bus	SPI bus number
+ * @param cs	Chip select number
+ * @return 0 if OK, -ENODEV if nothing is emulated there, other -ve on error
+ */
+int sandbox_sf_setup(void **privp, unsigned int bus, unsigned int cs);
+
+/**
+ * Release an emulated SPI flash
+ *
+ * @param priv	Private data from sandbox_sf_setup()
+ */
+void sandbox_sf_free(void *priv);
+
+/**
+ * Start a command: the chip select has been asserted
+ *
+ * @param priv	Private data from sandbox_sf_setup()
+ */
+void sandbox_sf_cs_activate(void *priv);
+
+/**
+ * End a command: the chip select has been deasserted
+ *
+ * @param priv	Private data from sandbox_sf_setup()
+ */
+void sandbox_sf_cs_deactivate(void *priv);
+
+/**
+ * Exchange bytes with an emulated SPI flash
+ *
+ * @param priv	Private data from sandbox_sf_setup()
+ * @param tx	Bytes sent to the flash, or NULL to send 0xff
+ * @param rx	Buffer for the bytes from the flash, or NULL
+ * @param bytes	Number of bytes to exchange
+ */
+void sandbox_sf_xfer(void *priv, const u8 *tx, u8 *rx, unsigned int bytes);
+
+#endif
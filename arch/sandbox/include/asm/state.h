@@ -21,6 +21,7 @@ struct sandbox_state {
 	const char *fdt_fname;		/* Filename of FDT binary */
 	enum exit_type_id exit_type;	/* How we exited U-Boot */
 	const char *parse_err;		/* Error to report from parsing */
+	const char *spi_sf;		/* SPI flash to emulate: bus:cs:file */
 	int argc;			/* Program arguments */
 	char **argv;
 };
@@ -7,6 +7,8 @@
  */
 
 #include <common.h>
+#include <os.h>
+#include <profile.h>
 
 int interrupt_init(void)
 {
@@ -21,3 +23,15 @@ int disable_interrupts(void)
 {
 	return 0;
 }
+
+#ifdef CONFIG_SAMPLE_PROFILE
+int profile_timer_start(uint hz, int depth)
+{
+	return os_profile_timer_start(hz, depth, profile_sample);
+}
+
+void profile_timer_stop(void)
+{
+	os_profile_timer_stop();
+}
+#endif
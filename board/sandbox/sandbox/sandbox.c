@@ -4,6 +4,7 @@
  */
 
 #include <common.h>
+#include <netdev.h>
 
 #include <os.h>
 
@@ -43,3 +44,10 @@ int dram_init(void)
 	gd->ram_size = CONFIG_SYS_SDRAM_SIZE;
 	return 0;
 }
+
+#ifdef CONFIG_SANDBOX_ETH
+int board_eth_init(bd_t *bis)
+{
+	return sandbox_eth_initialize(bis);
+}
+#endif
@@ -38,6 +38,7 @@
 #include <mmc.h>
 #include <nand.h>
 #include <onenand_uboot.h>
+#include <profile.h>
 #include <scsi.h>
 #include <serial.h>
 #include <spi.h>
@@ -100,6 +101,18 @@ static int initr_trace(void)
 	return 0;
 }
 
+static int initr_profile(void)
+{
+#ifdef CONFIG_SAMPLE_PROFILE
+	profile_init();
+#ifdef CONFIG_SAMPLE_PROFILE_BOOT
+	profile_start(0);
+#endif
+#endif
+
+	return 0;
+}
+
 static int initr_reloc(void)
 {
 	gd->flags |= GD_FLG_RELOC;	/* tell others: relocation done */
@@ -760,6 +773,7 @@ init_fnc_t init_sequence_r[] = {
 #endif
 	initr_barrier,
 	initr_malloc,
+	initr_profile,
 	bootstage_relocate,
 #ifdef CONFIG_ARCH_EARLY_INIT_R
 	arch_early_init_r,
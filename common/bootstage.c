@@ -30,10 +30,46 @@ struct bootstage_record {
 static struct bootstage_record record[BOOTSTAGE_ID_COUNT] = { {1} };
 static int next_id = BOOTSTAGE_ID_USER;
 
+#ifndef CONFIG_BOOTSTAGE_INTERVAL_COUNT
+#define CONFIG_BOOTSTAGE_INTERVAL_COUNT	128
+#endif
+
+#define BOOTSTAGE_MAX_DEPTH		16	/* Nesting of open intervals */
+
+/*
+ * Each bootstage_start() / bootstage_accum() pair is also logged as an
+ * interval, so that a timeline with nesting can be exported. These can
+ * be written before relocation, so must not be in BSS.
+ */
+struct bootstage_interval {
+	uint32_t start_us;
+	uint32_t end_us;	/* 0 if not finished */
+	const char *name;
+	enum bootstage_id id;
+	int parent;		/* interval this one is within, or -1 */
+};
+
+static struct bootstage_interval interval[CONFIG_BOOTSTAGE_INTERVAL_COUNT]
+	__attribute__((section(".data")));
+static int interval_count __attribute__((section(".data")));
+static int interval_dropped __attribute__((section(".data")));
+
+/* Intervals which have been started but not finished, innermost last */
+static struct {
+	enum bootstage_id id;
+	int interval;		/* -1 if not logged */
+} open_stack[BOOTSTAGE_MAX_DEPTH] __attribute__((section(".data")));
+static int open_depth __attribute__((section(".data")));
+
 enum {
 	BOOTSTAGE_VERSION	= 0,
 	BOOTSTAGE_MAGIC		= 0xb00757a3,
 	BOOTSTAGE_DIGITS	= 9,
+
+	BOOTSTAGE_EXPORT_VERSION = 1,
+	BOOTSTAGE_EXPORT_MAGIC	= 0xb0075e11,	/* "bootstage timeline" */
+	BOOTSTAGE_EXPORT_ACCUM	= 1 << 31,	/* record is an accumulator */
+	BOOTSTAGE_EXPORT_NONE	= -1U,		/* no parent interval */
 };
 
 struct bootstage_hdr {
@@ -43,6 +79,37 @@ struct bootstage_hdr {
 	uint32_t magic;		/* Unused */
 };
 
+/*
+ * Timeline export, for tools/bootstage. All values are 32-bit words in the
+ * target's byte order; the magic number shows which that is. The header
+ * is followed by the marks, the intervals and then the name strings.
+ */
+struct bootstage_export_hdr {
+	uint32_t magic;		/* BOOTSTAGE_EXPORT_MAGIC */
+	uint32_t version;	/* BOOTSTAGE_EXPORT_VERSION */
+	uint32_t size;		/* Total data size */
+	uint32_t time_us;	/* Time of the export */
+	uint32_t mark_count;	/* Number of marks */
+	uint32_t interval_count; /* Number of intervals */
+	uint32_t dropped;	/* Intervals which did not fit in the log */
+	uint32_t reserved;
+};
+
+struct bootstage_export_mark {
+	uint32_t time_us;	/* Mark time, or total time for accumulators */
+	uint32_t id;		/* Bootstage ID */
+	uint32_t flags;		/* BOOTSTAGEF_... and BOOTSTAGE_EXPORT_ACCUM */
+	uint32_t name;		/* Offset of name from start of strings */
+};
+
+struct bootstage_export_interval {
+	uint32_t start_us;
+	uint32_t end_us;	/* 0 if still running at the time of export */
+	uint32_t id;		/* Bootstage ID */
+	uint32_t parent;	/* Index of enclosing interval, or -1U */
+	uint32_t name;		/* Offset of name from start of strings */
+};
+
 int bootstage_relocate(void)
 {
 	int i;
@@ -55,6 +122,11 @@ int bootstage_relocate(void)
 		if (record[i].name)
 			record[i].name = strdup(record[i].name);
 
+	/* Intervals share their names with their records */
+	for (i = 0; i < interval_count; i++)
+		if (interval[i].id < BOOTSTAGE_ID_COUNT)
+			interval[i].name = record[interval[i].id].name;
+
 	return 0;
 }
 
@@ -131,22 +203,93 @@ ulong bootstage_mark_code(const char *file, const char *func, int linenum)
 	return bootstage_mark_name(BOOTSTAGE_ID_ALLOC, str);
 }
 
+enum bootstage_id bootstage_find_name(const char *name)
+{
+	int id;
+
+	for (id = BOOTSTAGE_ID_USER; id < next_id && id < BOOTSTAGE_ID_COUNT;
+	     id++) {
+		if (record[id].name && !strcmp(record[id].name, name))
+			return id;
+	}
+	if (next_id >= BOOTSTAGE_ID_COUNT)
+		return BOOTSTAGE_ID_ALLOC;
+	id = next_id++;
+	record[id].name = strdup(name);
+	record[id].id = id;
+
+	return id;
+}
+
 uint32_t bootstage_start(enum bootstage_id id, const char *name)
 {
 	struct bootstage_record *rec = &record[id];
+	struct bootstage_interval *iv;
 
 	rec->start_us = timer_get_boot_us();
-	rec->name = name;
+	if (name)
+		rec->name = name;
+	rec->id = id;
+
+	if (open_depth == BOOTSTAGE_MAX_DEPTH) {
+		interval_dropped++;
+		return rec->start_us;
+	}
+	open_stack[open_depth].id = id;
+	open_stack[open_depth].interval = -1;
+	if (interval_count < CONFIG_BOOTSTAGE_INTERVAL_COUNT) {
+		iv = &interval[interval_count];
+		iv->start_us = rec->start_us;
+		iv->end_us = 0;
+		iv->name = rec->name;
+		iv->id = id;
+		iv->parent = open_depth ?
+			open_stack[open_depth - 1].interval : -1;
+		open_stack[open_depth].interval = interval_count++;
+	} else {
+		interval_dropped++;
+	}
+	open_depth++;
+
 	return rec->start_us;
 }
 
+/**
+ * Finish the innermost open interval for an id
+ *
+ * Any intervals started within it which are still open finish at the same
+ * time, since their bootstage_accum() calls have evidently been skipped.
+ *
+ * @param id	Bootstage ID of the interval
+ * @param now	Finish time
+ */
+static void finish_interval(enum bootstage_id id, uint32_t now)
+{
+	int depth, i;
+
+	for (depth = open_depth - 1; depth >= 0; depth--) {
+		if (open_stack[depth].id == id)
+			break;
+	}
+	if (depth < 0)
+		return;
+	for (i = depth; i < open_depth; i++) {
+		if (open_stack[i].interval != -1)
+			interval[open_stack[i].interval].end_us = now;
+	}
+	open_depth = depth;
+}
+
 uint32_t bootstage_accum(enum bootstage_id id)
 {
 	struct bootstage_record *rec = &record[id];
+	uint32_t now = timer_get_boot_us();
 	uint32_t duration;
 
-	duration = (uint32_t)timer_get_boot_us() - rec->start_us;
+	duration = now - rec->start_us;
 	rec->time_us += duration;
+	finish_interval(id, now);
+
 	return duration;
 }
 
@@ -455,3 +598,89 @@ int bootstage_unstash(void *base, int size)
 
 	return 0;
 }
+
+/*
+ * Add a name to the export string table, returning its offset. Names are
+ * not shared, which keeps this simple at the cost of some space.
+ */
+static uint32_t export_name(char **ptrp, char *end, char *strings,
+			    const char *name)
+{
+	uint32_t offset = *ptrp - strings;
+
+	append_data(ptrp, end, name, strlen(name) + 1);
+
+	return offset;
+}
+
+int bootstage_export(void *base, int size)
+{
+	struct bootstage_export_hdr *hdr = base;
+	struct bootstage_export_mark mark;
+	struct bootstage_export_interval exp;
+	struct bootstage_interval *iv;
+	struct bootstage_record *rec;
+	char *ptr = base, *end = ptr + size;
+	char *names, *strings;
+	char buf[20];
+	uint32_t marks;
+	int i;
+
+	if (hdr + 1 > (struct bootstage_export_hdr *)end) {
+		debug("%s: Not enough space for bootstage hdr\n", __func__);
+		return -1;
+	}
+
+	for (rec = record, i = marks = 0; i < BOOTSTAGE_ID_COUNT; i++, rec++) {
+		if (rec->time_us != 0)
+			marks++;
+	}
+	memset(hdr, '\0', sizeof(*hdr));
+	hdr->magic = BOOTSTAGE_EXPORT_MAGIC;
+	hdr->version = BOOTSTAGE_EXPORT_VERSION;
+	hdr->time_us = timer_get_boot_us();
+	hdr->mark_count = marks;
+	hdr->interval_count = interval_count;
+	hdr->dropped = interval_dropped;
+
+	/* The strings follow the fixed-size records, so find them first */
+	ptr += sizeof(*hdr);
+	strings = ptr + marks * sizeof(mark) + interval_count * sizeof(exp);
+	names = strings;
+
+	for (rec = record, i = 0; i < BOOTSTAGE_ID_COUNT; i++, rec++) {
+		if (rec->time_us == 0)
+			continue;
+		mark.time_us = rec->time_us;
+		mark.id = rec->id;
+		mark.flags = rec->flags;
+		if (rec->start_us)
+			mark.flags |= BOOTSTAGE_EXPORT_ACCUM;
+		mark.name = export_name(&names, end, strings,
+				get_record_name(buf, sizeof(buf), rec));
+		append_data(&ptr, end, &mark, sizeof(mark));
+	}
+
+	for (iv = interval, i = 0; i < interval_count; i++, iv++) {
+		exp.start_us = iv->start_us;
+		exp.end_us = iv->end_us;
+		exp.id = iv->id;
+		exp.parent = iv->parent == -1 ? BOOTSTAGE_EXPORT_NONE :
+			iv->parent;
+		if (iv->name) {
+			exp.name = export_name(&names, end, strings, iv->name);
+		} else {
+			snprintf(buf, sizeof(buf), "id=%d", iv->id);
+			exp.name = export_name(&names, end, strings, buf);
+		}
+		append_data(&ptr, end, &exp, sizeof(exp));
+	}
+
+	if (names > end) {
+		debug("%s: Not enough space for bootstage export\n", __func__);
+		return -1;
+	}
+	hdr->size = names - (char *)base;
+
+	return hdr->size;
+}
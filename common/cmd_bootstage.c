@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <asm/io.h>
 
 #ifndef CONFIG_BOOTSTAGE_STASH
 #define CONFIG_BOOTSTAGE_STASH		-1UL
@@ -63,10 +64,57 @@ static int do_bootstage_stash(cmd_tbl_t *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_bootstage_export(cmd_tbl_t *cmdtp, int flag, int argc,
+			       char * const argv[])
+{
+	ulong base, size;
+	void *buf;
+	int ret;
+
+	if (argc != 3 || get_base_size(argc, argv, &base, &size))
+		return CMD_RET_USAGE;
+
+	buf = map_sysmem(base, size);
+	ret = bootstage_export(buf, size);
+	unmap_sysmem(buf);
+	if (ret < 0) {
+		printf("Not enough space for bootstage export\n");
+		return 1;
+	}
+	printf("Exported %d bytes\n", ret);
+	setenv_hex("filesize", ret);
+
+	return 0;
+}
+
+static int do_bootstage_interval(cmd_tbl_t *cmdtp, int flag, int argc,
+				 char * const argv[])
+{
+	enum bootstage_id id;
+
+	if (argc != 2)
+		return CMD_RET_USAGE;
+	id = bootstage_find_name(argv[1]);
+	if (id == BOOTSTAGE_ID_ALLOC) {
+		printf("No bootstage records left\n");
+		return 1;
+	}
+
+	if (!strcmp(argv[0], "start"))
+		bootstage_start(id, NULL);
+	else
+		bootstage_accum(id);
+
+	return 0;
+}
+
 static cmd_tbl_t cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+	U_BOOT_CMD_MKENT(export, 3, 0, do_bootstage_export, "", ""),
+	U_BOOT_CMD_MKENT(start, 2, 0, do_bootstage_interval, "", ""),
+	U_BOOT_CMD_MKENT(accum, 2, 0, do_bootstage_interval, "", ""),
 };
 
 /*
@@ -96,5 +144,8 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
-	"unstash [<start> [<size>]]  - Unstash data from memory"
+	"unstash [<start> [<size>]]  - Unstash data from memory\n"
+	"export <start> <size>       - Export timeline to memory\n"
+	"start <name>                - Start timing an activity\n"
+	"accum <name>                - Finish timing an activity"
 );
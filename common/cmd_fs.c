@@ -39,6 +39,26 @@ U_BOOT_CMD(
 	"      unless specified otherwise using a leading \"0x\"."
 );
 
+#ifdef CONFIG_CMD_GZLOAD
+int do_gzload_wrapper(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char * const argv[])
+{
+	return do_gzload(cmdtp, flag, argc, argv, FS_TYPE_ANY);
+}
+
+U_BOOT_CMD(
+	gzload,	6,	0,	do_gzload_wrapper,
+	"load and decompress a gzip file from a filesystem",
+	"<interface> <dev[:part]> <addr> <filename> [maxsize]\n"
+	"    - Decompress gzip file 'filename' from partition 'part' on\n"
+	"      device type 'interface' instance 'dev' to address 'addr'.\n"
+	"      The file is read a piece at a time while it is decompressed,\n"
+	"      so no room is needed for the compressed file in memory.\n"
+	"      'maxsize' (hex) limits the decompressed size, by default\n"
+	"      CONFIG_SYS_BOOTM_LEN."
+);
+#endif
+
 int do_ls_wrapper(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	return do_ls(cmdtp, flag, argc, argv, FS_TYPE_ANY);
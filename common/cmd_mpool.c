@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+
+static void show_stats(const char *name, const struct malloc_pool_stats *st)
+{
+	printf("%6s %6u %8lu %8lu %10lu %10lu %9lu\n", name, st->slabs,
+	       st->in_use, st->peak, st->allocs, st->frees, st->fallbacks);
+}
+
+static int do_mpool(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	struct malloc_pool_info info;
+	unsigned long allocs;
+	char name[8];
+	int i;
+
+	if (argc > 1) {
+		if (!strcmp(argv[1], "reset"))
+			malloc_pool_reset_stats();
+		else if (!strcmp(argv[1], "on"))
+			malloc_pool_enable(1);
+		else if (!strcmp(argv[1], "off"))
+			malloc_pool_enable(0);
+		else
+			return CMD_RET_USAGE;
+		return 0;
+	}
+
+	malloc_pool_get_info(&info);
+	printf("Pool %s, %u of %u slabs of %u bytes used\n",
+	       info.enabled ? "enabled" : "disabled", info.slabs_used,
+	       info.slabs, info.slab_size);
+	printf("%6s %6s %8s %8s %10s %10s %9s\n", "size", "slabs", "in use",
+	       "peak", "allocs", "frees", "fallbacks");
+	allocs = 0;
+	for (i = 0; i < info.count; i++) {
+		snprintf(name, sizeof(name), "%u", info.classes[i].size);
+		show_stats(name, &info.classes[i]);
+		allocs += info.classes[i].allocs;
+	}
+	show_stats("large", info.large);
+	printf("%lu of %lu allocations from the pool\n", allocs,
+	       allocs + info.large->allocs);
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	mpool,	2,	1,	do_mpool,
+	"show malloc() pool statistics",
+	"\n"
+	"    - show the size classes and allocation counts\n"
+	"mpool reset\n"
+	"    - clear the allocation counters\n"
+	"mpool on|off\n"
+	"    - choose whether small allocations use the pool"
+);
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <net.h>
+
+static void netstat_reset_devices(void)
+{
+	struct eth_device *dev;
+	int i;
+
+	for (i = 0; (dev = eth_get_dev_by_index(i)); i++) {
+		dev->rx_packets = 0;
+		dev->rx_dropped = 0;
+		dev->rx_overruns = 0;
+	}
+}
+
+static void netstat_show_devices(void)
+{
+	struct eth_device *dev;
+	int i;
+
+	for (i = 0; (dev = eth_get_dev_by_index(i)); i++) {
+		printf("%s: receive\n", dev->name);
+		printf("%12lu packets\n", dev->rx_packets);
+		printf("%12lu dropped\n", dev->rx_dropped);
+		printf("%12lu overruns\n", dev->rx_overruns);
+	}
+}
+
+static int do_netstat(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char * const argv[])
+{
+#ifdef CONFIG_IP_DEFRAG
+	struct net_defrag_stats defrag;
+#endif
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "reset"))
+			return CMD_RET_USAGE;
+		netstat_reset_devices();
+#ifdef CONFIG_IP_DEFRAG
+		net_defrag_reset_stats();
+#endif
+		return 0;
+	}
+
+	netstat_show_devices();
+#ifdef CONFIG_IP_DEFRAG
+	net_defrag_get_stats(&defrag);
+	printf("IP reassembly: %d of %d contexts in use\n", defrag.in_use,
+	       defrag.contexts);
+	printf("%12lu packets reassembled\n", defrag.reassembled);
+	printf("%12lu dropped\n", defrag.dropped);
+	printf("%12lu timed out\n", defrag.timeouts);
+#endif
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	netstat,	2,	1,	do_netstat,
+	"show network statistics",
+	"\n"
+	"    - show receive counts for each device and for IP reassembly\n"
+	"netstat reset\n"
+	"    - clear the counts"
+);
@@ -133,37 +133,94 @@ static int do_spi_flash_probe(int argc, char * const argv[])
 	return 0;
 }
 
+/*
+ * Update this much of the flash at a time, so that a run of sectors which
+ * all need erasing can use the larger erase commands
+ */
+#define SF_UPDATE_WINDOW	0x10000
+
+struct sf_update_stats {
+	size_t written;		/* bytes programmed */
+	size_t skipped;		/* bytes of the update left as they were */
+	size_t erased;		/* bytes erased */
+};
+
+/* Check if going from old to new data needs an erase (sets any bit) */
+static int sf_needs_erase(const u8 *old, const u8 *new, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if ((old[i] & new[i]) != new[i])
+			return 1;
+	}
+
+	return 0;
+}
+
 /**
- * Write a block of data to SPI flash, first checking if it is different from
- * what is already there.
+ * Update a range of whole sectors in SPI flash, which includes the part
+ * being written. The rest of the range is kept as it was.
  *
- * If the data being written is the same, then *skipped is incremented by len.
+ * Runs of sectors where bits must be set are erased together, then each
+ * page which differs from what is in the flash is programmed. Pages which
+ * are the same, including erased pages which should stay erased, are
+ * left alone.
  *
  * @param flash		flash context pointer
- * @param offset	flash offset to write
+ * @param start		flash offset of the sectors, sector aligned
+ * @param size		size of the sectors
+ * @param offset	flash offset to write, within the sectors
  * @param len		number of bytes to write
  * @param buf		buffer to write from
- * @param cmp_buf	read buffer to use to compare data
- * @param skipped	Count of skipped data (incremented by this function)
+ * @param old		buffer of size bytes for the current flash contents
+ * @param new		buffer of size bytes for the new flash contents
+ * @param stats		statistics to update
  * @return NULL if OK, else a string containing the stage which failed
  */
-static const char *spi_flash_update_block(struct spi_flash *flash, u32 offset,
-		size_t len, const char *buf, char *cmp_buf, size_t *skipped)
+static const char *spi_flash_update_block(struct spi_flash *flash, u32 start,
+		size_t size, u32 offset, size_t len, const char *buf,
+		u8 *old, u8 *new, struct sf_update_stats *stats)
 {
-	debug("offset=%#x, sector_size=%#x, len=%#zx\n",
-		offset, flash->sector_size, len);
-	if (spi_flash_read(flash, offset, len, cmp_buf))
+	u32 sect = flash->sector_size, page = flash->page_size;
+	u32 pos, end, lo, hi;
+
+	debug("start=%#x, size=%#zx, offset=%#x, len=%#zx\n", start, size,
+	      offset, len);
+	if (spi_flash_read(flash, start, size, old))
 		return "read";
-	if (memcmp(cmp_buf, buf, len) == 0) {
-		debug("Skip region %x size %zx: no change\n",
-			offset, len);
-		*skipped += len;
-		return NULL;
+	memcpy(new, old, size);
+	memcpy(new + offset - start, buf, len);
+
+	for (pos = 0; pos < size; pos = end + sect) {
+		for (end = pos; end < size; end += sect) {
+			if (!sf_needs_erase(old + end, new + end, sect))
+				break;
+		}
+		if (end == pos)
+			continue;
+		if (spi_flash_erase(flash, start + pos, end - pos))
+			return "erase";
+		memset(old + pos, 0xff, end - pos);
+		stats->erased += end - pos;
 	}
-	if (spi_flash_erase(flash, offset, len))
-		return "erase";
-	if (spi_flash_write(flash, offset, len, buf))
-		return "write";
+
+	for (pos = 0; pos < size; pos += page) {
+		if (memcmp(old + pos, new + pos, page)) {
+			if (spi_flash_write(flash, start + pos, page, new + pos))
+				return "write";
+			stats->written += page;
+			continue;
+		}
+		lo = max(start + pos, offset);
+		hi = min(start + pos + page, offset + len);
+		if (hi > lo) {
+			debug("Skip region %x size %x: no change\n", lo,
+			      hi - lo);
+			stats->skipped += hi - lo;
+		}
+	}
+
 	return NULL;
 }
 
@@ -180,38 +237,51 @@ static const char *spi_flash_update_block(struct spi_flash *flash, u32 offset,
 static int spi_flash_update(struct spi_flash *flash, u32 offset,
 		size_t len, const char *buf)
 {
+	struct sf_update_stats stats = { 0 };
 	const char *err_oper = NULL;
-	char *cmp_buf;
-	const char *end = buf + len;
+	u8 *old, *new;
+	u32 sect = flash->sector_size;
+	u32 window, pos, start, end;
 	size_t todo;		/* number of bytes to do in this pass */
-	size_t skipped = 0;	/* statistics */
 	const ulong start_time = get_timer(0);
 	size_t scale = 1;
-	const char *start_buf = buf;
 	ulong delta;
 
-	if (end - buf >= 200)
-		scale = (end - buf) / 100;
-	cmp_buf = malloc(flash->sector_size);
-	if (cmp_buf) {
+	if (len >= 200)
+		scale = len / 100;
+	window = max(sect, (u32)SF_UPDATE_WINDOW);
+	old = malloc(2 * window);
+	if (!old && window > sect) {
+		window = sect;
+		old = malloc(2 * window);
+	}
+	new = old + window;
+	if (old) {
 		ulong last_update = get_timer(0);
 
-		for (; buf < end && !err_oper; buf += todo, offset += todo) {
-			todo = min(end - buf, flash->sector_size);
+		for (pos = offset; pos < offset + len && !err_oper;
+		     pos += todo) {
+			/* whole sectors within one window */
+			start = pos - pos % sect;
+			end = min(roundup(offset + len, sect),
+				  pos - pos % window + window);
+			end = min(end, flash->size);
+			todo = min(offset + len, end) - pos;
 			if (get_timer(last_update) > 100) {
 				printf("   \rUpdating, %zu%% %lu B/s",
-					100 - (end - buf) / scale,
-					bytes_per_second(buf - start_buf,
+					(pos - offset) / scale,
+					bytes_per_second(pos - offset,
 							 start_time));
 				last_update = get_timer(0);
 			}
-			err_oper = spi_flash_update_block(flash, offset, todo,
-					buf, cmp_buf, &skipped);
+			err_oper = spi_flash_update_block(flash, start,
+					end - start, pos, todo,
+					buf + pos - offset, old, new, &stats);
 		}
 	} else {
 		err_oper = "malloc";
 	}
-	free(cmp_buf);
+	free(old);
 	putc('\r');
 	if (err_oper) {
 		printf("SPI flash failed in %s step\n", err_oper);
@@ -219,8 +289,8 @@ static int spi_flash_update(struct spi_flash *flash, u32 offset,
 	}
 
 	delta = get_timer(start_time);
-	printf("%zu bytes written, %zu bytes skipped", len - skipped,
-		skipped);
+	printf("%zu bytes written, %zu bytes skipped, %zu bytes erased",
+	       stats.written, stats.skipped, stats.erased);
 	printf(" in %ld.%lds, speed %ld B/s\n",
 		delta / 1000, delta % 1000, bytes_per_second(len, start_time));
 
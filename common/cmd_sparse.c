@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <errno.h>
+#include <image-sparse.h>
+#include <part.h>
+#include <asm/byteorder.h>
+#include <asm/io.h>
+
+/* Amount of the image passed to the parser at a time */
+#define SPARSE_STEP	(1 << 20)
+
+/*
+ * Feed the image to the parser until it has seen every chunk. The image
+ * size is not known in advance, but the parser checks the size of each
+ * chunk and stops at the last one.
+ */
+static int sparse_run(struct sparse_storage *info, ulong addr)
+{
+	struct sparse_state state;
+	ulong start = get_timer(0);
+	const void *buf;
+	int ret = 0;
+
+	sparse_start(&state, info);
+	while (!ret && state.phase != SPARSE_DONE) {
+		buf = map_sysmem(addr, SPARSE_STEP);
+		ret = sparse_write(&state, buf, SPARSE_STEP);
+		unmap_sysmem(buf);
+		addr += SPARSE_STEP;
+	}
+	if (sparse_finish(&state) || ret)
+		return CMD_RET_FAILURE;
+	if (info->write)
+		printf("sparse: Written in %lu ms\n", get_timer(start));
+
+	return 0;
+}
+
+static int do_sparse_info(ulong addr)
+{
+	struct sparse_storage info;
+	sparse_header_t *hdr;
+
+	hdr = map_sysmem(addr, sizeof(*hdr));
+	if (!is_sparse_image(hdr)) {
+		printf("No sparse image at %08lx\n", addr);
+		unmap_sysmem(hdr);
+		return CMD_RET_FAILURE;
+	}
+	printf("Sparse image v%d.%d, %u blocks of %u bytes in %u chunks\n",
+	       le16_to_cpu(hdr->major_version),
+	       le16_to_cpu(hdr->minor_version),
+	       le32_to_cpu(hdr->total_blks), le32_to_cpu(hdr->blk_sz),
+	       le32_to_cpu(hdr->total_chunks));
+
+	/* Check the image without writing anything */
+	memset(&info, '\0', sizeof(info));
+	info.size = le32_to_cpu(hdr->total_blks);
+	info.blksz = le32_to_cpu(hdr->blk_sz);
+	unmap_sysmem(hdr);
+	if (!info.blksz)
+		return CMD_RET_FAILURE;
+
+	return sparse_run(&info, addr);
+}
+
+static int do_sparse_write(const char *ifname, const char *dev_part_str,
+			   ulong addr)
+{
+	struct sparse_storage info;
+	block_dev_desc_t *dev_desc;
+	disk_partition_t part_info;
+	int part;
+
+	part = get_device_and_partition(ifname, dev_part_str, &dev_desc,
+					&part_info, 1);
+	if (part < 0)
+		return CMD_RET_FAILURE;
+	if (!dev_desc->block_write) {
+		printf("Device %s %d is read-only\n", ifname, dev_desc->dev);
+		return CMD_RET_FAILURE;
+	}
+	sparse_storage_blk_dev(&info, dev_desc, part_info.start,
+			       part_info.size);
+
+	return sparse_run(&info, addr);
+}
+
+static int do_sparse(cmd_tbl_t *cmdtp, int flag, int argc,
+		     char * const argv[])
+{
+	if (argc == 3 && !strcmp(argv[1], "info"))
+		return do_sparse_info(simple_strtoul(argv[2], NULL, 16));
+	if (argc == 5 && !strcmp(argv[1], "write"))
+		return do_sparse_write(argv[2], argv[3],
+				       simple_strtoul(argv[4], NULL, 16));
+
+	return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(
+	sparse,	5,	0,	do_sparse,
+	"Android sparse images",
+	"info <addr>             - check sparse image at <addr>\n"
+	"sparse write <interface> <dev[:part]> <addr>\n"
+	"    - write sparse image at <addr> to a device or partition,\n"
+	"      erasing don't-care regions where the device supports it"
+);
@@ -930,6 +930,22 @@ struct mallinfo mALLINFo();
 #endif	/* 0 */			/* Moved to malloc.h */
 
 #include <malloc.h>
+
+#ifdef CONFIG_SYS_MALLOC_POOL
+/* The pools in common/malloc_pool.c provide the public names */
+#undef cALLOc
+#undef fREe
+#undef mALLOc
+#undef mEMALIGn
+#undef rEALLOc
+#define cALLOc		dlcalloc
+#define fREe		dlfree
+#define mALLOc		dlmalloc
+#define mEMALIGn	dlmemalign
+#define rEALLOc		dlrealloc
+#define malloc_usable_size dlmalloc_usable_size
+#endif
+
 #ifdef DEBUG
 #if __STD_C
 static void malloc_update_mallinfo (void);
@@ -1528,6 +1544,9 @@ void mem_malloc_init(ulong start, ulong size)
 	mem_malloc_brk = start;
 
 	memset((void *)mem_malloc_start, 0, size);
+#ifdef CONFIG_SYS_MALLOC_POOL
+	mem_malloc_end -= malloc_pool_init(start, size);
+#endif
 
 	malloc_bin_reloc();
 }
@@ -2971,7 +2990,7 @@ void cfree(Void_t *mem)
 void cfree(mem) Void_t *mem;
 #endif
 {
-  fREe(mem);
+  free(mem);
 }
 #endif
 
@@ -7,6 +7,7 @@
 
 #include <common.h>
 #include <environment.h>
+#include <hush.h>
 
 #if defined(CONFIG_NEEDS_MANUAL_RELOC)
 DECLARE_GLOBAL_DATA_PTR;
@@ -69,6 +70,17 @@ void env_callback_init(ENTRY *var_entry)
 	}
 }
 
+/*
+ * Called when any variable is created, overwritten or deleted, whether
+ * or not it has a callback, so that nothing keeps using its old value
+ */
+void env_callback_changed(const char *name)
+{
+#if defined(CONFIG_HUSH_PARSE_CACHE) && !defined(CONFIG_SPL_BUILD)
+	parse_cache_drop(name);
+#endif
+}
+
 /*
  * Called on each existing env var prior to the blanket update since removing
  * a callback association should remove its callback.
@@ -203,6 +203,7 @@ int env_complete(char *var, int maxv, char *cmdv[], int bufsz, char *buf)
 	found = 0;
 	cmdv[0] = NULL;
 
+	/* matches come back in key order, so need no sorting */
 	while ((idx = hmatch_r(var, idx, &match, &env_htab))) {
 		int vallen = strlen(match->key) + 1;
 
@@ -215,8 +216,6 @@ int env_complete(char *var, int maxv, char *cmdv[], int bufsz, char *buf)
 		bufsz -= vallen;
 	}
 
-	qsort(cmdv, found, sizeof(cmdv[0]), strcmp_compar);
-
 	if (idx)
 		cmdv[found++] = "...";
 
@@ -81,6 +81,7 @@
 #include <common.h>        /* readline */
 #include <hush.h>
 #include <command.h>        /* find_cmd */
+#include <u-boot/crc.h>
 #ifndef CONFIG_SYS_PROMPT_HUSH_PS2
 #define CONFIG_SYS_PROMPT_HUSH_PS2	"> "
 #endif
@@ -1568,6 +1569,8 @@ static int run_pipe_real(struct pipe *pi)
 #endif
 		return rcode;
 	} else if (pi->num_progs == 1 && pi->progs[0].argv != NULL) {
+		int sp = child->sp;	/* the pipe may be run again */
+
 		for (i=0; is_assignment(child->argv[i]); i++) { /* nothing */ }
 		if (i!=0 && child->argv[i]==NULL) {
 			/* assignments, but no command: set the local environment */
@@ -1606,11 +1609,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string((child->argv + i));
@@ -1743,6 +1746,7 @@ static int run_list_real(struct pipe *pi)
 	char **list = NULL;
 	char **save_list = NULL;
 	struct pipe *rpipe;
+	struct pipe *for_pipe = NULL;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
 	int save_num_progs;
@@ -1781,7 +1785,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
-					return 1;
+					rcode = 1;
+					break;
 				}
 #endif
 				flag_restore = 0;
@@ -1810,6 +1815,7 @@ static int run_list_real(struct pipe *pi)
 				list = make_list_in(pi->next->progs->argv,
 					pi->progs->argv[0]);
 				save_list = list;
+				for_pipe = pi;
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
@@ -1881,7 +1887,8 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
-			return -2;	/* exit */
+			rcode = -2;	/* exit */
+			break;
 		}
 		last_return_code=(rcode == 0) ? 0 : 1;
 #endif
@@ -1901,6 +1908,15 @@ static int run_list_real(struct pipe *pi)
 		checkjobs(NULL);
 #endif
 	}
+	if (list) {
+		/* left a "for" loop early, so put back its variable name as
+		 * the list may be run again */
+		free(for_pipe->progs->argv[0]);
+		while (*list)
+			free(*list++);
+		free(save_list);
+		for_pipe->progs->argv[0] = save_name;
+	}
 	return rcode;
 }
 
@@ -3145,68 +3161,77 @@ static void update_ifs_map(void)
 	mapset(ifs, 2);            /* also flow through if quoted */
 }
 
-/* most recursion does not come through here, the exeception is
- * from builtin_source() */
-static int parse_stream_outer(struct in_str *inp, int flag)
+/* Parse the next line of input into a list of pipes without running it.
+ * Returns NULL on a syntax error or interrupt; *rcode is -1 at EOF. */
+static struct pipe *parse_stream_list(struct in_str *inp, int flag, int *rcode)
 {
-
 	struct p_context ctx;
 	o_string temp=NULL_O_STRING;
-	int rcode;
+
+	ctx.type = flag;
+	initialize_context(&ctx);
+	update_ifs_map();
+	if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING)) mapset((uchar *)";$&|", 0);
+	inp->promptmode=1;
+	*rcode = parse_stream(&temp, &ctx, inp, '\n');
 #ifdef __U_BOOT__
-	int code = 0;
+	if (*rcode == 1) flag_repeat = 0;
 #endif
-	do {
-		ctx.type = flag;
-		initialize_context(&ctx);
-		update_ifs_map();
-		if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING)) mapset((uchar *)";$&|", 0);
-		inp->promptmode=1;
-		rcode = parse_stream(&temp, &ctx, inp, '\n');
+	if (*rcode != 1 && ctx.old_flag != 0) {
+		syntax();
 #ifdef __U_BOOT__
-		if (rcode == 1) flag_repeat = 0;
+		flag_repeat = 0;
 #endif
-		if (rcode != 1 && ctx.old_flag != 0) {
-			syntax();
+	}
+	if (*rcode != 1 && ctx.old_flag == 0) {
+		done_word(&temp, &ctx);
+		done_pipe(&ctx,PIPE_SEQ);
+		b_free(&temp);
+		return ctx.list_head;
+	}
+	if (ctx.old_flag != 0) {
+		free(ctx.stack);
+		b_reset(&temp);
+	}
 #ifdef __U_BOOT__
-			flag_repeat = 0;
+	if (inp->__promptme == 0) printf("<INTERRUPT>\n");
+	inp->__promptme = 1;
 #endif
-		}
-		if (rcode != 1 && ctx.old_flag == 0) {
-			done_word(&temp, &ctx);
-			done_pipe(&ctx,PIPE_SEQ);
+	inp->p = NULL;
+	free_pipe_list(ctx.list_head,0);
+	b_free(&temp);
+	return NULL;
+}
+
+/* most recursion does not come through here, the exeception is
+ * from builtin_source() */
+static int parse_stream_outer(struct in_str *inp, int flag)
+{
+	struct pipe *list;
+	int rcode;
+#ifdef __U_BOOT__
+	int code = 0;
+#endif
+	do {
+		list = parse_stream_list(inp, flag, &rcode);
+		if (!list)
+			continue;
 #ifndef __U_BOOT__
-			run_list(ctx.list_head);
+		run_list(list);
 #else
-			code = run_list(ctx.list_head);
-			if (code == -2) {	/* exit */
-				b_free(&temp);
-				code = 0;
-				/* XXX hackish way to not allow exit from main loop */
-				if (inp->peek == file_peek) {
-					printf("exit not allowed from main input shell.\n");
-					continue;
-				}
-				break;
-			}
-			if (code == -1)
-			    flag_repeat = 0;
-#endif
-		} else {
-			if (ctx.old_flag != 0) {
-				free(ctx.stack);
-				b_reset(&temp);
+		code = run_list(list);
+		if (code == -2) {	/* exit */
+			code = 0;
+			/* XXX hackish way to not allow exit from main loop */
+			if (inp->peek == file_peek) {
+				printf("exit not allowed from main input shell.\n");
+				continue;
 			}
-#ifdef __U_BOOT__
-			if (inp->__promptme == 0) printf("<INTERRUPT>\n");
-			inp->__promptme = 1;
-#endif
-			temp.nonnull = 0;
-			temp.quote = 0;
-			inp->p = NULL;
-			free_pipe_list(ctx.list_head,0);
+			break;
 		}
-		b_free(&temp);
+		if (code == -1)
+		    flag_repeat = 0;
+#endif
 	} while (rcode != -1 && !(flag & FLAG_EXIT_FROM_LOOP));   /* loop on syntax errors, return on EOF */
 #ifndef __U_BOOT__
 	return 0;
@@ -3244,6 +3269,142 @@ int parse_string_outer(const char *s, int flag)
 #endif
 }
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+/*
+ * Parsed copies of the scripts in environment variables, so that 'run'
+ * does not parse the same text every time. Entries are found by variable
+ * name and checked against a hash of the text, and are dropped when the
+ * variable is changed. An entry which is running is not used again until
+ * it finishes, since running a "for" loop changes the list for a while.
+ */
+#ifndef CONFIG_HUSH_PARSE_CACHE_SIZE
+#define CONFIG_HUSH_PARSE_CACHE_SIZE	16
+#endif
+
+struct parse_cache {
+	char *name;		/* variable name, NULL if the entry is free */
+	uint32_t hash;		/* crc32 of the text that was parsed */
+	size_t len;		/* length of that text */
+	struct pipe *list;	/* parsed commands */
+	int busy;		/* list is running */
+	int stale;		/* variable changed while running */
+	ulong used;		/* when last run, to find an entry to reuse */
+};
+
+static struct parse_cache parse_cache[CONFIG_HUSH_PARSE_CACHE_SIZE];
+static ulong parse_cache_count;
+
+static void parse_cache_free(struct parse_cache *pc)
+{
+	free_pipe_list(pc->list, 0);
+	free(pc->name);
+	memset(pc, '\0', sizeof(*pc));
+}
+
+static struct parse_cache *parse_cache_find(const char *name)
+{
+	struct parse_cache *pc;
+
+	for (pc = parse_cache; pc < parse_cache + ARRAY_SIZE(parse_cache);
+	     pc++) {
+		if (pc->name && !pc->stale && !strcmp(pc->name, name))
+			return pc;
+	}
+
+	return NULL;
+}
+
+/* Find a free entry, or else the least recently used one not running */
+static struct parse_cache *parse_cache_alloc(void)
+{
+	struct parse_cache *pc, *lru = NULL;
+
+	for (pc = parse_cache; pc < parse_cache + ARRAY_SIZE(parse_cache);
+	     pc++) {
+		if (!pc->name)
+			return pc;
+		if (!pc->busy && (!lru || pc->used < lru->used))
+			lru = pc;
+	}
+	if (lru)
+		parse_cache_free(lru);
+
+	return lru;
+}
+
+void parse_cache_drop(const char *name)
+{
+	struct parse_cache *pc = parse_cache_find(name);
+
+	if (!pc)
+		return;
+	if (pc->busy)
+		pc->stale = 1;
+	else
+		parse_cache_free(pc);
+}
+
+int parse_var_outer(const char *name, const char *s, int flag)
+{
+	struct parse_cache *pc;
+	struct in_str input;
+	struct pipe *list;
+	uint32_t hash;
+	size_t len;
+	char *p;
+	int rcode, code;
+
+	if (!s || !*s)
+		return 1;
+	len = strlen(s);
+	hash = crc32(0, (const uchar *)s, len);
+	pc = parse_cache_find(name);
+	if (pc && pc->busy)
+		return parse_string_outer(s, flag);
+	if (pc && (pc->hash != hash || pc->len != len)) {
+		parse_cache_free(pc);
+		pc = NULL;
+	}
+
+	if (!pc) {
+		/* only the first line is run, as with parse_string_outer() */
+		p = xmalloc(len + 2);
+		strcpy(p, s);
+		strcat(p, "\n");
+		setup_string_in_str(&input, p);
+		list = parse_stream_list(&input, flag, &rcode);
+		free(p);
+		if (!list)
+			return 1;
+		pc = parse_cache_alloc();
+		if (pc)
+			pc->name = strdup(name);
+		if (!pc || !pc->name) {
+			/* nowhere to keep it, so just run it this once */
+			code = run_list(list);
+			goto done;
+		}
+		pc->hash = hash;
+		pc->len = len;
+		pc->list = list;
+	}
+
+	pc->used = ++parse_cache_count;
+	pc->busy = 1;
+	code = run_list_real(pc->list);
+	pc->busy = 0;
+	if (pc->stale)
+		parse_cache_free(pc);
+done:
+	if (code == -2)		/* exit */
+		code = 0;
+	if (code == -1)
+		flag_repeat = 0;
+
+	return (code != 0) ? 1 : 0;
+}
+#endif /* CONFIG_HUSH_PARSE_CACHE */
+
 #ifndef __U_BOOT__
 static int parse_file_outer(FILE *f)
 #else
@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Writing of Android sparse images to block devices
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <image-sparse.h>
+#include <malloc.h>
+#include <mmc.h>
+#include <asm/byteorder.h>
+
+int is_sparse_image(const void *buf)
+{
+	const sparse_header_t *hdr = buf;
+
+	return le32_to_cpu(hdr->magic) == SPARSE_HEADER_MAGIC;
+}
+
+static void sparse_collect(struct sparse_state *state,
+			   enum sparse_phase phase, void *dest, int size)
+{
+	state->phase = phase;
+	state->collect = dest;
+	state->collect_len = 0;
+	state->collect_size = size;
+}
+
+void sparse_start(struct sparse_state *state, struct sparse_storage *info)
+{
+	memset(state, '\0', sizeof(*state));
+	state->info = info;
+	sparse_collect(state, SPARSE_FILE_HDR, &state->hdr,
+		       sizeof(sparse_header_t));
+}
+
+/* Move on to the next chunk, if there is one */
+static void sparse_next_chunk(struct sparse_state *state)
+{
+	if (state->chunk_num == le32_to_cpu(state->hdr.total_chunks))
+		state->phase = SPARSE_DONE;
+	else
+		sparse_collect(state, SPARSE_CHUNK_HDR, &state->chunk,
+			       sizeof(chunk_header_t));
+}
+
+static int sparse_file_hdr(struct sparse_state *state)
+{
+	struct sparse_storage *info = state->info;
+	sparse_header_t *hdr = &state->hdr;
+	unsigned int blk_sz = le32_to_cpu(hdr->blk_sz);
+	u64 total;
+
+	if (!is_sparse_image(hdr)) {
+		puts("sparse: Bad magic\n");
+		return -EINVAL;
+	}
+	if (le16_to_cpu(hdr->major_version) != SPARSE_HEADER_MAJOR_VER ||
+	    le16_to_cpu(hdr->file_hdr_sz) < sizeof(sparse_header_t) ||
+	    le16_to_cpu(hdr->chunk_hdr_sz) < sizeof(chunk_header_t)) {
+		printf("sparse: Unsupported version %d.%d\n",
+		       le16_to_cpu(hdr->major_version),
+		       le16_to_cpu(hdr->minor_version));
+		return -EINVAL;
+	}
+	if (!blk_sz || blk_sz % info->blksz) {
+		printf("sparse: Block size %u is not a multiple of %u\n",
+		       blk_sz, info->blksz);
+		return -EINVAL;
+	}
+	state->ratio = blk_sz / info->blksz;
+	total = (u64)le32_to_cpu(hdr->total_blks) * state->ratio;
+	if (total > info->size) {
+		printf("sparse: Image of %llu blocks does not fit in " LBAFU
+		       "\n", total, info->size);
+		return -ENOSPC;
+	}
+	state->total = total;
+	state->skip = le16_to_cpu(hdr->file_hdr_sz) - sizeof(sparse_header_t);
+
+	if (info->write) {
+		state->buf_size = max(blk_sz, CONFIG_SPARSE_BUF_SIZE / blk_sz *
+				      blk_sz);
+		state->buf = memalign(ARCH_DMA_MINALIGN, state->buf_size);
+		if (!state->buf) {
+			puts("sparse: Out of memory\n");
+			return -ENOMEM;
+		}
+	}
+	sparse_next_chunk(state);
+
+	return 0;
+}
+
+/* Write blocks from a buffer to the output */
+static int sparse_out(struct sparse_state *state, const void *buf,
+		      lbaint_t blkcnt)
+{
+	struct sparse_storage *info = state->info;
+
+	if (info->write && info->write(info, info->start + state->blk,
+				       blkcnt, buf) != blkcnt) {
+		printf("sparse: Write failed at block " LBAF "\n",
+		       info->start + state->blk);
+		return -EIO;
+	}
+	state->blk += blkcnt;
+
+	return 0;
+}
+
+/* Write the current fill pattern over blkcnt blocks of the output */
+static int sparse_fill(struct sparse_state *state, lbaint_t blkcnt)
+{
+	struct sparse_storage *info = state->info;
+	lbaint_t buf_blks = state->buf_size / info->blksz;
+	u32 *ptr;
+	int ret;
+
+	state->filled += blkcnt;
+	if (!info->write) {
+		state->blk += blkcnt;
+		return 0;
+	}
+	for (ptr = (u32 *)state->buf;
+	     ptr < (u32 *)(state->buf + state->buf_size); ptr++)
+		*ptr = state->value;
+	while (blkcnt) {
+		lbaint_t count = min(blkcnt, buf_blks);
+
+		ret = sparse_out(state, state->buf, count);
+		if (ret)
+			return ret;
+		blkcnt -= count;
+	}
+
+	return 0;
+}
+
+/*
+ * Skip over blkcnt blocks of the output, erasing any whole erase groups
+ * among them
+ */
+static int sparse_dont_care(struct sparse_state *state, lbaint_t blkcnt)
+{
+	struct sparse_storage *info = state->info;
+	lbaint_t grp = info->erase_grp, start, end;
+
+	start = info->start + state->blk;
+	end = start + blkcnt;
+	state->blk += blkcnt;
+	if (info->write && info->erase) {
+		start = (start + grp - 1) / grp * grp;
+		end = end / grp * grp;
+		if (start < end) {
+			if (info->erase(info, start, end - start) !=
+					end - start) {
+				printf("sparse: Erase failed at block " LBAF
+				       "\n", start);
+				return -EIO;
+			}
+			state->erased += end - start;
+			blkcnt -= end - start;
+		}
+	}
+	state->skipped += blkcnt;
+
+	return 0;
+}
+
+static int sparse_chunk_hdr(struct sparse_state *state)
+{
+	chunk_header_t *chunk = &state->chunk;
+	unsigned int hdr_sz = le16_to_cpu(state->hdr.chunk_hdr_sz);
+	u64 size = le32_to_cpu(chunk->total_sz);
+	lbaint_t blkcnt;
+	u64 expect;
+
+	state->chunk_num++;
+	blkcnt = (lbaint_t)le32_to_cpu(chunk->chunk_sz) * state->ratio;
+	switch (le16_to_cpu(chunk->chunk_type)) {
+	case CHUNK_TYPE_RAW:
+		expect = hdr_sz + (u64)le32_to_cpu(chunk->chunk_sz) *
+			le32_to_cpu(state->hdr.blk_sz);
+		break;
+	case CHUNK_TYPE_FILL:
+	case CHUNK_TYPE_CRC32:
+		expect = hdr_sz + sizeof(u32);
+		break;
+	case CHUNK_TYPE_DONT_CARE:
+		expect = hdr_sz;
+		break;
+	default:
+		printf("sparse: Unknown type %#x in chunk %u\n",
+		       le16_to_cpu(chunk->chunk_type), state->chunk_num);
+		return -EINVAL;
+	}
+	if (size != expect) {
+		printf("sparse: Chunk %u has size %llu, expected %llu\n",
+		       state->chunk_num, size, expect);
+		return -EINVAL;
+	}
+	if (blkcnt > state->total - state->blk) {
+		printf("sparse: Chunk %u is beyond the end of the image\n",
+		       state->chunk_num);
+		return -EINVAL;
+	}
+	state->skip = hdr_sz - sizeof(chunk_header_t);
+
+	switch (le16_to_cpu(chunk->chunk_type)) {
+	case CHUNK_TYPE_RAW:
+		state->phase = SPARSE_CHUNK_DATA;
+		state->data_left = size - hdr_sz;
+		state->written += blkcnt;
+		if (!state->data_left)
+			sparse_next_chunk(state);
+		break;
+	case CHUNK_TYPE_FILL:
+	case CHUNK_TYPE_CRC32:
+		sparse_collect(state, SPARSE_CHUNK_VALUE, &state->value,
+			       sizeof(u32));
+		break;
+	case CHUNK_TYPE_DONT_CARE:
+		sparse_next_chunk(state);
+		return sparse_dont_care(state, blkcnt);
+	}
+
+	return 0;
+}
+
+/*
+ * The CRC in a CRC32 chunk is not checked, since it covers don't-care
+ * regions too and so would need the output to be read back.
+ */
+static int sparse_chunk_value(struct sparse_state *state)
+{
+	lbaint_t blkcnt;
+
+	sparse_next_chunk(state);
+	if (le16_to_cpu(state->chunk.chunk_type) != CHUNK_TYPE_FILL)
+		return 0;
+	blkcnt = (lbaint_t)le32_to_cpu(state->chunk.chunk_sz) * state->ratio;
+
+	return sparse_fill(state, blkcnt);
+}
+
+/*
+ * Write raw chunk data. Whole blocks which are suitably aligned are
+ * written straight from the input, the rest is staged in our buffer.
+ */
+static int sparse_chunk_data(struct sparse_state *state, const u8 **datap,
+			     size_t *lenp)
+{
+	unsigned int blksz = state->info->blksz;
+	size_t len = min((u64)*lenp, state->data_left);
+	const u8 *data = *datap;
+	size_t count;
+	int ret;
+
+	*datap += len;
+	*lenp -= len;
+	state->data_left -= len;
+	if (!state->info->write) {
+		state->buf_len += len;
+		state->blk += state->buf_len / blksz;
+		state->buf_len %= blksz;
+		goto done;
+	}
+	while (len) {
+		if (!state->buf_len && len >= blksz &&
+		    !((ulong)data & (ARCH_DMA_MINALIGN - 1))) {
+			count = len / blksz;
+			ret = sparse_out(state, data, count);
+			if (ret)
+				return ret;
+			count *= blksz;
+		} else {
+			count = min(len, (size_t)(state->buf_size -
+						  state->buf_len));
+			memcpy(state->buf + state->buf_len, data, count);
+			state->buf_len += count;
+			if (state->buf_len == state->buf_size) {
+				ret = sparse_out(state, state->buf,
+						 state->buf_len / blksz);
+				if (ret)
+					return ret;
+				state->buf_len = 0;
+			}
+		}
+		data += count;
+		len -= count;
+	}
+done:
+	if (state->data_left)
+		return 0;
+
+	/* The chunk is a whole number of blocks, so nothing is left over */
+	sparse_next_chunk(state);
+	if (!state->buf_len)
+		return 0;
+	ret = sparse_out(state, state->buf, state->buf_len / blksz);
+	state->buf_len = 0;
+
+	return ret;
+}
+
+int sparse_write(struct sparse_state *state, const void *data, size_t len)
+{
+	const u8 *ptr = data;
+	size_t count;
+	int ret = 0;
+
+	while (len && !ret) {
+		if (state->skip) {
+			count = min(len, (size_t)state->skip);
+			state->skip -= count;
+			ptr += count;
+			len -= count;
+			continue;
+		}
+		switch (state->phase) {
+		case SPARSE_FILE_HDR:
+		case SPARSE_CHUNK_HDR:
+		case SPARSE_CHUNK_VALUE:
+			count = min(len, (size_t)(state->collect_size -
+						  state->collect_len));
+			memcpy(state->collect + state->collect_len, ptr, count);
+			state->collect_len += count;
+			ptr += count;
+			len -= count;
+			if (state->collect_len < state->collect_size)
+				break;
+			if (state->phase == SPARSE_FILE_HDR)
+				ret = sparse_file_hdr(state);
+			else if (state->phase == SPARSE_CHUNK_HDR)
+				ret = sparse_chunk_hdr(state);
+			else
+				ret = sparse_chunk_value(state);
+			break;
+		case SPARSE_CHUNK_DATA:
+			ret = sparse_chunk_data(state, &ptr, &len);
+			break;
+		case SPARSE_DONE:
+			len = 0;
+			break;
+		}
+	}
+
+	return ret;
+}
+
+int sparse_finish(struct sparse_state *state)
+{
+	struct sparse_storage *info = state->info;
+	int ret = 0;
+
+	free(state->buf);
+	state->buf = NULL;
+	if (state->phase != SPARSE_DONE) {
+		printf("sparse: Image incomplete, %u of %u chunks seen\n",
+		       state->chunk_num,
+		       le32_to_cpu(state->hdr.total_chunks));
+		return -EINVAL;
+	}
+	if (state->blk != state->total) {
+		printf("sparse: Chunks cover " LBAFU " of " LBAFU " blocks\n",
+		       state->blk, state->total);
+		ret = -EINVAL;
+	}
+	printf("sparse: %u chunks, " LBAFU " blocks of %u bytes: " LBAFU
+	       " written, " LBAFU " filled, " LBAFU " erased, " LBAFU
+	       " skipped\n", state->chunk_num, state->total, info->blksz,
+	       state->written, state->filled, state->erased, state->skipped);
+
+	return ret;
+}
+
+static unsigned long sparse_blk_write(struct sparse_storage *info,
+				      lbaint_t blk, lbaint_t blkcnt,
+				      const void *buffer)
+{
+	block_dev_desc_t *dev_desc = info->priv;
+
+	return dev_desc->block_write(dev_desc->dev, blk, blkcnt, buffer);
+}
+
+static unsigned long sparse_blk_erase(struct sparse_storage *info,
+				      lbaint_t blk, lbaint_t blkcnt)
+{
+	block_dev_desc_t *dev_desc = info->priv;
+
+	return dev_desc->block_erase(dev_desc->dev, blk, blkcnt);
+}
+
+void sparse_storage_blk_dev(struct sparse_storage *info,
+			    block_dev_desc_t *dev_desc, lbaint_t start,
+			    lbaint_t size)
+{
+#ifdef CONFIG_GENERIC_MMC
+	struct mmc *mmc;
+#endif
+
+	memset(info, '\0', sizeof(*info));
+	info->start = start;
+	info->size = size;
+	info->blksz = dev_desc->blksz;
+	info->erase_grp = 1;
+	info->write = sparse_blk_write;
+	if (dev_desc->block_erase)
+		info->erase = sparse_blk_erase;
+	info->priv = dev_desc;
+#ifdef CONFIG_GENERIC_MMC
+	if (dev_desc->if_type == IF_TYPE_MMC) {
+		mmc = find_mmc_device(dev_desc->dev);
+		if (mmc && mmc->erase_grp_size)
+			info->erase_grp = mmc->erase_grp_size;
+	}
+#endif
+}
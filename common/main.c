@@ -1544,8 +1544,15 @@ int do_run (cmd_tbl_t * cmdtp, int flag, int argc, char * const argv[])
 			return 1;
 		}
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+		/* keep the parsed script, as it is likely to be run again */
+		if (parse_var_outer(argv[i], arg,
+				    FLAG_PARSE_SEMICOLON | FLAG_EXIT_FROM_LOOP))
+			return 1;
+#else
 		if (run_command(arg, flag) != 0)
 			return 1;
+#endif
 	}
 	return 0;
 }
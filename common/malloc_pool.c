@@ -0,0 +1,286 @@
+/*
+ * Fixed-size-class pools for small allocations, in front of dlmalloc
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Much of U-Boot allocates and frees lots of small, short-lived objects:
+ * hush allocates per word and per command, the environment per variable
+ * and ext4 per path component and block. dlmalloc handles each of these
+ * by searching its bins, splitting and coalescing chunks. Here the top of
+ * the malloc() area is instead cut into slabs, each holding objects of a
+ * single size class, so a small allocation or free is just a push or pop
+ * on the free list of its class. Requests which are too large, need more
+ * alignment or do not fit in the remaining slabs go to dlmalloc.
+ *
+ * Slabs are given to a class as it needs them and are not handed back,
+ * which is fine for U-Boot's fairly steady mix of small objects. Pool
+ * objects are recognised by their address, so free() and realloc() need
+ * no header on each object.
+ */
+
+#include <common.h>
+#include <malloc.h>
+
+#ifndef CONFIG_SYS_MALLOC_POOL_SIZE
+#define CONFIG_SYS_MALLOC_POOL_SIZE	(256 << 10)
+#endif
+
+#define POOL_SLAB_SIZE		4096
+#define POOL_ALIGN		16
+#define POOL_MAX_SIZE		256
+#define POOL_MAX_SLABS		(CONFIG_SYS_MALLOC_POOL_SIZE / POOL_SLAB_SIZE)
+
+/* Object sizes, each a multiple of POOL_ALIGN */
+static const unsigned int pool_sizes[] = {
+	16, 32, 48, 64, 96, 128, 192, 256,
+};
+
+#define POOL_CLASSES		ARRAY_SIZE(pool_sizes)
+
+/* Size class for each request size, in units of POOL_ALIGN rounded up */
+static const u8 pool_size_class[POOL_MAX_SIZE / POOL_ALIGN + 1] = {
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+};
+
+struct pool_class {
+	void *free;			/* list of free objects */
+	struct malloc_pool_stats stats;
+};
+
+static struct {
+	ulong base;			/* first slab, 0 if not set up */
+	ulong end;
+	unsigned int slabs;
+	unsigned int slabs_used;
+	int enabled;
+	struct pool_class classes[POOL_CLASSES];
+	struct malloc_pool_stats large;
+	u8 slab_class[POOL_MAX_SLABS];	/* class owning each used slab */
+} pool;
+
+static inline int pool_owns(void *mem)
+{
+	return (ulong)mem >= pool.base && (ulong)mem < pool.end;
+}
+
+static inline struct pool_class *pool_class_of(void *mem)
+{
+	return &pool.classes[pool.slab_class[((ulong)mem - pool.base) /
+					     POOL_SLAB_SIZE]];
+}
+
+static inline void pool_count_alloc(struct malloc_pool_stats *stats)
+{
+	stats->allocs++;
+	if (++stats->in_use > stats->peak)
+		stats->peak = stats->in_use;
+}
+
+static inline void pool_count_free(struct malloc_pool_stats *stats)
+{
+	stats->frees++;
+	stats->in_use--;
+}
+
+/* Give a new slab to a class, threading its objects onto the free list */
+static int pool_add_slab(struct pool_class *pc)
+{
+	unsigned int size = pc->stats.size;
+	char *slab, *obj;
+	void *next = NULL;
+
+	if (pool.slabs_used == pool.slabs)
+		return -1;
+	pool.slab_class[pool.slabs_used] = pc - pool.classes;
+	slab = (char *)(pool.base + pool.slabs_used * POOL_SLAB_SIZE);
+	pool.slabs_used++;
+	pc->stats.slabs++;
+
+	/* lowest address first, so that neighbours are allocated together */
+	for (obj = slab + (POOL_SLAB_SIZE / size - 1) * size; obj >= slab;
+	     obj -= size) {
+		*(void **)obj = next;
+		next = obj;
+	}
+	pc->free = next;
+
+	return 0;
+}
+
+static void *pool_alloc(size_t bytes)
+{
+	struct pool_class *pc;
+	void *obj;
+
+	pc = &pool.classes[pool_size_class[(bytes + POOL_ALIGN - 1) /
+					   POOL_ALIGN]];
+	if (!pc->free && pool_add_slab(pc)) {
+		pc->stats.fallbacks++;
+		return NULL;
+	}
+	obj = pc->free;
+	pc->free = *(void **)obj;
+	pool_count_alloc(&pc->stats);
+
+	return obj;
+}
+
+static void pool_free(void *mem)
+{
+	struct pool_class *pc = pool_class_of(mem);
+
+	*(void **)mem = pc->free;
+	pc->free = mem;
+	pool_count_free(&pc->stats);
+}
+
+void *malloc(size_t bytes)
+{
+	void *mem;
+
+	if (bytes <= POOL_MAX_SIZE && pool.enabled) {
+		mem = pool_alloc(bytes);
+		if (mem)
+			return mem;
+	}
+	mem = dlmalloc(bytes);
+	if (mem)
+		pool_count_alloc(&pool.large);
+
+	return mem;
+}
+
+void free(void *mem)
+{
+	if (pool_owns(mem)) {
+		pool_free(mem);
+	} else if (mem) {
+		pool_count_free(&pool.large);
+		dlfree(mem);
+	}
+}
+
+void *realloc(void *oldmem, size_t bytes)
+{
+	unsigned int size;
+	void *mem;
+
+	if (!oldmem)
+		return malloc(bytes);
+	if (!pool_owns(oldmem))
+		return dlrealloc(oldmem, bytes);
+
+	size = pool_class_of(oldmem)->stats.size;
+	if (bytes <= size)
+		return oldmem;
+	mem = malloc(bytes);
+	if (mem) {
+		memcpy(mem, oldmem, size);
+		pool_free(oldmem);
+	}
+
+	return mem;
+}
+
+void *memalign(size_t alignment, size_t bytes)
+{
+	void *mem;
+
+	if (alignment <= POOL_ALIGN)
+		return malloc(bytes);
+	mem = dlmemalign(alignment, bytes);
+	if (mem)
+		pool_count_alloc(&pool.large);
+
+	return mem;
+}
+
+void *calloc(size_t n, size_t elem_size)
+{
+	size_t bytes = n * elem_size;
+	void *mem;
+
+	if (bytes <= POOL_MAX_SIZE && pool.enabled) {
+		mem = pool_alloc(bytes);
+		if (mem) {
+			memset(mem, '\0', bytes);
+			return mem;
+		}
+	}
+	/* dlcalloc() knows when the memory is already clear */
+	mem = dlcalloc(n, elem_size);
+	if (mem)
+		pool_count_alloc(&pool.large);
+
+	return mem;
+}
+
+size_t malloc_usable_size(void *mem)
+{
+	if (pool_owns(mem))
+		return pool_class_of(mem)->stats.size;
+
+	return dlmalloc_usable_size(mem);
+}
+
+ulong malloc_pool_init(ulong start, ulong size)
+{
+	ulong end = start + size;
+	ulong base;
+	int i;
+
+	/* leave most of a small malloc() area to dlmalloc */
+	if (size < 4 * CONFIG_SYS_MALLOC_POOL_SIZE)
+		return 0;
+	base = (end - CONFIG_SYS_MALLOC_POOL_SIZE) & ~(POOL_SLAB_SIZE - 1);
+
+	memset(&pool, '\0', sizeof(pool));
+	for (i = 0; i < POOL_CLASSES; i++)
+		pool.classes[i].stats.size = pool_sizes[i];
+	pool.base = base;
+	pool.slabs = POOL_MAX_SLABS;
+	pool.end = base + pool.slabs * POOL_SLAB_SIZE;
+	pool.enabled = 1;
+
+	return end - base;
+}
+
+void malloc_pool_enable(int enable)
+{
+	pool.enabled = enable && pool.base;
+}
+
+void malloc_pool_get_info(struct malloc_pool_info *info)
+{
+	static struct malloc_pool_stats classes[POOL_CLASSES];
+	int i;
+
+	for (i = 0; i < POOL_CLASSES; i++)
+		classes[i] = pool.classes[i].stats;
+	info->enabled = pool.enabled;
+	info->slab_size = POOL_SLAB_SIZE;
+	info->slabs = pool.slabs;
+	info->slabs_used = pool.slabs_used;
+	info->count = POOL_CLASSES;
+	info->classes = classes;
+	info->large = &pool.large;
+}
+
+static void pool_reset_stats(struct malloc_pool_stats *stats)
+{
+	stats->allocs = 0;
+	stats->frees = 0;
+	stats->fallbacks = 0;
+	stats->peak = stats->in_use;
+}
+
+void malloc_pool_reset_stats(void)
+{
+	int i;
+
+	for (i = 0; i < POOL_CLASSES; i++)
+		pool_reset_stats(&pool.classes[i].stats);
+	pool_reset_stats(&pool.large);
+}
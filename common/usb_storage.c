@@ -33,6 +33,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <malloc.h>
 #include <asm/byteorder.h>
 #include <asm/processor.h>
 
@@ -131,19 +132,34 @@ struct us_data {
 	trans_cmnd	transport;		/* transport routine */
 };
 
-#ifdef CONFIG_USB_EHCI
-/*
- * The U-Boot EHCI driver can handle any transfer length as long as there is
- * enough free heap space left, but the SCSI READ(10) and WRITE(10) commands are
- * limited to 65535 blocks.
- */
+/* The SCSI READ(10) and WRITE(10) commands are limited to 65535 blocks */
 #define USB_MAX_XFER_BLK	65535
-#else
-#define USB_MAX_XFER_BLK	20
-#endif
+
+/* Transfer size for host controller drivers which do not give one */
+#define USB_DEFAULT_XFER_BLK	20
 
 static struct us_data usb_stor[USB_MAX_STOR_DEV];
 
+#ifdef CONFIG_USB_STORAGE_READAHEAD
+/* Blocks read beyond what was asked for, kept for the next read */
+struct usb_stor_cache {
+	int device;		/* usb_dev_desc[] index, -1 if empty */
+	lbaint_t start;		/* first block held */
+	lbaint_t count;		/* number of blocks held */
+	unsigned char *buf;
+	unsigned long size;	/* size of buf in bytes */
+};
+
+static struct usb_stor_cache usb_stor_cache = { .device = -1 };
+
+static void usb_stor_cache_invalidate(void)
+{
+	usb_stor_cache.device = -1;
+}
+#else
+static inline void usb_stor_cache_invalidate(void) {}
+#endif
+
 
 #define USB_STOR_TRANSPORT_GOOD	   0
 #define USB_STOR_TRANSPORT_FAILED -1
@@ -221,6 +237,7 @@ int usb_stor_scan(int mode)
 		printf("       scanning usb for storage devices... ");
 
 	usb_disable_asynch(1); /* asynch transfer not allowed */
+	usb_stor_cache_invalidate();
 
 	for (i = 0; i < USB_MAX_STOR_DEV; i++) {
 		memset(&usb_dev_desc[i], 0, sizeof(block_dev_desc_t));
@@ -1037,38 +1054,36 @@ static void usb_bin_fixup(struct usb_device_descriptor descriptor,
 }
 #endif /* CONFIG_USB_BIN_FIXUP */
 
-unsigned long usb_stor_read(int device, lbaint_t blknr,
-			    lbaint_t blkcnt, void *buffer)
+/*
+ * Number of blocks to move with each READ(10) or WRITE(10) command: as much
+ * as the host controller driver can take in one bulk transfer
+ */
+static unsigned short usb_max_xfer_blk(block_dev_desc_t *dev_desc)
+{
+#ifdef USB_MAX_BULK_XFER
+	return min(USB_MAX_BULK_XFER / dev_desc->blksz,
+		   (unsigned long)USB_MAX_XFER_BLK);
+#else
+	return USB_DEFAULT_XFER_BLK;
+#endif
+}
+
+/* Read blocks from the device, returning the number read successfully */
+static lbaint_t usb_stor_read_blocks(int device, struct us_data *ss,
+				     lbaint_t blknr, lbaint_t blkcnt,
+				     void *buffer)
 {
 	lbaint_t start, blks;
 	uintptr_t buf_addr;
-	unsigned short smallblks;
-	struct usb_device *dev;
-	struct us_data *ss;
-	int retry, i;
+	unsigned short smallblks, max_blks;
+	int retry;
 	ccb *srb = &usb_ccb;
 
-	if (blkcnt == 0)
-		return 0;
-
-	device &= 0xff;
-	/* Setup  device */
-	debug("\nusb_read: dev %d \n", device);
-	dev = NULL;
-	for (i = 0; i < USB_MAX_DEVICE; i++) {
-		dev = usb_get_dev_index(i);
-		if (dev == NULL)
-			return 0;
-		if (dev->devnum == usb_dev_desc[device].target)
-			break;
-	}
-	ss = (struct us_data *)dev->privptr;
-
-	usb_disable_asynch(1); /* asynch transfer not allowed */
 	srb->lun = usb_dev_desc[device].lun;
 	buf_addr = (unsigned long)buffer;
 	start = blknr;
 	blks = blkcnt;
+	max_blks = usb_max_xfer_blk(&usb_dev_desc[device]);
 
 	debug("\nusb_read: dev %d startblk " LBAF ", blccnt " LBAF
 	      " buffer %lx\n", device, start, blks, buf_addr);
@@ -1077,12 +1092,12 @@ unsigned long usb_stor_read(int device, lbaint_t blknr,
 		/* XXX need some comment here */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_XFER_BLK)
-			smallblks = USB_MAX_XFER_BLK;
+		if (blks > max_blks)
+			smallblks = max_blks;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_XFER_BLK)
+		if (smallblks == max_blks)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
@@ -1104,18 +1119,108 @@ retry_it:
 	      ", blccnt %x buffer %lx\n",
 	      start, smallblks, buf_addr);
 
-	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_XFER_BLK)
+	if (blkcnt >= max_blks)
 		debug("\n");
 	return blkcnt;
 }
 
+#ifdef CONFIG_USB_STORAGE_READAHEAD
+/*
+ * Read blocks through the read-ahead cache. Requests for fewer than
+ * CONFIG_USB_STORAGE_READAHEAD blocks fetch that many, so that the next
+ * small sequential read is a memcpy() rather than a SCSI command. Larger
+ * requests go straight to the device.
+ */
+static lbaint_t usb_stor_read_cached(int device, struct us_data *ss,
+				     lbaint_t blknr, lbaint_t blkcnt,
+				     void *buffer)
+{
+	struct usb_stor_cache *cache = &usb_stor_cache;
+	block_dev_desc_t *dev_desc = &usb_dev_desc[device];
+	unsigned long size;
+	lbaint_t done = 0;
+	lbaint_t count;
+
+	while (done < blkcnt) {
+		if (cache->device == device && blknr >= cache->start &&
+		    blknr < cache->start + cache->count) {
+			count = min(cache->start + cache->count - blknr,
+				    blkcnt - done);
+			memcpy(buffer, cache->buf + (blknr - cache->start) *
+			       dev_desc->blksz, count * dev_desc->blksz);
+		} else if (blkcnt - done < CONFIG_USB_STORAGE_READAHEAD &&
+			   blknr < dev_desc->lba) {
+			count = min((lbaint_t)CONFIG_USB_STORAGE_READAHEAD,
+				    dev_desc->lba - blknr);
+			size = count * dev_desc->blksz;
+			if (cache->size < size) {
+				free(cache->buf);
+				cache->buf = memalign(ARCH_DMA_MINALIGN, size);
+				cache->size = cache->buf ? size : 0;
+			}
+			cache->device = -1;
+			if (!cache->buf || usb_stor_read_blocks(device, ss,
+					blknr, count, cache->buf) != count)
+				return done + usb_stor_read_blocks(device, ss,
+					blknr, blkcnt - done, buffer);
+			cache->device = device;
+			cache->start = blknr;
+			cache->count = count;
+			continue;
+		} else {
+			return done + usb_stor_read_blocks(device, ss, blknr,
+							   blkcnt - done,
+							   buffer);
+		}
+		done += count;
+		blknr += count;
+		buffer += count * dev_desc->blksz;
+	}
+
+	return done;
+}
+#endif
+
+unsigned long usb_stor_read(int device, lbaint_t blknr,
+			    lbaint_t blkcnt, void *buffer)
+{
+	struct usb_device *dev;
+	struct us_data *ss;
+	int i;
+
+	if (blkcnt == 0)
+		return 0;
+
+	device &= 0xff;
+	/* Setup  device */
+	debug("\nusb_read: dev %d \n", device);
+	dev = NULL;
+	for (i = 0; i < USB_MAX_DEVICE; i++) {
+		dev = usb_get_dev_index(i);
+		if (dev == NULL)
+			return 0;
+		if (dev->devnum == usb_dev_desc[device].target)
+			break;
+	}
+	ss = (struct us_data *)dev->privptr;
+
+	usb_disable_asynch(1); /* asynch transfer not allowed */
+#ifdef CONFIG_USB_STORAGE_READAHEAD
+	blkcnt = usb_stor_read_cached(device, ss, blknr, blkcnt, buffer);
+#else
+	blkcnt = usb_stor_read_blocks(device, ss, blknr, blkcnt, buffer);
+#endif
+	usb_disable_asynch(0); /* asynch transfer allowed */
+
+	return blkcnt;
+}
+
 unsigned long usb_stor_write(int device, lbaint_t blknr,
 				lbaint_t blkcnt, const void *buffer)
 {
 	lbaint_t start, blks;
 	uintptr_t buf_addr;
-	unsigned short smallblks;
+	unsigned short smallblks, max_blks;
 	struct usb_device *dev;
 	struct us_data *ss;
 	int retry, i;
@@ -1138,11 +1243,13 @@ unsigned long usb_stor_write(int device, lbaint_t blknr,
 	ss = (struct us_data *)dev->privptr;
 
 	usb_disable_asynch(1); /* asynch transfer not allowed */
+	usb_stor_cache_invalidate();
 
 	srb->lun = usb_dev_desc[device].lun;
 	buf_addr = (unsigned long)buffer;
 	start = blknr;
 	blks = blkcnt;
+	max_blks = usb_max_xfer_blk(&usb_dev_desc[device]);
 
 	debug("\nusb_write: dev %d startblk " LBAF ", blccnt " LBAF
 	      " buffer %lx\n", device, start, blks, buf_addr);
@@ -1153,12 +1260,12 @@ unsigned long usb_stor_write(int device, lbaint_t blknr,
 		 */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_XFER_BLK)
-			smallblks = USB_MAX_XFER_BLK;
+		if (blks > max_blks)
+			smallblks = max_blks;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_XFER_BLK)
+		if (smallblks == max_blks)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
@@ -1180,7 +1287,7 @@ retry_it:
 	      start, smallblks, buf_addr);
 
 	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_XFER_BLK)
+	if (blkcnt >= max_blks)
 		debug("\n");
 	return blkcnt;
 
@@ -193,6 +193,15 @@ CPPFLAGS += -ffunction-sections -fdata-sections
 LDFLAGS_FINAL += --gc-sections
 endif
 
+# The sampling profiler follows the frame pointer to find each caller.
+# Pass 'PROFILE_UNWIND=1' for boards which enable it only when asked.
+ifdef PROFILE_UNWIND
+CPPFLAGS += -DPROFILE_UNWIND
+endif
+ifdef CONFIG_SAMPLE_PROFILE_UNWIND
+CPPFLAGS += -fno-omit-frame-pointer
+endif
+
 # TODO(sjg@chromium.org): Is this correct on Mac OS?
 ifdef CONFIG_FIT_SIGNATURE
 HOSTLIBS	+= -lssl -lcrypto
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Block devices backed by files on the host, so that filesystems and
+ * partition code can be exercised on sandbox: "sb bind 0 disk.img" and then
+ * for example "fatls hostblk 0".
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <os.h>
+#include <part.h>
+#include <sandboxblockdev.h>
+
+#ifndef CONFIG_HOST_MAX_DEVICES
+#define CONFIG_HOST_MAX_DEVICES	4
+#endif
+
+struct host_block_dev {
+	block_dev_desc_t blk_dev;
+	char *filename;
+	int fd;
+	unsigned long reads;	/* number of read requests */
+	unsigned long blocks;	/* number of blocks read */
+};
+
+static struct host_block_dev host_devices[CONFIG_HOST_MAX_DEVICES];
+
+static struct host_block_dev *find_host_device(int dev)
+{
+	if (dev < 0 || dev >= CONFIG_HOST_MAX_DEVICES)
+		return NULL;
+
+	return &host_devices[dev];
+}
+
+static unsigned long host_block_read(int dev, lbaint_t start, lbaint_t blkcnt,
+				     void *buffer)
+{
+	struct host_block_dev *host_dev = find_host_device(dev);
+	ssize_t len;
+
+	if (!host_dev || !host_dev->filename)
+		return -1;
+	if (os_lseek(host_dev->fd, start * host_dev->blk_dev.blksz,
+		     OS_SEEK_SET) == -1) {
+		printf("ERROR: Invalid position\n");
+		return -1;
+	}
+	len = os_read(host_dev->fd, buffer, blkcnt * host_dev->blk_dev.blksz);
+	if (len < 0)
+		return -1;
+	host_dev->reads++;
+	host_dev->blocks += blkcnt;
+
+	return len / host_dev->blk_dev.blksz;
+}
+
+static unsigned long host_block_write(int dev, lbaint_t start, lbaint_t blkcnt,
+				      const void *buffer)
+{
+	struct host_block_dev *host_dev = find_host_device(dev);
+	ssize_t len;
+
+	if (!host_dev || !host_dev->filename)
+		return -1;
+	if (os_lseek(host_dev->fd, start * host_dev->blk_dev.blksz,
+		     OS_SEEK_SET) == -1) {
+		printf("ERROR: Invalid position\n");
+		return -1;
+	}
+	len = os_write(host_dev->fd, buffer, blkcnt * host_dev->blk_dev.blksz);
+	if (len < 0)
+		return -1;
+
+	return len / host_dev->blk_dev.blksz;
+}
+
+/**
+ * host_dev_bind() - Attach a host file to a host block device
+ *
+ * @dev:	Device number to bind
+ * @filename:	Host file to use, or NULL to unbind the device
+ * @return 0 if OK, -1 on error
+ */
+int host_dev_bind(int dev, char *filename)
+{
+	struct host_block_dev *host_dev = find_host_device(dev);
+	block_dev_desc_t *blk_dev;
+	int fd;
+
+	if (!host_dev)
+		return -1;
+	if (host_dev->filename) {
+		os_close(host_dev->fd);
+		free(host_dev->filename);
+		host_dev->filename = NULL;
+	}
+	blk_dev = &host_dev->blk_dev;
+	blk_dev->type = DEV_TYPE_UNKNOWN;
+	if (!filename)
+		return 0;
+
+	fd = os_open(filename, OS_O_RDWR);
+	if (fd == -1) {
+		printf("Failed to access host backing file '%s'\n", filename);
+		return -1;
+	}
+	host_dev->filename = strdup(filename);
+	if (!host_dev->filename) {
+		os_close(fd);
+		return -1;
+	}
+	host_dev->fd = fd;
+	host_dev->reads = 0;
+	host_dev->blocks = 0;
+
+	blk_dev->if_type = IF_TYPE_HOST;
+	blk_dev->dev = dev;
+	blk_dev->part_type = PART_TYPE_UNKNOWN;
+	blk_dev->type = DEV_TYPE_HARDDISK;
+	blk_dev->blksz = 512;
+	blk_dev->log2blksz = LOG2(blk_dev->blksz);
+	blk_dev->lba = os_lseek(fd, 0, OS_SEEK_END) / blk_dev->blksz;
+	blk_dev->block_read = host_block_read;
+	blk_dev->block_write = host_block_write;
+	init_part(blk_dev);
+
+	return 0;
+}
+
+/**
+ * host_dev_info() - Print the host block devices and their read counts
+ */
+void host_dev_info(void)
+{
+	struct host_block_dev *host_dev;
+	int dev;
+
+	printf("%3s %12s %8s %10s %s\n", "dev", "blocks", "reads",
+	       "read blks", "filename");
+	for (dev = 0; dev < CONFIG_HOST_MAX_DEVICES; dev++) {
+		host_dev = &host_devices[dev];
+		if (!host_dev->filename)
+			continue;
+		printf("%3d %12lu %8lu %10lu %s\n", dev,
+		       (unsigned long)host_dev->blk_dev.lba, host_dev->reads,
+		       host_dev->blocks, host_dev->filename);
+	}
+}
+
+block_dev_desc_t *host_get_dev(int dev)
+{
+	struct host_block_dev *host_dev = find_host_device(dev);
+
+	if (!host_dev || !host_dev->filename)
+		return NULL;
+
+	return &host_dev->blk_dev;
+}
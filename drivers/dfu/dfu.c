@@ -13,6 +13,7 @@
 #include <mmc.h>
 #include <fat.h>
 #include <dfu.h>
+#include <div64.h>
 #include <linux/list.h>
 #include <linux/compiler.h>
 
@@ -33,6 +34,9 @@ static int dfu_find_alt_num(const char *s)
 static unsigned char *dfu_buf;
 static unsigned long dfu_buf_size = CONFIG_SYS_DFU_DATA_BUF_SIZE;
 
+/* The entity whose previous buffer is still being written to the medium */
+static struct dfu_entity *dfu_pending;
+
 static unsigned char *dfu_free_buf(void)
 {
 	free(dfu_buf);
@@ -59,34 +63,91 @@ static unsigned char *dfu_get_buf(void)
 	return dfu_buf;
 }
 
-static int dfu_write_buffer_drain(struct dfu_entity *dfu)
+/*
+ * Writes use the buffer as two halves. While one half receives data from
+ * USB, the other is written to the medium a chunk at a time by
+ * dfu_write_poll(), which the caller runs between USB interrupts. This
+ * keeps the host busy sending the next blocks instead of waiting for
+ * each whole buffer to be written.
+ */
+
+/* Write up to limit bytes (0 for all) of the pending half to the medium */
+static int dfu_write_pending(struct dfu_entity *dfu, long limit)
 {
+	ulong start;
 	long w_size;
 	int ret;
 
 	/* flush size? */
-	w_size = dfu->i_buf - dfu->i_buf_start;
+	w_size = dfu->p_buf_end - dfu->p_buf;
 	if (w_size == 0)
 		return 0;
+	if (limit && w_size > limit)
+		w_size = limit;
 
 	/* update CRC32 */
-	dfu->crc = crc32(dfu->crc, dfu->i_buf_start, w_size);
+	dfu->crc = crc32(dfu->crc, dfu->p_buf, w_size);
 
-	ret = dfu->write_medium(dfu, dfu->offset, dfu->i_buf_start, &w_size);
-	if (ret)
+	start = get_timer(0);
+	ret = dfu->write_medium(dfu, dfu->offset, dfu->p_buf, &w_size);
+	dfu->w_busy += get_timer(start);
+	if (ret) {
 		debug("%s: Write error!\n", __func__);
+		dfu->w_error = ret;
+	}
 
-	/* point back */
-	dfu->i_buf = dfu->i_buf_start;
+	/* the medium may round the last write up to its block size */
+	dfu->p_buf = min(dfu->p_buf + w_size, dfu->p_buf_end);
 
 	/* update offset */
 	dfu->offset += w_size;
 
-	puts("#");
+	if (dfu->p_buf == dfu->p_buf_end) {
+		dfu_pending = NULL;
+		puts("#");
+	}
+
+	return ret;
+}
+
+/* Hand the receiving half to the medium, and receive into the other */
+static int dfu_write_buffer_drain(struct dfu_entity *dfu)
+{
+	u8 *half = dfu->i_buf_start;
+	long half_size = dfu->i_buf_end - dfu->i_buf_start;
+	int ret;
+
+	/* The medium must finish with the other half before we reuse it */
+	ret = dfu_write_pending(dfu, 0);
+
+	dfu->p_buf = half;
+	dfu->p_buf_end = dfu->i_buf;
+	if (dfu->p_buf != dfu->p_buf_end)
+		dfu_pending = dfu;
+
+	dfu->i_buf_start = half == dfu_buf ? dfu_buf + half_size : dfu_buf;
+	dfu->i_buf_end = dfu->i_buf_start + half_size;
+	dfu->i_buf = dfu->i_buf_start;
 
 	return ret;
 }
 
+void dfu_write_poll(void)
+{
+	if (dfu_pending)
+		dfu_write_pending(dfu_pending, dfu_pending->w_chunk);
+}
+
+/* Print the effective download speed, including waiting for the host */
+static void dfu_write_stats(struct dfu_entity *dfu)
+{
+	ulong msecs = max(get_timer(dfu->w_start), 1UL);
+
+	printf("%s (alt %d): %llu bytes in %lu ms, %llu KiB/s, medium busy %lu ms\n",
+	       dfu->name, dfu->alt, dfu->offset, msecs,
+	       lldiv((dfu->offset * 1000) >> 10, msecs), dfu->w_busy);
+}
+
 int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 {
 	int ret = 0;
@@ -105,8 +166,15 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 		dfu->i_buf_start = dfu_get_buf();
 		if (dfu->i_buf_start == NULL)
 			return -ENOMEM;
-		dfu->i_buf_end = dfu_get_buf() + dfu_buf_size;
+		/* keep the second half aligned for DMA */
+		dfu->i_buf_end = dfu_get_buf() + ((dfu_buf_size / 2) &
+					~(CONFIG_SYS_CACHELINE_SIZE - 1));
 		dfu->i_buf = dfu->i_buf_start;
+		dfu->p_buf = dfu->i_buf_start;
+		dfu->p_buf_end = dfu->i_buf_start;
+		dfu->w_start = get_timer(0);
+		dfu->w_busy = 0;
+		dfu->w_error = 0;
 
 		dfu->inited = 1;
 	}
@@ -157,12 +225,27 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 			ret = tret;
 	}
 
+	/* report a failed write from dfu_write_poll() on the next call */
+	if (ret == 0)
+		ret = dfu->w_error;
+
 	/* end? */
 	if (size == 0) {
+		/* Write out what is left in the last half */
+		tret = dfu_write_pending(dfu, 0);
+		if (ret == 0)
+			ret = tret;
+
 		/* Now try and flush to the medium if needed. */
-		if (dfu->flush_medium)
-			ret = dfu->flush_medium(dfu);
+		if (dfu->flush_medium) {
+			tret = dfu->flush_medium(dfu);
+			if (ret == 0)
+				ret = tret;
+		}
 		printf("\nDFU complete CRC32: 0x%08x\n", dfu->crc);
+		if (dfu->w_error)
+			printf("DFU write error %d\n", dfu->w_error);
+		dfu_write_stats(dfu);
 
 		/* clear everything */
 		dfu_free_buf();
@@ -327,6 +410,7 @@ void dfu_free_entities(void)
 {
 	struct dfu_entity *dfu, *p, *t = NULL;
 
+	dfu_pending = NULL;
 	list_for_each_entry_safe_reverse(dfu, p, &dfu_list, list) {
 		list_del(&dfu->list);
 		t = dfu;
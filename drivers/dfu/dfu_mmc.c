@@ -12,6 +12,8 @@
 #include <errno.h>
 #include <div64.h>
 #include <dfu.h>
+#include <image-sparse.h>
+#include <mmc.h>
 
 enum dfu_mmc_op {
 	DFU_OP_READ = 1,
@@ -22,6 +24,84 @@ static unsigned char __aligned(CONFIG_SYS_CACHELINE_SIZE)
 				dfu_file_buf[CONFIG_SYS_DFU_MAX_FILE_SIZE];
 static long dfu_file_buf_len;
 
+#ifdef CONFIG_IMAGE_SPARSE
+/*
+ * A raw image which starts with a sparse header is written through the
+ * sparse parser, so only its used blocks are written and don't-care
+ * regions are erased.
+ */
+static struct sparse_storage dfu_sparse_info;
+static struct sparse_state dfu_sparse;
+static int dfu_sparse_active;
+static int dfu_sparse_ret;
+
+/* Check whether a raw write is part of a sparse image */
+static int mmc_sparse_detect(struct dfu_entity *dfu, u64 offset, void *buf,
+			     long len)
+{
+	struct mmc *mmc;
+
+	if (offset)
+		return dfu_sparse_active;
+
+	/* A new image: drop whatever was left of the last one */
+	if (dfu_sparse_active)
+		sparse_finish(&dfu_sparse);
+	dfu_sparse_active = 0;
+	if (len < sizeof(sparse_header_t) || !is_sparse_image(buf))
+		return 0;
+	mmc = find_mmc_device(dfu->dev_num);
+	if (!mmc)
+		return 0;
+
+	sparse_storage_blk_dev(&dfu_sparse_info, &mmc->block_dev,
+			       dfu->data.mmc.lba_start, dfu->data.mmc.lba_size);
+	sparse_start(&dfu_sparse, &dfu_sparse_info);
+	dfu_sparse_active = 1;
+	dfu_sparse_ret = 0;
+	puts("dfu: Writing sparse image\n");
+
+	return 1;
+}
+
+static int mmc_sparse_write(void *buf, long len)
+{
+	/* Once the image is found to be bad, reject the rest of it */
+	if (!dfu_sparse_ret)
+		dfu_sparse_ret = sparse_write(&dfu_sparse, buf, len);
+
+	return dfu_sparse_ret;
+}
+
+static int mmc_sparse_flush(void)
+{
+	int ret;
+
+	if (!dfu_sparse_active)
+		return 0;
+	dfu_sparse_active = 0;
+	ret = sparse_finish(&dfu_sparse);
+
+	return dfu_sparse_ret ? dfu_sparse_ret : ret;
+}
+#else
+static inline int mmc_sparse_detect(struct dfu_entity *dfu, u64 offset,
+				    void *buf, long len)
+{
+	return 0;
+}
+
+static inline int mmc_sparse_write(void *buf, long len)
+{
+	return -ENOSYS;
+}
+
+static inline int mmc_sparse_flush(void)
+{
+	return 0;
+}
+#endif
+
 static int mmc_block_op(enum dfu_mmc_op op, struct dfu_entity *dfu,
 			u64 offset, void *buf, long *len)
 {
@@ -122,7 +202,10 @@ int dfu_write_medium_mmc(struct dfu_entity *dfu,
 
 	switch (dfu->layout) {
 	case DFU_RAW_ADDR:
-		ret = mmc_block_op(DFU_OP_WRITE, dfu, offset, buf, len);
+		if (mmc_sparse_detect(dfu, offset, buf, *len))
+			ret = mmc_sparse_write(buf, *len);
+		else
+			ret = mmc_block_op(DFU_OP_WRITE, dfu, offset, buf, len);
 		break;
 	case DFU_FS_FAT:
 	case DFU_FS_EXT4:
@@ -147,6 +230,8 @@ int dfu_flush_medium_mmc(struct dfu_entity *dfu)
 
 		/* Now that we're done */
 		dfu_file_buf_len = 0;
+	} else {
+		ret = mmc_sparse_flush();
 	}
 
 	return ret;
@@ -232,6 +317,11 @@ int dfu_fill_entity_mmc(struct dfu_entity *dfu, char *s)
 	dfu->write_medium = dfu_write_medium_mmc;
 	dfu->flush_medium = dfu_flush_medium_mmc;
 
+	/* Files are only buffered until the end, so write them in one go */
+	if (dfu->layout == DFU_RAW_ADDR)
+		dfu->w_chunk = ALIGN(CONFIG_SYS_DFU_WRITE_CHUNK,
+				     dfu->data.mmc.lba_blk_size);
+
 	/* initial state */
 	dfu->inited = 0;
 
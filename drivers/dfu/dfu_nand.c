@@ -182,6 +182,16 @@ int dfu_fill_entity_nand(struct dfu_entity *dfu, char *s)
 	dfu->read_medium = dfu_read_medium_nand;
 	dfu->write_medium = dfu_write_medium_nand;
 
+	/*
+	 * Each write erases the blocks it covers first, so must not share
+	 * an erase block with the next one
+	 */
+	if (nand_curr_device >= 0 &&
+	    nand_curr_device < CONFIG_SYS_MAX_NAND_DEVICE &&
+	    nand_info[nand_curr_device].erasesize)
+		dfu->w_chunk = roundup(CONFIG_SYS_DFU_WRITE_CHUNK,
+				nand_info[nand_curr_device].erasesize);
+
 	/* initial state */
 	dfu->inited = 0;
 
@@ -13,6 +13,10 @@
 #include <mmc.h>
 #include <sdhci.h>
 
+#if defined(CONFIG_MMC_SDMA) && defined(CONFIG_MMC_SDHCI_ADMA)
+#error "Please select only one of CONFIG_MMC_SDMA and CONFIG_MMC_SDHCI_ADMA"
+#endif
+
 void *aligned_buffer;
 
 static void sdhci_reset(struct sdhci_host *host, u8 mask)
@@ -81,6 +85,12 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 		stat = sdhci_readl(host, SDHCI_INT_STATUS);
 		if (stat & SDHCI_INT_ERROR) {
 			printf("Error detected in status(0x%X)!\n", stat);
+#ifdef CONFIG_MMC_SDHCI_ADMA
+			if (stat & SDHCI_INT_ADMA_ERROR)
+				printf("ADMA error 0x%x at descriptor 0x%x\n",
+				       sdhci_readb(host, SDHCI_ADMA_ERROR),
+				       sdhci_readl(host, SDHCI_ADMA_ADDRESS));
+#endif
 			return -1;
 		}
 		if (stat & rdy) {
@@ -110,6 +120,47 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 	return 0;
 }
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+/*
+ * Describe a buffer to the controller as a chain of ADMA2 descriptors, so
+ * that the whole transfer runs without interrupting the CPU at each DMA
+ * boundary. Descriptors are split on SDHCI_ADMA_MAX_LEN boundaries.
+ *
+ * @return 0 if ok, -1 if the buffer cannot be transferred with ADMA2
+ */
+static int sdhci_adma_prepare(struct sdhci_host *host, unsigned int addr,
+			      unsigned int len)
+{
+	struct sdhci_adma_desc *desc = host->adma_desc;
+	unsigned int chunk;
+
+	/* 32-bit ADMA2 needs word-aligned buffers */
+	if (!desc || (addr & 0x3))
+		return -1;
+
+	while (len) {
+		if (desc == host->adma_desc + host->adma_count)
+			return -1;
+		chunk = SDHCI_ADMA_MAX_LEN - (addr & (SDHCI_ADMA_MAX_LEN - 1));
+		chunk = min(chunk, len);
+		desc->attr = cpu_to_le16(SDHCI_ADMA_VALID | SDHCI_ADMA_ACT_TRAN);
+		desc->len = cpu_to_le16(chunk);
+		desc->addr = cpu_to_le32(addr);
+		addr += chunk;
+		len -= chunk;
+		desc++;
+	}
+	desc[-1].attr |= cpu_to_le16(SDHCI_ADMA_END);
+
+	flush_cache((unsigned long)host->adma_desc,
+		    roundup((desc - host->adma_desc) * sizeof(*desc),
+			    ARCH_DMA_MINALIGN));
+	sdhci_writel(host, (unsigned int)host->adma_desc, SDHCI_ADMA_ADDRESS);
+
+	return 0;
+}
+#endif
+
 int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		       struct mmc_data *data)
 {
@@ -118,6 +169,9 @@ int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	int ret = 0;
 	int trans_bytes = 0, is_aligned = 1;
 	u32 mask, flags, mode;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	u8 ctrl;
+#endif
 	unsigned int timeout, start_addr = 0;
 	unsigned int retry = 10000;
 
@@ -185,6 +239,21 @@ int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 
 		sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
 		mode |= SDHCI_TRNS_DMA;
+#elif defined(CONFIG_MMC_SDHCI_ADMA)
+		/* Unaligned buffers are rare, and are done by PIO */
+		start_addr = (unsigned int)data->dest;
+		if (!sdhci_adma_prepare(host, start_addr, trans_bytes)) {
+			ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+			ctrl &= ~SDHCI_CTRL_DMA_MASK;
+			ctrl |= SDHCI_CTRL_ADMA32;
+			sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+			mode |= SDHCI_TRNS_DMA;
+		}
+
+		/* Let the controller stop the transfer, see add_sdhci() */
+		if (cmd->cmdidx == MMC_CMD_READ_MULTIPLE_BLOCK ||
+		    cmd->cmdidx == MMC_CMD_WRITE_MULTIPLE_BLOCK)
+			mode |= SDHCI_TRNS_ACMD12;
 #endif
 		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 				data->blocksize),
@@ -194,7 +263,7 @@ int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	}
 
 	sdhci_writel(host, cmd->cmdarg, SDHCI_ARGUMENT);
-#ifdef CONFIG_MMC_SDMA
+#if defined(CONFIG_MMC_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
 	flush_cache(start_addr, trans_bytes);
 #endif
 	sdhci_writew(host, SDHCI_MAKE_CMD(cmd->cmdidx, flags), SDHCI_COMMAND);
@@ -381,6 +450,24 @@ int sdhci_init(struct mmc *mmc)
 		}
 	}
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/*
+	 * Room for the largest transfer, which need not be aligned. Without
+	 * a table, as when the controller cannot do ADMA2, PIO is used.
+	 */
+	if (!host->adma_desc &&
+	    (sdhci_readl(host, SDHCI_CAPABILITIES) & SDHCI_CAN_DO_ADMA2)) {
+		host->adma_count = mmc->b_max * MMC_MAX_BLOCK_LEN /
+				SDHCI_ADMA_MAX_LEN + 2;
+		host->adma_desc = memalign(ARCH_DMA_MINALIGN,
+				host->adma_count * sizeof(*host->adma_desc));
+		if (!host->adma_desc) {
+			printf("ADMA descriptor alloc failed!!!");
+			return -1;
+		}
+	}
+#endif
+
 	sdhci_set_power(host, fls(mmc->voltages) - 1);
 
 	if (host->quirks & SDHCI_QUIRK_NO_CD) {
@@ -410,7 +497,7 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 	struct mmc *mmc;
 	unsigned int caps;
 
-	mmc = malloc(sizeof(struct mmc));
+	mmc = calloc(1, sizeof(struct mmc));
 	if (!mmc) {
 		printf("mmc malloc fail!\n");
 		return -1;
@@ -418,6 +505,10 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 
 	mmc->priv = host;
 	host->mmc = mmc;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/* Allocated on first use by sdhci_init() */
+	host->adma_desc = NULL;
+#endif
 
 	sprintf(mmc->name, "%s", host->name);
 	mmc->send_cmd = sdhci_send_command;
@@ -433,6 +524,10 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 		return -1;
 	}
 #endif
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	if (!(caps & SDHCI_CAN_DO_ADMA2))
+		debug("%s: no ADMA2, using PIO\n", host->name);
+#endif
 
 	if (max_clk)
 		mmc->f_max = max_clk;
@@ -476,6 +571,13 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 	}
 	if (host->host_caps)
 		mmc->host_caps |= host->host_caps;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/*
+	 * Auto CMD12 ends a multi-block transfer as soon as the last block
+	 * is done, saving a round trip through mmc_read_blocks().
+	 */
+	mmc->host_caps |= MMC_MODE_AUTO_CMD12;
+#endif
 
 	sdhci_reset(host, SDHCI_RESET_ALL);
 	mmc_register(mmc);
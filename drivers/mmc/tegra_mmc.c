@@ -14,6 +14,7 @@
 #include <asm/arch/clock.h>
 #include <asm/arch-tegra/clk_rst.h>
 #include <asm/arch-tegra/tegra_mmc.h>
+#include <malloc.h>
 #include <mmc.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -57,17 +58,58 @@ static void mmc_set_power(struct mmc_host *host, unsigned short power)
 	writeb(pwr, &host->reg->pwrcon);
 }
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+/*
+ * Build an ADMA2 descriptor table for a buffer, so that the controller
+ * moves all of it without stopping at each SDMA boundary.
+ *
+ * @return 0 if ok, -1 if the table is too small for this buffer
+ */
+static int mmc_adma_prepare(struct mmc_host *host, u32 addr, u32 len)
+{
+	struct tegra_mmc_adma_desc *desc = host->adma_desc;
+	u32 chunk;
+
+	while (len) {
+		if (desc == host->adma_desc + host->adma_count)
+			return -1;
+		chunk = TEGRA_MMC_ADMA_MAX_LEN -
+			(addr & (TEGRA_MMC_ADMA_MAX_LEN - 1));
+		chunk = min(chunk, len);
+		desc->attr = TEGRA_MMC_ADMA_VALID | TEGRA_MMC_ADMA_ACT_TRAN;
+		desc->len = chunk;
+		desc->addr = addr;
+		addr += chunk;
+		len -= chunk;
+		desc++;
+	}
+	desc[-1].attr |= TEGRA_MMC_ADMA_END;
+
+	flush_dcache_range((unsigned long)host->adma_desc,
+			   roundup((unsigned long)desc, ARCH_DMA_MINALIGN));
+	writel((u32)host->adma_desc, &host->reg->admaaddr);
+
+	return 0;
+}
+#endif
+
 static void mmc_prepare_data(struct mmc_host *host, struct mmc_data *data,
 				struct bounce_buffer *bbstate)
 {
 	unsigned char ctrl;
-
+	unsigned char dmasel = TEGRA_MMC_HOSTCTL_DMASEL_SDMA;
 
 	debug("buf: %p (%p), data->blocks: %u, data->blocksize: %u\n",
 		bbstate->bounce_buffer, bbstate->user_buffer, data->blocks,
 		data->blocksize);
 
-	writel((u32)bbstate->bounce_buffer, &host->reg->sysad);
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	if (!mmc_adma_prepare(host, (u32)bbstate->bounce_buffer,
+			      data->blocks * data->blocksize))
+		dmasel = TEGRA_MMC_HOSTCTL_DMASEL_ADMA2_32BIT;
+	else
+#endif
+		writel((u32)bbstate->bounce_buffer, &host->reg->sysad);
 	/*
 	 * DMASEL[4:3]
 	 * 00 = Selects SDMA
@@ -77,7 +119,7 @@ static void mmc_prepare_data(struct mmc_host *host, struct mmc_data *data,
 	 */
 	ctrl = readb(&host->reg->hostctl);
 	ctrl &= ~TEGRA_MMC_HOSTCTL_DMASEL_MASK;
-	ctrl |= TEGRA_MMC_HOSTCTL_DMASEL_SDMA;
+	ctrl |= dmasel;
 	writeb(ctrl, &host->reg->hostctl);
 
 	/* We do not handle DMA boundaries, so set it to max (512 KiB) */
@@ -85,7 +127,8 @@ static void mmc_prepare_data(struct mmc_host *host, struct mmc_data *data,
 	writew(data->blocks, &host->reg->blkcnt);
 }
 
-static void mmc_set_transfer_mode(struct mmc_host *host, struct mmc_data *data)
+static void mmc_set_transfer_mode(struct mmc_host *host, struct mmc_cmd *cmd,
+				  struct mmc_data *data)
 {
 	unsigned short mode;
 	debug(" mmc_set_transfer_mode called\n");
@@ -108,6 +151,13 @@ static void mmc_set_transfer_mode(struct mmc_host *host, struct mmc_data *data)
 	if (data->flags & MMC_DATA_READ)
 		mode |= TEGRA_MMC_TRNMOD_DATA_XFER_DIR_SEL_READ;
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/* The controller sends the stop, see do_mmc_init() */
+	if (cmd->cmdidx == MMC_CMD_READ_MULTIPLE_BLOCK ||
+	    cmd->cmdidx == MMC_CMD_WRITE_MULTIPLE_BLOCK)
+		mode |= TEGRA_MMC_TRNMOD_AUTO_CMD12_ENABLE;
+#endif
+
 	writew(mode, &host->reg->trnmod);
 }
 
@@ -164,7 +214,7 @@ static int mmc_send_cmd_bounced(struct mmc *mmc, struct mmc_cmd *cmd,
 	writel(cmd->cmdarg, &host->reg->argument);
 
 	if (data)
-		mmc_set_transfer_mode(host, data);
+		mmc_set_transfer_mode(host, cmd, data);
 
 	if ((cmd->resp_type & MMC_RSP_136) && (cmd->resp_type & MMC_RSP_BUSY))
 		return -1;
@@ -277,6 +327,11 @@ static int mmc_send_cmd_bounced(struct mmc *mmc, struct mmc_cmd *cmd,
 				writel(mask, &host->reg->norintsts);
 				printf("%s: error during transfer: 0x%08x\n",
 						__func__, mask);
+#ifdef CONFIG_MMC_SDHCI_ADMA
+				debug("ADMA error 0x%02x at descriptor 0x%08x\n",
+				      readb(&host->reg->admaerr),
+				      (u32)readl(&host->reg->admaaddr));
+#endif
 				return -1;
 			} else if (mask & TEGRA_MMC_NORINTSTS_DMA_INTERRUPT) {
 				/*
@@ -475,6 +530,20 @@ static int mmc_core_init(struct mmc *mmc)
 	host->version = readw(&host->reg->hcver);
 	debug("host version = %x\n", host->version);
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/* Room for the largest transfer, which need not be aligned */
+	if (!host->adma_desc) {
+		host->adma_count = mmc->b_max * MMC_MAX_BLOCK_LEN /
+				TEGRA_MMC_ADMA_MAX_LEN + 2;
+		host->adma_desc = memalign(ARCH_DMA_MINALIGN,
+				host->adma_count * sizeof(*host->adma_desc));
+		if (!host->adma_desc) {
+			printf("%s: ADMA descriptor alloc failed\n", __func__);
+			return -1;
+		}
+	}
+#endif
+
 	/* mask all */
 	writel(0xffffffff, &host->reg->norintstsen);
 	writel(0xffffffff, &host->reg->norintsigen);
@@ -571,6 +640,13 @@ static int do_mmc_init(int dev_index)
 	if (host->width >= 4)
 		mmc->host_caps |= MMC_MODE_4BIT;
 	mmc->host_caps |= MMC_MODE_HS_52MHz | MMC_MODE_HS | MMC_MODE_HC;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/*
+	 * Auto CMD12 ends a multi-block transfer as soon as the last block
+	 * is done, saving a round trip through mmc_read_blocks().
+	 */
+	mmc->host_caps |= MMC_MODE_AUTO_CMD12;
+#endif
 
 	/*
 	 * min freq is for card identification, and is the highest
@@ -29,6 +29,10 @@
 #define CONFIG_SYS_NAND_BASE_LIST { CONFIG_SYS_NAND_BASE }
 #endif
 
+#ifndef CONFIG_SYS_NAND_BBT_CACHE_BLOCKS
+#define CONFIG_SYS_NAND_BBT_CACHE_BLOCKS	2
+#endif
+
 DECLARE_GLOBAL_DATA_PTR;
 
 int nand_curr_device = -1;
@@ -58,6 +62,19 @@ int nand_register(int devnum)
 	sprintf(dev_name[devnum], "nand%d", devnum);
 	mtd->name = dev_name[devnum];
 
+#if defined(CONFIG_SYS_NAND_BBT_CACHE) && \
+	defined(CONFIG_SYS_NAND_BBT_CACHE_OFFS)
+	if (devnum == 0) {
+		struct nand_chip *chip = mtd->priv;
+
+		if (!chip->bbt_cache_blocks) {
+			chip->bbt_cache_offs = CONFIG_SYS_NAND_BBT_CACHE_OFFS;
+			chip->bbt_cache_blocks =
+				CONFIG_SYS_NAND_BBT_CACHE_BLOCKS;
+		}
+	}
+#endif
+
 #ifdef CONFIG_MTD_DEVICE
 	/*
 	 * Add MTD device so that we can reference it later
@@ -456,12 +456,13 @@ static int nand_default_block_markbad(struct mtd_info *mtd, loff_t ofs)
 		nand_release_device(mtd);
 	}
 
-	/* Update flash-based bad block table */
-	if (chip->bbt_options & NAND_BBT_USE_FLASH) {
+	/* Update flash-based bad block table, or the cached one */
+	if (chip->bbt_options & NAND_BBT_USE_FLASH)
 		res = nand_update_bbt(mtd, ofs);
-		if (!ret)
-			ret = res;
-	}
+	else
+		res = nand_save_bbt_cache(mtd);
+	if (!ret)
+		ret = res;
 
 	if (!ret)
 		mtd->ecc_stats.badblocks++;
@@ -512,6 +513,9 @@ static int nand_block_checkbad(struct mtd_info *mtd, loff_t ofs, int getchip,
 	if (!chip->bbt)
 		return chip->block_bad(mtd, ofs, getchip);
 
+	/* A cached BBT may be missing blocks marked bad since it was saved */
+	nand_check_bbt_cache(mtd, ofs, getchip);
+
 	/* Return info from the table */
 	return nand_isbad_bbt(mtd, ofs, allowbbt);
 }
@@ -1217,6 +1221,53 @@ static uint8_t *nand_transfer_oob(struct nand_chip *chip, uint8_t *oob,
 	return NULL;
 }
 
+/**
+ * nand_cache_read_last - [INTERN] Plan a sequential cache read
+ * @mtd: MTD device structure
+ * @chip: nand chip info structure
+ * @page: page number about to be read, after NAND_CMD_READ0
+ * @col: column to start reading from in this page
+ * @readlen: number of bytes still to read, from @col
+ * @ops: oob ops structure
+ *
+ * With READ CACHE SEQUENTIAL the chip loads the next page into its data
+ * register while the current one is transferred from its cache register,
+ * so that a long read costs the larger of tR and the transfer time per
+ * page rather than their sum. Only whole pages read with ecc.read_page or
+ * ecc.read_page_raw are read this way, and not past the end of the block.
+ *
+ * Returns the last page to read in the sequence, or -1 to read @page
+ * normally.
+ */
+static int nand_cache_read_last(struct mtd_info *mtd, struct nand_chip *chip,
+				int page, int col, uint32_t readlen,
+				struct mtd_oob_ops *ops)
+{
+	int block_mask = (1 << (chip->phys_erase_shift - chip->page_shift)) - 1;
+	int subpage, last;
+	uint64_t end;
+
+	if (!NAND_HAS_CACHE_READ(chip) ||
+	    chip->ecc.read_page == nand_read_page_hwecc_oob_first)
+		return -1;
+
+	/* Partial pages may be read with ecc.read_subpage instead */
+	subpage = NAND_HAS_SUBPAGE_READ(chip) && !ops->oobbuf &&
+		ops->mode != MTD_OPS_RAW;
+	if (subpage && (col || readlen < mtd->writesize))
+		return -1;
+	end = (uint64_t)col + readlen;
+	if (!subpage)
+		end += mtd->writesize - 1;
+
+	/* Stop at the last page wanted, or the end of the block */
+	last = page | block_mask;
+	if ((end >> chip->page_shift) <= last - page)
+		last = page + (int)(end >> chip->page_shift) - 1;
+
+	return last > page ? last : -1;
+}
+
 /**
  * nand_do_read_ops - [INTERN] Read data with ECC
  * @mtd: MTD device structure
@@ -1231,6 +1282,7 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	int chipnr, page, realpage, col, bytes, aligned, oob_required;
 	struct nand_chip *chip = mtd->priv;
 	struct mtd_ecc_stats stats;
+	int cache_last = -1;
 	int ret = 0;
 	uint32_t readlen = ops->len;
 	uint32_t oobreadlen = ops->ooblen;
@@ -1263,7 +1315,33 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		if (realpage != chip->pagebuf || oob) {
 			bufpoi = aligned ? buf : chip->buffers->databuf;
 
-			chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00, page);
+			if (page <= cache_last) {
+				/* Next page of a sequential cache read */
+				if (page == cache_last) {
+					chip->cmdfunc(mtd,
+						      NAND_CMD_READCACHEEND,
+						      -1, -1);
+					cache_last = -1;
+				} else {
+					chip->cmdfunc(mtd,
+						      NAND_CMD_READCACHESEQ,
+						      -1, -1);
+				}
+			} else {
+				chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00, page);
+				cache_last = nand_cache_read_last(mtd, chip,
+						page, col, readlen, ops);
+				if (cache_last != -1) {
+					chip->cmdfunc(mtd,
+						      NAND_CMD_READCACHESEQ,
+						      -1, -1);
+					/* These pages will not be cached */
+					if (chip->pagebuf > realpage &&
+					    chip->pagebuf <= realpage +
+					    cache_last - page)
+						chip->pagebuf = -1;
+				}
+			}
 
 			/* Now read the page into the buffer */
 			if (unlikely(ops->mode == MTD_OPS_RAW))
@@ -1331,6 +1409,10 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		}
 	}
 
+	/* Finish a cache read cut short by an error */
+	if (cache_last != -1)
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+
 	ops->retlen = ops->len - (size_t) readlen;
 	if (oob)
 		ops->oobretlen = ops->ooblen - oobreadlen;
@@ -3019,6 +3101,14 @@ ident_done:
 	if (mtd->writesize > 512 && chip->cmdfunc == nand_command)
 		chip->cmdfunc = nand_command_lp;
 
+#if defined(CONFIG_SYS_NAND_CACHE_READ) && \
+	defined(CONFIG_SYS_NAND_ONFI_DETECTION)
+	/* Only our own command function is known to pass these on */
+	if (chip->onfi_version && chip->cmdfunc == nand_command_lp &&
+	    (le16_to_cpu(chip->onfi_params.opt_cmd) & ONFI_OPT_CMD_READ_CACHE))
+		chip->options |= NAND_CACHE_READ;
+#endif
+
 	name = type->name;
 #ifdef CONFIG_SYS_NAND_ONFI_DETECTION
 	if (chip->onfi_version)
@@ -53,6 +53,10 @@
  *
  * Multichip devices like DOC store the bad block info per floor.
  *
+ * Without a flash-based BBT, the memory BBT can be cached in a few reserved
+ * blocks (CONFIG_SYS_NAND_BBT_CACHE), so that the device need not be
+ * scanned each time U-Boot starts.
+ *
  * Following assumptions are made:
  * - bbts start at a page boundary, if autolocated on a block boundary
  * - the space necessary for a bbt in FLASH does not exceed a block boundary
@@ -68,6 +72,7 @@
 #include <linux/mtd/nand_ecc.h>
 #include <linux/bitops.h>
 #include <linux/string.h>
+#include <u-boot/crc.h>
 
 #include <asm/errno.h>
 
@@ -1100,6 +1105,203 @@ static void verify_bbt_descr(struct mtd_info *mtd, struct nand_bbt_descr *bd)
 	BUG_ON(table_size > (1 << this->bbt_erase_shift));
 }
 
+#ifdef CONFIG_SYS_NAND_BBT_CACHE
+/*
+ * Each copy of the cached BBT starts at the beginning of one of the
+ * chip->bbt_cache_blocks blocks from chip->bbt_cache_offs. Copies are
+ * written in turn to the blocks, so an interrupted update leaves the
+ * previous copy intact, and the valid copy with the highest sequence
+ * number is used.
+ */
+#define NAND_BBT_CACHE_MAGIC	0x43544242	/* "BBTC" */
+
+struct nand_bbt_cache_hdr {
+	uint32_t magic;
+	uint32_t seq;		/* incremented for each copy written */
+	uint64_t size;		/* mtd->size */
+	uint32_t erasesize;	/* mtd->erasesize */
+	uint32_t len;		/* bytes of BBT following the header */
+	uint32_t crc;		/* CRC32 of the BBT */
+	uint32_t hcrc;		/* CRC32 of the header before this field */
+};
+
+/* Size of one copy of the cached BBT, in whole pages */
+static size_t bbt_cache_size(struct mtd_info *mtd, int len)
+{
+	return ALIGN(sizeof(struct nand_bbt_cache_hdr) + len, mtd->writesize);
+}
+
+static int bbt_cache_valid(struct mtd_info *mtd,
+			   struct nand_bbt_cache_hdr *hdr, int len)
+{
+	return hdr->magic == NAND_BBT_CACHE_MAGIC &&
+		hdr->hcrc == crc32(0, (uint8_t *)hdr,
+				   offsetof(struct nand_bbt_cache_hdr, hcrc)) &&
+		hdr->size == mtd->size && hdr->erasesize == mtd->erasesize &&
+		hdr->len == len && hdr->crc == crc32(0, (uint8_t *)(hdr + 1),
+						     len);
+}
+
+/* Mark the cache blocks as reserved, so that they are not erased */
+static void bbt_cache_mark_region(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd->priv;
+	int block, i;
+
+	block = (int)(this->bbt_cache_offs >> this->bbt_erase_shift);
+	for (i = 0; i < this->bbt_cache_blocks; i++, block++)
+		this->bbt[block >> 2] |= 0x2 << ((block & 0x03) << 1);
+}
+
+/**
+ * bbt_cache_load - read the memory BBT from the cache
+ * @mtd: MTD device structure
+ *
+ * Returns 0 if a valid copy was found, -ve if the device must be scanned.
+ */
+static int bbt_cache_load(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd->priv;
+	int len = mtd->size >> (this->bbt_erase_shift + 2);
+	size_t size = bbt_cache_size(mtd, len), retlen;
+	struct nand_bbt_cache_hdr *hdr;
+	int i, res, found = -1;
+	loff_t offs;
+
+	hdr = malloc(size);
+	if (!hdr)
+		return -ENOMEM;
+	for (i = 0; i < this->bbt_cache_blocks; i++) {
+		offs = this->bbt_cache_offs +
+			((loff_t)i << this->bbt_erase_shift);
+		res = mtd_read(mtd, offs, size, &retlen, (uint8_t *)hdr);
+		if (res && !mtd_is_bitflip(res))
+			continue;
+		if (!bbt_cache_valid(mtd, hdr, len))
+			continue;
+		if (found != -1 && (int32_t)(hdr->seq - this->bbt_cache_seq) < 0)
+			continue;
+		memcpy(this->bbt, hdr + 1, len);
+		this->bbt_cache_seq = hdr->seq;
+		found = i;
+	}
+	free(hdr);
+	if (found == -1)
+		return -ENOENT;
+
+	/* Each good block's own marker is checked the first time it is used */
+	kfree(this->bbt_cache_unchecked);
+	this->bbt_cache_unchecked = malloc(DIV_ROUND_UP(len * 4, 8));
+	if (!this->bbt_cache_unchecked)
+		return -ENOMEM;
+	memset(this->bbt_cache_unchecked, 0xff, DIV_ROUND_UP(len * 4, 8));
+
+	pr_info("nand_bbt: Using cached BBT at 0x%012llx, sequence %u\n",
+		this->bbt_cache_offs + ((loff_t)found << this->bbt_erase_shift),
+		this->bbt_cache_seq);
+	return 0;
+}
+
+/**
+ * nand_check_bbt_cache - [NAND Interface] check a block the cache says is good
+ * @mtd: MTD device structure
+ * @offs: offset in the device
+ * @getchip: 0, if the chip is already selected
+ *
+ * Software other than U-Boot (e.g. Linux) may have marked blocks bad since
+ * the cache was written. So the first time a block which the cached BBT
+ * has as good is used, its bad block marker is read too, and if it is set
+ * the block is marked bad in the memory BBT.
+ */
+void nand_check_bbt_cache(struct mtd_info *mtd, loff_t offs, int getchip)
+{
+	struct nand_chip *this = mtd->priv;
+	int block = (int)(offs >> this->bbt_erase_shift);
+	uint8_t *unchecked = this->bbt_cache_unchecked;
+
+	if (!unchecked || !(unchecked[block >> 3] & (1 << (block & 0x07))))
+		return;
+	unchecked[block >> 3] &= ~(1 << (block & 0x07));
+
+	if ((this->bbt[block >> 2] >> ((block & 0x03) << 1)) & 0x03)
+		return;
+	if (!this->block_bad(mtd, offs, getchip))
+		return;
+
+	pr_info("nand_bbt: Block at 0x%012llx is marked bad, but not in the cached BBT\n",
+		(unsigned long long)offs);
+	this->bbt[block >> 2] |= 0x03 << ((block & 0x03) << 1);
+}
+
+/**
+ * nand_save_bbt_cache - [NAND Interface] write the memory BBT to the cache
+ * @mtd: MTD device structure
+ *
+ * This is called after the device is scanned and when a block is marked
+ * bad, if there is no flash-based BBT.
+ */
+int nand_save_bbt_cache(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd->priv;
+	int len = mtd->size >> (this->bbt_erase_shift + 2);
+	size_t size = bbt_cache_size(mtd, len), retlen;
+	struct nand_bbt_cache_hdr *hdr;
+	struct erase_info einfo;
+	int i, block, res = -EIO;
+	loff_t offs;
+
+	if (!this->bbt || !this->bbt_cache_blocks || this->bbt_td)
+		return 0;
+	hdr = malloc(size);
+	if (!hdr)
+		return -ENOMEM;
+	memset(hdr, 0xff, size);
+	hdr->magic = NAND_BBT_CACHE_MAGIC;
+	hdr->seq = ++this->bbt_cache_seq;
+	hdr->size = mtd->size;
+	hdr->erasesize = mtd->erasesize;
+	hdr->len = len;
+	memcpy(hdr + 1, this->bbt, len);
+	hdr->crc = crc32(0, (uint8_t *)(hdr + 1), len);
+	hdr->hcrc = crc32(0, (uint8_t *)hdr,
+			  offsetof(struct nand_bbt_cache_hdr, hcrc));
+
+	/* Start with the block after the last copy written */
+	for (i = 0; i < this->bbt_cache_blocks; i++) {
+		block = (hdr->seq + i) % this->bbt_cache_blocks;
+		offs = this->bbt_cache_offs +
+			((loff_t)block << this->bbt_erase_shift);
+		if (nand_isbad_bbt(mtd, offs, 1))
+			continue;
+
+		memset(&einfo, 0, sizeof(einfo));
+		einfo.mtd = mtd;
+		einfo.addr = offs;
+		einfo.len = mtd->erasesize;
+		res = nand_erase_nand(mtd, &einfo, 1);
+		if (!res)
+			res = mtd_write(mtd, offs, size, &retlen,
+					(uint8_t *)hdr);
+		if (!res)
+			break;
+		pr_warn("nand_bbt: Cannot write cached BBT at 0x%012llx\n",
+			offs);
+	}
+	free(hdr);
+
+	return res;
+}
+#else
+static inline int bbt_cache_load(struct mtd_info *mtd)
+{
+	return -ENOSYS;
+}
+
+static inline void bbt_cache_mark_region(struct mtd_info *mtd)
+{
+}
+#endif
+
 /**
  * nand_scan_bbt - [NAND Interface] scan, find, read and maybe create bad block table(s)
  * @mtd: MTD device structure
@@ -1121,6 +1323,8 @@ int nand_scan_bbt(struct mtd_info *mtd, struct nand_bbt_descr *bd)
 	struct nand_bbt_descr *md = this->bbt_md;
 
 	len = mtd->size >> (this->bbt_erase_shift + 2);
+	kfree(this->bbt_cache_unchecked);
+	this->bbt_cache_unchecked = NULL;
 	/*
 	 * Allocate memory (2bit per block) and clear the memory bad block
 	 * table.
@@ -1133,13 +1337,30 @@ int nand_scan_bbt(struct mtd_info *mtd, struct nand_bbt_descr *bd)
 	 * If no primary table decriptor is given, scan the device to build a
 	 * memory based bad block table.
 	 */
+	if (this->bbt_cache_blocks &&
+	    ((this->bbt_cache_offs & (mtd->erasesize - 1)) ||
+	     this->bbt_cache_offs + ((loff_t)this->bbt_cache_blocks <<
+				     this->bbt_erase_shift) > mtd->size)) {
+		pr_warn("nand_bbt: Invalid BBT cache location\n");
+		this->bbt_cache_blocks = 0;
+	}
+
 	if (!td) {
+		if (this->bbt_cache_blocks && !bbt_cache_load(mtd)) {
+			bbt_cache_mark_region(mtd);
+			return 0;
+		}
 		if ((res = nand_memory_bbt(mtd, bd))) {
 			pr_err("nand_bbt: can't scan flash and build the RAM-based BBT\n");
 			kfree(this->bbt);
 			this->bbt = NULL;
+			return res;
 		}
-		return res;
+		if (this->bbt_cache_blocks) {
+			bbt_cache_mark_region(mtd);
+			nand_save_bbt_cache(mtd);
+		}
+		return 0;
 	}
 	verify_bbt_descr(mtd, td);
 	verify_bbt_descr(mtd, md);
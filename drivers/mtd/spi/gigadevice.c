@@ -60,6 +60,7 @@ struct spi_flash *spi_flash_probe_gigadevice(struct spi_slave *spi, u8 *idcode)
 	flash->sector_size = flash->page_size * 16;
 	/* size = sector_size * sector_per_block * number of blocks */
 	flash->size = flash->sector_size * 16 * params->nr_blocks;
+	flash->erase_sizes = SECT_32K | SECT_64K;
 
 	return flash;
 }
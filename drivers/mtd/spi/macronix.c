@@ -23,6 +23,7 @@ struct macronix_spi_flash_params {
 	u16 idcode;
 	u16 nr_blocks;
 	const char *name;
+	u8 flags;
 };
 
 static const struct macronix_spi_flash_params macronix_spi_flash_table[] = {
@@ -60,6 +61,7 @@ static const struct macronix_spi_flash_params macronix_spi_flash_table[] = {
 		.idcode = 0x2618,
 		.nr_blocks = 256,
 		.name = "MX25L12855E",
+		.flags = SPI_OPM_RX_DIO | SPI_OPM_RX_QIO,
 	},
 };
 
@@ -90,6 +92,7 @@ struct spi_flash *spi_flash_probe_macronix(struct spi_slave *spi, u8 *idcode)
 	flash->page_size = 256;
 	flash->sector_size = 256 * 16 * 16;
 	flash->size = flash->sector_size * params->nr_blocks;
+	flash->rd_modes = params->flags & RD_FULL;
 
 	/* Clear BP# bits for read-only flash */
 	spi_flash_cmd_write_status(flash, 0);
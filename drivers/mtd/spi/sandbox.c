@@ -0,0 +1,323 @@
+/*
+ * Emulation of a SPI flash for sandbox, backed by a file on the host
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * The flash is a Winbond W25Q32 (4MiB, 256-byte pages, 4KiB sectors and
+ * 32KiB/64KiB blocks). It is given on the command line as
+ *
+ *	--spi_sf <bus>:<cs>:<file>
+ *
+ * and the whole file is held in memory, with changes written back to it
+ * as soon as they are made. A file which is missing or short is filled
+ * out with erased (0xff) bytes.
+ *
+ * Only single-line commands are understood. Like a real flash, programs
+ * and erases need a write enable first, and happen when the chip select
+ * is deasserted. Programming can only clear bits. Each program and erase
+ * is counted, and the counts are printed when the flash is released.
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <os.h>
+#include <spi_flash.h>
+#include <asm/spi.h>
+#include <asm/state.h>
+
+#include "spi_flash_internal.h"
+
+#define SANDBOX_SF_SIZE		(4 << 20)
+#define SANDBOX_SF_PAGE_SIZE	256
+
+/* Status register */
+#define STATUS_WEL		0x02
+
+static const u8 sandbox_sf_id[] = { SPI_FLASH_WINBOND_IDCODE0, 0x40, 0x16 };
+
+enum sandbox_sf_state {
+	SF_CMD,		/* waiting for the command */
+	SF_ADDR,	/* receiving the address */
+	SF_DUMMY,	/* receiving dummy bytes */
+	SF_READ,	/* sending data from the array */
+	SF_WRITE,	/* receiving data to program */
+	SF_ID,		/* sending the ID */
+	SF_STATUS,	/* sending the status register */
+	SF_CONFIG,	/* sending the configuration register */
+	SF_WRITE_STATUS, /* receiving the status/configuration registers */
+	SF_ERASE,	/* address received, erase at the end */
+	SF_IGNORE,	/* ignoring the rest of the command */
+};
+
+struct sandbox_sf {
+	int fd;			/* backing file */
+	u8 *data;		/* flash contents */
+	enum sandbox_sf_state state;
+	enum sandbox_sf_state next;	/* state after the address */
+	u8 cmd;			/* current command */
+	u32 addr;		/* current address */
+	int pos;		/* byte count within the current state */
+	int dummy;		/* dummy bytes after the address */
+	u8 status;
+	u8 config;
+	u8 page[SANDBOX_SF_PAGE_SIZE];	/* data to program */
+	u8 page_set[SANDBOX_SF_PAGE_SIZE]; /* which bytes of page[] are used */
+	unsigned long programs;	/* statistics */
+	unsigned long erases[3];	/* 4KiB, 32KiB, 64KiB */
+};
+
+/* Write part of the flash back to the file */
+static void sandbox_sf_sync(struct sandbox_sf *sbsf, u32 addr, u32 len)
+{
+	if (os_lseek(sbsf->fd, addr, OS_SEEK_SET) != addr ||
+	    os_write(sbsf->fd, sbsf->data + addr, len) != len)
+		printf("sandbox_sf: cannot write back %#x bytes at %#x\n",
+		       len, addr);
+}
+
+int sandbox_sf_setup(void **privp, unsigned int bus, unsigned int cs)
+{
+	struct sandbox_state *state = state_get_current();
+	struct sandbox_sf *sbsf;
+	unsigned int sf_bus, sf_cs;
+	const char *fname;
+	char *end;
+	ssize_t len;
+
+	if (!state->spi_sf)
+		return -ENODEV;
+	sf_bus = simple_strtoul(state->spi_sf, &end, 10);
+	if (*end++ != ':')
+		goto err_spec;
+	sf_cs = simple_strtoul(end, &end, 10);
+	if (*end++ != ':')
+		goto err_spec;
+	fname = end;
+	if (sf_bus != bus || sf_cs != cs)
+		return -ENODEV;
+
+	sbsf = malloc(sizeof(*sbsf));
+	if (!sbsf)
+		return -ENOMEM;
+	memset(sbsf, '\0', sizeof(*sbsf));
+	sbsf->data = os_malloc(SANDBOX_SF_SIZE);
+	if (!sbsf->data)
+		goto err_mem;
+
+	sbsf->fd = os_open(fname, OS_O_RDWR | OS_O_CREAT);
+	if (sbsf->fd < 0) {
+		printf("sandbox_sf: cannot open '%s'\n", fname);
+		os_free(sbsf->data, SANDBOX_SF_SIZE);
+		goto err_mem;
+	}
+	len = os_read(sbsf->fd, sbsf->data, SANDBOX_SF_SIZE);
+	if (len < 0)
+		len = 0;
+	if (len < SANDBOX_SF_SIZE) {
+		memset(sbsf->data + len, 0xff, SANDBOX_SF_SIZE - len);
+		sandbox_sf_sync(sbsf, len, SANDBOX_SF_SIZE - len);
+	}
+	*privp = sbsf;
+
+	return 0;
+
+err_mem:
+	free(sbsf);
+	return -ENOMEM;
+err_spec:
+	printf("sandbox_sf: expected <bus>:<cs>:<file>, not '%s'\n",
+	       state->spi_sf);
+	return -EINVAL;
+}
+
+void sandbox_sf_free(void *priv)
+{
+	struct sandbox_sf *sbsf = priv;
+
+	printf("sandbox_sf: %lu page programs, %lu/%lu/%lu 4K/32K/64K erases\n",
+	       sbsf->programs, sbsf->erases[0], sbsf->erases[1],
+	       sbsf->erases[2]);
+	os_close(sbsf->fd);
+	os_free(sbsf->data, SANDBOX_SF_SIZE);
+	free(sbsf);
+}
+
+void sandbox_sf_cs_activate(void *priv)
+{
+	struct sandbox_sf *sbsf = priv;
+
+	sbsf->state = SF_CMD;
+	sbsf->addr = 0;
+	sbsf->pos = 0;
+	memset(sbsf->page_set, '\0', sizeof(sbsf->page_set));
+}
+
+static void sandbox_sf_erase(struct sandbox_sf *sbsf)
+{
+	u32 size;
+	int i;
+
+	switch (sbsf->cmd) {
+	case CMD_ERASE_4K:
+		size = 4 << 10;
+		i = 0;
+		break;
+	case CMD_ERASE_32K:
+		size = 32 << 10;
+		i = 1;
+		break;
+	default:
+		size = 64 << 10;
+		i = 2;
+		break;
+	}
+	sbsf->addr &= ~(size - 1);
+	memset(sbsf->data + sbsf->addr, 0xff, size);
+	sandbox_sf_sync(sbsf, sbsf->addr, size);
+	sbsf->erases[i]++;
+}
+
+static void sandbox_sf_program(struct sandbox_sf *sbsf)
+{
+	u32 base = sbsf->addr & ~(SANDBOX_SF_PAGE_SIZE - 1);
+	int i;
+
+	for (i = 0; i < SANDBOX_SF_PAGE_SIZE; i++) {
+		if (sbsf->page_set[i])
+			sbsf->data[base + i] &= sbsf->page[i];
+	}
+	sandbox_sf_sync(sbsf, base, SANDBOX_SF_PAGE_SIZE);
+	sbsf->programs++;
+}
+
+void sandbox_sf_cs_deactivate(void *priv)
+{
+	struct sandbox_sf *sbsf = priv;
+
+	switch (sbsf->state) {
+	case SF_ERASE:
+		sandbox_sf_erase(sbsf);
+		break;
+	case SF_WRITE:
+		sandbox_sf_program(sbsf);
+		break;
+	case SF_WRITE_STATUS:
+		break;
+	default:
+		return;
+	}
+	sbsf->status &= ~STATUS_WEL;
+}
+
+/* Start a command, returning the state for its first byte after that */
+static enum sandbox_sf_state sandbox_sf_cmd(struct sandbox_sf *sbsf, u8 cmd)
+{
+	int write = sbsf->status & STATUS_WEL;
+
+	sbsf->cmd = cmd;
+	sbsf->dummy = 0;
+	switch (cmd) {
+	case CMD_READ_ID:
+		return SF_ID;
+	case CMD_READ_STATUS:
+		return SF_STATUS;
+	case CMD_READ_CONFIG:
+		return SF_CONFIG;
+	case CMD_WRITE_ENABLE:
+		sbsf->status |= STATUS_WEL;
+		return SF_IGNORE;
+	case CMD_WRITE_DISABLE:
+		sbsf->status &= ~STATUS_WEL;
+		return SF_IGNORE;
+	case CMD_WRITE_STATUS:
+		return write ? SF_WRITE_STATUS : SF_IGNORE;
+	case CMD_READ_ARRAY_FAST:
+		sbsf->dummy = 1;
+		/* no break */
+	case CMD_READ_ARRAY_SLOW:
+		sbsf->next = SF_READ;
+		return SF_ADDR;
+	case CMD_PAGE_PROGRAM:
+		sbsf->next = SF_WRITE;
+		return write ? SF_ADDR : SF_IGNORE;
+	case CMD_ERASE_4K:
+	case CMD_ERASE_32K:
+	case CMD_ERASE_64K:
+		sbsf->next = SF_ERASE;
+		return write ? SF_ADDR : SF_IGNORE;
+	default:
+		printf("sandbox_sf: unknown command %02x\n", cmd);
+		return SF_IGNORE;
+	}
+}
+
+void sandbox_sf_xfer(void *priv, const u8 *tx, u8 *rx, unsigned int bytes)
+{
+	struct sandbox_sf *sbsf = priv;
+	unsigned int i, off;
+	u8 in, out;
+
+	for (i = 0; i < bytes; i++) {
+		in = tx ? tx[i] : 0xff;
+		out = 0xff;
+
+		switch (sbsf->state) {
+		case SF_CMD:
+			sbsf->state = sandbox_sf_cmd(sbsf, in);
+			break;
+		case SF_ADDR:
+			sbsf->addr = (sbsf->addr << 8 | in) &
+					(SANDBOX_SF_SIZE - 1);
+			if (++sbsf->pos == 3) {
+				sbsf->pos = 0;
+				sbsf->state = sbsf->dummy ? SF_DUMMY :
+						sbsf->next;
+			}
+			break;
+		case SF_DUMMY:
+			if (++sbsf->pos == sbsf->dummy) {
+				sbsf->pos = 0;
+				sbsf->state = sbsf->next;
+			}
+			break;
+		case SF_READ:
+			out = sbsf->data[sbsf->addr];
+			sbsf->addr = (sbsf->addr + 1) & (SANDBOX_SF_SIZE - 1);
+			break;
+		case SF_WRITE:
+			/* the address wraps around within the page */
+			off = (sbsf->addr + sbsf->pos++) &
+					(SANDBOX_SF_PAGE_SIZE - 1);
+			sbsf->page[off] = in;
+			sbsf->page_set[off] = 1;
+			break;
+		case SF_ID:
+			if (sbsf->pos < sizeof(sandbox_sf_id))
+				out = sandbox_sf_id[sbsf->pos++];
+			else
+				out = 0;
+			break;
+		case SF_STATUS:
+			out = sbsf->status;
+			break;
+		case SF_CONFIG:
+			out = sbsf->config;
+			break;
+		case SF_WRITE_STATUS:
+			if (sbsf->pos++ == 0)
+				sbsf->status = in & ~(STATUS_WEL | STATUS_WIP);
+			else
+				sbsf->config = in;
+			break;
+		case SF_ERASE:
+		case SF_IGNORE:
+			break;
+		}
+
+		if (rx)
+			rx[i] = out;
+	}
+}
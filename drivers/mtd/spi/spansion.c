@@ -21,6 +21,7 @@ struct spansion_spi_flash_params {
 	u16 pages_per_sector;
 	u16 nr_sectors;
 	const char *name;
+	u8 flags;
 };
 
 static const struct spansion_spi_flash_params spansion_spi_flash_table[] = {
@@ -72,6 +73,7 @@ static const struct spansion_spi_flash_params spansion_spi_flash_table[] = {
 		.pages_per_sector = 256,
 		.nr_sectors = 64,
 		.name = "S25FL032P",
+		.flags = RD_FULL,
 	},
 	{
 		.idcode1 = 0x0216,
@@ -79,6 +81,7 @@ static const struct spansion_spi_flash_params spansion_spi_flash_table[] = {
 		.pages_per_sector = 256,
 		.nr_sectors = 128,
 		.name = "S25FL064P",
+		.flags = RD_FULL,
 	},
 	{
 		.idcode1 = 0x2018,
@@ -86,6 +89,7 @@ static const struct spansion_spi_flash_params spansion_spi_flash_table[] = {
 		.pages_per_sector = 256,
 		.nr_sectors = 256,
 		.name = "S25FL129P_64K/S25FL128S_64K",
+		.flags = RD_FULL,
 	},
 	{
 		.idcode1 = 0x0219,
@@ -93,6 +97,7 @@ static const struct spansion_spi_flash_params spansion_spi_flash_table[] = {
 		.pages_per_sector = 256,
 		.nr_sectors = 512,
 		.name = "S25FL256S_64K",
+		.flags = RD_FULL | ADDR_4B,
 	},
 	{
 		.idcode1 = 0x0220,
@@ -100,6 +105,7 @@ static const struct spansion_spi_flash_params spansion_spi_flash_table[] = {
 		.pages_per_sector = 256,
 		.nr_sectors = 1024,
 		.name = "S25FL512S_64K",
+		.flags = RD_FULL | ADDR_4B,
 	},
 };
 
@@ -135,6 +141,9 @@ struct spi_flash *spi_flash_probe_spansion(struct spi_slave *spi, u8 *idcode)
 	flash->page_size = 256;
 	flash->sector_size = 256 * params->pages_per_sector;
 	flash->size = flash->sector_size * params->nr_sectors;
+	flash->rd_modes = params->flags & RD_FULL;
+	if (params->flags & ADDR_4B)
+		flash->addr_width = 4;
 
 	return flash;
 }
@@ -18,12 +18,19 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-static void spi_flash_addr(u32 addr, u8 *cmd)
+/* Fill in the address after the command, returning the command length */
+static int spi_flash_addr(struct spi_flash *flash, u32 addr, u8 *cmd)
 {
+	int i = 1;
+
 	/* cmd[0] is actual command */
-	cmd[1] = addr >> 16;
-	cmd[2] = addr >> 8;
-	cmd[3] = addr >> 0;
+	if (flash->addr_width == 4)
+		cmd[i++] = addr >> 24;
+	cmd[i++] = addr >> 16;
+	cmd[i++] = addr >> 8;
+	cmd[i++] = addr >> 0;
+
+	return i;
 }
 
 static int spi_flash_read_write(struct spi_slave *spi,
@@ -154,24 +161,48 @@ int spi_flash_write_common(struct spi_flash *flash, const u8 *cmd,
 	return ret;
 }
 
+/*
+ * Pick the erase command for the next part of a range: the largest block
+ * which starts at offset and fits in len, or else a sector. There is no
+ * common 4-byte address command for 32KiB blocks.
+ */
+static u32 spi_flash_erase_block(struct spi_flash *flash, u32 offset,
+		size_t len, u8 *cmd)
+{
+	int addr_4b = flash->addr_width == 4;
+
+	if ((flash->erase_sizes & SECT_64K) && !(offset % 0x10000) &&
+	    len >= 0x10000) {
+		*cmd = addr_4b ? CMD_ERASE_64K_4B : CMD_ERASE_64K;
+		return 0x10000;
+	}
+	if ((flash->erase_sizes & SECT_32K) && !addr_4b &&
+	    !(offset % 0x8000) && len >= 0x8000) {
+		*cmd = CMD_ERASE_32K;
+		return 0x8000;
+	}
+	if (flash->sector_size == 4096)
+		*cmd = addr_4b ? CMD_ERASE_4K_4B : CMD_ERASE_4K;
+	else
+		*cmd = addr_4b ? CMD_ERASE_64K_4B : CMD_ERASE_64K;
+
+	return flash->sector_size;
+}
+
 int spi_flash_cmd_erase(struct spi_flash *flash, u32 offset, size_t len)
 {
 	u32 erase_size;
-	u8 cmd[4];
-	int ret = -1;
+	u8 cmd[SPI_FLASH_CMD_LEN];
+	int cmd_len, ret = -1;
 
-	erase_size = flash->sector_size;
-	if (offset % erase_size || len % erase_size) {
+	if (offset % flash->sector_size || len % flash->sector_size) {
 		debug("SF: Erase offset/length not multiple of erase size\n");
 		return -1;
 	}
 
-	if (erase_size == 4096)
-		cmd[0] = CMD_ERASE_4K;
-	else
-		cmd[0] = CMD_ERASE_64K;
-
 	while (len) {
+		erase_size = spi_flash_erase_block(flash, offset, len, cmd);
+
 #ifdef CONFIG_SPI_FLASH_BAR
 		u8 bank_sel;
 
@@ -183,12 +214,12 @@ int spi_flash_cmd_erase(struct spi_flash *flash, u32 offset, size_t len)
 			return ret;
 		}
 #endif
-		spi_flash_addr(offset, cmd);
+		cmd_len = spi_flash_addr(flash, offset, cmd);
 
 		debug("SF: erase %2x %2x %2x %2x (%x)\n", cmd[0], cmd[1],
 		      cmd[2], cmd[3], offset);
 
-		ret = spi_flash_write_common(flash, cmd, sizeof(cmd), NULL, 0);
+		ret = spi_flash_write_common(flash, cmd, cmd_len, NULL, 0);
 		if (ret < 0) {
 			debug("SF: erase failed\n");
 			break;
@@ -206,12 +237,12 @@ int spi_flash_cmd_write_multi(struct spi_flash *flash, u32 offset,
 {
 	unsigned long byte_addr, page_size;
 	size_t chunk_len, actual;
-	u8 cmd[4];
-	int ret = -1;
+	u8 cmd[SPI_FLASH_CMD_LEN];
+	int cmd_len, ret = -1;
 
 	page_size = flash->page_size;
 
-	cmd[0] = CMD_PAGE_PROGRAM;
+	cmd[0] = flash->addr_width == 4 ? CMD_PAGE_PROGRAM_4B : CMD_PAGE_PROGRAM;
 	for (actual = 0; actual < len; actual += chunk_len) {
 #ifdef CONFIG_SPI_FLASH_BAR
 		u8 bank_sel;
@@ -230,12 +261,12 @@ int spi_flash_cmd_write_multi(struct spi_flash *flash, u32 offset,
 		if (flash->spi->max_write_size)
 			chunk_len = min(chunk_len, flash->spi->max_write_size);
 
-		spi_flash_addr(offset, cmd);
+		cmd_len = spi_flash_addr(flash, offset, cmd);
 
 		debug("PP: 0x%p => cmd = { 0x%02x 0x%02x%02x%02x } chunk_len = %zu\n",
 		      buf + actual, cmd[0], cmd[1], cmd[2], cmd[3], chunk_len);
 
-		ret = spi_flash_write_common(flash, cmd, sizeof(cmd),
+		ret = spi_flash_write_common(flash, cmd, cmd_len,
 					buf + actual, chunk_len);
 		if (ret < 0) {
 			debug("SF: write failed\n");
@@ -271,12 +302,72 @@ int spi_flash_read_common(struct spi_flash *flash, const u8 *cmd,
 	return ret;
 }
 
+/*
+ * Send a read command, with its address (and dummy bytes) on the lanes
+ * chosen by spi_flash_read_config(), and read the data. The cache-aligned
+ * middle of the data is read separately if the controller can move it by
+ * DMA.
+ */
+static int spi_flash_read_data(struct spi_flash *flash, const u8 *cmd,
+		size_t cmd_len, void *data, size_t data_len)
+{
+	struct spi_slave *spi = flash->spi;
+	unsigned long lanes = flash->read_data_lanes;
+	size_t head = 0, bulk = 0;
+	int ret;
+
+	ret = spi_claim_bus(spi);
+	if (ret) {
+		debug("SF: unable to claim SPI bus\n");
+		return ret;
+	}
+
+	if (flash->read_addr_lanes) {
+		ret = spi_xfer(spi, 8, cmd, NULL, SPI_XFER_BEGIN);
+		if (!ret)
+			ret = spi_xfer(spi, (cmd_len - 1) * 8, cmd + 1, NULL,
+				       flash->read_addr_lanes);
+	} else {
+		ret = spi_xfer(spi, cmd_len * 8, cmd, NULL, SPI_XFER_BEGIN);
+	}
+	if (ret) {
+		debug("SF: Failed to send command (%zu bytes): %d\n",
+		      cmd_len, ret);
+		goto out;
+	}
+
+	if (spi->op_mode_rx & SPI_OPM_RX_BULK) {
+		head = -(ulong)data & (ARCH_DMA_MINALIGN - 1);
+		head = min(head, data_len);
+		bulk = (data_len - head) & ~(ARCH_DMA_MINALIGN - 1);
+	}
+	if (head)
+		ret = spi_xfer(spi, head * 8, NULL, data, lanes);
+	if (!ret && bulk)
+		ret = spi_xfer(spi, bulk * 8, NULL, data + head,
+			       lanes | SPI_XFER_BULK |
+			       (head + bulk == data_len ? SPI_XFER_END : 0));
+	if (!ret && head + bulk < data_len)
+		ret = spi_xfer(spi, (data_len - head - bulk) * 8, NULL,
+			       data + head + bulk, lanes | SPI_XFER_END);
+	if (ret)
+		debug("SF: Failed to transfer %zu bytes of data: %d\n",
+		      data_len, ret);
+
+out:
+	if (ret)
+		spi_xfer(spi, 0, NULL, NULL, SPI_XFER_END);
+	spi_release_bus(spi);
+
+	return ret;
+}
+
 int spi_flash_cmd_read_fast(struct spi_flash *flash, u32 offset,
 		size_t len, void *data)
 {
-	u8 cmd[5], bank_sel = 0;
+	u8 cmd[SPI_FLASH_CMD_LEN], bank_sel = 0;
 	u32 remain_len, read_len;
-	int ret = -1;
+	int cmd_len, ret = -1;
 
 	/* Handle memory-mapped SPI */
 	if (flash->memory_map) {
@@ -284,29 +375,33 @@ int spi_flash_cmd_read_fast(struct spi_flash *flash, u32 offset,
 		return 0;
 	}
 
-	cmd[0] = CMD_READ_ARRAY_FAST;
-	cmd[4] = 0x00;
+	cmd[0] = flash->read_cmd;
 
 	while (len) {
+		read_len = len;
+
+		/* With 3-byte addresses, a read cannot cross a 16MiB bank */
+		if (flash->addr_width != 4) {
 #ifdef CONFIG_SPI_FLASH_BAR
-		bank_sel = offset / SPI_FLASH_16MB_BOUN;
+			bank_sel = offset / SPI_FLASH_16MB_BOUN;
 
-		ret = spi_flash_cmd_bankaddr_write(flash, bank_sel);
-		if (ret) {
-			debug("SF: fail to set bank%d\n", bank_sel);
-			return ret;
-		}
+			ret = spi_flash_cmd_bankaddr_write(flash, bank_sel);
+			if (ret) {
+				debug("SF: fail to set bank%d\n", bank_sel);
+				return ret;
+			}
 #endif
-		remain_len = (SPI_FLASH_16MB_BOUN * (bank_sel + 1) - offset);
-		if (len < remain_len)
-			read_len = len;
-		else
-			read_len = remain_len;
+			remain_len = (SPI_FLASH_16MB_BOUN * (bank_sel + 1) -
+				      offset);
+			if (len > remain_len)
+				read_len = remain_len;
+		}
 
-		spi_flash_addr(offset, cmd);
+		cmd_len = spi_flash_addr(flash, offset, cmd);
+		memset(cmd + cmd_len, '\0', flash->dummy_byte);
+		cmd_len += flash->dummy_byte;
 
-		ret = spi_flash_read_common(flash, cmd, sizeof(cmd),
-							data, read_len);
+		ret = spi_flash_read_data(flash, cmd, cmd_len, data, read_len);
 		if (ret < 0) {
 			debug("SF: read failed\n");
 			break;
@@ -341,6 +436,9 @@ int spi_flash_cmd_bankaddr_write(struct spi_flash *flash, u8 bank_sel)
 	u8 cmd;
 	int ret;
 
+	if (flash->addr_width == 4)
+		return 0;
+
 	if (flash->bank_curr == bank_sel) {
 		debug("SF: not require to enable bank%d\n", bank_sel);
 		return 0;
@@ -362,6 +460,10 @@ int spi_flash_bank_config(struct spi_flash *flash, u8 idcode0)
 	u8 cmd;
 	u8 curr_bank = 0;
 
+	/* Not needed if the flash has 4-byte address commands */
+	if (flash->addr_width == 4)
+		return 0;
+
 	/* discover bank cmds */
 	switch (idcode0) {
 	case SPI_FLASH_SPANSION_IDCODE0:
@@ -394,6 +496,96 @@ int spi_flash_bank_config(struct spi_flash *flash, u8 idcode0)
 }
 #endif
 
+/* Set the quad enable bit, which quad read commands need */
+static int spi_flash_set_qeb(struct spi_flash *flash, u8 idcode0)
+{
+	u8 cmd, status[2];
+
+	switch (idcode0) {
+	case SPI_FLASH_SPANSION_IDCODE0:
+	case SPI_FLASH_WINBOND_IDCODE0:
+		cmd = CMD_READ_STATUS;
+		if (spi_flash_read_common(flash, &cmd, 1, &status[0], 1))
+			return -1;
+		cmd = CMD_READ_CONFIG;
+		if (spi_flash_read_common(flash, &cmd, 1, &status[1], 1))
+			return -1;
+		if (status[1] & STATUS_QEB_WINSPAN)
+			return 0;
+
+		/* status and configuration registers are written together */
+		status[1] |= STATUS_QEB_WINSPAN;
+		cmd = CMD_WRITE_STATUS;
+		return spi_flash_write_common(flash, &cmd, 1, status, 2);
+	case SPI_FLASH_MACRONIX_IDCODE0:
+		cmd = CMD_READ_STATUS;
+		if (spi_flash_read_common(flash, &cmd, 1, &status[0], 1))
+			return -1;
+		if (status[0] & STATUS_QEB_MXIC)
+			return 0;
+
+		return spi_flash_cmd_write_status(flash,
+						  status[0] | STATUS_QEB_MXIC);
+	case SPI_FLASH_STMICRO_IDCODE0:
+		/* Quad commands are enabled unless disabled in the NVCR */
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+/*
+ * Read commands, fastest first. The number of dummy bytes (including any
+ * mode byte) is counted on the lanes used for the address; it suits the
+ * default latency settings of the flashes which list the mode.
+ */
+static const struct {
+	u8 op_mode;		/* SPI_OPM_RX_* needed for this command */
+	u8 cmd;
+	u8 cmd_4b;		/* same with a 4-byte address */
+	u8 dummy_byte;
+	u8 addr_lanes;		/* SPI_XFER_* for address and dummy bytes */
+	u8 data_lanes;		/* SPI_XFER_* for data */
+} spi_flash_read_modes[] = {
+	{ SPI_OPM_RX_QIO, CMD_READ_QUAD_IO_FAST, CMD_READ_QUAD_IO_FAST_4B,
+	  3, SPI_XFER_QUAD, SPI_XFER_QUAD },
+	{ SPI_OPM_RX_QOF, CMD_READ_QUAD_OUTPUT_FAST,
+	  CMD_READ_QUAD_OUTPUT_FAST_4B, 1, 0, SPI_XFER_QUAD },
+	{ SPI_OPM_RX_DIO, CMD_READ_DUAL_IO_FAST, CMD_READ_DUAL_IO_FAST_4B,
+	  1, SPI_XFER_DUAL, SPI_XFER_DUAL },
+	{ SPI_OPM_RX_DOUT, CMD_READ_DUAL_OUTPUT_FAST,
+	  CMD_READ_DUAL_OUTPUT_FAST_4B, 1, 0, SPI_XFER_DUAL },
+	{ 0, CMD_READ_ARRAY_FAST, CMD_READ_ARRAY_FAST_4B, 1, 0, 0 },
+};
+
+/* Pick the fastest read command which both flash and controller support */
+static void spi_flash_read_config(struct spi_flash *flash, u8 idcode0)
+{
+	u8 modes = flash->rd_modes & flash->spi->op_mode_rx;
+	int i;
+
+	if ((modes & (SPI_OPM_RX_QOF | SPI_OPM_RX_QIO)) &&
+	    spi_flash_set_qeb(flash, idcode0)) {
+		debug("SF: fail to set quad enable bit\n");
+		modes &= ~(SPI_OPM_RX_QOF | SPI_OPM_RX_QIO);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(spi_flash_read_modes); i++) {
+		if ((modes & spi_flash_read_modes[i].op_mode) ==
+		    spi_flash_read_modes[i].op_mode)
+			break;
+	}
+
+	flash->read_cmd = flash->addr_width == 4 ?
+			spi_flash_read_modes[i].cmd_4b :
+			spi_flash_read_modes[i].cmd;
+	flash->dummy_byte = spi_flash_read_modes[i].dummy_byte;
+	flash->read_addr_lanes = spi_flash_read_modes[i].addr_lanes;
+	flash->read_data_lanes = spi_flash_read_modes[i].data_lanes;
+	debug("SF: read cmd %02x, %d dummy bytes\n", flash->read_cmd,
+	      flash->dummy_byte);
+}
+
 #ifdef CONFIG_OF_CONTROL
 int spi_flash_decode_fdt(const void *blob, struct spi_flash *flash)
 {
@@ -541,6 +733,8 @@ struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 		goto err_manufacturer_probe;
 	}
 
+	spi_flash_read_config(flash, *idp);
+
 #ifdef CONFIG_SPI_FLASH_BAR
 	/* Configure the BAR - disover bank cmds and read current bank  */
 	ret = spi_flash_bank_config(flash, *idp);
@@ -561,7 +755,7 @@ struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 		printf(", mapped at %p", flash->memory_map);
 	puts("\n");
 #ifndef CONFIG_SPI_FLASH_BAR
-	if (flash->size > SPI_FLASH_16MB_BOUN) {
+	if (flash->size > SPI_FLASH_16MB_BOUN && flash->addr_width != 4) {
 		puts("SF: Warning - Only lower 16MiB accessible,");
 		puts(" Full access #define CONFIG_SPI_FLASH_BAR\n");
 	}
@@ -597,6 +791,9 @@ void *spi_flash_do_alloc(int offset, int size, struct spi_slave *spi,
 	flash->spi = spi;
 	flash->name = name;
 	flash->poll_cmd = CMD_READ_STATUS;
+	flash->addr_width = 3;
+	flash->read_cmd = CMD_READ_ARRAY_FAST;
+	flash->dummy_byte = 1;
 
 	flash->read = spi_flash_cmd_read_fast;
 	flash->write = spi_flash_cmd_write_multi;
@@ -17,6 +17,10 @@
 
 #define CMD_READ_ARRAY_SLOW		0x03
 #define CMD_READ_ARRAY_FAST		0x0b
+#define CMD_READ_DUAL_OUTPUT_FAST	0x3b
+#define CMD_READ_DUAL_IO_FAST		0xbb
+#define CMD_READ_QUAD_OUTPUT_FAST	0x6b
+#define CMD_READ_QUAD_IO_FAST		0xeb
 
 #define CMD_WRITE_STATUS		0x01
 #define CMD_PAGE_PROGRAM		0x02
@@ -28,12 +32,34 @@
 #define CMD_ERASE_32K			0x52
 #define CMD_ERASE_64K			0xd8
 #define CMD_ERASE_CHIP			0xc7
+#define CMD_READ_CONFIG			0x35
+
+/* 4-byte address commands, for flashes over 16MiB */
+#define CMD_READ_ARRAY_FAST_4B		0x0c
+#define CMD_READ_DUAL_OUTPUT_FAST_4B	0x3c
+#define CMD_READ_DUAL_IO_FAST_4B	0xbc
+#define CMD_READ_QUAD_OUTPUT_FAST_4B	0x6c
+#define CMD_READ_QUAD_IO_FAST_4B	0xec
+#define CMD_PAGE_PROGRAM_4B		0x12
+#define CMD_ERASE_4K_4B			0x21
+#define CMD_ERASE_64K_4B		0xdc
+
+/* Longest command: opcode, 4 address bytes and up to 3 dummy bytes */
+#define SPI_FLASH_CMD_LEN		8
 
 #define SPI_FLASH_16MB_BOUN		0x1000000
 
+/* Flags in the vendor tables: read modes (see SPI_OPM_RX_*) and others */
+#define RD_EXTN		(SPI_OPM_RX_DOUT | SPI_OPM_RX_QOF)
+#define RD_FULL		(RD_EXTN | SPI_OPM_RX_DIO | SPI_OPM_RX_QIO)
+#define SECT_32K	0x20	/* has 32KiB block erase */
+#define SECT_64K	0x40	/* has 64KiB block erase */
+#define ADDR_4B		0x80	/* has 4-byte address commands */
+
 /* Manufacture ID's */
 #define SPI_FLASH_SPANSION_IDCODE0	0x01
 #define SPI_FLASH_STMICRO_IDCODE0	0x20
+#define SPI_FLASH_MACRONIX_IDCODE0	0xc2
 #define SPI_FLASH_WINBOND_IDCODE0	0xef
 
 #ifdef CONFIG_SPI_FLASH_BAR
@@ -48,6 +74,10 @@
 #define STATUS_WIP			0x01
 #define STATUS_PEC			0x80
 
+/* Quad enable bit: configuration register (Spansion, Winbond) or status */
+#define STATUS_QEB_WINSPAN		0x02
+#define STATUS_QEB_MXIC			0x40
+
 /* Send a single-byte command to the device and read the response */
 int spi_flash_cmd(struct spi_slave *spi, u8 cmd, void *response, size_t len);
 
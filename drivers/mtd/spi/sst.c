@@ -216,6 +216,7 @@ spi_flash_probe_sst(struct spi_slave *spi, u8 *idcode)
 	stm->flash.page_size = 256;
 	stm->flash.sector_size = 4096;
 	stm->flash.size = stm->flash.sector_size * params->nr_sectors;
+	stm->flash.erase_sizes = SECT_32K | SECT_64K;
 
 	/* Flash powers up read-only, so clear BP# bits */
 	spi_flash_cmd_write_status(&stm->flash, 0);
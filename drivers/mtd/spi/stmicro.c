@@ -25,6 +25,7 @@ struct stmicro_spi_flash_params {
 	u16 pages_per_sector;
 	u16 nr_sectors;
 	const char *name;
+	u8 flags;
 };
 
 static const struct stmicro_spi_flash_params stmicro_spi_flash_table[] = {
@@ -81,72 +82,84 @@ static const struct stmicro_spi_flash_params stmicro_spi_flash_table[] = {
 		.pages_per_sector = 256,
 		.nr_sectors = 64,
 		.name = "N25Q32",
+		.flags = RD_EXTN,
 	},
 	{
 		.id = 0xbb16,
 		.pages_per_sector = 256,
 		.nr_sectors = 64,
 		.name = "N25Q32A",
+		.flags = RD_EXTN,
 	},
 	{
 		.id = 0xba17,
 		.pages_per_sector = 256,
 		.nr_sectors = 128,
 		.name = "N25Q064",
+		.flags = RD_EXTN,
 	},
 	{
 		.id = 0xbb17,
 		.pages_per_sector = 256,
 		.nr_sectors = 128,
 		.name = "N25Q64A",
+		.flags = RD_EXTN,
 	},
 	{
 		.id = 0xba18,
 		.pages_per_sector = 256,
 		.nr_sectors = 256,
 		.name = "N25Q128",
+		.flags = RD_EXTN,
 	},
 	{
 		.id = 0xbb18,
 		.pages_per_sector = 256,
 		.nr_sectors = 256,
 		.name = "N25Q128A",
+		.flags = RD_EXTN,
 	},
 	{
 		.id = 0xba19,
 		.pages_per_sector = 256,
 		.nr_sectors = 512,
 		.name = "N25Q256",
+		.flags = RD_EXTN | ADDR_4B,
 	},
 	{
 		.id = 0xbb19,
 		.pages_per_sector = 256,
 		.nr_sectors = 512,
 		.name = "N25Q256A",
+		.flags = RD_EXTN | ADDR_4B,
 	},
 	{
 		.id = 0xba20,
 		.pages_per_sector = 256,
 		.nr_sectors = 1024,
 		.name = "N25Q512",
+		.flags = RD_EXTN | ADDR_4B,
 	},
 	{
 		.id = 0xbb20,
 		.pages_per_sector = 256,
 		.nr_sectors = 1024,
 		.name = "N25Q512A",
+		.flags = RD_EXTN | ADDR_4B,
 	},
 	{
 		.id = 0xba21,
 		.pages_per_sector = 256,
 		.nr_sectors = 2048,
 		.name = "N25Q1024",
+		.flags = RD_EXTN | ADDR_4B,
 	},
 	{
 		.id = 0xbb21,
 		.pages_per_sector = 256,
 		.nr_sectors = 2048,
 		.name = "N25Q1024A",
+		.flags = RD_EXTN | ADDR_4B,
 	},
 };
 
@@ -194,6 +207,10 @@ struct spi_flash *spi_flash_probe_stmicro(struct spi_slave *spi, u8 * idcode)
 	flash->sector_size = 256 * params->pages_per_sector;
 	flash->size = flash->sector_size * params->nr_sectors;
 
+	flash->rd_modes = params->flags & RD_FULL;
+	if (params->flags & ADDR_4B)
+		flash->addr_width = 4;
+
 	/* for >= 512MiB flashes, use flag status instead of read_status */
 	if (flash->size >= 0x4000000)
 		flash->poll_cmd = CMD_FLAG_STATUS;
@@ -14,6 +14,7 @@ struct winbond_spi_flash_params {
 	uint16_t	id;
 	uint16_t	nr_blocks;
 	const char	*name;
+	uint8_t		flags;
 };
 
 static const struct winbond_spi_flash_params winbond_spi_flash_table[] = {
@@ -36,76 +37,91 @@ static const struct winbond_spi_flash_params winbond_spi_flash_table[] = {
 		.id			= 0x3013,
 		.nr_blocks		= 8,
 		.name			= "W25X40",
+		.flags			= SPI_OPM_RX_DOUT | SECT_64K,
 	},
 	{
 		.id			= 0x3015,
 		.nr_blocks		= 32,
 		.name			= "W25X16",
+		.flags			= SPI_OPM_RX_DOUT | SECT_64K,
 	},
 	{
 		.id			= 0x3016,
 		.nr_blocks		= 64,
 		.name			= "W25X32",
+		.flags			= SPI_OPM_RX_DOUT | SECT_64K,
 	},
 	{
 		.id			= 0x3017,
 		.nr_blocks		= 128,
 		.name			= "W25X64",
+		.flags			= SPI_OPM_RX_DOUT | SECT_64K,
 	},
 	{
 		.id			= 0x4014,
 		.nr_blocks		= 16,
 		.name			= "W25Q80BL/W25Q80BV",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x4015,
 		.nr_blocks		= 32,
 		.name			= "W25Q16CL/W25Q16DV",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x4016,
 		.nr_blocks		= 64,
 		.name			= "W25Q32BV/W25Q32FV_SPI",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x4017,
 		.nr_blocks		= 128,
 		.name			= "W25Q64CV/W25Q64FV_SPI",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x4018,
 		.nr_blocks		= 256,
 		.name			= "W25Q128BV/W25Q128FV_SPI",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x4019,
 		.nr_blocks		= 512,
 		.name			= "W25Q256",
+		.flags			= RD_FULL | SECT_32K | SECT_64K | ADDR_4B,
 	},
 	{
 		.id			= 0x5014,
 		.nr_blocks		= 16,
 		.name			= "W25Q80BW",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x6015,
 		.nr_blocks		= 32,
 		.name			= "W25Q16DW",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x6016,
 		.nr_blocks		= 64,
 		.name			= "W25Q32DW/W25Q32FV_QPI",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x6017,
 		.nr_blocks		= 128,
 		.name			= "W25Q64DW/W25Q64FV_QPI",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 	{
 		.id			= 0x6018,
 		.nr_blocks		= 256,
 		.name			= "W25Q128FW/W25Q128FV_QPI",
+		.flags			= RD_FULL | SECT_32K | SECT_64K,
 	},
 };
 
@@ -136,6 +152,10 @@ struct spi_flash *spi_flash_probe_winbond(struct spi_slave *spi, u8 *idcode)
 	flash->page_size = 256;
 	flash->sector_size = (idcode[1] == 0x20) ? 65536 : 4096;
 	flash->size = 4096 * 16 * params->nr_blocks;
+	flash->erase_sizes = params->flags & (SECT_32K | SECT_64K);
+	flash->rd_modes = params->flags & RD_FULL;
+	if (params->flags & ADDR_4B)
+		flash->addr_width = 4;
 
 	return flash;
 }
@@ -235,19 +235,36 @@ static int dw_eth_send(struct eth_device *dev, void *packet, int length)
 static int dw_eth_recv(struct eth_device *dev)
 {
 	struct dw_eth_dev *priv = dev->priv;
+	struct eth_dma_regs *dma_p = priv->dma_regs_p;
 	u32 desc_num = priv->rx_currdescnum;
-	struct dmamacdescr *desc_p = &priv->rx_mac_descrtable[desc_num];
+	struct dmamacdescr *desc_p;
+	u32 status, missed;
+	int length, total = 0;
+	int count;
 
-	u32 status = desc_p->txrx_status;
-	int length = 0;
+	/* Take every frame the DMA has finished with, not just the first */
+	for (count = 0; count < CONFIG_RX_DESCR_NUM; count++) {
+		desc_p = &priv->rx_mac_descrtable[desc_num];
+		status = desc_p->txrx_status;
 
-	/* Check  if the owner is the CPU */
-	if (!(status & DESC_RXSTS_OWNBYDMA)) {
+		/* Check  if the owner is the CPU */
+		if (status & DESC_RXSTS_OWNBYDMA)
+			break;
 
 		length = (status & DESC_RXSTS_FRMLENMSK) >> \
 			 DESC_RXSTS_FRMLENSHFT;
 
-		NetReceive(desc_p->dmamac_addr, length);
+		/* A frame in error, or too big for one buffer, is dropped */
+		if ((status & DESC_RXSTS_ERROR) ||
+		    (status & (DESC_RXSTS_RXFIRST | DESC_RXSTS_RXLAST)) !=
+		    (DESC_RXSTS_RXFIRST | DESC_RXSTS_RXLAST)) {
+			dev->rx_dropped++;
+			length = 0;
+		}
+
+		if (length)
+			NetReceive(desc_p->dmamac_addr, length);
+		total += length;
 
 		/*
 		 * Make the current descriptor valid again and go to
@@ -258,11 +275,20 @@ static int dw_eth_recv(struct eth_device *dev)
 		/* Test the wrap-around condition. */
 		if (++desc_num >= CONFIG_RX_DESCR_NUM)
 			desc_num = 0;
+
+		/* Leave the rest once a protocol has finished or failed */
+		if (net_state != NETLOOP_CONTINUE)
+			break;
 	}
 
 	priv->rx_currdescnum = desc_num;
 
-	return length;
+	/* Frames lost because the ring or the receive FIFO was full */
+	missed = readl(&dma_p->missedframes);
+	dev->rx_overruns += (missed & MISSED_NOBUFFER_MASK) +
+		((missed >> MISSED_FIFO_SHIFT) & MISSED_FIFO_MASK);
+
+	return total;
 }
 
 static void dw_eth_halt(struct eth_device *dev)
@@ -9,7 +9,9 @@
 #define _DW_ETH_H
 
 #define CONFIG_TX_DESCR_NUM	16
+#ifndef CONFIG_RX_DESCR_NUM
 #define CONFIG_RX_DESCR_NUM	16
+#endif
 #define CONFIG_ETH_BUFSIZE	2048
 #define TX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_TX_DESCR_NUM)
 #define RX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_RX_DESCR_NUM)
@@ -70,7 +72,8 @@ struct eth_dma_regs {
 	u32 status;		/* 0x14 */
 	u32 opmode;		/* 0x18 */
 	u32 intenable;		/* 0x1c */
-	u8 reserved[40];
+	u32 missedframes;	/* 0x20 */
+	u8 reserved[36];
 	u32 currhosttxdesc;	/* 0x48 */
 	u32 currhostrxdesc;	/* 0x4c */
 	u32 currhosttxbuffaddr;	/* 0x50 */
@@ -162,6 +165,11 @@ struct dmamacdescr {
 #define DESC_RXSTS_RXDRIBBLING		(1 << 2)
 #define DESC_RXSTS_RXCRC		(1 << 1)
 
+/* Missed frame counter register definitions (clear on read) */
+#define MISSED_NOBUFFER_MASK		0xffff
+#define MISSED_FIFO_SHIFT		17
+#define MISSED_FIFO_MASK		0x7ff
+
 /*
  * dmamac_cntl definitions
  */
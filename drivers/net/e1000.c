@@ -41,15 +41,23 @@ tested on both gig copper and gig fiber boards
 
 /* NIC specific static variables go here */
 
+#ifndef CONFIG_E1000_RX_DESCR_NUM
+#define CONFIG_E1000_RX_DESCR_NUM	8
+#endif
+#if CONFIG_E1000_RX_DESCR_NUM % 8
+#error "CONFIG_E1000_RX_DESCR_NUM must be a multiple of 8"
+#endif
+#define E1000_RX_BUFSIZE	2048	/* as set by E1000_RCTL_SZ_2048 */
+
 static char tx_pool[128 + 16];
-static char rx_pool[128 + 16];
-static char packet[2096];
+static char rx_pool[CONFIG_E1000_RX_DESCR_NUM * 16 + 16];
+static uchar rx_buf[CONFIG_E1000_RX_DESCR_NUM][E1000_RX_BUFSIZE];
 
 static struct e1000_tx_desc *tx_base;
 static struct e1000_rx_desc *rx_base;
 
 static int tx_tail;
-static int rx_tail, rx_last;
+static int rx_tail;	/* the descriptor to be filled next by the hardware */
 
 static struct pci_device_id e1000_supported[] = {
 	{PCI_VENDOR_ID_INTEL, PCI_DEVICE_ID_INTEL_82542},
@@ -4783,17 +4791,18 @@ e1000_sw_init(struct eth_device *nic)
 	return E1000_SUCCESS;
 }
 
-void
-fill_rx(struct e1000_hw *hw)
+/*
+ * Give receive descriptor @i a buffer. The hardware owns the descriptors
+ * from RDH up to but not including RDT, so once RDT is moved past it the
+ * descriptor is filled after all the others in the ring.
+ */
+static void
+fill_rx(int i)
 {
-	struct e1000_rx_desc *rd;
+	struct e1000_rx_desc *rd = rx_base + i;
 
-	rx_last = rx_tail;
-	rd = rx_base + rx_tail;
-	rx_tail = (rx_tail + 1) % 8;
 	memset(rd, 0, 16);
-	rd->buffer_addr = cpu_to_le64((u32) & packet);
-	E1000_WRITE_REG(hw, RDT, rx_tail);
+	rd->buffer_addr = cpu_to_le64((u32)rx_buf[i]);
 }
 
 /**
@@ -4927,6 +4936,7 @@ e1000_configure_rx(struct e1000_hw *hw)
 {
 	unsigned long ptr;
 	unsigned long rctl, ctrl_ext;
+	int i;
 	rx_tail = 0;
 	/* make sure receives are disabled while setting up the descriptors */
 	rctl = E1000_READ_REG(hw, RCTL);
@@ -4954,15 +4964,20 @@ e1000_configure_rx(struct e1000_hw *hw)
 	E1000_WRITE_REG(hw, RDBAL, (u32) rx_base);
 	E1000_WRITE_REG(hw, RDBAH, 0);
 
-	E1000_WRITE_REG(hw, RDLEN, 128);
+	E1000_WRITE_REG(hw, RDLEN, CONFIG_E1000_RX_DESCR_NUM * 16);
 
-	/* Setup the HW Rx Head and Tail Descriptor Pointers */
+	/*
+	 * Setup the HW Rx Head and Tail Descriptor Pointers. All but the
+	 * last descriptor are given to the hardware; that one follows as
+	 * soon as the first is taken back.
+	 */
+	for (i = 0; i < CONFIG_E1000_RX_DESCR_NUM; i++)
+		fill_rx(i);
 	E1000_WRITE_REG(hw, RDH, 0);
-	E1000_WRITE_REG(hw, RDT, 0);
+	E1000_WRITE_REG(hw, RDT, CONFIG_E1000_RX_DESCR_NUM - 1);
 	/* Enable Receives */
 
 	E1000_WRITE_REG(hw, RCTL, rctl);
-	fill_rx(hw);
 }
 
 /**************************************************************************
@@ -4973,14 +4988,35 @@ e1000_poll(struct eth_device *nic)
 {
 	struct e1000_hw *hw = nic->priv;
 	struct e1000_rx_desc *rd;
-	/* return true if there's an ethernet packet ready to read */
-	rd = rx_base + rx_last;
-	if (!(le32_to_cpu(rd->status)) & E1000_RXD_STAT_DD)
-		return 0;
-	/*DEBUGOUT("recv: packet len=%d \n", rd->length); */
-	NetReceive((uchar *)packet, le32_to_cpu(rd->length));
-	fill_rx(hw);
-	return 1;
+	int count, len, total = 0;
+
+	/* take every frame that is ready, each in its own buffer */
+	for (count = 0; count < CONFIG_E1000_RX_DESCR_NUM; count++) {
+		rd = rx_base + rx_tail;
+		if (!(rd->status & E1000_RXD_STAT_DD))
+			break;
+		/*DEBUGOUT("recv: packet len=%d \n", rd->length); */
+		len = le16_to_cpu(rd->length);
+		if (!(rd->status & E1000_RXD_STAT_EOP) ||
+		    (rd->errors & E1000_RXD_ERR_FRAME_ERR_MASK)) {
+			nic->rx_dropped++;
+			len = 0;
+		}
+		if (len)
+			NetReceive(rx_buf[rx_tail], len);
+		total += len;
+		fill_rx(rx_tail);
+		E1000_WRITE_REG(hw, RDT, rx_tail);
+		rx_tail = (rx_tail + 1) % CONFIG_E1000_RX_DESCR_NUM;
+
+		/* leave the rest once a protocol has finished or failed */
+		if (net_state != NETLOOP_CONTINUE)
+			break;
+	}
+	/* frames missed because the receive FIFO was full */
+	nic->rx_overruns += E1000_READ_REG(hw, MPC);
+
+	return total;
 }
 
 /**************************************************************************
@@ -780,15 +780,14 @@ static int fec_send(struct eth_device *dev, void *packet, int length)
 }
 
 /**
- * Pull one frame from the card
+ * Pull one frame from the receive ring
  * @param[in] dev Our ethernet device to handle
- * @return Length of packet read
+ * @return Length of packet read, 0 if it was dropped, -1 if the ring is empty
  */
-static int fec_recv(struct eth_device *dev)
+static int fec_recv_bd(struct eth_device *dev)
 {
 	struct fec_priv *fec = (struct fec_priv *)dev->priv;
 	struct fec_bd *rbd = &fec->rbd_base[fec->rbd_index];
-	unsigned long ievent;
 	int frame_length, len = 0;
 	struct nbuf *frame;
 	uint16_t bd_status;
@@ -796,33 +795,6 @@ static int fec_recv(struct eth_device *dev)
 	int i;
 	uchar buff[FEC_MAX_PKT_SIZE] __aligned(ARCH_DMA_MINALIGN);
 
-	/*
-	 * Check if any critical events have happened
-	 */
-	ievent = readl(&fec->eth->ievent);
-	writel(ievent, &fec->eth->ievent);
-	debug("fec_recv: ievent 0x%lx\n", ievent);
-	if (ievent & FEC_IEVENT_BABR) {
-		fec_halt(dev);
-		fec_init(dev, fec->bd);
-		printf("some error: 0x%08lx\n", ievent);
-		return 0;
-	}
-	if (ievent & FEC_IEVENT_HBERR) {
-		/* Heartbeat error */
-		writel(0x00000001 | readl(&fec->eth->x_cntrl),
-				&fec->eth->x_cntrl);
-	}
-	if (ievent & FEC_IEVENT_GRA) {
-		/* Graceful stop complete */
-		if (readl(&fec->eth->x_cntrl) & 0x00000001) {
-			fec_halt(dev);
-			writel(~0x00000001 & readl(&fec->eth->x_cntrl),
-					&fec->eth->x_cntrl);
-			fec_init(dev, fec->bd);
-		}
-	}
-
 	/*
 	 * Read the buffer status. Before the status can be read, the data cache
 	 * must be invalidated, because the data in RAM might have been changed
@@ -844,62 +816,118 @@ static int fec_recv(struct eth_device *dev)
 	bd_status = readw(&rbd->status);
 	debug("fec_recv: status 0x%x\n", bd_status);
 
-	if (!(bd_status & FEC_RBD_EMPTY)) {
-		if ((bd_status & FEC_RBD_LAST) && !(bd_status & FEC_RBD_ERR) &&
-			((readw(&rbd->data_length) - 4) > 14)) {
-			/*
-			 * Get buffer address and size
-			 */
-			frame = (struct nbuf *)readl(&rbd->data_pointer);
-			frame_length = readw(&rbd->data_length) - 4;
-			/*
-			 * Invalidate data cache over the buffer
-			 */
-			addr = (uint32_t)frame;
-			end = roundup(addr + frame_length, ARCH_DMA_MINALIGN);
-			addr &= ~(ARCH_DMA_MINALIGN - 1);
-			invalidate_dcache_range(addr, end);
-
-			/*
-			 *  Fill the buffer and pass it to upper layers
-			 */
+	if (bd_status & FEC_RBD_EMPTY)
+		return -1;
+
+	if ((bd_status & FEC_RBD_LAST) && !(bd_status & FEC_RBD_ERR) &&
+		((readw(&rbd->data_length) - 4) > 14)) {
+		/*
+		 * Get buffer address and size
+		 */
+		frame = (struct nbuf *)readl(&rbd->data_pointer);
+		frame_length = readw(&rbd->data_length) - 4;
+		/*
+		 * Invalidate data cache over the buffer
+		 */
+		addr = (uint32_t)frame;
+		end = roundup(addr + frame_length, ARCH_DMA_MINALIGN);
+		addr &= ~(ARCH_DMA_MINALIGN - 1);
+		invalidate_dcache_range(addr, end);
+
+		/*
+		 *  Fill the buffer and pass it to upper layers
+		 */
 #ifdef CONFIG_FEC_MXC_SWAP_PACKET
-			swap_packet((uint32_t *)frame->data, frame_length);
+		swap_packet((uint32_t *)frame->data, frame_length);
 #endif
-			memcpy(buff, frame->data, frame_length);
-			NetReceive(buff, frame_length);
-			len = frame_length;
-		} else {
-			if (bd_status & FEC_RBD_ERR)
-				printf("error frame: 0x%08lx 0x%08x\n",
-						(ulong)rbd->data_pointer,
-						bd_status);
+		memcpy(buff, frame->data, frame_length);
+		NetReceive(buff, frame_length);
+		len = frame_length;
+	} else {
+		if (bd_status & FEC_RBD_ERR)
+			printf("error frame: 0x%08lx 0x%08x\n",
+					(ulong)rbd->data_pointer,
+					bd_status);
+		if (bd_status & FEC_RBD_OV)
+			dev->rx_overruns++;
+		else
+			dev->rx_dropped++;
+	}
+
+	/*
+	 * Free the current buffer, restart the engine and move forward
+	 * to the next buffer. Here we check if the whole cacheline of
+	 * descriptors was already processed and if so, we mark it free
+	 * as whole.
+	 */
+	size = RXDESC_PER_CACHELINE - 1;
+	if ((fec->rbd_index & size) == size) {
+		i = fec->rbd_index - size;
+		addr = (uint32_t)&fec->rbd_base[i];
+		for (; i <= fec->rbd_index ; i++) {
+			fec_rbd_clean(i == (FEC_RBD_NUM - 1),
+				      &fec->rbd_base[i]);
 		}
+		flush_dcache_range(addr,
+			addr + ARCH_DMA_MINALIGN);
+	}
 
-		/*
-		 * Free the current buffer, restart the engine and move forward
-		 * to the next buffer. Here we check if the whole cacheline of
-		 * descriptors was already processed and if so, we mark it free
-		 * as whole.
-		 */
-		size = RXDESC_PER_CACHELINE - 1;
-		if ((fec->rbd_index & size) == size) {
-			i = fec->rbd_index - size;
-			addr = (uint32_t)&fec->rbd_base[i];
-			for (; i <= fec->rbd_index ; i++) {
-				fec_rbd_clean(i == (FEC_RBD_NUM - 1),
-					      &fec->rbd_base[i]);
-			}
-			flush_dcache_range(addr,
-				addr + ARCH_DMA_MINALIGN);
+	fec_rx_task_enable(fec);
+	fec->rbd_index = (fec->rbd_index + 1) % FEC_RBD_NUM;
+
+	return len;
+}
+
+/**
+ * Pull every frame which is ready from the card
+ * @param[in] dev Our ethernet device to handle
+ * @return Total length of the packets read
+ */
+static int fec_recv(struct eth_device *dev)
+{
+	struct fec_priv *fec = (struct fec_priv *)dev->priv;
+	unsigned long ievent;
+	int count, len, total = 0;
+
+	/*
+	 * Check if any critical events have happened
+	 */
+	ievent = readl(&fec->eth->ievent);
+	writel(ievent, &fec->eth->ievent);
+	debug("fec_recv: ievent 0x%lx\n", ievent);
+	if (ievent & FEC_IEVENT_BABR) {
+		fec_halt(dev);
+		fec_init(dev, fec->bd);
+		printf("some error: 0x%08lx\n", ievent);
+		return 0;
+	}
+	if (ievent & FEC_IEVENT_HBERR) {
+		/* Heartbeat error */
+		writel(0x00000001 | readl(&fec->eth->x_cntrl),
+				&fec->eth->x_cntrl);
+	}
+	if (ievent & FEC_IEVENT_GRA) {
+		/* Graceful stop complete */
+		if (readl(&fec->eth->x_cntrl) & 0x00000001) {
+			fec_halt(dev);
+			writel(~0x00000001 & readl(&fec->eth->x_cntrl),
+					&fec->eth->x_cntrl);
+			fec_init(dev, fec->bd);
 		}
+	}
 
-		fec_rx_task_enable(fec);
-		fec->rbd_index = (fec->rbd_index + 1) % FEC_RBD_NUM;
+	for (count = 0; count < FEC_RBD_NUM; count++) {
+		len = fec_recv_bd(dev);
+		if (len < 0)
+			break;
+		total += len;
+		/* Leave the rest once a protocol has finished or failed */
+		if (net_state != NETLOOP_CONTINUE)
+			break;
 	}
 	debug("fec_recv: stop\n");
 
-	return len;
+	return total;
 }
 
 static void fec_set_dev_name(char *dest, int dev_id)
@@ -270,9 +270,14 @@ struct fec_priv {
  * @brief Numbers of buffer descriptors for receiving
  *
  * The number defines the stocked memory buffers for the receiving task.
- * Larger values makes no sense in this limited environment.
+ * It must be a multiple of RXDESC_PER_CACHELINE, the number of descriptors
+ * which share a cache line.
  */
+#ifdef CONFIG_FEC_MXC_RBD_NUM
+#define FEC_RBD_NUM		CONFIG_FEC_MXC_RBD_NUM
+#else
 #define FEC_RBD_NUM		64
+#endif
 
 /**
  * @brief Define the ethernet packet size limit in memory
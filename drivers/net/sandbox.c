@@ -0,0 +1,1315 @@
+/*
+ * Sandbox Ethernet driver
+ *
+ * There is no wire behind this device. Frames sent by U-Boot are inspected
+ * in place and answered by small stand-ins for the servers a board would
+ * normally talk to:
+ *
+ *  - ARP requests for any address are answered with a fixed server MAC
+ *  - TFTP read requests (port 69) are served from files on the host,
+ *    including the blksize, tsize and windowsize (RFC 7440) options
+ *  - NFS (portmapper, mount and NFSv2/v3 LOOKUP and READ over UDP) serves
+ *    files on the host, with file handles naming host paths. Large READ
+ *    replies are sent as IP fragments, and several READ calls may be
+ *    outstanding; they are answered in order.
+ *  - HTTP GET requests (TCP port 80) are served from files on the host,
+ *    taking the path in the request as the file name. The sending side
+ *    of TCP honours the client's window and retransmits after three
+ *    duplicate ACKs or a timeout, so that loss can be recovered from.
+ *
+ * Received frames are copied into a small ring of buffers, as DMA would
+ * fill them, and as many as are ready go on the ring before any is
+ * handled. The buffers are given back once all have been handled, the
+ * first with a buffer posted by a protocol if there is one (see
+ * net_rx_post_get()), so that receiving in place can be tried.
+ *
+ * Two environment variables, read each time the device is started, make
+ * the link less than perfect so that protocol behaviour can be measured:
+ *
+ *  sbeth_latency	milliseconds between a request and the reply, or
+ *			between a TCP ACK and the window it opens
+ *  sbeth_drop		drop one in every N data frames sent to U-Boot
+ *
+ * and sbeth_nfsvers set to 2 hides NFSv3 from the portmapper, so that a
+ * client's fallback to NFSv2 can be tried. sbeth_interleave sets how many
+ * NFS READ replies may be sent at once, with their IP fragments
+ * interleaved, so that reassembly of several packets can be tried.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <net.h>
+#include <netdev.h>
+#include <os.h>
+#include <asm/unaligned.h>
+
+#define SB_ETH_TFTP_PORT	69
+#define SB_ETH_TFTP_MAX_BLKSIZE	1468
+
+/* TFTP opcodes, as in net/tftp.c */
+#define TFTP_RRQ	1
+#define TFTP_DATA	3
+#define TFTP_ACK	4
+#define TFTP_ERROR	5
+#define TFTP_OACK	6
+
+/* ONC RPC and NFS, as in net/nfs.h */
+#define SUNRPC_PORT		111
+#define PROG_PORTMAP		100000
+#define PROG_NFS		100003
+#define PROG_MOUNT		100005
+#define MSG_CALL		0
+#define MSG_REPLY		1
+#define RPC_PROG_MISMATCH	2
+#define RPC_PROC_UNAVAIL	3
+#define PORTMAP_GETPORT		3
+#define MOUNT_ADDENTRY		1
+#define NFS_LOOKUP		4
+#define NFS_READ		6
+#define NFS3PROC_LOOKUP		3
+#define NFS3PROC_FSINFO		19
+#define NFS_FHSIZE		32
+#define NFS_MAXDATA		8192
+#define NFREG			1
+#define NFS_FATTR_WORDS		17
+#define NFS3_FATTR_WORDS	21
+#define NFSERR_NOENT		2
+#define NFSERR_IO		5
+#define NFSERR_INVAL		22
+#define NFS3ERR_BADHANDLE	10001
+
+#define SB_ETH_MOUNT_PORT	635
+#define SB_ETH_NFS_PORT		2049
+#define SB_ETH_NFS_RTMAX	16384	/* largest NFSv3 READ allowed */
+#define SB_ETH_NFS3_FHSIZE	8	/* our NFSv3 file handles */
+#define SB_ETH_NFS_FHS		8	/* file handles remembered */
+#define SB_ETH_NFS_READS	32	/* READ calls that can be queued */
+#define SB_ETH_NFS_FRAG		1480	/* IP payload in each fragment */
+#define SB_ETH_NFS_DGRAMS	4	/* READ replies sent at once */
+
+#define SB_ETH_RX_RING		8	/* receive buffers, as in a DMA ring */
+
+#define SB_ETH_HTTP_PORT	80
+#define SB_ETH_TCP_MSS		1460
+#define SB_ETH_TCP_WINDOW	8192	/* window offered to the client */
+#define SB_ETH_TCP_RTO		200	/* ms, plus twice the latency */
+#define SB_ETH_TCP_ACKS		64	/* ACKs that can be in flight */
+/* start near the top so that sequence numbers wrap during a download */
+#define SB_ETH_TCP_ISS		0xfff00000
+
+/* A TFTP transfer in progress from the stand-in server */
+struct sb_tftp {
+	int fd;			/* host file being sent, -1 if idle */
+	IPaddr_t server_ip;	/* address the client sent its RRQ to */
+	IPaddr_t client_ip;
+	unsigned client_port;
+	unsigned our_port;
+	unsigned blksize;
+	unsigned windowsize;
+	ulong size;		/* file size in bytes */
+	ulong nblocks;		/* number of blocks including the last one */
+	ulong acked;		/* last block acknowledged by the client */
+	ulong next;		/* next block to send */
+	ulong ready;		/* time (ms) before which nothing is sent */
+};
+
+/* A READ call waiting to be answered by the stand-in NFS server */
+struct sb_nfs_read {
+	u32 xid;		/* as received, in network order */
+	int vers;
+	int fh;			/* index of the file handle */
+	ulong offset;
+	unsigned count;
+	ulong ready;		/* time (ms) the reply may be sent */
+};
+
+/* A READ reply being sent: UDP header and RPC reply */
+struct sb_nfs_dgram {
+	uchar buf[UDP_HDR_SIZE + 128 + SB_ETH_NFS_RTMAX] __aligned(4);
+	int len;			/* 0 if none */
+	int sent;			/* bytes already sent in fragments */
+	unsigned ip_id;
+};
+
+/*
+ * The stand-in NFS server. File handles are indexes into a small table of
+ * host paths. READ replies are sent as UDP datagrams split into IP
+ * fragments, started in the order the calls arrived. Normally one reply
+ * is sent at a time, but the fragments of up to SB_ETH_NFS_DGRAMS may be
+ * interleaved.
+ */
+struct sb_nfs {
+	int vers;			/* highest NFS version offered */
+	IPaddr_t server_ip;
+	IPaddr_t client_ip;
+	unsigned client_port;
+	char path[SB_ETH_NFS_FHS][256];	/* host path of each file handle */
+	int next_fh;
+	struct sb_nfs_read reads[SB_ETH_NFS_READS];
+	int read_head;
+	int read_count;
+	struct sb_nfs_dgram dgrams[SB_ETH_NFS_DGRAMS];
+	int interleave;			/* replies sent at once */
+	int dgram_next;			/* next to send a fragment of */
+	unsigned ip_id;
+};
+
+/* An ACK from the client, which takes effect after the link latency */
+struct sb_tcp_ack {
+	ulong time;		/* when the server sees it */
+	u32 ack;
+	ulong wnd;		/* window in bytes */
+	int pure;		/* no data, SYN or FIN, so may be a duplicate */
+};
+
+/*
+ * An HTTP response in progress from the stand-in server. The stream sent
+ * is the response header followed by the file; offsets here are in that
+ * stream, with FIN at offset 'size'.
+ */
+struct sb_http {
+	int active;		/* a connection is open */
+	int fd;			/* host file being sent, -1 if none */
+	IPaddr_t server_ip;
+	IPaddr_t client_ip;
+	unsigned client_port;
+	u32 rcv_nxt;		/* next sequence number from the client */
+	unsigned mss;		/* largest segment the client accepts */
+	int wscale;		/* scale of the client's window */
+	char req[512];		/* request received so far */
+	unsigned req_len;
+	char hdr[128];		/* response header */
+	unsigned hdr_len;
+	ulong size;		/* header plus file */
+	int sending;		/* the response has been started */
+	ulong ready;		/* time (ms) before which nothing is sent */
+	ulong una;		/* oldest unacknowledged offset */
+	ulong nxt;		/* next offset to send */
+	ulong wnd;		/* client's window in bytes */
+	unsigned dupacks;
+	int retransmit;		/* resend the segment at 'una' next */
+	ulong rto_deadline;	/* when to go back to 'una', 0 if none */
+	struct sb_tcp_ack acks[SB_ETH_TCP_ACKS];
+	int ack_head;
+	int ack_count;
+};
+
+struct sb_eth_priv {
+	uchar server_ether[6];
+	uchar ctrl[PKTSIZE_ALIGN];	/* queued ARP/OACK/ERROR frame */
+	int ctrl_len;			/* length of that frame, 0 if none */
+	ulong ctrl_ready;		/* time (ms) it may be delivered */
+	ulong latency;			/* reply latency in ms */
+	ulong drop;			/* drop one in this many data frames */
+	ulong data_sent;		/* data frames generated so far */
+	uchar *rx_buf[SB_ETH_RX_RING];	/* own or posted, NULL if taken */
+	int rx_len[SB_ETH_RX_RING];	/* length of the frame in it, or 0 */
+	int rx_fill;			/* the one the hardware fills next */
+	int rx_next;			/* the one handled next */
+	uchar rx_own[SB_ETH_RX_RING][PKTSIZE_ALIGN];
+	struct sb_tftp tftp;
+#ifdef CONFIG_CMD_NFS
+	struct sb_nfs nfs;
+#endif
+#ifdef CONFIG_CMD_WGET
+	struct sb_http http;
+#endif
+};
+
+/* Build Ethernet, IP and UDP headers around a payload already in @frame */
+static int sb_eth_udp_frame(struct eth_device *dev, uchar *frame,
+			    IPaddr_t src_ip, IPaddr_t dst_ip, unsigned sport,
+			    unsigned dport, int len)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct ethernet_hdr *et = (struct ethernet_hdr *)frame;
+	struct ip_udp_hdr *ip = (struct ip_udp_hdr *)(frame + ETHER_HDR_SIZE);
+
+	memcpy(et->et_dest, dev->enetaddr, 6);
+	memcpy(et->et_src, priv->server_ether, 6);
+	et->et_protlen = htons(PROT_IP);
+
+	if (len & 1)
+		((uchar *)ip)[IP_UDP_HDR_SIZE + len] = 0;
+	net_set_ip_header((uchar *)ip, dst_ip, src_ip);
+	ip->ip_len = htons(IP_UDP_HDR_SIZE + len);
+	ip->ip_p = IPPROTO_UDP;
+	ip->ip_sum = ~NetCksum((uchar *)ip, IP_HDR_SIZE >> 1);
+	ip->udp_src = htons(sport);
+	ip->udp_dst = htons(dport);
+	ip->udp_len = htons(UDP_HDR_SIZE + len);
+	ip->udp_xsum = 0;
+
+	return ETHER_HDR_SIZE + IP_UDP_HDR_SIZE + len;
+}
+
+static uchar *sb_eth_payload(uchar *frame)
+{
+	return frame + ETHER_HDR_SIZE + IP_UDP_HDR_SIZE;
+}
+
+/* Whether the hardware has an empty buffer on the receive ring */
+static int sb_eth_rx_room(struct sb_eth_priv *priv)
+{
+	int i = priv->rx_fill;
+
+	return priv->rx_buf[i] && !priv->rx_len[i];
+}
+
+/* Copy a frame to the next buffer on the receive ring, as DMA would */
+static void sb_eth_deliver(struct sb_eth_priv *priv, uchar *frame, int len)
+{
+	int i = priv->rx_fill;
+
+	memcpy(priv->rx_buf[i], frame, len);
+	priv->rx_len[i] = len;
+	priv->rx_fill = (i + 1) % SB_ETH_RX_RING;
+}
+
+static void sb_eth_queue_ctrl(struct sb_eth_priv *priv, int len)
+{
+	priv->ctrl_len = len;
+	priv->ctrl_ready = get_timer(0) + priv->latency;
+}
+
+static void sb_eth_arp(struct eth_device *dev, struct arp_hdr *req)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct ethernet_hdr *et = (struct ethernet_hdr *)priv->ctrl;
+	struct arp_hdr *arp = (struct arp_hdr *)(priv->ctrl + ETHER_HDR_SIZE);
+
+	if (ntohs(req->ar_op) != ARPOP_REQUEST)
+		return;
+
+	memcpy(et->et_dest, dev->enetaddr, 6);
+	memcpy(et->et_src, priv->server_ether, 6);
+	et->et_protlen = htons(PROT_ARP);
+
+	arp->ar_hrd = htons(ARP_ETHER);
+	arp->ar_pro = htons(PROT_IP);
+	arp->ar_hln = ARP_HLEN;
+	arp->ar_pln = ARP_PLEN;
+	arp->ar_op = htons(ARPOP_REPLY);
+	memcpy(&arp->ar_sha, priv->server_ether, ARP_HLEN);
+	NetCopyIP(&arp->ar_spa, &req->ar_tpa);
+	memcpy(&arp->ar_tha, &req->ar_sha, ARP_HLEN);
+	NetCopyIP(&arp->ar_tpa, &req->ar_spa);
+
+	sb_eth_queue_ctrl(priv, ETHER_HDR_SIZE + ARP_HDR_SIZE);
+}
+
+static void sb_eth_tftp_stop(struct sb_tftp *tftp)
+{
+	if (tftp->fd >= 0)
+		os_close(tftp->fd);
+	tftp->fd = -1;
+}
+
+static void sb_eth_tftp_error(struct eth_device *dev, struct sb_tftp *tftp,
+			      int code, const char *msg)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	uchar *pkt = sb_eth_payload(priv->ctrl);
+	int len;
+
+	pkt[0] = 0;
+	pkt[1] = TFTP_ERROR;
+	pkt[2] = 0;
+	pkt[3] = code;
+	strcpy((char *)pkt + 4, msg);
+	len = 4 + strlen(msg) + 1;
+	sb_eth_queue_ctrl(priv, sb_eth_udp_frame(dev, priv->ctrl,
+			tftp->server_ip, tftp->client_ip, tftp->our_port,
+			tftp->client_port, len));
+	sb_eth_tftp_stop(tftp);
+}
+
+static void sb_eth_tftp_rrq(struct eth_device *dev, IPaddr_t dst_ip,
+			    IPaddr_t src_ip, unsigned sport, uchar *pkt,
+			    int len)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_tftp *tftp = &priv->tftp;
+	char *p = (char *)pkt + 2, *end = (char *)pkt + len;
+	char *fname, *oack, *opt, *val;
+	ssize_t size;
+
+	sb_eth_tftp_stop(tftp);
+	tftp->server_ip = dst_ip;
+	tftp->client_ip = src_ip;
+	tftp->client_port = sport;
+	tftp->our_port = 1024 + (tftp->our_port + 1) % 3072;
+	tftp->blksize = 512;
+	tftp->windowsize = 1;
+
+	if (len < 4 || pkt[1] != TFTP_RRQ || end[-1]) {
+		sb_eth_tftp_error(dev, tftp, 0, "Bad request");
+		return;
+	}
+	fname = p;
+	p += strlen(p) + 1;
+	if (p < end)
+		p += strlen(p) + 1;	/* skip the mode */
+
+	size = os_get_filesize(fname);
+	tftp->fd = size < 0 ? -1 : os_open(fname, OS_O_RDONLY);
+	if (tftp->fd < 0) {
+		sb_eth_tftp_error(dev, tftp, 1, "File not found");
+		return;
+	}
+	tftp->size = size;
+
+	/* build an OACK for the options we understand as we parse them */
+	oack = (char *)sb_eth_payload(priv->ctrl);
+	oack[0] = 0;
+	oack[1] = TFTP_OACK;
+	opt = oack + 2;
+	while (p < end) {
+		/* tolerate stray empty strings between options */
+		if (!*p) {
+			p++;
+			continue;
+		}
+		val = p + strlen(p) + 1;
+		if (val >= end)
+			break;
+		if (!strcmp(p, "blksize")) {
+			tftp->blksize = min(simple_strtoul(val, NULL, 10),
+					    (ulong)SB_ETH_TFTP_MAX_BLKSIZE);
+			opt += sprintf(opt, "blksize%c%u%c", 0,
+				       tftp->blksize, 0);
+		} else if (!strcmp(p, "windowsize")) {
+			tftp->windowsize = max(simple_strtoul(val, NULL, 10),
+					       1UL);
+			opt += sprintf(opt, "windowsize%c%u%c", 0,
+				       tftp->windowsize, 0);
+		} else if (!strcmp(p, "tsize")) {
+			opt += sprintf(opt, "tsize%c%lu%c", 0, tftp->size, 0);
+		} else if (!strcmp(p, "timeout")) {
+			opt += sprintf(opt, "timeout%c%s%c", 0, val, 0);
+		}
+		p = val + strlen(val) + 1;
+	}
+
+	tftp->nblocks = tftp->size / tftp->blksize + 1;
+	tftp->acked = 0;
+	tftp->next = 1;
+	tftp->ready = get_timer(0) + priv->latency;
+	debug("sb_eth: sending '%s', %lu bytes, blksize %u, window %u\n",
+	      fname, tftp->size, tftp->blksize, tftp->windowsize);
+
+	/* with options, data starts once the client has ACKed the OACK */
+	if (opt != oack + 2) {
+		tftp->next = 0;
+		sb_eth_queue_ctrl(priv, sb_eth_udp_frame(dev, priv->ctrl,
+				tftp->server_ip, tftp->client_ip,
+				tftp->our_port, tftp->client_port,
+				opt - oack));
+	}
+}
+
+static void sb_eth_tftp_ack(struct eth_device *dev, uchar *pkt, int len)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_tftp *tftp = &priv->tftp;
+	ulong block;
+
+	if (len < 4 || pkt[1] != TFTP_ACK)
+		return;
+
+	/* widen the 16-bit block number relative to the last ACK */
+	block = (pkt[2] << 8) | pkt[3];
+	block = tftp->acked + ((block - tftp->acked) & 0xffff);
+	if (tftp->next && block >= tftp->next)
+		return;
+
+	/* RFC 7440: the next window starts just after the ACKed block */
+	tftp->acked = block;
+	tftp->next = block + 1;
+	tftp->ready = get_timer(0) + priv->latency;
+	if (block == tftp->nblocks)
+		sb_eth_tftp_stop(tftp);
+}
+
+/* Generate the next data frame of the current window, if it is due */
+static int sb_eth_tftp_data(struct eth_device *dev, uchar *frame)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_tftp *tftp = &priv->tftp;
+	uchar *pkt = sb_eth_payload(frame);
+	ulong offset;
+	int len;
+
+	if (tftp->fd < 0 || !tftp->next ||
+	    tftp->next > tftp->nblocks ||
+	    tftp->next > tftp->acked + tftp->windowsize ||
+	    get_timer(0) < tftp->ready)
+		return 0;
+
+	offset = (tftp->next - 1) * tftp->blksize;
+	len = min(tftp->size - offset, (ulong)tftp->blksize);
+	os_lseek(tftp->fd, offset, OS_SEEK_SET);
+	if (os_read(tftp->fd, pkt + 4, len) != len) {
+		sb_eth_tftp_error(dev, tftp, 0, "Read error");
+		return 0;
+	}
+	pkt[0] = 0;
+	pkt[1] = TFTP_DATA;
+	pkt[2] = (tftp->next >> 8) & 0xff;
+	pkt[3] = tftp->next & 0xff;
+	tftp->next++;
+
+	return sb_eth_udp_frame(dev, frame, tftp->server_ip, tftp->client_ip,
+				tftp->our_port, tftp->client_port, len + 4);
+}
+
+#ifdef CONFIG_CMD_NFS
+static void sb_eth_nfs_stop(struct sb_nfs *nfs)
+{
+	int i;
+
+	nfs->read_count = 0;
+	for (i = 0; i < SB_ETH_NFS_DGRAMS; i++)
+		nfs->dgrams[i].len = 0;
+	nfs->dgram_next = 0;
+}
+
+/* Port of an RPC program on the stand-in, or 0 if it is not offered */
+static unsigned sb_eth_nfs_port(struct sb_nfs *nfs, u32 prog, u32 vers)
+{
+	if (prog == PROG_MOUNT && vers >= 1 &&
+	    vers <= (nfs->vers == 3 ? 3 : 2))
+		return SB_ETH_MOUNT_PORT;
+	if (prog == PROG_NFS && vers >= 2 && vers <= nfs->vers)
+		return SB_ETH_NFS_PORT;
+
+	return 0;
+}
+
+/* Return a file handle for a host path, making one if needed */
+static int sb_eth_nfs_fh(struct sb_nfs *nfs, const char *path)
+{
+	int i;
+
+	for (i = 0; i < SB_ETH_NFS_FHS; i++) {
+		if (!strcmp(nfs->path[i], path))
+			return i;
+	}
+	i = nfs->next_fh++ % SB_ETH_NFS_FHS;
+	strncpy(nfs->path[i], path, sizeof(nfs->path[i]) - 1);
+
+	return i;
+}
+
+/* Add a file handle to a reply */
+static u32 *sb_eth_nfs_put_fh(u32 *p, int vers, int fh)
+{
+	if (vers == 3)
+		*p++ = htonl(SB_ETH_NFS3_FHSIZE);
+	memset(p, 0, vers == 3 ? SB_ETH_NFS3_FHSIZE : NFS_FHSIZE);
+	*p = htonl(fh + 1);
+
+	return p + (vers == 3 ? SB_ETH_NFS3_FHSIZE : NFS_FHSIZE) / 4;
+}
+
+/* Read a file handle from a call, returning its index or -1 if invalid */
+static int sb_eth_nfs_get_fh(struct sb_nfs *nfs, u32 **pp, int vers)
+{
+	u32 *p = *pp;
+	int fh;
+
+	if (vers == 3)
+		p++;		/* always SB_ETH_NFS3_FHSIZE */
+	fh = ntohl(*p) - 1;
+	*pp = p + (vers == 3 ? SB_ETH_NFS3_FHSIZE : NFS_FHSIZE) / 4;
+	if (fh < 0 || fh >= SB_ETH_NFS_FHS || !*nfs->path[fh])
+		return -1;
+
+	return fh;
+}
+
+/* Add the attributes of a regular file of @size bytes */
+static u32 *sb_eth_nfs_put_attr(u32 *p, int vers, ulong size, int fh)
+{
+	int words = vers == 3 ? NFS3_FATTR_WORDS : NFS_FATTR_WORDS;
+
+	memset(p, 0, words * 4);
+	p[0] = htonl(NFREG);
+	p[1] = htonl(0100644);
+	p[2] = htonl(1);	/* links */
+	if (vers == 3) {
+		p[6] = htonl(size);
+		p[8] = htonl(size);	/* space used */
+		p[15] = htonl(fh + 1);	/* file id */
+	} else {
+		p[5] = htonl(size);
+		p[6] = htonl(4096);	/* block size */
+		p[8] = htonl((size + 4095) / 4096);
+		p[10] = htonl(fh + 1);
+	}
+
+	return p + words;
+}
+
+/*
+ * Answer an NFS call. READ calls are queued, to be answered through the
+ * data path; the others are answered at once. @p points to the arguments
+ * and @rep to the results.
+ */
+static u32 *sb_eth_nfs_proc(struct sb_eth_priv *priv, u32 xid, u32 vers,
+			    u32 proc, u32 *p, u32 *end, u32 *rep)
+{
+	struct sb_nfs *nfs = &priv->nfs;
+	struct sb_nfs_read *rd;
+	char path[256];
+	ssize_t size;
+	unsigned len;
+	int fh;
+
+	fh = sb_eth_nfs_get_fh(nfs, &p, vers);
+	if (fh < 0 || p > end) {
+		*rep++ = htonl(vers == 3 ? NFS3ERR_BADHANDLE : NFSERR_INVAL);
+		if (vers == 3)
+			*rep++ = 0;	/* no attributes */
+		return rep;
+	}
+
+	if (proc == (vers == 3 ? NFS3PROC_LOOKUP : NFS_LOOKUP)) {
+		len = ntohl(*p++);
+		if (len > sizeof(path) - 2 - strlen(nfs->path[fh]))
+			len = 0;
+		snprintf(path, sizeof(path), "%s/%.*s", nfs->path[fh], len,
+			 (char *)p);
+		size = os_get_filesize(path);
+		if (size < 0) {
+			*rep++ = htonl(NFSERR_NOENT);
+			if (vers == 3)
+				*rep++ = 0;	/* no directory attributes */
+			return rep;
+		}
+		fh = sb_eth_nfs_fh(nfs, path);
+		*rep++ = 0;
+		rep = sb_eth_nfs_put_fh(rep, vers, fh);
+		if (vers == 3) {
+			*rep++ = htonl(1);
+			rep = sb_eth_nfs_put_attr(rep, vers, size, fh);
+			*rep++ = 0;		/* no directory attributes */
+		} else {
+			rep = sb_eth_nfs_put_attr(rep, vers, size, fh);
+		}
+	} else if (vers == 3 && proc == NFS3PROC_FSINFO) {
+		*rep++ = 0;
+		*rep++ = 0;			/* no attributes */
+		*rep++ = htonl(SB_ETH_NFS_RTMAX);	/* rtmax */
+		*rep++ = htonl(SB_ETH_NFS_RTMAX);	/* rtpref */
+		*rep++ = htonl(4096);			/* rtmult */
+		*rep++ = htonl(SB_ETH_NFS_RTMAX);	/* wtmax */
+		*rep++ = htonl(SB_ETH_NFS_RTMAX);	/* wtpref */
+		*rep++ = htonl(4096);			/* wtmult */
+		*rep++ = htonl(4096);			/* dtpref */
+		*rep++ = 0;				/* maxfilesize */
+		*rep++ = htonl(0xffffffff);
+		*rep++ = 0;				/* time_delta */
+		*rep++ = htonl(1000);
+		*rep++ = 0;				/* properties */
+	} else if (proc == NFS_READ) {
+		if (nfs->read_count == SB_ETH_NFS_READS || (vers == 3 && *p))
+			return NULL;
+		rd = &nfs->reads[(nfs->read_head + nfs->read_count++) %
+				 SB_ETH_NFS_READS];
+		if (vers == 3)
+			p++;		/* upper half of the offset */
+		rd->xid = xid;
+		rd->vers = vers;
+		rd->fh = fh;
+		rd->offset = ntohl(p[0]);
+		rd->count = min(ntohl(p[1]), vers == 3 ?
+				(u32)SB_ETH_NFS_RTMAX : (u32)NFS_MAXDATA);
+		rd->ready = get_timer(0) + priv->latency;
+		return NULL;
+	} else {
+		/* there are no links or directories to read */
+		*rep++ = htonl(NFSERR_INVAL);
+		if (vers == 3)
+			*rep++ = 0;
+	}
+
+	return rep;
+}
+
+/* Handle an RPC call to the portmapper, mount daemon or NFS server */
+static void sb_eth_nfs_call(struct eth_device *dev, struct ip_udp_hdr *ip,
+			    int len)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_nfs *nfs = &priv->nfs;
+	u32 call[512], *rep, *p, *end, *start;
+	u32 xid, prog, vers, proc;
+	unsigned dport = ntohs(ip->udp_dst);
+	char path[256];
+	int fh;
+
+	len = min(len, (int)sizeof(call));
+	memcpy(call, ip + 1, len);
+	end = call + len / 4;
+	if (len < 40 || ntohl(call[1]) != MSG_CALL)
+		return;
+	xid = call[0];
+	prog = ntohl(call[3]);
+	vers = ntohl(call[4]);
+	proc = ntohl(call[5]);
+	p = call + 6;
+	p += 2 + (ntohl(p[1]) + 3) / 4;		/* credential */
+	p += 2 + (ntohl(p[1]) + 3) / 4;		/* verifier */
+	if (p > end)
+		return;
+
+	nfs->server_ip = NetReadIP(&ip->ip_dst);
+	nfs->client_ip = NetReadIP(&ip->ip_src);
+	nfs->client_port = ntohs(ip->udp_src);
+
+	start = (u32 *)sb_eth_payload(priv->ctrl);
+	rep = start;
+	*rep++ = xid;
+	*rep++ = htonl(MSG_REPLY);
+	*rep++ = 0;			/* accepted */
+	*rep++ = 0;			/* AUTH_NONE verifier */
+	*rep++ = 0;
+	if (dport == SUNRPC_PORT && prog == PROG_PORTMAP &&
+	    proc == PORTMAP_GETPORT) {
+		*rep++ = 0;
+		*rep++ = htonl(sb_eth_nfs_port(nfs, ntohl(p[0]),
+					       ntohl(p[1])));
+	} else if (dport == SUNRPC_PORT) {
+		*rep++ = htonl(RPC_PROC_UNAVAIL);
+	} else if (!sb_eth_nfs_port(nfs, prog, vers) ||
+		   sb_eth_nfs_port(nfs, prog, vers) != dport) {
+		*rep++ = htonl(RPC_PROG_MISMATCH);
+		*rep++ = htonl(prog == PROG_NFS ? 2 : 1);
+		*rep++ = htonl(prog == PROG_NFS ? nfs->vers : 3);
+	} else if (prog == PROG_MOUNT && proc == MOUNT_ADDENTRY) {
+		*rep++ = 0;
+		len = ntohl(*p++);
+		snprintf(path, sizeof(path), "%.*s",
+			 min(len, (int)sizeof(path) - 1), (char *)p);
+		if (os_get_filesize(path) < 0) {
+			*rep++ = htonl(NFSERR_NOENT);
+		} else {
+			fh = sb_eth_nfs_fh(nfs, path);
+			*rep++ = 0;
+			rep = sb_eth_nfs_put_fh(rep, vers == 3 ? 3 : 2, fh);
+			if (vers == 3) {
+				*rep++ = htonl(1);	/* auth flavours */
+				*rep++ = htonl(1);	/* AUTH_UNIX */
+			}
+		}
+	} else if (prog == PROG_MOUNT) {
+		*rep++ = 0;			/* UMNT, UMNTALL: no result */
+	} else {
+		*rep++ = 0;
+		rep = sb_eth_nfs_proc(priv, xid, vers, proc, p, end, rep);
+		if (!rep)
+			return;
+	}
+
+	sb_eth_queue_ctrl(priv, sb_eth_udp_frame(dev, priv->ctrl,
+			nfs->server_ip, nfs->client_ip, dport,
+			nfs->client_port, (rep - start) * 4));
+}
+
+/* Build the reply to a READ as a UDP datagram */
+static void sb_eth_nfs_read_reply(struct sb_nfs *nfs, struct sb_nfs_read *rd,
+				  struct sb_nfs_dgram *dg)
+{
+	u32 *start = (u32 *)(dg->buf + UDP_HDR_SIZE);
+	u32 *rep = start;
+	uchar *data;
+	ssize_t size = -1;
+	int fd, len = 0;
+
+	*rep++ = rd->xid;
+	*rep++ = htonl(MSG_REPLY);
+	*rep++ = 0;
+	*rep++ = 0;
+	*rep++ = 0;
+	*rep++ = 0;
+	if (*nfs->path[rd->fh])
+		size = os_get_filesize(nfs->path[rd->fh]);
+	fd = size < 0 ? -1 : os_open(nfs->path[rd->fh], OS_O_RDONLY);
+	data = (uchar *)(rep + 1 + (rd->vers == 3 ? 1 + NFS3_FATTR_WORDS + 3 :
+				   NFS_FATTR_WORDS + 1));
+	if (fd >= 0) {
+		if (rd->offset < size) {
+			os_lseek(fd, rd->offset, OS_SEEK_SET);
+			len = os_read(fd, data, rd->count);
+		}
+		os_close(fd);
+	}
+	if (fd < 0 || len < 0) {
+		*rep++ = htonl(NFSERR_IO);
+		if (rd->vers == 3)
+			*rep++ = 0;
+	} else {
+		*rep++ = 0;
+		if (rd->vers == 3)
+			*rep++ = htonl(1);
+		rep = sb_eth_nfs_put_attr(rep, rd->vers, size, rd->fh);
+		*rep++ = htonl(len);
+		if (rd->vers == 3) {
+			*rep++ = htonl(rd->offset + len >= size);
+			*rep++ = htonl(len);
+		}
+		memset(data + len, 0, -len & 3);
+		rep = (u32 *)(data + ((len + 3) & ~3));
+	}
+
+	dg->len = (uchar *)rep - dg->buf;
+	dg->sent = 0;
+	dg->ip_id = ++nfs->ip_id;
+	put_unaligned_be16(SB_ETH_NFS_PORT, dg->buf);
+	put_unaligned_be16(nfs->client_port, dg->buf + 2);
+	put_unaligned_be16(dg->len, dg->buf + 4);
+	put_unaligned_be16(0, dg->buf + 6);	/* no checksum */
+}
+
+/* Generate the next fragment of a READ reply, if one is due */
+static int sb_eth_nfs_data(struct eth_device *dev, uchar *frame)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_nfs *nfs = &priv->nfs;
+	struct ethernet_hdr *et = (struct ethernet_hdr *)frame;
+	struct ip_hdr *ip = (struct ip_hdr *)(frame + ETHER_HDR_SIZE);
+	struct sb_nfs_dgram *dg;
+	struct sb_nfs_read *rd;
+	int i, n, len, more;
+
+	/* start replies to the calls which are due, as far as allowed */
+	for (i = 0; i < nfs->interleave && nfs->read_count; i++) {
+		rd = &nfs->reads[nfs->read_head];
+		if (get_timer(0) < rd->ready)
+			break;
+		if (nfs->dgrams[i].len)
+			continue;
+		nfs->read_head = (nfs->read_head + 1) % SB_ETH_NFS_READS;
+		nfs->read_count--;
+		sb_eth_nfs_read_reply(nfs, rd, &nfs->dgrams[i]);
+	}
+
+	/* take a fragment from each reply in turn */
+	n = nfs->dgram_next;
+	for (i = 0; i < nfs->interleave && !nfs->dgrams[n].len; i++)
+		n = (n + 1) % nfs->interleave;
+	if (i == nfs->interleave)
+		return 0;
+	dg = &nfs->dgrams[n];
+	nfs->dgram_next = (n + 1) % nfs->interleave;
+
+	/* send the datagram in IP fragments that fit the MTU */
+	len = min(dg->len - dg->sent, SB_ETH_NFS_FRAG);
+	more = dg->sent + len < dg->len;
+	memcpy(et->et_dest, dev->enetaddr, 6);
+	memcpy(et->et_src, priv->server_ether, 6);
+	et->et_protlen = htons(PROT_IP);
+	net_set_ip_header((uchar *)ip, nfs->client_ip, nfs->server_ip);
+	ip->ip_len = htons(IP_HDR_SIZE + len);
+	ip->ip_id = htons(dg->ip_id);
+	ip->ip_off = htons(dg->sent / 8 | (more ? IP_FLAGS_MFRAG : 0));
+	ip->ip_p = IPPROTO_UDP;
+	ip->ip_sum = ~NetCksum((uchar *)ip, IP_HDR_SIZE >> 1);
+	memcpy(ip + 1, dg->buf + dg->sent, len);
+	dg->sent += len;
+	if (!more)
+		dg->len = 0;
+
+	return ETHER_HDR_SIZE + IP_HDR_SIZE + len;
+}
+#else
+static inline int sb_eth_nfs_data(struct eth_device *dev, uchar *frame)
+{
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_CMD_WGET
+/*
+ * Build Ethernet, IP and TCP headers around options and data already in
+ * @frame, returning the frame length
+ */
+static int sb_eth_tcp_frame(struct eth_device *dev, uchar *frame, u32 seq,
+			    uchar flags, int optlen, int len)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_http *http = &priv->http;
+	struct ethernet_hdr *et = (struct ethernet_hdr *)frame;
+	struct ip_tcp_hdr *ip = (struct ip_tcp_hdr *)(frame + ETHER_HDR_SIZE);
+	int seglen = TCP_HDR_SIZE + optlen + len;
+
+	memcpy(et->et_dest, dev->enetaddr, 6);
+	memcpy(et->et_src, priv->server_ether, 6);
+	et->et_protlen = htons(PROT_IP);
+
+	net_set_ip_header((uchar *)ip, http->client_ip, http->server_ip);
+	ip->ip_len = htons(IP_HDR_SIZE + seglen);
+	ip->ip_p = IPPROTO_TCP;
+	ip->ip_sum = ~NetCksum((uchar *)ip, IP_HDR_SIZE >> 1);
+	ip->tcp_src = htons(SB_ETH_HTTP_PORT);
+	ip->tcp_dst = htons(http->client_port);
+	put_unaligned_be32(seq, &ip->tcp_seq);
+	put_unaligned_be32(http->rcv_nxt, &ip->tcp_ack);
+	ip->tcp_hlen = (TCP_HDR_SIZE + optlen) << 2;
+	ip->tcp_flags = flags | TCP_ACK;
+	ip->tcp_win = htons(SB_ETH_TCP_WINDOW);
+	ip->tcp_urg = 0;
+	ip->tcp_xsum = 0;
+	ip->tcp_xsum = ~net_tcp_cksum(ip, seglen);
+
+	return ETHER_HDR_SIZE + IP_HDR_SIZE + seglen;
+}
+
+static void sb_eth_http_stop(struct sb_http *http)
+{
+	if (http->fd >= 0)
+		os_close(http->fd);
+	http->fd = -1;
+	http->active = 0;
+}
+
+static void sb_eth_tcp_ack_now(struct eth_device *dev)
+{
+	struct sb_eth_priv *priv = dev->priv;
+
+	sb_eth_queue_ctrl(priv, sb_eth_tcp_frame(dev, priv->ctrl,
+			SB_ETH_TCP_ISS + 1 + priv->http.nxt, 0, 0, 0));
+}
+
+/* Answer a SYN, starting a new connection */
+static void sb_eth_tcp_syn(struct eth_device *dev, struct ip_tcp_hdr *ip,
+			   uchar *opt, int optlen)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_http *http = &priv->http;
+	uchar *out = priv->ctrl + ETHER_HDR_SIZE + IP_TCP_HDR_SIZE;
+
+	sb_eth_http_stop(http);
+	memset(http, '\0', sizeof(*http));
+	http->fd = -1;
+	http->active = 1;
+	http->server_ip = NetReadIP(&ip->ip_dst);
+	http->client_ip = NetReadIP(&ip->ip_src);
+	http->client_port = ntohs(ip->tcp_src);
+	http->rcv_nxt = get_unaligned_be32(&ip->tcp_seq) + 1;
+	http->mss = 536;
+	http->wnd = ntohs(ip->tcp_win);
+	while (optlen > 1 && opt[0] != 0) {
+		if (opt[0] == 1) {
+			opt++;
+			optlen--;
+			continue;
+		}
+		if (opt[1] < 2 || opt[1] > optlen)
+			break;
+		if (opt[0] == 2 && opt[1] == 4)
+			http->mss = min(get_unaligned_be16(opt + 2),
+					(u16)SB_ETH_TCP_MSS);
+		else if (opt[0] == 3 && opt[1] == 3)
+			http->wscale = opt[2];
+		optlen -= opt[1];
+		opt += opt[1];
+	}
+
+	/* MSS, then window scaling so that the client may scale its own */
+	out[0] = 2;
+	out[1] = 4;
+	put_unaligned_be16(SB_ETH_TCP_MSS, out + 2);
+	out[4] = 1;
+	out[5] = 3;
+	out[6] = 3;
+	out[7] = 0;
+	sb_eth_queue_ctrl(priv, sb_eth_tcp_frame(dev, priv->ctrl,
+			SB_ETH_TCP_ISS, TCP_SYN, 8, 0));
+}
+
+/* Start the response once the whole request has arrived */
+static void sb_eth_http_request(struct eth_device *dev, struct sb_http *http)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	char *path, *end;
+	ssize_t size = -1;
+
+	http->req[http->req_len] = '\0';
+	if (!strstr(http->req, "\r\n\r\n"))
+		return;
+
+	path = http->req + 4;
+	end = strchr(path, ' ');
+	if (!strncmp(http->req, "GET ", 4) && end) {
+		*end = '\0';
+		size = os_get_filesize(path);
+		http->fd = size < 0 ? -1 : os_open(path, OS_O_RDONLY);
+	}
+	if (http->fd < 0)
+		strcpy(http->hdr, "HTTP/1.1 404 Not Found\r\n"
+		       "Content-Length: 0\r\nConnection: close\r\n\r\n");
+	else
+		sprintf(http->hdr, "HTTP/1.1 200 OK\r\nContent-Length: %lu\r\n"
+			"Connection: close\r\n\r\n", (ulong)size);
+	http->hdr_len = strlen(http->hdr);
+	debug("sb_eth: HTTP GET '%s', %ld bytes\n", path, (long)size);
+	http->size = http->hdr_len + (http->fd < 0 ? 0 : size);
+	http->sending = 1;
+	http->ready = get_timer(0) + priv->latency;
+}
+
+/* Handle a TCP segment from the client */
+static void sb_eth_tcp(struct eth_device *dev, struct ip_tcp_hdr *ip,
+		       int len)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_http *http = &priv->http;
+	int hlen = (ip->tcp_hlen >> 4) * 4;
+	uchar flags = ip->tcp_flags;
+	struct sb_tcp_ack *ack;
+	int dlen;
+
+	if (ntohs(ip->tcp_dst) != SB_ETH_HTTP_PORT || hlen < TCP_HDR_SIZE ||
+	    IP_HDR_SIZE + hlen > len)
+		return;
+	if (flags & TCP_SYN) {
+		sb_eth_tcp_syn(dev, ip, (uchar *)(ip + 1), hlen - TCP_HDR_SIZE);
+		return;
+	}
+	if (!http->active || ntohs(ip->tcp_src) != http->client_port)
+		return;
+	if (flags & TCP_RST) {
+		sb_eth_http_stop(http);
+		return;
+	}
+
+	dlen = len - IP_HDR_SIZE - hlen;
+	if (flags & TCP_ACK) {
+		if (http->ack_count == SB_ETH_TCP_ACKS) {
+			/* ACKs are cumulative, so update the newest */
+			ack = &http->acks[(http->ack_head + http->ack_count - 1)
+					  % SB_ETH_TCP_ACKS];
+		} else {
+			ack = &http->acks[(http->ack_head + http->ack_count++)
+					  % SB_ETH_TCP_ACKS];
+			ack->time = get_timer(0) + priv->latency;
+		}
+		ack->ack = get_unaligned_be32(&ip->tcp_ack);
+		ack->wnd = (ulong)ntohs(ip->tcp_win) << http->wscale;
+		ack->pure = !dlen && !(flags & TCP_FIN);
+	}
+
+	/* only take data in order; the client will send it again */
+	if (get_unaligned_be32(&ip->tcp_seq) != http->rcv_nxt)
+		return;
+	if (dlen && !http->sending) {
+		dlen = min(dlen, (int)sizeof(http->req) - 1 -
+			   (int)http->req_len);
+		memcpy(http->req + http->req_len, (uchar *)ip + IP_HDR_SIZE +
+		       hlen, dlen);
+		http->req_len += dlen;
+		http->rcv_nxt += dlen;
+		sb_eth_http_request(dev, http);
+	}
+	if (flags & TCP_FIN)
+		http->rcv_nxt++;
+	if (dlen || (flags & TCP_FIN))
+		sb_eth_tcp_ack_now(dev);
+}
+
+/* Apply the ACKs that have now reached the server */
+static void sb_eth_http_acks(struct sb_eth_priv *priv, struct sb_http *http,
+			     ulong now)
+{
+	struct sb_tcp_ack *ack;
+	ulong offset;
+
+	while (http->ack_count) {
+		ack = &http->acks[http->ack_head];
+		if (now < ack->time)
+			break;
+		http->ack_head = (http->ack_head + 1) % SB_ETH_TCP_ACKS;
+		http->ack_count--;
+
+		offset = ack->ack - SB_ETH_TCP_ISS - 1;
+		if (offset > http->nxt)
+			continue;
+		if (offset > http->una) {
+			http->una = offset;
+			http->dupacks = 0;
+			/* restart the timer for whatever is still in flight */
+			http->rto_deadline = http->una < http->nxt ?
+				now + SB_ETH_TCP_RTO + 2 * priv->latency : 0;
+		} else if (offset == http->una && http->una < http->nxt &&
+			   ack->pure && ++http->dupacks == 3) {
+			http->retransmit = 1;
+		}
+		http->wnd = ack->wnd;
+	}
+}
+
+/* Generate the next segment of the response, if one is due */
+static int sb_eth_http_data(struct eth_device *dev, uchar *frame)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct sb_http *http = &priv->http;
+	uchar *pkt = frame + ETHER_HDR_SIZE + IP_TCP_HDR_SIZE;
+	ulong now = get_timer(0), offset, len, n = 0;
+
+	if (!http->active || !http->sending || now < http->ready)
+		return 0;
+	sb_eth_http_acks(priv, http, now);
+
+	/* all sent and acknowledged, including FIN */
+	if (http->una > http->size) {
+		if (http->fd >= 0)
+			os_close(http->fd);
+		http->fd = -1;
+		return 0;
+	}
+
+	if (http->rto_deadline && now >= http->rto_deadline) {
+		debug("sb_eth: TCP timeout, resending from %lu\n", http->una);
+		http->nxt = http->una;
+		http->rto_deadline = 0;
+	}
+	if (http->retransmit) {
+		http->retransmit = 0;
+		offset = http->una;
+		len = min(http->size - offset, (ulong)http->mss);
+	} else {
+		offset = http->nxt;
+		if (offset > http->size || offset >= http->una + http->wnd)
+			return 0;
+		len = min(http->size - offset, (ulong)http->mss);
+		len = min(len, http->una + http->wnd - offset);
+		http->nxt += len ? len : 1;
+	}
+	if (!http->rto_deadline)
+		http->rto_deadline = now + SB_ETH_TCP_RTO + 2 * priv->latency;
+
+	/* the response header, then the file */
+	if (offset < http->hdr_len) {
+		n = min(len, http->hdr_len - offset);
+		memcpy(pkt, http->hdr + offset, n);
+	}
+	if (n < len) {
+		os_lseek(http->fd, offset + n - http->hdr_len, OS_SEEK_SET);
+		if (os_read(http->fd, pkt + n, len - n) != len - n) {
+			sb_eth_http_stop(http);
+			return 0;
+		}
+	}
+
+	return sb_eth_tcp_frame(dev, frame, SB_ETH_TCP_ISS + 1 + offset,
+				offset == http->size ? TCP_FIN : TCP_PUSH, 0,
+				len);
+}
+#else
+static inline int sb_eth_http_data(struct eth_device *dev, uchar *frame)
+{
+	return 0;
+}
+#endif
+
+static int sb_eth_init(struct eth_device *dev, bd_t *bis)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	int i;
+
+	priv->latency = getenv_ulong("sbeth_latency", 10, 0);
+	priv->drop = getenv_ulong("sbeth_drop", 10, 0);
+	priv->data_sent = 0;
+	priv->ctrl_len = 0;
+	for (i = 0; i < SB_ETH_RX_RING; i++) {
+		priv->rx_buf[i] = priv->rx_own[i];
+		priv->rx_len[i] = 0;
+	}
+	priv->rx_fill = 0;
+	priv->rx_next = 0;
+	sb_eth_tftp_stop(&priv->tftp);
+#ifdef CONFIG_CMD_NFS
+	priv->nfs.vers = getenv_ulong("sbeth_nfsvers", 10, 3) == 2 ? 2 : 3;
+	priv->nfs.interleave = min(max(getenv_ulong("sbeth_interleave", 10, 1),
+				       1UL), (ulong)SB_ETH_NFS_DGRAMS);
+	sb_eth_nfs_stop(&priv->nfs);
+#endif
+#ifdef CONFIG_CMD_WGET
+	sb_eth_http_stop(&priv->http);
+#endif
+
+	return 0;
+}
+
+static int sb_eth_send(struct eth_device *dev, void *packet, int length)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	struct ethernet_hdr *et = packet;
+	struct ip_udp_hdr *ip = packet + ETHER_HDR_SIZE;
+	unsigned dport;
+
+	if (length < ETHER_HDR_SIZE + ARP_HDR_SIZE)
+		return 0;
+
+	switch (ntohs(et->et_protlen)) {
+	case PROT_ARP:
+		sb_eth_arp(dev, (struct arp_hdr *)ip);
+		break;
+	case PROT_IP:
+		if (length < ETHER_HDR_SIZE + IP_UDP_HDR_SIZE)
+			break;
+#ifdef CONFIG_CMD_WGET
+		if (ip->ip_p == IPPROTO_TCP &&
+		    length >= ETHER_HDR_SIZE + IP_TCP_HDR_SIZE) {
+			sb_eth_tcp(dev, (struct ip_tcp_hdr *)ip,
+				   ntohs(ip->ip_len));
+			break;
+		}
+#endif
+		if (ip->ip_p != IPPROTO_UDP)
+			break;
+		length = ntohs(ip->udp_len) - UDP_HDR_SIZE;
+		dport = ntohs(ip->udp_dst);
+		if (dport == SB_ETH_TFTP_PORT)
+			sb_eth_tftp_rrq(dev, NetReadIP(&ip->ip_dst),
+					NetReadIP(&ip->ip_src),
+					ntohs(ip->udp_src),
+					(uchar *)(ip + 1), length);
+		else if (priv->tftp.fd >= 0 && dport == priv->tftp.our_port)
+			sb_eth_tftp_ack(dev, (uchar *)(ip + 1), length);
+#ifdef CONFIG_CMD_NFS
+		else if (dport == SUNRPC_PORT || dport == SB_ETH_MOUNT_PORT ||
+			 dport == SB_ETH_NFS_PORT)
+			sb_eth_nfs_call(dev, ip, length);
+#endif
+		break;
+	}
+
+	return 0;
+}
+
+/* Queue the next frame the server has ready, returning its length */
+static int sb_eth_recv_one(struct eth_device *dev)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	uchar *frame = NetRxPackets[0];
+	int len;
+
+	if (priv->ctrl_len && get_timer(0) >= priv->ctrl_ready) {
+		len = priv->ctrl_len;
+		priv->ctrl_len = 0;
+		sb_eth_deliver(priv, priv->ctrl, len);
+		return len;
+	}
+
+	len = sb_eth_tftp_data(dev, frame);
+	if (!len)
+		len = sb_eth_http_data(dev, frame);
+	if (!len)
+		len = sb_eth_nfs_data(dev, frame);
+	if (!len)
+		return 0;
+	if (priv->drop && ++priv->data_sent % priv->drop == 0) {
+		debug("sb_eth: dropping data frame\n");
+		dev->rx_dropped++;
+		return len;
+	}
+	sb_eth_deliver(priv, frame, len);
+
+	return len;
+}
+
+/*
+ * Like a DMA driver, let the ring fill with the frames that are ready and
+ * then handle them. The buffers are given back once all have been handled,
+ * so that the first goes ahead of any other and may be a posted one.
+ */
+static int sb_eth_recv(struct eth_device *dev)
+{
+	struct sb_eth_priv *priv = dev->priv;
+	int i, j, len, ahead, total = 0;
+	uchar *buf;
+
+	while (sb_eth_rx_room(priv) && sb_eth_recv_one(dev))
+		;
+
+	while (priv->rx_len[priv->rx_next]) {
+		i = priv->rx_next;
+		buf = priv->rx_buf[i];
+		len = priv->rx_len[i];
+		priv->rx_buf[i] = NULL;
+		priv->rx_len[i] = 0;
+		priv->rx_next = (i + 1) % SB_ETH_RX_RING;
+		if (buf == priv->rx_own[i])
+			NetReceive(buf, len);
+		else
+			net_rx_post_receive(buf, len);
+		total += len;
+		/* Leave the rest once a protocol has finished or failed */
+		if (net_state != NETLOOP_CONTINUE)
+			break;
+	}
+
+	/* Those taken are filled after every buffer still on the ring */
+	ahead = 0;
+	for (i = 0; i < SB_ETH_RX_RING; i++)
+		if (priv->rx_buf[i])
+			ahead++;
+	for (j = 0; j < SB_ETH_RX_RING; j++) {
+		i = (priv->rx_fill + j) % SB_ETH_RX_RING;
+		if (priv->rx_buf[i])
+			continue;
+		buf = net_rx_post_get(ahead++, PKTSIZE_ALIGN, 1);
+		priv->rx_buf[i] = buf ? buf : priv->rx_own[i];
+	}
+
+	return total;
+}
+
+static void sb_eth_halt(struct eth_device *dev)
+{
+	struct sb_eth_priv *priv = dev->priv;
+
+	sb_eth_tftp_stop(&priv->tftp);
+#ifdef CONFIG_CMD_NFS
+	sb_eth_nfs_stop(&priv->nfs);
+#endif
+#ifdef CONFIG_CMD_WGET
+	sb_eth_http_stop(&priv->http);
+#endif
+}
+
+int sandbox_eth_initialize(bd_t *bis)
+{
+	static const uchar ether[6] = { 0x02, 0x00, 0x11, 0x22, 0x33, 0x44 };
+	static const uchar server[6] = { 0x02, 0x00, 0x11, 0x22, 0x33, 0x55 };
+	struct sb_eth_priv *priv;
+	struct eth_device *dev;
+
+	dev = calloc(1, sizeof(*dev));
+	priv = calloc(1, sizeof(*priv));
+	if (!dev || !priv) {
+		free(dev);
+		free(priv);
+		return -1;
+	}
+
+	strcpy(dev->name, "sb_eth");
+	memcpy(dev->enetaddr, ether, 6);
+	memcpy(priv->server_ether, server, 6);
+	priv->tftp.fd = -1;
+#ifdef CONFIG_CMD_WGET
+	priv->http.fd = -1;
+#endif
+	dev->priv = priv;
+	dev->init = sb_eth_init;
+	dev->send = sb_eth_send;
+	dev->recv = sb_eth_recv;
+	dev->halt = sb_eth_halt;
+
+	return eth_register(dev);
+}
@@ -0,0 +1,89 @@
+/*
+ * SPI controller for sandbox, which passes transfers to emulated devices
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <spi.h>
+#include <asm/spi.h>
+
+struct sandbox_spi_slave {
+	struct spi_slave slave;
+	void *emu;		/* emulated device */
+};
+
+static inline struct sandbox_spi_slave *to_sandbox_spi(struct spi_slave *slave)
+{
+	return container_of(slave, struct sandbox_spi_slave, slave);
+}
+
+int spi_cs_is_valid(unsigned int bus, unsigned int cs)
+{
+	return 1;
+}
+
+void spi_init(void)
+{
+}
+
+struct spi_slave *spi_setup_slave(unsigned int bus, unsigned int cs,
+		unsigned int max_hz, unsigned int mode)
+{
+	struct sandbox_spi_slave *sss;
+	int ret;
+
+	sss = spi_alloc_slave(struct sandbox_spi_slave, bus, cs);
+	if (!sss)
+		return NULL;
+
+	ret = sandbox_sf_setup(&sss->emu, bus, cs);
+	if (ret) {
+		if (ret == -ENODEV)
+			printf("sandbox_spi: nothing emulated at %u:%u\n",
+			       bus, cs);
+		free(sss);
+		return NULL;
+	}
+
+	return &sss->slave;
+}
+
+void spi_free_slave(struct spi_slave *slave)
+{
+	struct sandbox_spi_slave *sss = to_sandbox_spi(slave);
+
+	sandbox_sf_free(sss->emu);
+	free(sss);
+}
+
+int spi_claim_bus(struct spi_slave *slave)
+{
+	return 0;
+}
+
+void spi_release_bus(struct spi_slave *slave)
+{
+}
+
+int spi_xfer(struct spi_slave *slave, unsigned int bitlen, const void *dout,
+		void *din, unsigned long flags)
+{
+	struct sandbox_spi_slave *sss = to_sandbox_spi(slave);
+
+	if (bitlen % 8)
+		return -EINVAL;
+
+	if (flags & SPI_XFER_BEGIN)
+		sandbox_sf_cs_activate(sss->emu);
+	if (bitlen)
+		sandbox_sf_xfer(sss->emu, dout, din, bitlen / 8);
+	if (flags & SPI_XFER_END)
+		sandbox_sf_cs_deactivate(sss->emu);
+
+	return 0;
+}
@@ -508,6 +508,7 @@ static int asix_recv(struct eth_device *eth)
 	}
 	if (actual_len > AX_RX_URB_SIZE) {
 		debug("Rx: received too many bytes %d\n", actual_len);
+		eth->rx_dropped++;
 		return -1;
 	}
 
@@ -519,6 +520,7 @@ static int asix_recv(struct eth_device *eth)
 		 */
 		if (actual_len < sizeof(packet_len)) {
 			debug("Rx: incomplete packet length\n");
+			eth->rx_dropped++;
 			return -1;
 		}
 		memcpy(&packet_len, buf_ptr, sizeof(packet_len));
@@ -527,11 +529,13 @@ static int asix_recv(struct eth_device *eth)
 			debug("Rx: malformed packet length: %#x (%#x:%#x)\n",
 			      packet_len, (~packet_len >> 16) & 0x7ff,
 			      packet_len & 0x7ff);
+			eth->rx_dropped++;
 			return -1;
 		}
 		packet_len = packet_len & 0x7ff;
 		if (packet_len > actual_len - sizeof(packet_len)) {
 			debug("Rx: too large packet: %d\n", packet_len);
+			eth->rx_dropped++;
 			return -1;
 		}
 
@@ -124,7 +124,7 @@
 #define USB_BULK_SEND_TIMEOUT 5000
 #define USB_BULK_RECV_TIMEOUT 5000
 
-#define AX_RX_URB_SIZE 2048
+#define RX_URB_SIZE DEFAULT_HS_BURST_CAP_SIZE
 #define PHY_CONNECT_TIMEOUT 5000
 
 #define TURBO_MODE
@@ -696,28 +696,31 @@ static int smsc95xx_send(struct eth_device *eth, void* packet, int length)
 static int smsc95xx_recv(struct eth_device *eth)
 {
 	struct ueth_data *dev = (struct ueth_data *)eth->priv;
-	DEFINE_CACHE_ALIGN_BUFFER(unsigned char, recv_buf, AX_RX_URB_SIZE);
+	struct smsc95xx_private *priv = dev->dev_priv;
+	/* one transfer carries as many frames as BURST_CAP allows */
+	DEFINE_CACHE_ALIGN_BUFFER(unsigned char, recv_buf, RX_URB_SIZE);
 	unsigned char *buf_ptr;
 	int err;
 	int actual_len;
-	u32 packet_len;
+	u32 packet_len, rx_status;
 	int cur_buf_align;
 
 	debug("** %s()\n", __func__);
 	err = usb_bulk_msg(dev->pusb_dev,
 				usb_rcvbulkpipe(dev->pusb_dev, dev->ep_in),
 				(void *)recv_buf,
-				AX_RX_URB_SIZE,
+				priv->rx_urb_size,
 				&actual_len,
 				USB_BULK_RECV_TIMEOUT);
-	debug("Rx: len = %u, actual = %u, err = %d\n", AX_RX_URB_SIZE,
-	      actual_len, err);
+	debug("Rx: len = %lu, actual = %u, err = %d\n",
+	      (ulong)priv->rx_urb_size, actual_len, err);
 	if (err != 0) {
 		debug("Rx: failed to receive\n");
 		return -1;
 	}
-	if (actual_len > AX_RX_URB_SIZE) {
+	if (actual_len > priv->rx_urb_size) {
 		debug("Rx: received too many bytes %d\n", actual_len);
+		eth->rx_dropped++;
 		return -1;
 	}
 
@@ -729,23 +732,27 @@ static int smsc95xx_recv(struct eth_device *eth)
 		 */
 		if (actual_len < sizeof(packet_len)) {
 			debug("Rx: incomplete packet length\n");
+			eth->rx_dropped++;
 			return -1;
 		}
-		memcpy(&packet_len, buf_ptr, sizeof(packet_len));
-		le32_to_cpus(&packet_len);
-		if (packet_len & RX_STS_ES_) {
-			debug("Rx: Error header=%#x", packet_len);
-			return -1;
-		}
-		packet_len = ((packet_len & RX_STS_FL_) >> 16);
+		memcpy(&rx_status, buf_ptr, sizeof(rx_status));
+		le32_to_cpus(&rx_status);
+		packet_len = ((rx_status & RX_STS_FL_) >> 16);
 
 		if (packet_len > actual_len - sizeof(packet_len)) {
 			debug("Rx: too large packet: %d\n", packet_len);
+			eth->rx_dropped++;
 			return -1;
 		}
 
-		/* Notify net stack */
-		NetReceive(buf_ptr + sizeof(packet_len), packet_len - 4);
+		/* Notify net stack, unless the frame is in error */
+		if (rx_status & RX_STS_ES_) {
+			debug("Rx: Error header=%#x\n", rx_status);
+			eth->rx_dropped++;
+		} else {
+			NetReceive(buf_ptr + sizeof(packet_len),
+				   packet_len - 4);
+		}
 
 		/* Adjust for next iteration */
 		actual_len -= sizeof(packet_len) + packet_len;
@@ -36,6 +36,15 @@
 #define CONFIG_USB_MAX_CONTROLLER_COUNT 1
 #endif
 
+/* Endpoint which a queue head in the asynchronous schedule belongs to */
+struct ehci_async_ep {
+	int linked;		/* QH is in the asynchronous schedule */
+	unsigned long key;	/* device, endpoint and direction */
+	uint32_t endpt1;	/* endpoint characteristics it was set up with */
+	uint32_t endpt2;
+	unsigned long used;	/* for least-recently-used replacement */
+};
+
 static struct ehci_ctrl {
 	struct ehci_hccr *hccr;	/* R/O registers, not need for volatile */
 	struct ehci_hcor *hcor;
@@ -45,6 +54,9 @@ static struct ehci_ctrl {
 	struct QH periodic_queue __aligned(USB_DMA_MINALIGN);
 	uint32_t *periodic_list;
 	int ntds;
+	void *async_qh;		/* CONFIG_USB_EHCI_ASYNC_QHS queue heads */
+	struct ehci_async_ep async_ep[CONFIG_USB_EHCI_ASYNC_QHS];
+	unsigned long async_seq;
 } ehcic[CONFIG_USB_MAX_CONTROLLER_COUNT];
 
 #define ALIGN_END_ADDR(type, ptr, size)			\
@@ -243,20 +255,207 @@ static inline u8 ehci_encode_speed(enum usb_device_speed speed)
 	return QH_FULL_SPEED;
 }
 
+static inline struct QH *ehci_async_qh(struct ehci_ctrl *ctrl, int i)
+{
+	return ctrl->async_qh + i * EHCI_ASYNC_QH_SIZE;
+}
+
+/*
+ * Turn on the asynchronous schedule. It stays on, with the queue heads of
+ * recently used endpoints linked into it, until the controller is stopped.
+ */
+static int ehci_enable_async(struct ehci_ctrl *ctrl)
+{
+	uint32_t cmd, usbsts;
+	int ret;
+
+	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
+	if (cmd & CMD_ASE)
+		return 0;
+
+	/* Set async. queue head pointer. */
+	ehci_writel(&ctrl->hcor->or_asynclistaddr, (uint32_t)&ctrl->qh_list);
+
+	usbsts = ehci_readl(&ctrl->hcor->or_usbsts);
+	ehci_writel(&ctrl->hcor->or_usbsts, (usbsts & 0x3f));
+
+	/* Enable async. schedule. */
+	cmd |= CMD_ASE;
+	ehci_writel(&ctrl->hcor->or_usbcmd, cmd);
+
+	ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_ASS, STS_ASS,
+			100 * 1000);
+	if (ret < 0)
+		printf("EHCI fail timeout STS_ASS set\n");
+
+	return ret;
+}
+
+/* Turn off the asynchronous schedule and forget the queue heads in it */
+static int ehci_disable_async(struct ehci_ctrl *ctrl)
+{
+	uint32_t cmd;
+	int i, ret = 0;
+
+	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
+	if (cmd & CMD_ASE) {
+		cmd &= ~CMD_ASE;
+		ehci_writel(&ctrl->hcor->or_usbcmd, cmd);
+		ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_ASS,
+				0, 100 * 1000);
+		if (ret < 0)
+			printf("EHCI fail timeout STS_ASS reset\n");
+	}
+
+	ctrl->qh_list.qh_link = cpu_to_hc32((uint32_t)&ctrl->qh_list |
+					    QH_LINK_TYPE_QH);
+	flush_dcache_range((uint32_t)&ctrl->qh_list,
+			   ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
+	for (i = 0; i < CONFIG_USB_EHCI_ASYNC_QHS; i++)
+		ctrl->async_ep[i].linked = 0;
+
+	return ret;
+}
+
+/*
+ * Take a queue head out of the asynchronous schedule. The controller may
+ * still hold a pointer to it, so if the schedule is running, ring the
+ * doorbell and wait until the controller has moved on (EHCI 4.8.2).
+ */
+static int ehci_unlink_async_qh(struct ehci_ctrl *ctrl, struct QH *qh)
+{
+	struct QH *prev = &ctrl->qh_list;
+	struct QH *next;
+	uint32_t cmd;
+	int ret;
+
+	for (;;) {
+		next = (struct QH *)(hc32_to_cpu(prev->qh_link) & ~0x1f);
+		if (next == qh)
+			break;
+		if (next == &ctrl->qh_list)
+			return 0;	/* not linked */
+		prev = next;
+	}
+	prev->qh_link = qh->qh_link;
+	flush_dcache_range((uint32_t)prev, ALIGN_END_ADDR(struct QH, prev, 1));
+
+	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
+	if (!(cmd & CMD_ASE))
+		return 0;
+	ehci_writel(&ctrl->hcor->or_usbsts, STS_IAA);
+	ehci_writel(&ctrl->hcor->or_usbcmd, cmd | CMD_IAAD);
+	ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_IAA, STS_IAA,
+			100 * 1000);
+	ehci_writel(&ctrl->hcor->or_usbsts, STS_IAA);
+	if (ret < 0)
+		printf("EHCI fail timeout on async advance doorbell\n");
+
+	return ret;
+}
+
+/*
+ * Find the queue head for an endpoint in the asynchronous schedule, or set
+ * one up. QHs are only modified while out of the schedule, so a QH whose
+ * endpoint characteristics have changed (e.g. the maximum packet size of
+ * endpoint 0 during enumeration) is unlinked first, as is the least
+ * recently used one when they are all taken.
+ */
+static struct QH *ehci_get_async_qh(struct ehci_ctrl *ctrl, unsigned long pipe,
+				    uint32_t endpt1, uint32_t endpt2)
+{
+	struct ehci_async_ep *ep;
+	unsigned long key;
+	struct QH *qh;
+	int i, slot = -1;
+
+	key = usb_pipedevice(pipe) | usb_pipeendpoint(pipe) << 8;
+	if (!usb_pipecontrol(pipe))
+		key |= usb_pipein(pipe) << 12;
+
+	for (i = 0; i < CONFIG_USB_EHCI_ASYNC_QHS; i++) {
+		ep = &ctrl->async_ep[i];
+		if (ep->linked && ep->key == key) {
+			slot = i;
+			break;
+		}
+		if (slot == -1 || (ctrl->async_ep[slot].linked &&
+				   (!ep->linked ||
+				    ep->used < ctrl->async_ep[slot].used)))
+			slot = i;
+	}
+	ep = &ctrl->async_ep[slot];
+	qh = ehci_async_qh(ctrl, slot);
+	ep->used = ++ctrl->async_seq;
+	if (ep->linked && ep->key == key && ep->endpt1 == endpt1 &&
+	    ep->endpt2 == endpt2)
+		return qh;
+
+	if (ep->linked) {
+		ep->linked = 0;
+		if (ehci_unlink_async_qh(ctrl, qh))
+			return NULL;
+	}
+
+	/*
+	 * Setup QH (3.6 in ehci-r10.pdf)
+	 *
+	 *   qh_link ................. 03-00 H
+	 *   qh_endpt1 ............... 07-04 H
+	 *   qh_endpt2 ............... 0B-08 H
+	 * - qh_curtd
+	 *   qh_overlay.qt_next ...... 13-10 H
+	 * - qh_overlay.qt_altnext
+	 */
+	memset(qh, 0, sizeof(struct QH));
+	qh->qh_link = ctrl->qh_list.qh_link;
+	qh->qh_endpt1 = cpu_to_hc32(endpt1);
+	qh->qh_endpt2 = cpu_to_hc32(endpt2);
+	qh->qh_curtd = cpu_to_hc32(QT_NEXT_TERMINATE);
+	qh->qh_overlay.qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
+	qh->qh_overlay.qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
+	flush_dcache_range((uint32_t)qh, ALIGN_END_ADDR(struct QH, qh, 1));
+
+	ctrl->qh_list.qh_link = cpu_to_hc32((uint32_t)qh | QH_LINK_TYPE_QH);
+	flush_dcache_range((uint32_t)&ctrl->qh_list,
+			   ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
+
+	ep->linked = 1;
+	ep->key = key;
+	ep->endpt1 = endpt1;
+	ep->endpt2 = endpt2;
+
+	return qh;
+}
+
+/*
+ * Hand a list of qTDs to an idle queue head. The controller may look at
+ * the QH at any time, so point the overlay at the list before clearing
+ * any halt left by the previous transfer.
+ */
+static void ehci_start_qh(struct QH *qh, uint32_t first)
+{
+	qh->qh_overlay.qt_next = first;
+	qh->qh_overlay.qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
+	flush_dcache_range((uint32_t)qh, ALIGN_END_ADDR(struct QH, qh, 1));
+	qh->qh_overlay.qt_token = 0;
+	flush_dcache_range((uint32_t)qh, ALIGN_END_ADDR(struct QH, qh, 1));
+}
+
 static int
 ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		   int length, struct devrequest *req)
 {
-	ALLOC_ALIGN_BUFFER(struct QH, qh, 1, USB_DMA_MINALIGN);
+	struct QH *qh;
 	struct qTD *qtd;
 	int qtd_count = 0;
 	int qtd_counter = 0;
 	volatile struct qTD *vtd;
 	unsigned long ts;
 	uint32_t *tdp;
-	uint32_t endpt, maxpacket, token, usbsts;
+	uint32_t first = cpu_to_hc32(QT_NEXT_TERMINATE);
+	uint32_t endpt1, endpt2, maxpacket, token, status;
 	uint32_t c, toggle;
-	uint32_t cmd;
 	int timeout;
 	int ret = 0;
 	struct ehci_ctrl *ctrl = dev->controller;
@@ -335,38 +534,24 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		return -1;
 	}
 
-	memset(qh, 0, sizeof(struct QH));
 	memset(qtd, 0, qtd_count * sizeof(*qtd));
 
 	toggle = usb_gettoggle(dev, usb_pipeendpoint(pipe), usb_pipeout(pipe));
 
-	/*
-	 * Setup QH (3.6 in ehci-r10.pdf)
-	 *
-	 *   qh_link ................. 03-00 H
-	 *   qh_endpt1 ............... 07-04 H
-	 *   qh_endpt2 ............... 0B-08 H
-	 * - qh_curtd
-	 *   qh_overlay.qt_next ...... 13-10 H
-	 * - qh_overlay.qt_altnext
-	 */
-	qh->qh_link = cpu_to_hc32((uint32_t)&ctrl->qh_list | QH_LINK_TYPE_QH);
 	c = (dev->speed != USB_SPEED_HIGH) && !usb_pipeendpoint(pipe);
 	maxpacket = usb_maxpacket(dev, pipe);
-	endpt = QH_ENDPT1_RL(8) | QH_ENDPT1_C(c) |
+	endpt1 = QH_ENDPT1_RL(8) | QH_ENDPT1_C(c) |
 		QH_ENDPT1_MAXPKTLEN(maxpacket) | QH_ENDPT1_H(0) |
 		QH_ENDPT1_DTC(QH_ENDPT1_DTC_DT_FROM_QTD) |
 		QH_ENDPT1_EPS(ehci_encode_speed(dev->speed)) |
 		QH_ENDPT1_ENDPT(usb_pipeendpoint(pipe)) | QH_ENDPT1_I(0) |
 		QH_ENDPT1_DEVADDR(usb_pipedevice(pipe));
-	qh->qh_endpt1 = cpu_to_hc32(endpt);
-	endpt = QH_ENDPT2_MULT(1) | QH_ENDPT2_PORTNUM(dev->portnr) |
+	endpt2 = QH_ENDPT2_MULT(1) | QH_ENDPT2_PORTNUM(dev->portnr) |
 		QH_ENDPT2_HUBADDR(dev->parent->devnum) |
 		QH_ENDPT2_UFCMASK(0) | QH_ENDPT2_UFSMASK(0);
-	qh->qh_endpt2 = cpu_to_hc32(endpt);
-	qh->qh_overlay.qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
 
-	tdp = &qh->qh_overlay.qt_next;
+	/* The qTDs are linked in a list which is given to the QH at the end */
+	tdp = &first;
 
 	if (req != NULL) {
 		/*
@@ -484,32 +669,16 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		tdp = &qtd[qtd_counter++].qt_next;
 	}
 
-	ctrl->qh_list.qh_link = cpu_to_hc32((uint32_t)qh | QH_LINK_TYPE_QH);
-
 	/* Flush dcache */
-	flush_dcache_range((uint32_t)&ctrl->qh_list,
-		ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
-	flush_dcache_range((uint32_t)qh, ALIGN_END_ADDR(struct QH, qh, 1));
 	flush_dcache_range((uint32_t)qtd,
 			   ALIGN_END_ADDR(struct qTD, qtd, qtd_count));
 
-	/* Set async. queue head pointer. */
-	ehci_writel(&ctrl->hcor->or_asynclistaddr, (uint32_t)&ctrl->qh_list);
-
-	usbsts = ehci_readl(&ctrl->hcor->or_usbsts);
-	ehci_writel(&ctrl->hcor->or_usbsts, (usbsts & 0x3f));
-
-	/* Enable async. schedule. */
-	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
-	cmd |= CMD_ASE;
-	ehci_writel(&ctrl->hcor->or_usbcmd, cmd);
-
-	ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_ASS, STS_ASS,
-			100 * 1000);
-	if (ret < 0) {
-		printf("EHCI fail timeout STS_ASS set\n");
+	qh = ehci_get_async_qh(ctrl, pipe, endpt1, endpt2);
+	if (!qh)
 		goto fail;
-	}
+	if (ehci_enable_async(ctrl))
+		goto fail;
+	ehci_start_qh(qh, first);
 
 	/* Wait for TDs to be processed. */
 	ts = get_timer(0);
@@ -527,6 +696,10 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		token = hc32_to_cpu(vtd->qt_token);
 		if (!(QT_TOKEN_GET_STATUS(token) & QT_TOKEN_STATUS_ACTIVE))
 			break;
+		/* An error part way along the list halts the QH */
+		if (QT_TOKEN_GET_STATUS(hc32_to_cpu(qh->qh_overlay.qt_token)) &
+		    QT_TOKEN_STATUS_HALTED)
+			break;
 		WATCHDOG_RESET();
 	} while (get_timer(ts) < timeout);
 
@@ -542,20 +715,26 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 	invalidate_dcache_range((uint32_t)buffer,
 		ALIGN((uint32_t)buffer + length, ARCH_DMA_MINALIGN));
 
-	/* Check that the TD processing happened */
-	if (QT_TOKEN_GET_STATUS(token) & QT_TOKEN_STATUS_ACTIVE)
-		printf("EHCI timed out on TD - token=%#x\n", token);
-
-	/* Disable async schedule. */
-	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
-	cmd &= ~CMD_ASE;
-	ehci_writel(&ctrl->hcor->or_usbcmd, cmd);
-
-	ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_ASS, 0,
-			100 * 1000);
-	if (ret < 0) {
-		printf("EHCI fail timeout STS_ASS reset\n");
-		goto fail;
+	/*
+	 * Check that the TD processing happened. If not, because the QH
+	 * halted part way along the list or because we timed out, the
+	 * controller still owns the qTDs, so take the QH out of the
+	 * schedule before they are freed.
+	 */
+	if (QT_TOKEN_GET_STATUS(token) & QT_TOKEN_STATUS_ACTIVE) {
+		status = QT_TOKEN_GET_STATUS(hc32_to_cpu(
+					qh->qh_overlay.qt_token));
+		if (status & QT_TOKEN_STATUS_HALTED)
+			printf("EHCI halted on TD - status=%#x\n", status);
+		else
+			printf("EHCI timed out on TD - token=%#x\n", token);
+		ctrl->async_ep[((void *)qh - ctrl->async_qh) /
+			       EHCI_ASYNC_QH_SIZE].linked = 0;
+		ret = ehci_unlink_async_qh(ctrl, qh);
+		invalidate_dcache_range((uint32_t)qh,
+			ALIGN_END_ADDR(struct QH, qh, 1));
+		if (ret < 0)
+			goto fail;
 	}
 
 	token = hc32_to_cpu(qh->qh_overlay.qt_token);
@@ -887,6 +1066,8 @@ unknown:
 
 int usb_lowlevel_stop(int index)
 {
+	if (ehcic[index].async_qh)
+		ehci_disable_async(&ehcic[index]);
 	return ehci_hcd_stop(index);
 }
 
@@ -932,6 +1113,15 @@ int usb_lowlevel_init(int index, void **controller)
 	/* Set async. queue head pointer. */
 	ehci_writel(&ehcic[index].hcor->or_asynclistaddr, (uint32_t)qh_list);
 
+	/* Queue heads for endpoints, added to the reclaim list when used */
+	if (!ehcic[index].async_qh) {
+		ehcic[index].async_qh = memalign(4096, EHCI_ASYNC_QH_SIZE *
+						 CONFIG_USB_EHCI_ASYNC_QHS);
+		if (!ehcic[index].async_qh)
+			return -ENOMEM;
+	}
+	memset(ehcic[index].async_ep, '\0', sizeof(ehcic[index].async_ep));
+
 	/*
 	 * Set up periodic list
 	 * Step 1: Parent QH for all periodic transfers.
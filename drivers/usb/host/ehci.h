@@ -63,7 +63,7 @@ struct ehci_hcor {
 #define CMD_PARK_CNT(c)	(((c) >> 8) & 3)	/* how many transfers to park */
 #define CMD_ASE		(1 << 5)		/* async schedule enable */
 #define CMD_LRESET	(1 << 7)		/* partial reset */
-#define CMD_IAAD	(1 << 5)		/* "doorbell" interrupt */
+#define CMD_IAAD	(1 << 6)		/* "doorbell" interrupt */
 #define CMD_PSE		(1 << 4)		/* periodic schedule enable */
 #define CMD_RESET	(1 << 1)		/* reset HC not bus */
 #define CMD_RUN		(1 << 0)		/* start/stop HC */
@@ -71,6 +71,7 @@ struct ehci_hcor {
 #define STS_ASS		(1 << 15)
 #define	STS_PSS		(1 << 14)
 #define STS_HALT	(1 << 12)
+#define STS_IAA		(1 << 5)		/* async advance (doorbell) */
 	uint32_t or_usbintr;
 #define INTR_UE         (1 << 0)                /* USB interrupt enable */
 #define INTR_UEE        (1 << 1)                /* USB error interrupt enable */
@@ -252,6 +253,17 @@ struct QH {
 	};
 };
 
+/*
+ * Queue heads are kept in the asynchronous schedule between transfers, one
+ * per endpoint in use, up to CONFIG_USB_EHCI_ASYNC_QHS of them. Each takes
+ * EHCI_ASYNC_QH_SIZE bytes, so that none crosses a 4K page and none shares
+ * a cache line with another.
+ */
+#ifndef CONFIG_USB_EHCI_ASYNC_QHS
+#define CONFIG_USB_EHCI_ASYNC_QHS	16
+#endif
+#define EHCI_ASYNC_QH_SIZE	128
+
 /* Low level init functions */
 int ehci_hcd_init(int index, struct ehci_hccr **hccr, struct ehci_hcor **hcor);
 int ehci_hcd_stop(int index);
@@ -44,6 +44,20 @@ int ext4fs_indir3_blkno = -1;
 struct ext2_inode *g_parent_inode;
 static int symlinknest;
 
+/*
+ * Extent tree leaf used by the last lookup. Mapping a file block by block
+ * would otherwise walk the tree from the inode each time and re-read the
+ * same index and leaf blocks for every block of the file. The cache is
+ * keyed on the root node held in the inode, which identifies the tree.
+ */
+static struct {
+	uint32_t root[INDIRECT_BLOCKS + 3];	/* root node of the tree */
+	char *leaf;		/* leaf block, or NULL if not allocated */
+	int size;		/* size of the leaf buffer */
+	uint32_t first;		/* first file block mapped by the leaf */
+	uint32_t end;		/* file block after the leaf, 0 if invalid */
+} ext4fs_ext_cache;
+
 #if defined(CONFIG_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n)
 {
@@ -1407,14 +1421,20 @@ void ext4fs_allocate_blocks(struct ext2_inode *file_inode,
 
 #endif
 
+/*
+ * Walk down the extent tree from ext_block to the leaf mapping fileblock.
+ * Index blocks are read into buf. On return *first and *end give the range
+ * of file blocks [first, end) which the returned leaf is responsible for,
+ * and must be set to the range of ext_block (0, ~0) on entry.
+ */
 static struct ext4_extent_header *ext4fs_get_extent_block
 	(struct ext2_data *data, char *buf,
 		struct ext4_extent_header *ext_block,
-		uint32_t fileblock, int log2_blksz)
+		uint32_t fileblock, int log2_blksz,
+		uint32_t *first, uint32_t *end)
 {
 	struct ext4_extent_idx *index;
 	unsigned long long block;
-	struct ext_filesystem *fs = get_fs();
 	int i;
 
 	while (1) {
@@ -1430,22 +1450,120 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 			i++;
 			if (i >= le16_to_cpu(ext_block->eh_entries))
 				break;
-		} while (fileblock > le32_to_cpu(index[i].ei_block));
+		} while (fileblock >= le32_to_cpu(index[i].ei_block));
 
 		if (--i < 0)
 			return 0;
 
+		*first = le32_to_cpu(index[i].ei_block);
+		if (i + 1 < le16_to_cpu(ext_block->eh_entries))
+			*end = le32_to_cpu(index[i + 1].ei_block);
+
 		block = le16_to_cpu(index[i].ei_leaf_hi);
 		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
 
-		if (ext4fs_devread((lbaint_t)block << log2_blksz, 0, fs->blksz,
-				   buf))
+		if (ext4fs_devread((lbaint_t)block << log2_blksz, 0,
+				   EXT2_BLOCK_SIZE(data), buf))
 			ext_block = (struct ext4_extent_header *)buf;
 		else
 			return 0;
 	}
 }
 
+/**
+ * ext4fs_map_extent() - Map a file block of an inode which uses extents
+ *
+ * Besides the block itself this reports how many of the following file
+ * blocks are laid out contiguously after it on disk (or, for a hole, how
+ * many are unallocated), so that callers can map a whole run at once.
+ *
+ * @inode:	Inode to look up, with EXT4_EXTENTS_FL set
+ * @fileblock:	File block to map
+ * @count:	Returns the number of blocks in the run starting at fileblock
+ * @return filesystem block number, 0 for a hole, -ve on error
+ */
+long int ext4fs_map_extent(struct ext2_inode *inode, int fileblock,
+			   uint32_t *count)
+{
+	struct ext4_extent_header *root, *ext_block;
+	struct ext4_extent *extent;
+	uint32_t first = 0, end = ~0U;
+	unsigned long long start;
+	int blksz, log2_blksz;
+	int i = -1;
+
+	blksz = EXT2_BLOCK_SIZE(ext4fs_root);
+	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root)
+		- get_fs()->dev_desc->log2blksz;
+	root = (struct ext4_extent_header *)inode->b.blocks.dir_blocks;
+
+	if (le16_to_cpu(root->eh_depth) == 0) {
+		/* the extents are held in the inode itself */
+		ext_block = root;
+	} else if (ext4fs_ext_cache.end &&
+		   fileblock >= ext4fs_ext_cache.first &&
+		   fileblock < ext4fs_ext_cache.end &&
+		   !memcmp(ext4fs_ext_cache.root, root,
+			   sizeof(ext4fs_ext_cache.root))) {
+		ext_block = (struct ext4_extent_header *)ext4fs_ext_cache.leaf;
+		first = ext4fs_ext_cache.first;
+		end = ext4fs_ext_cache.end;
+	} else {
+		if (ext4fs_ext_cache.size != blksz) {
+			free(ext4fs_ext_cache.leaf);
+			ext4fs_ext_cache.leaf = zalloc(blksz);
+			if (!ext4fs_ext_cache.leaf) {
+				ext4fs_ext_cache.size = 0;
+				return -ENOMEM;
+			}
+			ext4fs_ext_cache.size = blksz;
+		}
+		/* the buffer is overwritten by the walk */
+		ext4fs_ext_cache.end = 0;
+		ext_block = ext4fs_get_extent_block(ext4fs_root,
+						    ext4fs_ext_cache.leaf,
+						    root, fileblock,
+						    log2_blksz, &first, &end);
+		if (ext_block) {
+			memcpy(ext4fs_ext_cache.root, root,
+			       sizeof(ext4fs_ext_cache.root));
+			ext4fs_ext_cache.first = first;
+			ext4fs_ext_cache.end = end;
+		}
+	}
+	if (!ext_block) {
+		printf("invalid extent block\n");
+		return -EINVAL;
+	}
+
+	extent = (struct ext4_extent *)(ext_block + 1);
+
+	do {
+		i++;
+		if (i >= le16_to_cpu(ext_block->eh_entries))
+			break;
+	} while (fileblock >= le32_to_cpu(extent[i].ee_block));
+	if (--i < 0) {
+		printf("Extent Error\n");
+		return -1;
+	}
+
+	fileblock -= le32_to_cpu(extent[i].ee_block);
+	if (fileblock >= le16_to_cpu(extent[i].ee_len)) {
+		/* a hole, up to the next extent or the end of this leaf */
+		if (i + 1 < le16_to_cpu(ext_block->eh_entries))
+			end = le32_to_cpu(extent[i + 1].ee_block);
+		*count = end - le32_to_cpu(extent[i].ee_block) - fileblock;
+		return 0;
+	}
+
+	*count = le16_to_cpu(extent[i].ee_len) - fileblock;
+	start = le16_to_cpu(extent[i].ee_start_hi);
+	start = (start << 32) + le32_to_cpu(extent[i].ee_start_lo);
+
+	return fileblock + start;
+}
+
 static int ext4fs_blockgroup
 	(struct ext2_data *data, int group, struct ext2_block_group *blkgrp)
 {
@@ -1508,54 +1626,15 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	long int rblock;
 	long int perblock_parent;
 	long int perblock_child;
-	unsigned long long start;
 	/* get the blocksize of the filesystem */
 	blksz = EXT2_BLOCK_SIZE(ext4fs_root);
 	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root)
 		- get_fs()->dev_desc->log2blksz;
 
 	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL) {
-		char *buf = zalloc(blksz);
-		if (!buf)
-			return -ENOMEM;
-		struct ext4_extent_header *ext_block;
-		struct ext4_extent *extent;
-		int i = -1;
-		ext_block =
-			ext4fs_get_extent_block(ext4fs_root, buf,
-						(struct ext4_extent_header *)
-						inode->b.blocks.dir_blocks,
-						fileblock, log2_blksz);
-		if (!ext_block) {
-			printf("invalid extent block\n");
-			free(buf);
-			return -EINVAL;
-		}
-
-		extent = (struct ext4_extent *)(ext_block + 1);
+		uint32_t count;
 
-		do {
-			i++;
-			if (i >= le16_to_cpu(ext_block->eh_entries))
-				break;
-		} while (fileblock >= le32_to_cpu(extent[i].ee_block));
-		if (--i >= 0) {
-			fileblock -= le32_to_cpu(extent[i].ee_block);
-			if (fileblock >= le16_to_cpu(extent[i].ee_len)) {
-				free(buf);
-				return 0;
-			}
-
-			start = le16_to_cpu(extent[i].ee_start_hi);
-			start = (start << 32) +
-					le32_to_cpu(extent[i].ee_start_lo);
-			free(buf);
-			return fileblock + start;
-		}
-
-		printf("Extent Error\n");
-		free(buf);
-		return -1;
+		return ext4fs_map_extent(inode, fileblock, &count);
 	}
 
 	/* Direct blocks. */
@@ -1871,6 +1950,12 @@ void ext4fs_close(void)
 		ext4fs_indir3_size = 0;
 		ext4fs_indir3_blkno = -1;
 	}
+	if (ext4fs_ext_cache.leaf != NULL) {
+		free(ext4fs_ext_cache.leaf);
+		ext4fs_ext_cache.leaf = NULL;
+		ext4fs_ext_cache.size = 0;
+		ext4fs_ext_cache.end = 0;
+	}
 }
 
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
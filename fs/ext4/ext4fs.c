@@ -62,10 +62,16 @@ int ext4fs_read_file(struct ext2fs_node *node, int pos,
 	lbaint_t delayed_next = 0;
 	char *delayed_buf = NULL;
 	short status;
+	int extents = le32_to_cpu(node->inode.flags) & EXT4_EXTENTS_FL;
+	lbaint_t run_start = 0;
+	int run_first = 0;
+	int run_end = 0;
 
 	/* Adjust len so it we can't read past the end of the file. */
-	if (len > filesize)
-		len = filesize;
+	if (pos >= filesize)
+		return 0;
+	if (len > filesize - pos)
+		len = filesize - pos;
 
 	blockcnt = ((len + pos) + blocksize - 1) / blocksize;
 
@@ -74,9 +80,28 @@ int ext4fs_read_file(struct ext2fs_node *node, int pos,
 		int blockoff = pos % blocksize;
 		int blockend = blocksize;
 		int skipfirst = 0;
-		blknr = read_allocated_block(&(node->inode), i);
-		if (blknr < 0)
-			return -1;
+
+		if (extents) {
+			/* map each run of contiguous blocks only once */
+			if (i >= run_end) {
+				uint32_t count;
+
+				blknr = ext4fs_map_extent(&node->inode, i,
+							  &count);
+				if (blknr < 0)
+					return -1;
+				if (count > blockcnt - i)
+					count = blockcnt - i;
+				run_start = blknr;
+				run_first = i;
+				run_end = i + count;
+			}
+			blknr = run_start ? run_start + i - run_first : 0;
+		} else {
+			blknr = read_allocated_block(&(node->inode), i);
+			if (blknr < 0)
+				return -1;
+		}
 
 		blknr = blknr << log2_fs_blocksize;
 
@@ -174,12 +199,12 @@ int ext4fs_ls(const char *dirname)
 	return 0;
 }
 
-int ext4fs_read(char *buf, unsigned len)
+int ext4fs_read(char *buf, int pos, unsigned len)
 {
 	if (ext4fs_root == NULL || ext4fs_file == NULL)
 		return 0;
 
-	return ext4fs_read_file(ext4fs_file, 0, len, buf);
+	return ext4fs_read_file(ext4fs_file, pos, len, buf);
 }
 
 int ext4fs_probe(block_dev_desc_t *fs_dev_desc,
@@ -200,11 +225,6 @@ int ext4_read_file(const char *filename, void *buf, int offset, int len)
 	int file_len;
 	int len_read;
 
-	if (offset != 0) {
-		printf("** Cannot support non-zero offset **\n");
-		return -1;
-	}
-
 	file_len = ext4fs_open(filename);
 	if (file_len < 0) {
 		printf("** File not found %s **\n", filename);
@@ -214,7 +234,23 @@ int ext4_read_file(const char *filename, void *buf, int offset, int len)
 	if (len == 0)
 		len = file_len;
 
-	len_read = ext4fs_read(buf, len);
+	len_read = ext4fs_read(buf, offset, len);
 
 	return len_read;
 }
+
+int ext4_open_file(const char *filename)
+{
+	int file_len;
+
+	file_len = ext4fs_open(filename);
+	if (file_len < 0)
+		printf("** File not found %s **\n", filename);
+
+	return file_len;
+}
+
+int ext4_read_open(void *buf, int offset, int len)
+{
+	return ext4fs_read(buf, offset, len);
+}
@@ -160,23 +160,20 @@ static void get_name(dir_entry *dirent, char *s_name)
  */
 static __u32 get_fatent(fsdata *mydata, __u32 entry)
 {
-	__u32 bufnum;
+	__u32 bufnum, perbuf;
 	__u32 off16, offset;
 	__u32 ret = 0x00;
 	__u16 val1, val2;
+	__u8 *fatbuf;
+	int i, slot;
 
 	switch (mydata->fatsize) {
 	case 32:
-		bufnum = entry / FAT32BUFSIZE;
-		offset = entry - bufnum * FAT32BUFSIZE;
-		break;
 	case 16:
-		bufnum = entry / FAT16BUFSIZE;
-		offset = entry - bufnum * FAT16BUFSIZE;
-		break;
 	case 12:
-		bufnum = entry / FAT12BUFSIZE;
-		offset = entry - bufnum * FAT12BUFSIZE;
+		perbuf = FATCACHESIZE * 8 / mydata->fatsize;
+		bufnum = entry / perbuf;
+		offset = entry - bufnum * perbuf;
 		break;
 
 	default:
@@ -187,57 +184,70 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 	debug("FAT%d: entry: 0x%04x = %d, offset: 0x%04x = %d\n",
 	       mydata->fatsize, entry, entry, offset, offset);
 
+	/* Look for the window in the cache, else evict the oldest one */
+	slot = 0;
+	for (i = 0; i < CONFIG_FAT_CACHE_WINDOWS; i++) {
+		if (mydata->fatcache_num[i] == bufnum) {
+			slot = i;
+			break;
+		}
+		if (mydata->fatcache_used[i] < mydata->fatcache_used[slot])
+			slot = i;
+	}
+	fatbuf = mydata->fatcache + slot * FATCACHESIZE;
+
 	/* Read a new block of FAT entries into the cache. */
-	if (bufnum != mydata->fatbufnum) {
-		__u32 getsize = FATBUFBLOCKS;
-		__u8 *bufptr = mydata->fatbuf;
+	if (bufnum != mydata->fatcache_num[slot]) {
+		__u32 getsize = FATCACHEBLOCKS;
 		__u32 fatlength = mydata->fatlength;
-		__u32 startblock = bufnum * FATBUFBLOCKS;
+		__u32 startblock = bufnum * FATCACHEBLOCKS;
 
 		if (startblock + getsize > fatlength)
 			getsize = fatlength - startblock;
 
 		startblock += mydata->fat_sect;	/* Offset from start of disk */
 
-		if (disk_read(startblock, getsize, bufptr) < 0) {
+		mydata->fatcache_num[slot] = -1;
+		if (disk_read(startblock, getsize, fatbuf) < 0) {
 			debug("Error reading FAT blocks\n");
 			return ret;
 		}
-		mydata->fatbufnum = bufnum;
+		mydata->fatcache_num[slot] = bufnum;
 	}
+	mydata->fatcache_used[slot] = ++mydata->fatcache_tick;
 
 	/* Get the actual entry from the table */
 	switch (mydata->fatsize) {
 	case 32:
-		ret = FAT2CPU32(((__u32 *) mydata->fatbuf)[offset]);
+		ret = FAT2CPU32(((__u32 *) fatbuf)[offset]);
 		break;
 	case 16:
-		ret = FAT2CPU16(((__u16 *) mydata->fatbuf)[offset]);
+		ret = FAT2CPU16(((__u16 *) fatbuf)[offset]);
 		break;
 	case 12:
 		off16 = (offset * 3) / 4;
 
 		switch (offset & 0x3) {
 		case 0:
-			ret = FAT2CPU16(((__u16 *) mydata->fatbuf)[off16]);
+			ret = FAT2CPU16(((__u16 *) fatbuf)[off16]);
 			ret &= 0xfff;
 			break;
 		case 1:
-			val1 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16]);
+			val1 = FAT2CPU16(((__u16 *)fatbuf)[off16]);
 			val1 &= 0xf000;
-			val2 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16 + 1]);
+			val2 = FAT2CPU16(((__u16 *)fatbuf)[off16 + 1]);
 			val2 &= 0x00ff;
 			ret = (val2 << 4) | (val1 >> 12);
 			break;
 		case 2:
-			val1 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16]);
+			val1 = FAT2CPU16(((__u16 *)fatbuf)[off16]);
 			val1 &= 0xff00;
-			val2 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16 + 1]);
+			val2 = FAT2CPU16(((__u16 *)fatbuf)[off16 + 1]);
 			val2 &= 0x000f;
 			ret = (val2 << 8) | (val1 >> 8);
 			break;
 		case 3:
-			ret = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16]);
+			ret = FAT2CPU16(((__u16 *)fatbuf)[off16]);
 			ret = (ret & 0xfff0) >> 4;
 			break;
 		default:
@@ -314,6 +324,28 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+/*
+ * Follow the cluster chain from 'clust' for as long as the clusters are
+ * consecutive on disk, up to 'max' clusters, so that the whole run can be
+ * read with a single disk_read().
+ * Return the number of clusters in the run and set 'next' to the FAT entry
+ * of its last cluster.
+ */
+static __u32 get_run(fsdata *mydata, __u32 clust, __u32 max, __u32 *next)
+{
+	__u32 len = 1;
+
+	*next = get_fatent(mydata, clust);
+	while (len < max && *next == clust + 1 &&
+	       !CHECK_CLUST(*next, mydata->fatsize)) {
+		clust = *next;
+		*next = get_fatent(mydata, clust);
+		len++;
+	}
+
+	return len;
+}
+
 /*
  * Read at most 'maxsize' bytes from 'pos' in the file associated with 'dentptr'
  * into 'buffer'.
@@ -322,14 +354,25 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 __u8 get_contents_vfatname_block[MAX_CLUSTSIZE]
 	__aligned(ARCH_DMA_MINALIGN);
 
+/* Where a file open for reading in pieces was last read */
+struct fat_cursor {
+	unsigned long pos;	/* offset in the file of the start of clust */
+	__u32 clust;		/* 0 if nothing read yet */
+};
+
+/*
+ * Read from the file at dentptr. If cursor is not NULL, the cluster chain
+ * is followed from where the last read left it, rather than from the
+ * start, so that a file read in order is not walked again for each piece.
+ */
 static long
 get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
-	     __u8 *buffer, unsigned long maxsize)
+	     __u8 *buffer, unsigned long maxsize, struct fat_cursor *cursor)
 {
 	unsigned long filesize = FAT2CPU32(dentptr->size), gotsize = 0;
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
 	__u32 curclust = START(dentptr);
-	__u32 endclust, newclust;
+	__u32 nclust, newclust;
 	unsigned long actsize;
 
 	debug("Filesize: %ld bytes\n", filesize);
@@ -345,6 +388,10 @@ get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
 	debug("%ld bytes\n", filesize);
 
 	actsize = bytesperclust;
+	if (cursor && cursor->clust && cursor->pos <= pos) {
+		curclust = cursor->clust;
+		actsize += cursor->pos;
+	}
 
 	/* go to cluster at pos */
 	while (actsize <= pos) {
@@ -356,6 +403,10 @@ get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
 		}
 		actsize += bytesperclust;
 	}
+	if (cursor) {
+		cursor->clust = curclust;
+		cursor->pos = actsize - bytesperclust;
+	}
 
 	/* actsize > pos */
 	actsize -= bytesperclust;
@@ -386,49 +437,27 @@ get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
 		}
 	}
 
-	actsize = bytesperclust;
-	endclust = curclust;
-
 	do {
-		/* search for consecutive clusters */
-		while (actsize < filesize) {
-			newclust = get_fatent(mydata, endclust);
-			if ((newclust - 1) != endclust)
-				goto getit;
-			if (CHECK_CLUST(newclust, mydata->fatsize)) {
-				debug("curclust: 0x%x\n", newclust);
-				debug("Invalid FAT entry\n");
-				return gotsize;
-			}
-			endclust = newclust;
-			actsize += bytesperclust;
-		}
-
-		/* get remaining bytes */
-		actsize = filesize;
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
+		/* read the run of consecutive clusters at curclust in one go */
+		nclust = (filesize + bytesperclust - 1) / bytesperclust;
+		nclust = get_run(mydata, curclust, nclust, &newclust);
+		actsize = min(filesize, (unsigned long)nclust * bytesperclust);
+		if (get_cluster(mydata, curclust, buffer, actsize) != 0) {
 			printf("Error reading cluster\n");
 			return -1;
 		}
 		gotsize += actsize;
-		return gotsize;
-getit:
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
-			printf("Error reading cluster\n");
-			return -1;
-		}
-		gotsize += (int)actsize;
 		filesize -= actsize;
+		if (!filesize)
+			return gotsize;
 		buffer += actsize;
 
-		curclust = get_fatent(mydata, endclust);
+		curclust = newclust;
 		if (CHECK_CLUST(curclust, mydata->fatsize)) {
 			debug("curclust: 0x%x\n", curclust);
 			printf("Invalid FAT entry\n");
 			return gotsize;
 		}
-		actsize = bytesperclust;
-		endclust = curclust;
 	} while (1);
 }
 
@@ -806,9 +835,21 @@ exit:
 __u8 do_fat_read_at_block[MAX_CLUSTSIZE]
 	__aligned(ARCH_DMA_MINALIGN);
 
-long
-do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
-	       unsigned long maxsize, int dols)
+/* The file opened by file_fat_open(), if any */
+static struct {
+	int open;
+	fsdata data;
+	dir_entry dent;
+	struct fat_cursor cursor;
+} fat_open_file;
+
+/*
+ * Look up filename and read from it, list a directory (dols), or, if open
+ * is non-zero, keep the file in fat_open_file and return its size.
+ */
+static long
+do_fat_lookup(const char *filename, unsigned long pos, void *buffer,
+	      unsigned long maxsize, int dols, int open)
 {
 	char fnamecopy[2048];
 	boot_sector bs;
@@ -866,11 +907,18 @@ do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
 	}
 
 	mydata->fatbufnum = -1;
-	mydata->fatbuf = memalign(ARCH_DMA_MINALIGN, FATBUFSIZE);
-	if (mydata->fatbuf == NULL) {
+	mydata->fatbuf = NULL;
+	mydata->fatcache = memalign(ARCH_DMA_MINALIGN,
+				    FATCACHESIZE * CONFIG_FAT_CACHE_WINDOWS);
+	if (mydata->fatcache == NULL) {
 		debug("Error: allocating memory\n");
 		return -1;
 	}
+	for (j = 0; j < CONFIG_FAT_CACHE_WINDOWS; j++) {
+		mydata->fatcache_num[j] = -1;
+		mydata->fatcache_used[j] = 0;
+	}
+	mydata->fatcache_tick = 0;
 
 	if (vfat_enabled)
 		debug("VFAT Support enabled\n");
@@ -1152,14 +1200,30 @@ rootdir_done:
 			subname = nextname;
 	}
 
-	ret = get_contents(mydata, dentptr, pos, buffer, maxsize);
+	if (open) {
+		/* the FAT cache stays allocated until fat_close() */
+		fat_open_file.data = *mydata;
+		fat_open_file.dent = *dentptr;
+		fat_open_file.cursor.clust = 0;
+		fat_open_file.open = 1;
+		return FAT2CPU32(dentptr->size);
+	}
+
+	ret = get_contents(mydata, dentptr, pos, buffer, maxsize, NULL);
 	debug("Size: %d, got: %ld\n", FAT2CPU32(dentptr->size), ret);
 
 exit:
-	free(mydata->fatbuf);
+	free(mydata->fatcache);
 	return ret;
 }
 
+long
+do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
+	       unsigned long maxsize, int dols)
+{
+	return do_fat_lookup(filename, pos, buffer, maxsize, dols, 0);
+}
+
 long
 do_fat_read(const char *filename, void *buffer, unsigned long maxsize, int dols)
 {
@@ -1258,6 +1322,32 @@ int fat_read_file(const char *filename, void *buf, int offset, int len)
 	return len_read;
 }
 
+int file_fat_open(const char *filename)
+{
+	long size;
+
+	fat_close();
+	printf("reading %s\n", filename);
+	size = do_fat_lookup(filename, 0, NULL, 0, LS_NO, 1);
+	if (size < 0)
+		printf("** Unable to read file %s **\n", filename);
+
+	return size;
+}
+
+int fat_read_open(void *buf, int offset, int len)
+{
+	if (!fat_open_file.open)
+		return -1;
+
+	return get_contents(&fat_open_file.data, &fat_open_file.dent, offset,
+			    buf, len, &fat_open_file.cursor);
+}
+
 void fat_close(void)
 {
+	if (fat_open_file.open) {
+		free(fat_open_file.data.fatcache);
+		fat_open_file.open = 0;
+	}
 }
@@ -59,12 +59,20 @@ static inline void fs_close_unsupported(void)
 
 struct fstype_info {
 	int fstype;
+	/* The filesystem does not live on a block device (e.g. sandbox host) */
+	bool null_dev_desc_ok;
 	int (*probe)(block_dev_desc_t *fs_dev_desc,
 		     disk_partition_t *fs_partition);
 	int (*ls)(const char *dirname);
 	int (*read)(const char *filename, void *buf, int offset, int len);
 	int (*write)(const char *filename, void *buf, int offset, int len);
 	void (*close)(void);
+	/*
+	 * Optional: look up a file once and then read it in pieces, until
+	 * close() is called. open() returns the file size or -1.
+	 */
+	int (*open)(const char *filename);
+	int (*read_open)(void *buf, int offset, int len);
 };
 
 static struct fstype_info fstypes[] = {
@@ -75,6 +83,8 @@ static struct fstype_info fstypes[] = {
 		.close = fat_close,
 		.ls = file_fat_ls,
 		.read = fat_read_file,
+		.open = file_fat_open,
+		.read_open = fat_read_open,
 	},
 #endif
 #ifdef CONFIG_FS_EXT4
@@ -84,11 +94,14 @@ static struct fstype_info fstypes[] = {
 		.close = ext4fs_close,
 		.ls = ext4fs_ls,
 		.read = ext4_read_file,
+		.open = ext4_open_file,
+		.read_open = ext4_read_open,
 	},
 #endif
 #ifdef CONFIG_SANDBOX
 	{
 		.fstype = FS_TYPE_SANDBOX,
+		.null_dev_desc_ok = true,
 		.probe = sandbox_fs_set_blk_dev,
 		.close = sandbox_fs_close,
 		.ls = sandbox_fs_ls,
@@ -98,6 +111,7 @@ static struct fstype_info fstypes[] = {
 #endif
 	{
 		.fstype = FS_TYPE_ANY,
+		.null_dev_desc_ok = true,
 		.probe = fs_probe_unsupported,
 		.close = fs_close_unsupported,
 		.ls = fs_ls_unsupported,
@@ -135,6 +149,10 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 			info->ls += gd->reloc_off;
 			info->read += gd->reloc_off;
 			info->write += gd->reloc_off;
+			if (info->open) {
+				info->open += gd->reloc_off;
+				info->read_open += gd->reloc_off;
+			}
 		}
 		relocated = 1;
 	}
@@ -150,6 +168,9 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 				fstype != info->fstype)
 			continue;
 
+		if (!fs_dev_desc && !info->null_dev_desc_ok)
+			continue;
+
 		if (!info->probe(fs_dev_desc, &fs_partition)) {
 			fs_type = info->fstype;
 			return 0;
@@ -206,6 +227,69 @@ int fs_read(const char *filename, ulong addr, int offset, int len)
 	return ret;
 }
 
+#ifdef CONFIG_CMD_GZLOAD
+#ifndef CONFIG_SYS_BOOTM_LEN
+#define CONFIG_SYS_BOOTM_LEN	0x800000	/* default max gzload size */
+#endif
+
+struct fs_stream {
+	struct fstype_info *info;
+	const char *filename;
+	int offset;		/* next byte of the file to read */
+	int size;		/* compressed bytes read so far */
+};
+
+static int fs_stream_read(void *priv, void *buf, int size)
+{
+	struct fs_stream *stream = priv;
+	int ret;
+
+	if (stream->info->read_open)
+		ret = stream->info->read_open(buf, stream->offset, size);
+	else
+		ret = stream->info->read(stream->filename, buf, stream->offset,
+					 size);
+	if (ret > 0) {
+		stream->offset += ret;
+		stream->size += ret;
+	}
+
+	return ret;
+}
+
+long fs_read_gz(const char *filename, ulong addr, ulong maxlen)
+{
+	struct fs_stream stream;
+	unsigned long len;
+	void *buf;
+	int ret;
+
+	stream.info = fs_get_info(fs_type);
+	stream.filename = filename;
+	stream.offset = 0;
+	stream.size = 0;
+
+	/*
+	 * The filesystem stays open until the whole file has been read. Where
+	 * it can, the file is looked up just once rather than for each piece.
+	 */
+	if (stream.info->open && stream.info->open(filename) < 0) {
+		fs_close();
+		return -1;
+	}
+	buf = map_sysmem(addr, maxlen);
+	ret = gunzip_stream(buf, maxlen, fs_stream_read, &stream, &len);
+	unmap_sysmem(buf);
+	fs_close();
+	if (ret)
+		return -1;
+	debug("%s: %d bytes decompressed to %lu\n", __func__, stream.size,
+	      len);
+
+	return len;
+}
+#endif
+
 int fs_write(const char *filename, ulong addr, int offset, int len)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
@@ -295,6 +379,46 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	return 0;
 }
 
+#ifdef CONFIG_CMD_GZLOAD
+int do_gzload(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+		int fstype)
+{
+	unsigned long addr, maxlen;
+	long len;
+	unsigned long time;
+
+	if (argc < 5 || argc > 6)
+		return CMD_RET_USAGE;
+
+	if (fs_set_blk_dev(argv[1], argv[2], fstype))
+		return 1;
+
+	addr = simple_strtoul(argv[3], NULL, 16);
+	if (argc >= 6)
+		maxlen = simple_strtoul(argv[5], NULL, 16);
+	else
+		maxlen = CONFIG_SYS_BOOTM_LEN;
+
+	time = get_timer(0);
+	len = fs_read_gz(argv[4], addr, maxlen);
+	time = get_timer(time);
+	if (len < 0)
+		return 1;
+
+	printf("%ld bytes unpacked in %lu ms", len, time);
+	if (time > 0) {
+		puts(" (");
+		print_size(len / time * 1000, "/s");
+		puts(")");
+	}
+	puts("\n");
+
+	setenv_hex("filesize", len);
+
+	return 0;
+}
+#endif
+
 int do_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	int fstype)
 {
@@ -272,11 +272,24 @@ ulong bootstage_mark_code(const char *file, const char *func,
  * in an activty during boot.
  *
  * @param id	Bootstage id to record this timestamp against
- * @param name	Textual name to display for this id in the report (maybe NULL)
+ * @param name	Textual name to display for this id in the report (NULL to
+ *		keep any name it already has)
  * @return start timestamp in microseconds
  */
 uint32_t bootstage_start(enum bootstage_id id, const char *name);
 
+/**
+ * Find the user bootstage id with a given name
+ *
+ * This allows commands and scripts to refer to their activities by name.
+ * If there is no such record yet then a new id is allocated and given a
+ * copy of the name.
+ *
+ * @param name	Name to look for
+ * @return bootstage id, or BOOTSTAGE_ID_ALLOC if none are left
+ */
+enum bootstage_id bootstage_find_name(const char *name);
+
 /**
  * Mark the end of a bootstage activity
  *
@@ -284,6 +297,9 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name);
  * call this function to mark the end. You can call these functions in pairs
  * as many times as you like.
  *
+ * Each pair is also logged as an interval for bootstage_export(). Pairs may
+ * be nested, so long as the inner one finishes first.
+ *
  * @param id	Bootstage id to record this timestamp against
  * @return time spent in this iteration of the activity (i.e. the time now
  *		less the start time recorded in the last bootstage_start() call
@@ -322,6 +338,18 @@ int bootstage_stash(void *base, int size);
  */
 int bootstage_unstash(void *base, int size);
 
+/**
+ * Export the bootstage timeline to memory
+ *
+ * This writes all marks, accumulated times and logged intervals, with
+ * their nesting, in a form which tools/bootstage can read.
+ *
+ * @param base	Base address of memory buffer
+ * @param size	Size of memory buffer
+ * @return number of bytes written, or -1 if out of space
+ */
+int bootstage_export(void *base, int size);
+
 #else
 static inline ulong bootstage_add_record(enum bootstage_id id,
 		const char *name, int flags, ulong mark)
@@ -382,6 +410,11 @@ static inline int bootstage_unstash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
 }
+
+static inline int bootstage_export(void *base, int size)
+{
+	return -1;
+}
 #endif /* CONFIG_BOOTSTAGE */
 
 /* Helper macro for adding a bootstage to a line of code */
@@ -782,6 +782,10 @@ int	init_timebase (void);
 
 /* lib/gunzip.c */
 int gunzip(void *, int, unsigned char *, unsigned long *);
+/* Reads up to size bytes into buf, returns bytes read, 0 at end, -ve on error */
+typedef int (*gunzip_read_func)(void *priv, void *buf, int size);
+int gunzip_stream(void *dst, int dstlen, gunzip_read_func read, void *priv,
+		  unsigned long *lenp);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
 
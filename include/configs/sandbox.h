@@ -18,6 +18,14 @@
 
 #define CONFIG_BOOTSTAGE
 #define CONFIG_BOOTSTAGE_REPORT
+#define CONFIG_CMD_BOOTSTAGE
+
+#define CONFIG_SAMPLE_PROFILE
+#ifdef PROFILE_UNWIND
+#define CONFIG_SAMPLE_PROFILE_UNWIND
+#define CONFIG_SAMPLE_PROFILE_DEPTH	16
+#endif
+#define CONFIG_CMD_PROFILE
 
 /* Number of bits in a C 'long' on this architecture */
 #define CONFIG_SANDBOX_BITS_PER_LONG	64
@@ -37,20 +45,38 @@
 #define CONFIG_CMD_FAT
 #define CONFIG_CMD_EXT4
 #define CONFIG_CMD_EXT4_WRITE
+#define CONFIG_CMD_FS_GENERIC
+#define CONFIG_CMD_GZLOAD
+#define CONFIG_DOS_PARTITION
+#define CONFIG_IMAGE_SPARSE
+#define CONFIG_CMD_SPARSE
+#define CONFIG_HOST_MAX_DEVICES	4
 
 #define CONFIG_SYS_VSNPRINTF
+#define CONFIG_CRC32_SLICE_BY_8
+#define CONFIG_ZLIB_INFLATE_FAST
 
 #define CONFIG_CMD_GPIO
 #define CONFIG_SANDBOX_GPIO
 #define CONFIG_SANDBOX_GPIO_COUNT	20
 
+#define CONFIG_CMD_SF
+#define CONFIG_SANDBOX_SPI
+#define CONFIG_SPI_FLASH
+#define CONFIG_SPI_FLASH_SANDBOX
+#define CONFIG_SPI_FLASH_WINBOND
+
 /*
  * Size of malloc() pool, although we don't actually use this yet.
  */
 #define CONFIG_SYS_MALLOC_LEN		(4 << 20)	/* 4MB  */
+#define CONFIG_SYS_MALLOC_POOL
+#define CONFIG_CMD_MPOOL
+#define CONFIG_CMD_TIME
 
 #define CONFIG_SYS_PROMPT		"=>"	/* Command Prompt */
 #define CONFIG_SYS_HUSH_PARSER
+#define CONFIG_HUSH_PARSE_CACHE
 #define CONFIG_SYS_LONGHELP			/* #undef to save memory */
 #define CONFIG_SYS_CBSIZE		1024	/* Console I/O Buffer Size */
 
@@ -92,9 +118,17 @@
 /* include default commands */
 #include <config_cmd_default.h>
 
-/* We don't have networking support yet */
-#undef CONFIG_CMD_NET
-#undef CONFIG_CMD_NFS
+/* Networking goes to the stand-in servers in drivers/net/sandbox.c */
+#define CONFIG_SANDBOX_ETH
+#define CONFIG_IP_DEFRAG
+#define CONFIG_NET_MAXDEFRAG		32768
+#define CONFIG_NET_DEFRAG_CONTEXTS	4
+#define CONFIG_NFS_READ_SIZE		32768
+#define CONFIG_TFTP_TSIZE
+#define CONFIG_TFTP_WINDOWSIZE		1
+#define CONFIG_CMD_WGET
+#define CONFIG_NET_RX_POST
+#define CONFIG_CMD_NETSTAT
 
 #define CONFIG_CMD_HASH
 #define CONFIG_HASH_VERIFY
@@ -49,6 +49,7 @@
 # define CONFIG_GENERIC_MMC
 # define CONFIG_SDHCI
 # define CONFIG_ZYNQ_SDHCI
+# define CONFIG_MMC_SDHCI_ADMA
 # define CONFIG_CMD_MMC
 # define CONFIG_CMD_FAT
 # define CONFIG_SUPPORT_VFAT
@@ -59,6 +59,9 @@ static inline unsigned int get_mmc_blk_size(int dev)
 #ifndef CONFIG_SYS_DFU_DATA_BUF_SIZE
 #define CONFIG_SYS_DFU_DATA_BUF_SIZE		(1024*1024*8)	/* 8 MiB */
 #endif
+#ifndef CONFIG_SYS_DFU_WRITE_CHUNK
+#define CONFIG_SYS_DFU_WRITE_CHUNK	(64 << 10)	/* 64 KiB */
+#endif
 #ifndef CONFIG_SYS_DFU_MAX_FILE_SIZE
 #define CONFIG_SYS_DFU_MAX_FILE_SIZE	(4 << 20)	/* 4 MiB */
 #endif
@@ -96,6 +99,14 @@ struct dfu_entity {
 	long r_left;
 	long b_left;
 
+	/* writes: the half of the buffer still going to the medium */
+	u8 *p_buf;
+	u8 *p_buf_end;
+	long w_chunk;		/* bytes to write at a time, 0 for all */
+	ulong w_start;		/* time the download started, in ms */
+	ulong w_busy;		/* time spent writing to the medium, in ms */
+	int w_error;
+
 	u32 bad_skip;	/* for nand use */
 
 	unsigned int inited:1;
@@ -112,6 +123,14 @@ char *dfu_extract_token(char** e, int *n);
 
 int dfu_read(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
 int dfu_write(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
+
+/**
+ * dfu_write_poll() - Write some received data to the medium
+ *
+ * Call this between USB interrupts while a download is in progress. It
+ * writes a chunk of the buffer filled earlier, while USB fills the other.
+ */
+void dfu_write_poll(void);
 /* Device specific */
 #ifdef CONFIG_DFU_MMC
 extern int dfu_fill_entity_mmc(struct dfu_entity *dfu, char *s);
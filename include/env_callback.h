@@ -52,6 +52,7 @@ struct env_clbk_tbl {
 };
 
 void env_callback_init(ENTRY *var_entry);
+void env_callback_changed(const char *name);
 
 /*
  * Define a callback that can be associated with variables.
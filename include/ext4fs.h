@@ -130,7 +130,7 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 
 struct ext_filesystem *get_fs(void);
 int ext4fs_open(const char *filename);
-int ext4fs_read(char *buf, unsigned len);
+int ext4fs_read(char *buf, int pos, unsigned len);
 int ext4fs_mount(unsigned part_length);
 void ext4fs_close(void);
 int ext4fs_ls(const char *dirname);
@@ -141,5 +141,7 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock);
 int ext4fs_probe(block_dev_desc_t *fs_dev_desc,
 		 disk_partition_t *fs_partition);
 int ext4_read_file(const char *filename, void *buf, int offset, int len);
+int ext4_open_file(const char *filename);
+int ext4_read_open(void *buf, int offset, int len);
 int ext4_read_superblock(char *buffer);
 #endif
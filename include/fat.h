@@ -29,6 +29,26 @@
 #define FAT16BUFSIZE	(FATBUFSIZE/2)
 #define FAT32BUFSIZE	(FATBUFSIZE/4)
 
+/*
+ * The read path caches several windows of the FAT, replacing the least
+ * recently used one, so that walking the cluster chain of a fragmented
+ * file does not re-read the same FAT sectors. A window must be a multiple
+ * of 3 sectors so that no FAT12 entry straddles two windows.
+ */
+#ifndef CONFIG_FAT_CACHE_WINDOWS
+#ifdef CONFIG_SPL_BUILD
+#define CONFIG_FAT_CACHE_WINDOWS	1
+#else
+#define CONFIG_FAT_CACHE_WINDOWS	4
+#endif
+#endif
+#ifdef CONFIG_SPL_BUILD
+#define FATCACHEBLOCKS	FATBUFBLOCKS
+#else
+#define FATCACHEBLOCKS	(FATBUFBLOCKS * 4)
+#endif
+#define FATCACHESIZE	(mydata->sect_size * FATCACHEBLOCKS)
+
 
 /* Filesystem identifiers */
 #define FAT12_SIGN	"FAT12   "
@@ -165,6 +185,10 @@ typedef struct {
 	__u16	clust_size;	/* Size of clusters in sectors */
 	int	data_begin;	/* The sector of the first cluster, can be negative */
 	int	fatbufnum;	/* Used by get_fatent, init to -1 */
+	__u8	*fatcache;	/* FAT windows cached by get_fatent */
+	int	fatcache_num[CONFIG_FAT_CACHE_WINDOWS]; /* window, or -1 */
+	__u32	fatcache_used[CONFIG_FAT_CACHE_WINDOWS]; /* LRU stamps */
+	__u32	fatcache_tick;	/* Last LRU stamp handed out */
 } fsdata;
 
 typedef int	(file_detectfs_func)(void);
@@ -197,5 +221,7 @@ int fat_register_device(block_dev_desc_t *dev_desc, int part_no);
 
 int file_fat_write(const char *filename, void *buffer, unsigned long maxsize);
 int fat_read_file(const char *filename, void *buf, int offset, int len);
+int file_fat_open(const char *filename);
+int fat_read_open(void *buf, int offset, int len);
 void fat_close(void);
 #endif /* _FAT_H_ */
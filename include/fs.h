@@ -54,6 +54,16 @@ int fs_ls(const char *dirname);
  */
 int fs_read(const char *filename, ulong addr, int offset, int len);
 
+/*
+ * Read gzip-compressed file "filename" from the partition previously set by
+ * fs_set_blk_dev() and decompress it to address "addr", which has room for
+ * "maxlen" bytes. The file is read a piece at a time as it is decompressed,
+ * so it never needs to be in memory as a whole.
+ *
+ * Returns number of bytes decompressed on success. Returns < 0 on error.
+ */
+long fs_read_gz(const char *filename, ulong addr, ulong maxlen);
+
 /*
  * Common implementation for various filesystem commands, optionally limited
  * to a specific filesystem type via the fstype parameter.
@@ -62,6 +72,8 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype, int cmdline_base);
 int do_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype);
+int do_gzload(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+		int fstype);
 int do_save(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype, int cmdline_base);
 
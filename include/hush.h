@@ -15,6 +15,8 @@
 extern int u_boot_hush_start(void);
 extern int parse_string_outer(const char *, int);
 extern int parse_file_outer(void);
+int parse_var_outer(const char *name, const char *s, int flag);
+void parse_cache_drop(const char *name);
 
 int set_local_var(const char *s, int flg_export);
 void unset_local_var(const char *name);
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __IMAGE_SPARSE_H
+#define __IMAGE_SPARSE_H
+
+#include <part.h>
+
+/* Size of the buffer used to stage raw data and fill patterns */
+#ifndef CONFIG_SPARSE_BUF_SIZE
+#define CONFIG_SPARSE_BUF_SIZE	(1 << 20)
+#endif
+
+/*
+ * Android sparse image format
+ *
+ * A sparse image is a file header followed by chunks. Each chunk covers a
+ * number of blocks of the output and holds either the raw data for them,
+ * a 32-bit pattern to fill them with, nothing (the blocks are left as
+ * they are), or a CRC32 of the output so far. All fields are
+ * little-endian. Tools such as img2simg and make_ext4fs produce these, so
+ * that the unused parts of a filesystem image are neither transferred nor
+ * written.
+ */
+
+#define SPARSE_HEADER_MAGIC	0xed26ff3a
+#define SPARSE_HEADER_MAJOR_VER	1
+
+#define CHUNK_TYPE_RAW		0xcac1
+#define CHUNK_TYPE_FILL		0xcac2
+#define CHUNK_TYPE_DONT_CARE	0xcac3
+#define CHUNK_TYPE_CRC32	0xcac4
+
+typedef struct sparse_header {
+	__le32	magic;		/* SPARSE_HEADER_MAGIC */
+	__le16	major_version;	/* (0x1) - reject images with higher major */
+	__le16	minor_version;	/* (0x0) - allow images with higer minor */
+	__le16	file_hdr_sz;	/* 28 bytes for first revision of the format */
+	__le16	chunk_hdr_sz;	/* 12 bytes for first revision of the format */
+	__le32	blk_sz;		/* block size in bytes, a multiple of 4 */
+	__le32	total_blks;	/* total blocks in the non-sparse output */
+	__le32	total_chunks;	/* total chunks in the sparse input image */
+	__le32	image_checksum;	/* CRC32 of the original data, or 0 */
+} sparse_header_t;
+
+typedef struct chunk_header {
+	__le16	chunk_type;	/* CHUNK_TYPE_... */
+	__le16	reserved1;
+	__le32	chunk_sz;	/* in blocks of the output image */
+	__le32	total_sz;	/* in bytes of chunk input, including header */
+} chunk_header_t;
+
+/**
+ * struct sparse_storage - Where a sparse image is written
+ *
+ * @start:	First block to write to
+ * @size:	Number of blocks available
+ * @blksz:	Block size in bytes, which must divide the image's block size
+ * @erase_grp:	Number of blocks erased at once by erase(). Only whole
+ *		groups within a don't-care chunk are erased.
+ * @write:	Write blocks, returning the number written
+ * @erase:	Erase blocks, returning the number erased, or NULL to leave
+ *		don't-care chunks untouched
+ * @priv:	Private data for write() and erase()
+ */
+struct sparse_storage {
+	lbaint_t start;
+	lbaint_t size;
+	unsigned int blksz;
+	lbaint_t erase_grp;
+
+	unsigned long (*write)(struct sparse_storage *info, lbaint_t blk,
+			       lbaint_t blkcnt, const void *buffer);
+	unsigned long (*erase)(struct sparse_storage *info, lbaint_t blk,
+			       lbaint_t blkcnt);
+	void *priv;
+};
+
+enum sparse_phase {
+	SPARSE_FILE_HDR,	/* collecting the file header */
+	SPARSE_CHUNK_HDR,	/* collecting a chunk header */
+	SPARSE_CHUNK_VALUE,	/* collecting a fill pattern or CRC */
+	SPARSE_CHUNK_DATA,	/* writing raw chunk data */
+	SPARSE_DONE,		/* all chunks seen, further data ignored */
+};
+
+/**
+ * struct sparse_state - Progress through a sparse image
+ *
+ * The image can be passed to sparse_write() in pieces of any size, so
+ * it can be written as it arrives, e.g. over USB. Block numbers here are
+ * in units of the storage block size, relative to info->start.
+ */
+struct sparse_state {
+	struct sparse_storage *info;
+	enum sparse_phase phase;
+
+	sparse_header_t hdr;
+	chunk_header_t chunk;
+	u32 value;		/* fill pattern or CRC of the current chunk */
+	unsigned int chunk_num;	/* chunks started so far */
+
+	void *collect;		/* header or value being collected */
+	unsigned int collect_len;	/* bytes of it collected so far */
+	unsigned int collect_size;	/* bytes of it needed */
+	unsigned int skip;	/* bytes of input to skip */
+
+	unsigned int ratio;	/* storage blocks per image block */
+	lbaint_t total;		/* size of the output */
+	lbaint_t blk;		/* next output block */
+	u64 data_left;		/* bytes of raw chunk data still to come */
+
+	u8 *buf;		/* staging buffer, aligned for DMA */
+	unsigned int buf_size;	/* size of buf, a multiple of blksz */
+	unsigned int buf_len;	/* bytes of data in buf */
+
+	/* statistics, in storage blocks */
+	lbaint_t written;	/* raw data written */
+	lbaint_t filled;	/* written with a pattern */
+	lbaint_t erased;	/* erased as don't-care */
+	lbaint_t skipped;	/* left untouched as don't-care */
+};
+
+/**
+ * is_sparse_image() - Check whether data starts with a sparse image header
+ *
+ * @buf:	Data to check, at least sizeof(sparse_header_t) bytes
+ * @return 1 if it is a sparse image, 0 if not
+ */
+int is_sparse_image(const void *buf);
+
+/**
+ * sparse_start() - Prepare to write a sparse image
+ *
+ * @state:	State to set up
+ * @info:	Where to write the image. If info->write is NULL the image is
+ *		only checked.
+ */
+void sparse_start(struct sparse_state *state, struct sparse_storage *info);
+
+/**
+ * sparse_write() - Write the next part of a sparse image
+ *
+ * @state:	State from sparse_start()
+ * @data:	Next part of the image
+ * @len:	Number of bytes in data
+ * @return 0 if ok, -EINVAL if the image is invalid, -ENOSPC if it does not
+ * fit, -ENOMEM if out of memory, -EIO if writing failed
+ */
+int sparse_write(struct sparse_state *state, const void *data, size_t len);
+
+/**
+ * sparse_finish() - Finish writing a sparse image and free the state
+ *
+ * This prints a summary of what was written. It must be called even if
+ * sparse_write() fails, to free the state.
+ *
+ * @state:	State from sparse_start()
+ * @return 0 if the whole image was written, -EINVAL if it was incomplete
+ */
+int sparse_finish(struct sparse_state *state);
+
+/**
+ * sparse_storage_blk_dev() - Set up to write a sparse image to a device
+ *
+ * Don't-care chunks are erased when the device supports it, in whole
+ * erase groups for MMC.
+ *
+ * @info:	Returns the storage information
+ * @dev_desc:	Block device to write to
+ * @start:	First block to write
+ * @size:	Number of blocks available
+ */
+void sparse_storage_blk_dev(struct sparse_storage *info,
+			    block_dev_desc_t *dev_desc, lbaint_t start,
+			    lbaint_t size);
+
+#endif
@@ -96,6 +96,8 @@ extern void nand_wait_ready(struct mtd_info *mtd);
 #define NAND_CMD_READSTART	0x30
 #define NAND_CMD_RNDOUTSTART	0xE0
 #define NAND_CMD_CACHEDPROG	0x15
+#define NAND_CMD_READCACHESEQ	0x31
+#define NAND_CMD_READCACHEEND	0x3f
 
 /* Extended commands for AG-AND device */
 /*
@@ -191,6 +193,12 @@ typedef enum {
 /* Device supports subpage reads */
 #define NAND_SUBPAGE_READ       0x00001000
 
+/*
+ * Chip has READ CACHE SEQUENTIAL / READ CACHE END, and the driver's
+ * cmdfunc and ecc.read_page can use them
+ */
+#define NAND_CACHE_READ		0x00002000
+
 /* Options valid for Samsung large page devices */
 #define NAND_SAMSUNG_LP_OPTIONS \
 	(NAND_NO_PADDING | NAND_CACHEPRG | NAND_COPYBACK)
@@ -200,6 +208,7 @@ typedef enum {
 #define NAND_HAS_CACHEPROG(chip) ((chip->options & NAND_CACHEPRG))
 #define NAND_HAS_COPYBACK(chip) ((chip->options & NAND_COPYBACK))
 #define NAND_HAS_SUBPAGE_READ(chip) ((chip->options & NAND_SUBPAGE_READ))
+#define NAND_HAS_CACHE_READ(chip) ((chip->options & NAND_CACHE_READ))
 
 /* Non chip related options */
 /* This option skips the bbt scan during initialization. */
@@ -240,6 +249,9 @@ struct nand_chip;
 /* ONFI subfeature parameters length */
 #define ONFI_SUBFEATURE_PARAM_LEN	4
 
+/* ONFI optional command: READ CACHE SEQUENTIAL / READ CACHE END */
+#define ONFI_OPT_CMD_READ_CACHE		(1 << 1)
+
 struct nand_onfi_params {
 	/* rev info and features block */
 	/* 'O' 'N' 'F' 'I'  */
@@ -478,6 +490,13 @@ struct nand_buffers {
  * @bbt_md:		[REPLACEABLE] bad block table mirror descriptor
  * @badblock_pattern:	[REPLACEABLE] bad block scan pattern used for initial
  *			bad block scan.
+ * @bbt_cache_offs:	[BOARDSPECIFIC] offset of the blocks holding the cached
+ *			memory BBT, used when there is no flash-based BBT
+ * @bbt_cache_blocks:	[BOARDSPECIFIC] number of blocks for the cached BBT, 0
+ *			if it is not cached
+ * @bbt_cache_seq:	[INTERN] sequence number of the newest cached BBT
+ * @bbt_cache_unchecked: [INTERN] bitmap of the blocks whose bad block marker
+ *			has not been checked since the cached BBT was loaded
  * @controller:		[REPLACEABLE] a pointer to a hardware controller
  *			structure which is shared among multiple independent
  *			devices.
@@ -557,6 +576,11 @@ struct nand_chip {
 
 	struct nand_bbt_descr *badblock_pattern;
 
+	loff_t bbt_cache_offs;
+	int bbt_cache_blocks;
+	uint32_t bbt_cache_seq;
+	uint8_t *bbt_cache_unchecked;
+
 	void *priv;
 };
 
@@ -613,6 +637,21 @@ extern int nand_scan_bbt(struct mtd_info *mtd, struct nand_bbt_descr *bd);
 extern int nand_update_bbt(struct mtd_info *mtd, loff_t offs);
 extern int nand_default_bbt(struct mtd_info *mtd);
 extern int nand_isbad_bbt(struct mtd_info *mtd, loff_t offs, int allowbbt);
+#ifdef CONFIG_SYS_NAND_BBT_CACHE
+extern int nand_save_bbt_cache(struct mtd_info *mtd);
+extern void nand_check_bbt_cache(struct mtd_info *mtd, loff_t offs,
+				 int getchip);
+#else
+static inline int nand_save_bbt_cache(struct mtd_info *mtd)
+{
+	return 0;
+}
+
+static inline void nand_check_bbt_cache(struct mtd_info *mtd, loff_t offs,
+					int getchip)
+{
+}
+#endif
 extern int nand_erase_nand(struct mtd_info *mtd, struct erase_info *instr,
 			   int allowbbt);
 extern int nand_do_read(struct mtd_info *mtd, loff_t from, size_t len,
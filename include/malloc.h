@@ -938,6 +938,69 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+#ifdef CONFIG_SYS_MALLOC_POOL
+/*
+ * Small requests are served from fixed-size-class pools carved out of the
+ * top of the malloc() area (see common/malloc_pool.c), and everything else
+ * is passed on to dlmalloc under these names.
+ */
+Void_t *dlmalloc(size_t);
+void dlfree(Void_t *);
+Void_t *dlrealloc(Void_t *, size_t);
+Void_t *dlmemalign(size_t, size_t);
+Void_t *dlcalloc(size_t, size_t);
+size_t dlmalloc_usable_size(Void_t *);
+
+/* Counters for one size class, or for requests passed to dlmalloc */
+struct malloc_pool_stats {
+	unsigned int size;	/* object size, 0 for dlmalloc */
+	unsigned int slabs;	/* slabs owned by this class */
+	unsigned long in_use;	/* objects currently allocated */
+	unsigned long peak;	/* highest in_use since the last reset */
+	unsigned long allocs;
+	unsigned long frees;
+	unsigned long fallbacks; /* allocations passed on as the pool was full */
+};
+
+struct malloc_pool_info {
+	int enabled;		/* new small allocations use the pool */
+	unsigned int slab_size;
+	unsigned int slabs;	/* total number of slabs */
+	unsigned int slabs_used;
+	int count;		/* number of size classes */
+	const struct malloc_pool_stats *classes;
+	const struct malloc_pool_stats *large;	/* requests for dlmalloc */
+};
+
+/**
+ * malloc_pool_init() - Set up the pool at the top of the malloc() area
+ *
+ * @start:	Start of the malloc() area
+ * @size:	Size of the malloc() area
+ * @return number of bytes taken from the top of the area for the pool
+ */
+ulong malloc_pool_init(ulong start, ulong size);
+
+/**
+ * malloc_pool_enable() - Choose whether new small allocations use the pool
+ *
+ * Objects already in the pool can still be freed when it is disabled.
+ *
+ * @enable:	1 to use the pool, 0 to pass every request to dlmalloc
+ */
+void malloc_pool_enable(int enable);
+
+/**
+ * malloc_pool_get_info() - Get the state and statistics of the pool
+ *
+ * @info:	Returns the information
+ */
+void malloc_pool_get_info(struct malloc_pool_info *info);
+
+/* Clear the allocation counters, setting each peak to the current use */
+void malloc_pool_reset_stats(void);
+#endif
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
@@ -95,6 +95,10 @@ struct eth_device {
 	struct eth_device *next;
 	int index;
 	void *priv;
+	/* receive counts, kept by the driver except for rx_packets */
+	ulong rx_packets;	/* frames passed to the network stack */
+	ulong rx_dropped;	/* frames discarded with receive errors */
+	ulong rx_overruns;	/* frames lost for want of a receive buffer */
 };
 
 extern int eth_initialize(bd_t *bis);	/* Initialize network subsystem */
@@ -244,6 +248,7 @@ struct vlan_ethernet_hdr {
 #define PROT_VLAN	0x8100		/* IEEE 802.1q protocol		*/
 
 #define IPPROTO_ICMP	 1	/* Internet Control Message Protocol	*/
+#define IPPROTO_TCP	 6	/* Transmission Control Protocol	*/
 #define IPPROTO_UDP	17	/* User Datagram Protocol		*/
 
 /*
@@ -293,6 +298,42 @@ struct ip_udp_hdr {
 #define IP_UDP_HDR_SIZE		(sizeof(struct ip_udp_hdr))
 #define UDP_HDR_SIZE		(IP_UDP_HDR_SIZE - IP_HDR_SIZE)
 
+/*
+ *	Internet Protocol (IP) + TCP header, without TCP options.
+ *	The sequence numbers are not 32-bit aligned in a received
+ *	frame, so use get/put_unaligned_be32() on them.
+ */
+struct ip_tcp_hdr {
+	uchar		ip_hl_v;	/* header length and version	*/
+	uchar		ip_tos;		/* type of service		*/
+	ushort		ip_len;		/* total length			*/
+	ushort		ip_id;		/* identification		*/
+	ushort		ip_off;		/* fragment offset field	*/
+	uchar		ip_ttl;		/* time to live			*/
+	uchar		ip_p;		/* protocol			*/
+	ushort		ip_sum;		/* checksum			*/
+	IPaddr_t	ip_src;		/* Source IP address		*/
+	IPaddr_t	ip_dst;		/* Destination IP address	*/
+	ushort		tcp_src;	/* TCP source port		*/
+	ushort		tcp_dst;	/* TCP destination port		*/
+	u32		tcp_seq;	/* Sequence number		*/
+	u32		tcp_ack;	/* Acknowledgement number	*/
+	uchar		tcp_hlen;	/* Header length in words << 4	*/
+	uchar		tcp_flags;	/* TCP_... flags		*/
+	ushort		tcp_win;	/* Receive window		*/
+	ushort		tcp_xsum;	/* Checksum			*/
+	ushort		tcp_urg;	/* Urgent pointer		*/
+};
+
+#define IP_TCP_HDR_SIZE		(sizeof(struct ip_tcp_hdr))
+#define TCP_HDR_SIZE		(IP_TCP_HDR_SIZE - IP_HDR_SIZE)
+
+#define TCP_FIN		0x01
+#define TCP_SYN		0x02
+#define TCP_RST		0x04
+#define TCP_PUSH	0x08
+#define TCP_ACK		0x10
+
 /*
  *	Address Resolution Protocol (ARP) header.
  */
@@ -437,7 +478,7 @@ extern int		NetRestartWrap;		/* Tried all network devices */
 
 enum proto_t {
 	BOOTP, RARP, ARP, TFTPGET, DHCP, PING, DNS, NFS, CDP, NETCONS, SNTP,
-	TFTPSRV, TFTPPUT, LINKLOCAL
+	TFTPSRV, TFTPPUT, LINKLOCAL, WGET
 };
 
 /* from net/net.c */
@@ -542,12 +583,107 @@ static inline void NetSendPacket(uchar *pkt, int len)
  * @param sport Source UDP port
  * @param payload_len Length of data after the UDP header
  */
+/**
+ * net_send_ip_packet() - Send an IP packet, using ARP to find the MAC first
+ *
+ * The IP header and payload must already be in NetTxPacket, after an
+ * Ethernet header of NetEthHdrSize() bytes. The Ethernet header is
+ * filled in here.
+ *
+ * @ether:	Destination MAC address, all zero if not yet known. ARP
+ *		writes the address here when it is found.
+ * @dest:	Destination IP address
+ * @len:	Length of the IP packet including its header
+ * @return 0 if transmitted, 1 if waiting for ARP, -1 on error
+ */
+int net_send_ip_packet(uchar *ether, IPaddr_t dest, int len);
+
+/* Calculate the TCP checksum of the segment in an IP packet */
+uint net_tcp_cksum(struct ip_tcp_hdr *ip, int len);
+
 extern int NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport,
 			int sport, int payload_len);
 
 /* Processes a received packet */
 extern void NetReceive(uchar *, int);
 
+#ifdef CONFIG_IP_DEFRAG
+/* Counts kept by IP fragment reassembly */
+struct net_defrag_stats {
+	ulong reassembled;	/* packets completed */
+	ulong dropped;		/* given up for a newer one, or too large */
+	ulong timeouts;		/* given up as no fragment came in time */
+	int in_use;		/* contexts holding part of a packet */
+	int contexts;		/* number of contexts */
+};
+
+void net_defrag_get_stats(struct net_defrag_stats *st);
+void net_defrag_reset_stats(void);
+#endif
+
+/*
+ * Posted receive buffers
+ *
+ * A protocol receiving a bulk transfer in order, with a payload of the
+ * same size in each frame, can ask for frames to be received in place:
+ * a driver then gives the hardware a buffer placed so that the payload
+ * of the frame expected next lands where it is to be stored, and the
+ * protocol finds nothing to copy. The headers land on the end of the
+ * previous payload and are put back afterwards. Frames which turn out
+ * not to be the expected one are handled as usual.
+ *
+ * There is one such buffer at a time, and only for a descriptor which
+ * the hardware fills before any other. A driver which hands each
+ * descriptor back to the end of a busy ring never gets one.
+ */
+#ifdef CONFIG_NET_RX_POST
+/**
+ * net_rx_post_start() - Start posting receive buffers for a transfer
+ *
+ * @base:	Where payload 0 is stored
+ * @hdr_len:	Bytes in a frame before its payload, at most 64
+ * @stride:	Bytes of payload in each frame, more than @hdr_len
+ * @limit:	Bytes from @base which may be written
+ * @next:	Payload expected next, 0 if none is stored yet
+ */
+void net_rx_post_start(uchar *base, int hdr_len, int stride, ulong limit,
+		       ulong next);
+
+/* Tell that payloads before @next are stored, in order */
+void net_rx_post_next(ulong next);
+
+/* Stop posting buffers; those already handed out remain valid */
+void net_rx_post_stop(void);
+
+/**
+ * net_rx_post_get() - Get a buffer to refill a receive descriptor with
+ *
+ * @ahead:	Number of frames the hardware receives, or has received and
+ *		are not yet passed on, before it fills this buffer
+ * @size:	Number of bytes the hardware may write to the buffer
+ * @align:	Alignment the hardware needs, a power of two
+ * @return buffer, or NULL if the driver's own buffer should be used
+ */
+uchar *net_rx_post_get(int ahead, int size, int align);
+
+/* Pass on a frame received in a buffer from net_rx_post_get() */
+void net_rx_post_receive(uchar *buf, int len);
+
+/* Forget all posted buffers, when the hardware has been stopped */
+void net_rx_post_reset(void);
+#else
+static inline void net_rx_post_start(uchar *base, int hdr_len, int stride,
+				     ulong limit, ulong next) {}
+static inline void net_rx_post_next(ulong next) {}
+static inline void net_rx_post_stop(void) {}
+static inline uchar *net_rx_post_get(int ahead, int size, int align)
+{
+	return NULL;
+}
+static inline void net_rx_post_receive(uchar *buf, int len) {}
+static inline void net_rx_post_reset(void) {}
+#endif
+
 #ifdef CONFIG_NETCONSOLE
 void NcStart(void);
 int nc_input_packet(uchar *pkt, IPaddr_t src_ip, unsigned dest_port,
@@ -104,6 +104,14 @@ void os_tty_raw(int fd);
  */
 void *os_malloc(size_t length);
 
+/**
+ * Returns memory acquired with os_malloc() to the underlying os.
+ *
+ * \param ptr		Pointer returned by os_malloc()
+ * \param length	Number of bytes which were allocated
+ */
+void os_free(void *ptr, size_t length);
+
 /**
  * Access to the usleep function of the os
  *
@@ -118,6 +126,26 @@ void os_usleep(unsigned long usec);
  */
 u64 os_get_nsec(void);
 
+/**
+ * Start a timer which samples where the program is running
+ *
+ * This uses the host's real-time interval timer, so like a timer
+ * interrupt on a board it also samples delays and waiting for input. The
+ * signal it sends is SIGALRM. It is only available on x86 hosts.
+ *
+ * @param hz		Number of samples per second of CPU time
+ * @param depth		Most addresses to pass to func() for each sample
+ * @param func		Called from a signal handler with the interrupted PC
+ *			followed by the return addresses of its callers,
+ *			found by following the frame pointer
+ * @return 0 if ok, -ve errno on error
+ */
+int os_profile_timer_start(unsigned int hz, int depth,
+			   void (*func)(const unsigned long *frames, int count));
+
+/* Stop the timer started by os_profile_timer_start() */
+void os_profile_timer_stop(void);
+
 /**
  * Parse arguments and update sandbox state.
  *
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+/*
+ * Statistical sampling profiler
+ *
+ * A periodic timer tick records where U-Boot is running into a ring
+ * buffer, and optionally (with CONFIG_SAMPLE_PROFILE_UNWIND) the chain of
+ * callers found by following the frame pointer. Unlike CONFIG_TRACE this
+ * needs no instrumentation, so the code being measured runs at full speed
+ * and the cost is a few microseconds per tick. The samples can be written
+ * to memory with 'profile samples' and turned into flat and call-graph
+ * profiles by tools/proftool.
+ */
+
+#ifndef CONFIG_SAMPLE_PROFILE_DEPTH
+#define CONFIG_SAMPLE_PROFILE_DEPTH	8
+#endif
+
+#ifndef CONFIG_SAMPLE_PROFILE_SAMPLES
+#define CONFIG_SAMPLE_PROFILE_SAMPLES	4096
+#endif
+
+#ifndef CONFIG_SAMPLE_PROFILE_HZ
+#define CONFIG_SAMPLE_PROFILE_HZ	1000
+#endif
+
+/* Recorded in place of a frame which is not within U-Boot's code */
+#define PROFILE_OUTSIDE		0xffffffffU
+
+/**
+ * Record a sample
+ *
+ * This is called by the architecture's profile timer, normally from an
+ * interrupt or signal handler, so it takes no locks and does not allocate.
+ *
+ * @param frames	Addresses: the interrupted PC, followed by the
+ *			return address of each caller, innermost first
+ * @param count		Number of addresses in frames[]
+ */
+void profile_sample(const ulong *frames, int count);
+
+/**
+ * Start the architecture's profile timer
+ *
+ * Each tick should call profile_sample() with the interrupted PC and, if
+ * depth is more than 1, the return addresses of up to depth - 1 callers.
+ *
+ * @param hz		Number of samples to take each second
+ * @param depth		Maximum number of addresses to pass per sample
+ * @return 0 if ok, -ENOSYS if there is no profile timer, other -ve on error
+ */
+int profile_timer_start(uint hz, int depth);
+
+/* Stop the architecture's profile timer */
+void profile_timer_stop(void);
+
+#ifdef CONFIG_SAMPLE_PROFILE
+/**
+ * Allocate the sample buffer
+ *
+ * This must be called after malloc() is available.
+ *
+ * @return 0 if ok, -ENOMEM if there is not enough memory
+ */
+int profile_init(void);
+
+/**
+ * Start taking samples, discarding any from an earlier run
+ *
+ * @param hz		Number of samples to take each second, or 0 for
+ *			CONFIG_SAMPLE_PROFILE_HZ
+ * @return 0 if ok, -ve on error
+ */
+int profile_start(uint hz);
+
+/* Stop taking samples, keeping those recorded so far */
+void profile_stop(void);
+
+/* Print statistics about the samples taken */
+void profile_print_stats(void);
+
+/**
+ * Dump the samples into a buffer
+ *
+ * The buffer holds a struct trace_output_hdr of type TRACE_CHUNK_SAMPLES
+ * followed by the samples, oldest first. Each sample is a uint32_t frame
+ * count followed by that many code offsets, innermost first. A frame
+ * outside U-Boot's code is recorded as PROFILE_OUTSIDE.
+ *
+ * @param buff		Buffer in which to place data, or NULL to count size
+ * @param buff_size	Size of buffer
+ * @param needed	Returns number of bytes used / needed
+ * @return 0 if ok, -1 on error (buffer exhausted)
+ */
+int profile_list_samples(void *buff, int buff_size, unsigned int *needed);
+#else
+static inline int profile_init(void)
+{
+	return 0;
+}
+#endif
+
+#endif
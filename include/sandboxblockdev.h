@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __SANDBOX_BLOCK_DEV__
+#define __SANDBOX_BLOCK_DEV__
+
+int host_dev_bind(int dev, char *filename);
+void host_dev_info(void);
+
+#endif
@@ -219,6 +219,25 @@ struct sdhci_host;
  */
 #define SDHCI_DEFAULT_BOUNDARY_SIZE	(512 * 1024)
 #define SDHCI_DEFAULT_BOUNDARY_ARG	(7)
+
+/*
+ * ADMA2 descriptor with 32-bit addressing. A transfer is described by a
+ * table of these, the last one marked with SDHCI_ADMA_END, so that the
+ * controller walks the whole buffer without stopping at DMA boundaries.
+ */
+#define SDHCI_ADMA_VALID	0x01
+#define SDHCI_ADMA_END		0x02
+#define SDHCI_ADMA_INT		0x04
+#define SDHCI_ADMA_ACT_TRAN	0x20
+/* Bytes moved by one descriptor, must fit in its 16-bit length field */
+#define SDHCI_ADMA_MAX_LEN	(32 * 1024)
+
+struct sdhci_adma_desc {
+	u16 attr;
+	u16 len;
+	u32 addr;
+} __packed;
+
 struct sdhci_ops {
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
 	u32             (*read_l)(struct sdhci_host *host, int reg);
@@ -244,6 +263,10 @@ struct sdhci_host {
 	void (*set_control_reg)(struct sdhci_host *host);
 	void (*set_clock)(int dev_index, unsigned int div);
 	uint	voltages;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	struct sdhci_adma_desc *adma_desc;	/* ADMA2 descriptor table */
+	uint	adma_count;		/* number of entries in adma_desc */
+#endif
 };
 
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
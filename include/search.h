@@ -39,8 +39,9 @@ typedef struct entry {
 	int flags;
 } ENTRY;
 
-/* Opaque type for internal use.  */
+/* Opaque types for internal use.  */
 struct _ENTRY;
+struct _HSLOT;
 
 /*
  * Family of hash table handling functions.  The functions also
@@ -50,9 +51,13 @@ struct _ENTRY;
 
 /* Data type for reentrant functions.  */
 struct hsearch_data {
-	struct _ENTRY *table;
-	unsigned int size;
-	unsigned int filled;
+	struct _ENTRY *table;	/* entries, which never move while in use */
+	unsigned int size;	/* number of entries allocated */
+	unsigned int filled;	/* number of entries in use */
+	struct _HSLOT *slots;	/* open-addressed index of entries by hash */
+	unsigned int slot_mask;	/* number of slots - 1 */
+	unsigned int *sorted;	/* entry numbers in ascending key order */
+	unsigned int free;	/* first unused entry number + 1, or 0 */
 /*
  * Callback function which will check whether the given change for variable
  * "item" to "newval" may be applied or not, and possibly apply such change.
@@ -64,7 +69,10 @@ struct hsearch_data {
 		int flag);
 };
 
-/* Create a new hashing table which will at most contain NEL elements.  */
+/*
+ * Create a new hashing table with room for NEL elements. The table grows
+ * as needed when more are entered.
+ */
 extern int hcreate_r(size_t __nel, struct hsearch_data *__htab);
 
 /* Destroy current internal hashing table.  */
@@ -80,8 +88,10 @@ extern int hsearch_r(ENTRY __item, ACTION __action, ENTRY ** __retval,
 		     struct hsearch_data *__htab, int __flag);
 
 /*
- * Search for an entry matching `MATCH'.  Otherwise, Same semantics
- * as hsearch_r().
+ * Search for an entry whose key starts with `MATCH', in ascending key
+ * order.  Pass 0 as __LAST_IDX to get the first match and the return
+ * value of the previous call to get the next; 0 is returned when there
+ * are no more.
  */
 extern int hmatch_r(const char *__match, int __last_idx, ENTRY ** __retval,
 		    struct hsearch_data *__htab);
@@ -104,7 +114,7 @@ extern int himport_r(struct hsearch_data *__htab,
 		     const char *__env, size_t __size, const char __sep,
 		     int __flag, int nvars, char * const vars[]);
 
-/* Walk the whole table calling the callback on each element */
+/* Walk the whole table in key order calling the callback on each element */
 extern int hwalk_r(struct hsearch_data *__htab, int (*callback)(ENTRY *));
 
 /* Flags for himport_r(), hexport_r(), hdelete_r(), and hsearch_r() */
@@ -27,6 +27,16 @@
 /* SPI transfer flags */
 #define SPI_XFER_BEGIN	0x01			/* Assert CS before transfer */
 #define SPI_XFER_END	0x02			/* Deassert CS after transfer */
+#define SPI_XFER_DUAL	0x04			/* Use two data lines */
+#define SPI_XFER_QUAD	0x08			/* Use four data lines */
+#define SPI_XFER_BULK	0x10			/* Long, cache-aligned transfer */
+
+/* SPI read modes supported by a controller (and flash) */
+#define SPI_OPM_RX_DOUT	0x01			/* Dual output */
+#define SPI_OPM_RX_DIO	0x02			/* Dual address and output */
+#define SPI_OPM_RX_QOF	0x04			/* Quad output */
+#define SPI_OPM_RX_QIO	0x08			/* Quad address and output */
+#define SPI_OPM_RX_BULK	0x10			/* Takes SPI_XFER_BULK reads */
 
 /* Header byte that marks the start of the message */
 #define SPI_PREAMBLE_END_BYTE	0xec
@@ -40,11 +50,15 @@
  *   cs:	ID of the chip select connected to the slave.
  *   max_write_size:	If non-zero, the maximum number of bytes which can
  *		be written at once, excluding command bytes.
+ *   op_mode_rx:	SPI_OPM_RX_* flags for the ways of reading which the
+ *		controller supports, beyond single-line transfers. Set by
+ *		spi_setup_slave().
  */
 struct spi_slave {
 	unsigned int	bus;
 	unsigned int	cs;
 	unsigned int max_write_size;
+	unsigned int	op_mode_rx;
 };
 
 /*-----------------------------------------------------------------------
@@ -168,6 +182,12 @@ void spi_release_bus(struct spi_slave *slave);
  *   din:	Pointer to a string of bits that will be filled in.
  *   flags:	A bitwise combination of SPI_XFER_* flags.
  *
+ *   SPI_XFER_DUAL and SPI_XFER_QUAD are only used if the controller has
+ *   set the matching SPI_OPM_RX_* flags in op_mode_rx. SPI_XFER_BULK
+ *   marks the bulk of a long read, with "din" and "bitlen" aligned to
+ *   ARCH_DMA_MINALIGN bytes, which the controller may move by DMA. It
+ *   is only used if SPI_OPM_RX_BULK is set.
+ *
  *   Returns: 0 on success, not 0 on failure
  */
 int  spi_xfer(struct spi_slave *slave, unsigned int bitlen, const void *dout,
@@ -28,6 +28,8 @@ struct spi_flash {
 	u32		page_size;
 	/* Erase (sector) size */
 	u32		sector_size;
+	/* Larger blocks which can be erased in one go (SECT_32K, SECT_64K) */
+	u8		erase_sizes;
 #ifdef CONFIG_SPI_FLASH_BAR
 	/* Bank read cmd */
 	u8		bank_read_cmd;
@@ -38,6 +40,15 @@ struct spi_flash {
 #endif
 	/* Poll cmd - for flash erase/program */
 	u8		poll_cmd;
+	/* Address bytes in commands, 4 if the flash has 4-byte commands */
+	u8		addr_width;
+	/* Read modes (SPI_OPM_RX_*) supported by the flash */
+	u8		rd_modes;
+	/* Read cmd, its dummy bytes and SPI_XFER_* lanes for addr/data */
+	u8		read_cmd;
+	u8		dummy_byte;
+	u8		read_addr_lanes;
+	u8		read_data_lanes;
 
 	void *memory_map;	/* Address of read-only SPI flash access */
 	int		(*read)(struct spi_flash *flash, u32 offset,
@@ -150,6 +150,18 @@ int submit_control_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 int submit_int_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 			int transfer_len, int interval);
 
+#ifdef CONFIG_USB_EHCI
+/*
+ * Largest bulk transfer (in bytes) that USB storage should submit at once.
+ * Each EHCI qTD covers QT_BUFFER_CNT (5) pages, one of which may be lost if
+ * the buffer is not page-aligned, so it moves at least 16KB.
+ */
+#ifndef CONFIG_USB_EHCI_MAX_XFER_QTDS
+#define CONFIG_USB_EHCI_MAX_XFER_QTDS	128
+#endif
+#define USB_MAX_BULK_XFER	(CONFIG_USB_EHCI_MAX_XFER_QTDS * 4 * 4096)
+#endif
+
 /* Defines */
 #define USB_UHCI_VEND_ID	0x8086
 #define USB_UHCI_DEV_ID		0x7112
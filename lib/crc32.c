@@ -21,6 +21,12 @@
 #endif
 #include "u-boot/zlib.h"
 
+#if defined(CONFIG_CRC32_SLICE_BY_8) && !defined(CONFIG_SPL_BUILD) && \
+	!defined(USE_HOSTCC)
+#define CRC32_SLICE_BY_8
+DECLARE_GLOBAL_DATA_PTR;
+#endif
+
 #define local static
 #define ZEXPORT	/* empty */
 
@@ -164,6 +170,57 @@ const uint32_t * ZEXPORT get_crc_table()
 }
 #endif
 
+#ifdef CRC32_SLICE_BY_8
+/*
+ * Slice-by-8: crc_table8[k][n] is the CRC of byte n followed by k zero
+ * bytes, which lets eight bytes of input be folded into the CRC with eight
+ * independent table lookups instead of eight dependent ones. The 8KB of
+ * tables are built from crc_table on first use, in CPU byte order.
+ */
+local uint32_t crc_table8[8][256];
+local int crc_table8_ready;
+
+local void make_crc_table8(void)
+{
+  uint32_t c;
+  int n, k;
+
+  for (n = 0; n < 256; n++)
+    crc_table8[0][n] = le32_to_cpu(crc_table[n]);
+  for (n = 0; n < 256; n++) {
+    c = crc_table8[0][n];
+    for (k = 1; k < 8; k++) {
+      c = crc_table8[0][c & 0xff] ^ (c >> 8);
+      crc_table8[k][n] = c;
+    }
+  }
+  crc_table8_ready = 1;
+}
+
+local uint32_t crc32_slice8(uint32_t crc, const uint8_t *p, uInt len)
+{
+    const uint32_t (*t)[256] = crc_table8;
+    uint32_t lo, hi;
+
+    while (len && ((long)p & 3)) {
+	 crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	 len--;
+    }
+    for (; len >= 8; len -= 8, p += 8) {
+	 lo = crc ^ le32_to_cpu(*(const uint32_t *)p);
+	 hi = le32_to_cpu(*(const uint32_t *)(p + 4));
+	 crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+	       t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+	       t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+	       t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    while (len--)
+	 crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+    return crc;
+}
+#endif
+
 /* ========================================================================= */
 # if __BYTE_ORDER == __LITTLE_ENDIAN
 #  define DO_CRC(x) crc = tab[(crc ^ (x)) & 255] ^ (crc >> 8)
@@ -184,6 +241,14 @@ uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 #ifdef DYNAMIC_CRC_TABLE
     if (crc_table_empty)
       make_crc_table();
+#endif
+#ifdef CRC32_SLICE_BY_8
+    /* The tables live in BSS, which is only usable after relocation */
+    if (gd->flags & GD_FLG_RELOC) {
+	 if (!crc_table8_ready)
+	      make_crc_table8();
+	 return crc32_slice8(crc, buf, len);
+    }
 #endif
     crc = cpu_to_le32(crc);
     /* Align it */
@@ -20,6 +20,10 @@
 #define RESERVED		0xe0
 #define DEFLATED		8
 
+#ifndef CONFIG_GZIP_STREAM_BUFSIZE
+#define CONFIG_GZIP_STREAM_BUFSIZE	(256 << 10)
+#endif
+
 void *gzalloc(void *x, unsigned items, unsigned size)
 {
 	void *p;
@@ -37,7 +41,12 @@ void gzfree(void *x, void *addr, unsigned nb)
 	free (addr);
 }
 
-int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
+/*
+ * Work out the size of the gzip header at src, which has len bytes
+ *
+ * Returns the offset of the compressed data, or -1 on error
+ */
+static int gzip_parse_header(const unsigned char *src, unsigned long len)
 {
 	int i, flags;
 
@@ -58,12 +67,91 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 			;
 	if ((flags & HEAD_CRC) != 0)
 		i += 2;
-	if (i >= *lenp) {
+	if (i >= len) {
 		puts ("Error: gunzip out of data in header\n");
 		return (-1);
 	}
 
-	return zunzip(dst, dstlen, src, lenp, 1, i);
+	return i;
+}
+
+int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
+{
+	int offset;
+
+	offset = gzip_parse_header(src, *lenp);
+	if (offset < 0)
+		return -1;
+
+	return zunzip(dst, dstlen, src, lenp, 1, offset);
+}
+
+/*
+ * Decompress gzip data which is read a piece at a time into a small
+ * buffer, so that it never has to be held in memory as a whole.
+ */
+int gunzip_stream(void *dst, int dstlen, gunzip_read_func read, void *priv,
+		  unsigned long *lenp)
+{
+	unsigned char *buf;
+	z_stream s;
+	int offset, len, r;
+
+	buf = memalign(ARCH_DMA_MINALIGN, CONFIG_GZIP_STREAM_BUFSIZE);
+	if (!buf) {
+		puts("Error: no memory for gunzip buffer\n");
+		return -1;
+	}
+
+	len = read(priv, buf, CONFIG_GZIP_STREAM_BUFSIZE);
+	if (len <= 0) {
+		free(buf);
+		return -1;
+	}
+	offset = gzip_parse_header(buf, len);
+	if (offset < 0) {
+		free(buf);
+		return -1;
+	}
+
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+	r = inflateInit2(&s, -MAX_WBITS);
+	if (r != Z_OK) {
+		printf("Error: inflateInit2() returned %d\n", r);
+		free(buf);
+		return -1;
+	}
+	s.next_in = buf + offset;
+	s.avail_in = len - offset;
+	s.next_out = dst;
+	s.avail_out = dstlen;
+	do {
+		if (!s.avail_in) {
+			len = read(priv, buf, CONFIG_GZIP_STREAM_BUFSIZE);
+			if (len <= 0) {
+				puts("Error: gunzip out of data\n");
+				break;
+			}
+			s.next_in = buf;
+			s.avail_in = len;
+		}
+		r = inflate(&s, Z_NO_FLUSH);
+		WATCHDOG_RESET();
+	} while (r == Z_OK && s.avail_out);
+
+	*lenp = s.next_out - (unsigned char *)dst;
+	inflateEnd(&s);
+	free(buf);
+	if (r != Z_STREAM_END) {
+		if (!s.avail_out)
+			puts("Error: gunzip output buffer too small\n");
+		else if (r != Z_OK)
+			printf("Error: inflate() returned %d\n", r);
+		return -1;
+	}
+
+	return 0;
 }
 
 /*
@@ -57,44 +57,177 @@
  * which describes the current status.
  */
 
+/*
+ * The table is kept in three parts:
+ *
+ * - The entries themselves, each with the full hash of its key. An entry
+ *   keeps its place for as long as it is in use, so its number can be
+ *   handed out; unused entries are chained on a free list through hval.
+ * - An open-addressed index of (hash, entry number) slots, with linear
+ *   probing. There are at least twice as many slots as entries so that
+ *   probe sequences stay short, and a probe only looks at the key of an
+ *   entry when the full hashes match. Deletion moves later slots of the
+ *   probe sequence back, so no "deleted" markers are needed.
+ * - The entry numbers in ascending key order, kept up to date on each
+ *   insertion and deletion by binary search. Export, matching and
+ *   walking just follow this list, without any sorting.
+ *
+ * When all the entries are in use, the table doubles in size.
+ */
+
 typedef struct _ENTRY {
-	int used;
-	ENTRY entry;
+	unsigned int hval;	/* hash of key, or next free entry + 1 */
+	ENTRY entry;		/* entry.key is NULL if unused */
 } _ENTRY;
 
+typedef struct _HSLOT {
+	unsigned int hval;	/* hash of the key of the entry */
+	unsigned int idx;	/* entry number + 1, or 0 if the slot is free */
+} _HSLOT;
+
 
-static void _hdelete(const char *key, struct hsearch_data *htab, ENTRY *ep,
-	int idx);
+static void _hdelete(struct hsearch_data *htab, unsigned int idx);
+
+/* FNV-1a, which spreads similar keys like "ethaddr"/"eth1addr" well */
+static unsigned int hash_key(const char *key)
+{
+	unsigned int hval = 2166136261U;
+
+	while (*key) {
+		hval ^= (unsigned char)*key++;
+		hval *= 16777619;
+	}
+
+	return hval;
+}
+
+static inline ENTRY *sorted_entry(struct hsearch_data *htab,
+				  unsigned int pos)
+{
+	return &htab->table[htab->sorted[pos]].entry;
+}
 
 /*
- * hcreate()
+ * Find the position of a key in the sorted list, or where it would go.
+ * Keys are mostly entered in order (e.g. on import), so try the end
+ * first.
  */
+static unsigned int sorted_pos(struct hsearch_data *htab, const char *key)
+{
+	unsigned int lo = 0, hi = htab->filled, mid;
+
+	if (!hi || strcmp(sorted_entry(htab, hi - 1)->key, key) < 0)
+		return hi;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (strcmp(sorted_entry(htab, mid)->key, key) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
 
 /*
- * For the used double hash method the table size has to be a prime. To
- * correct the user given table size we need a prime test.  This trivial
- * algorithm is adequate because
- * a)  the code is (most probably) called a few times per program run and
- * b)  the number is small because the table must fit in the core
- * */
-static int isprime(unsigned int number)
+ * Find the slot holding a key, returning 1, or else the free slot where
+ * it would go, returning 0.
+ */
+static int find_slot(struct hsearch_data *htab, const char *key,
+		     unsigned int hval, unsigned int *slotp)
+{
+	unsigned int i = hval & htab->slot_mask;
+	_HSLOT *slot;
+
+	for (;; i = (i + 1) & htab->slot_mask) {
+		slot = &htab->slots[i];
+		if (!slot->idx)
+			break;
+		if (slot->hval == hval &&
+		    !strcmp(htab->table[slot->idx - 1].entry.key, key))
+			break;
+	}
+	*slotp = i;
+
+	return slot->idx != 0;
+}
+
+/* Free a slot, moving back any later slots of the probe sequence */
+static void remove_slot(struct hsearch_data *htab, unsigned int i)
 {
-	/* no even number will be passed */
-	unsigned int div = 3;
+	unsigned int mask = htab->slot_mask;
+	unsigned int j = i, home;
+
+	for (;;) {
+		htab->slots[i].idx = 0;
+		do {
+			j = (j + 1) & mask;
+			if (!htab->slots[j].idx)
+				return;
+			home = htab->slots[j].hval & mask;
+			/* leave it if its home is cyclically in (i, j] */
+		} while (i <= j ? (i < home && home <= j) :
+			 (i < home || home <= j));
+		htab->slots[i] = htab->slots[j];
+		i = j;
+	}
+}
 
-	while (div * div < number && number % div != 0)
-		div += 2;
+/*
+ * Grow the table to hold SIZE entries, adding the new ones to the free
+ * list and rebuilding the index. Returns 0 on success.
+ */
+static int hresize(struct hsearch_data *htab, unsigned int size)
+{
+	unsigned int nslots, i, pos, hval;
+	_ENTRY *table;
+	_HSLOT *slots;
+	unsigned int *sorted;
+
+	for (nslots = 8; nslots < size * 2; nslots <<= 1)
+		;
+	table = realloc(htab->table, size * sizeof(_ENTRY));
+	if (!table)
+		return -1;
+	htab->table = table;
+	sorted = realloc(htab->sorted, size * sizeof(*sorted));
+	if (!sorted)
+		return -1;
+	htab->sorted = sorted;
+	slots = calloc(nslots, sizeof(_HSLOT));
+	if (!slots)
+		return -1;
+
+	for (i = size; i-- > htab->size; ) {
+		table[i].entry.key = NULL;
+		table[i].hval = htab->free;
+		htab->free = i + 1;
+	}
+	htab->size = size;
+
+	free(htab->slots);
+	htab->slots = slots;
+	htab->slot_mask = nslots - 1;
+	for (pos = 0; pos < htab->filled; pos++) {
+		hval = table[sorted[pos]].hval;
+		for (i = hval & htab->slot_mask; slots[i].idx;
+		     i = (i + 1) & htab->slot_mask)
+			;
+		slots[i].hval = hval;
+		slots[i].idx = sorted[pos] + 1;
+	}
 
-	return number % div != 0;
+	return 0;
 }
 
+/*
+ * hcreate()
+ */
+
 /*
  * Before using the hash table we must allocate memory for it.
- * Test for an existing table are done. We allocate one element
- * more as the found prime number says. This is done for more effective
- * indexing as explained in the comment for the hsearch function.
- * The contents of the table is zeroed, especially the field used
- * becomes zero.
+ * Test for an existing table are done. NEL is only the initial number of
+ * entries, since the table grows when it is full.
  */
 
 int hcreate_r(size_t nel, struct hsearch_data *htab)
@@ -109,18 +242,17 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
 	if (htab->table != NULL)
 		return 0;
 
-	/* Change nel to the first prime number not smaller as nel. */
-	nel |= 1;		/* make odd */
-	while (!isprime(nel))
-		nel += 2;
-
-	htab->size = nel;
+	htab->size = 0;
 	htab->filled = 0;
+	htab->slots = NULL;
+	htab->sorted = NULL;
+	htab->free = 0;
 
-	/* allocate memory and zero out */
-	htab->table = (_ENTRY *) calloc(htab->size + 1, sizeof(_ENTRY));
-	if (htab->table == NULL)
+	if (hresize(htab, nel ? nel : 1)) {
+		hdestroy_r(htab);
+		__set_errno(ENOMEM);
 		return 0;
+	}
 
 	/* everything went alright */
 	return 1;
@@ -138,7 +270,7 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
 
 void hdestroy_r(struct hsearch_data *htab)
 {
-	int i;
+	unsigned int pos;
 
 	/* Test for correct arguments.  */
 	if (htab == NULL) {
@@ -147,18 +279,23 @@ void hdestroy_r(struct hsearch_data *htab)
 	}
 
 	/* free used memory */
-	for (i = 1; i <= htab->size; ++i) {
-		if (htab->table[i].used > 0) {
-			ENTRY *ep = &htab->table[i].entry;
+	for (pos = 0; pos < htab->filled; pos++) {
+		ENTRY *ep = sorted_entry(htab, pos);
 
-			free((void *)ep->key);
-			free(ep->data);
-		}
+		free((void *)ep->key);
+		free(ep->data);
 	}
 	free(htab->table);
+	free(htab->slots);
+	free(htab->sorted);
 
 	/* the sign for an existing table is an value != NULL in htable */
 	htab->table = NULL;
+	htab->slots = NULL;
+	htab->sorted = NULL;
+	htab->size = 0;
+	htab->filled = 0;
+	htab->free = 0;
 }
 
 /*
@@ -166,19 +303,8 @@ void hdestroy_r(struct hsearch_data *htab)
  */
 
 /*
- * This is the search function. It uses double hashing with open addressing.
- * The argument item.key has to be a pointer to an zero terminated, most
- * probably strings of chars. The function for generating a number of the
- * strings is simple but fast. It can be replaced by a more complex function
- * like ajw (see [Aho,Sethi,Ullman]) if the needs are shown.
- *
- * We use an trick to speed up the lookup. The table is created by hcreate
- * with one more element available. This enables us to use the index zero
- * special. This index will never be used because we store the first hash
- * index in the field used where zero means not used. Every other value
- * means used. The used field can be used as a first fast comparison for
- * equality of the stored and the parameter value. This helps to prevent
- * unnecessary expensive calls of strcmp.
+ * This is the search function. The argument item.key has to be a pointer
+ * to a zero terminated string; see the description of the table above.
  *
  * This implementation differs from the standard library version of
  * this function in a number of ways:
@@ -192,25 +318,23 @@ void hdestroy_r(struct hsearch_data *htab)
  * - The standard implementation does not provide a way to update an
  *   existing entry.  This version will create a new entry or update an
  *   existing one when both "action == ENTER" and "item.data != NULL".
- * - Instead of returning 1 on success, we return the index into the
- *   internal hash table, which is also guaranteed to be positive.
- *   This allows us direct access to the found hash table slot for
- *   example for functions like hdelete().
+ * - Instead of returning 1 on success, we return the entry number plus
+ *   one, which is guaranteed to be positive. This allows us direct
+ *   access to the found entry for example for functions like hdelete().
  */
 
 int hmatch_r(const char *match, int last_idx, ENTRY ** retval,
 	     struct hsearch_data *htab)
 {
-	unsigned int idx;
 	size_t key_len = strlen(match);
-
-	for (idx = last_idx + 1; idx < htab->size; ++idx) {
-		if (htab->table[idx].used <= 0)
-			continue;
-		if (!strncmp(match, htab->table[idx].entry.key, key_len)) {
-			*retval = &htab->table[idx].entry;
-			return idx;
-		}
+	unsigned int pos;
+
+	/* last_idx is the sorted position of the previous match + 1 */
+	pos = last_idx ? last_idx : sorted_pos(htab, match);
+	if (pos < htab->filled &&
+	    !strncmp(match, sorted_entry(htab, pos)->key, key_len)) {
+		*retval = sorted_entry(htab, pos);
+		return pos + 1;
 	}
 
 	__set_errno(ESRCH);
@@ -219,199 +343,140 @@ int hmatch_r(const char *match, int last_idx, ENTRY ** retval,
 }
 
 /*
- * Compare an existing entry with the desired key, and overwrite if the action
- * is ENTER.  This is simply a helper function for hsearch_r().
+ * Overwrite the data of an existing entry if the action is ENTER.
+ * This is simply a helper function for hsearch_r().
  */
-static inline int _compare_and_overwrite_entry(ENTRY item, ACTION action,
+static inline int _overwrite_entry(ENTRY item, ACTION action,
 	ENTRY **retval, struct hsearch_data *htab, int flag,
-	unsigned int hval, unsigned int idx)
+	unsigned int idx)
 {
-	if (htab->table[idx].used == hval
-	    && strcmp(item.key, htab->table[idx].entry.key) == 0) {
-		/* Overwrite existing value? */
-		if ((action == ENTER) && (item.data != NULL)) {
-			/* check for permission */
-			if (htab->change_ok != NULL && htab->change_ok(
-			    &htab->table[idx].entry, item.data,
-			    env_op_overwrite, flag)) {
-				debug("change_ok() rejected setting variable "
-					"%s, skipping it!\n", item.key);
-				__set_errno(EPERM);
-				*retval = NULL;
-				return 0;
-			}
-
-			/* If there is a callback, call it */
-			if (htab->table[idx].entry.callback &&
-			    htab->table[idx].entry.callback(item.key,
-			    item.data, env_op_overwrite, flag)) {
-				debug("callback() rejected setting variable "
-					"%s, skipping it!\n", item.key);
-				__set_errno(EINVAL);
-				*retval = NULL;
-				return 0;
-			}
-
-			free(htab->table[idx].entry.data);
-			htab->table[idx].entry.data = strdup(item.data);
-			if (!htab->table[idx].entry.data) {
-				__set_errno(ENOMEM);
-				*retval = NULL;
-				return 0;
-			}
-		}
-		/* return found entry */
-		*retval = &htab->table[idx].entry;
-		return idx;
-	}
-	/* keep searching */
-	return -1;
-}
+	ENTRY *ep = &htab->table[idx - 1].entry;
 
-int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
-	      struct hsearch_data *htab, int flag)
-{
-	unsigned int hval;
-	unsigned int count;
-	unsigned int len = strlen(item.key);
-	unsigned int idx;
-	unsigned int first_deleted = 0;
-	int ret;
-
-	/* Compute an value for the given string. Perhaps use a better method. */
-	hval = len;
-	count = len;
-	while (count-- > 0) {
-		hval <<= 4;
-		hval += item.key[count];
-	}
-
-	/*
-	 * First hash function:
-	 * simply take the modul but prevent zero.
-	 */
-	hval %= htab->size;
-	if (hval == 0)
-		++hval;
-
-	/* The first index tried. */
-	idx = hval;
-
-	if (htab->table[idx].used) {
-		/*
-		 * Further action might be required according to the
-		 * action value.
-		 */
-		unsigned hval2;
-
-		if (htab->table[idx].used == -1
-		    && !first_deleted)
-			first_deleted = idx;
-
-		ret = _compare_and_overwrite_entry(item, action, retval, htab,
-			flag, hval, idx);
-		if (ret != -1)
-			return ret;
-
-		/*
-		 * Second hash function:
-		 * as suggested in [Knuth]
-		 */
-		hval2 = 1 + hval % (htab->size - 2);
-
-		do {
-			/*
-			 * Because SIZE is prime this guarantees to
-			 * step through all available indices.
-			 */
-			if (idx <= hval2)
-				idx = htab->size + idx - hval2;
-			else
-				idx -= hval2;
-
-			/*
-			 * If we visited all entries leave the loop
-			 * unsuccessfully.
-			 */
-			if (idx == hval)
-				break;
-
-			/* If entry is found use it. */
-			ret = _compare_and_overwrite_entry(item, action, retval,
-				htab, flag, hval, idx);
-			if (ret != -1)
-				return ret;
+	/* Overwrite existing value? */
+	if ((action == ENTER) && (item.data != NULL)) {
+		/* check for permission */
+		if (htab->change_ok != NULL && htab->change_ok(
+		    ep, item.data, env_op_overwrite, flag)) {
+			debug("change_ok() rejected setting variable "
+				"%s, skipping it!\n", item.key);
+			__set_errno(EPERM);
+			*retval = NULL;
+			return 0;
 		}
-		while (htab->table[idx].used);
-	}
 
-	/* An empty bucket has been found. */
-	if (action == ENTER) {
-		/*
-		 * If table is full and another entry should be
-		 * entered return with error.
-		 */
-		if (htab->filled == htab->size) {
-			__set_errno(ENOMEM);
+		/* If there is a callback, call it */
+		if (ep->callback && ep->callback(item.key, item.data,
+		    env_op_overwrite, flag)) {
+			debug("callback() rejected setting variable "
+				"%s, skipping it!\n", item.key);
+			__set_errno(EINVAL);
 			*retval = NULL;
 			return 0;
 		}
 
-		/*
-		 * Create new entry;
-		 * create copies of item.key and item.data
-		 */
-		if (first_deleted)
-			idx = first_deleted;
-
-		htab->table[idx].used = hval;
-		htab->table[idx].entry.key = strdup(item.key);
-		htab->table[idx].entry.data = strdup(item.data);
-		if (!htab->table[idx].entry.key ||
-		    !htab->table[idx].entry.data) {
+		/* the callback may have changed the table */
+		ep = &htab->table[idx - 1].entry;
+		free(ep->data);
+		ep->data = strdup(item.data);
+		env_callback_changed(ep->key);
+		if (!ep->data) {
 			__set_errno(ENOMEM);
 			*retval = NULL;
 			return 0;
 		}
+	}
+	/* return found entry */
+	*retval = ep;
+	return idx;
+}
 
-		++htab->filled;
+int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
+	      struct hsearch_data *htab, int flag)
+{
+	unsigned int hval = hash_key(item.key);
+	unsigned int slot, pos, idx;
+	_ENTRY *ent;
 
-		/* This is a new entry, so look up a possible callback */
-		env_callback_init(&htab->table[idx].entry);
-		/* Also look for flags */
-		env_flags_init(&htab->table[idx].entry);
+	if (find_slot(htab, item.key, hval, &slot))
+		return _overwrite_entry(item, action, retval, htab, flag,
+					htab->slots[slot].idx);
 
-		/* check for permission */
-		if (htab->change_ok != NULL && htab->change_ok(
-		    &htab->table[idx].entry, item.data, env_op_create, flag)) {
-			debug("change_ok() rejected setting variable "
-				"%s, skipping it!\n", item.key);
-			_hdelete(item.key, htab, &htab->table[idx].entry, idx);
-			__set_errno(EPERM);
-			*retval = NULL;
-			return 0;
-		}
+	if (action != ENTER) {
+		__set_errno(ESRCH);
+		*retval = NULL;
+		return 0;
+	}
 
-		/* If there is a callback, call it */
-		if (htab->table[idx].entry.callback &&
-		    htab->table[idx].entry.callback(item.key, item.data,
-		    env_op_create, flag)) {
-			debug("callback() rejected setting variable "
-				"%s, skipping it!\n", item.key);
-			_hdelete(item.key, htab, &htab->table[idx].entry, idx);
-			__set_errno(EINVAL);
+	/* If the table is full, make it bigger */
+	if (!htab->free) {
+		if (hresize(htab, htab->size * 2)) {
+			__set_errno(ENOMEM);
 			*retval = NULL;
 			return 0;
 		}
+		find_slot(htab, item.key, hval, &slot);
+	}
 
-		/* return new entry */
-		*retval = &htab->table[idx].entry;
-		return 1;
+	/*
+	 * Create new entry;
+	 * create copies of item.key and item.data
+	 */
+	idx = htab->free;
+	ent = &htab->table[idx - 1];
+	ent->entry.key = strdup(item.key);
+	ent->entry.data = strdup(item.data);
+	if (!ent->entry.key || !ent->entry.data) {
+		free((void *)ent->entry.key);
+		free(ent->entry.data);
+		ent->entry.key = NULL;
+		__set_errno(ENOMEM);
+		*retval = NULL;
+		return 0;
+	}
+	htab->free = ent->hval;
+	ent->hval = hval;
+	ent->entry.callback = NULL;
+	ent->entry.flags = 0;
+
+	htab->slots[slot].hval = hval;
+	htab->slots[slot].idx = idx;
+	pos = sorted_pos(htab, item.key);
+	memmove(&htab->sorted[pos + 1], &htab->sorted[pos],
+		(htab->filled - pos) * sizeof(htab->sorted[0]));
+	htab->sorted[pos] = idx - 1;
+	++htab->filled;
+
+	/* This is a new entry, so look up a possible callback */
+	env_callback_init(&ent->entry);
+	/* Also look for flags */
+	env_flags_init(&ent->entry);
+
+	/* check for permission */
+	if (htab->change_ok != NULL && htab->change_ok(
+	    &ent->entry, item.data, env_op_create, flag)) {
+		debug("change_ok() rejected setting variable "
+			"%s, skipping it!\n", item.key);
+		_hdelete(htab, idx);
+		__set_errno(EPERM);
+		*retval = NULL;
+		return 0;
 	}
 
-	__set_errno(ESRCH);
-	*retval = NULL;
-	return 0;
+	/* If there is a callback, call it */
+	if (ent->entry.callback &&
+	    ent->entry.callback(item.key, item.data, env_op_create, flag)) {
+		debug("callback() rejected setting variable "
+			"%s, skipping it!\n", item.key);
+		_hdelete(htab, idx);
+		__set_errno(EINVAL);
+		*retval = NULL;
+		return 0;
+	}
+
+	/* return new entry; the callback may have changed the table */
+	*retval = &htab->table[idx - 1].entry;
+	env_callback_changed((*retval)->key);
+	return idx;
 }
 
 
@@ -425,18 +490,29 @@ int hsearch_r(ENTRY item, ACTION action, ENTRY ** retval,
  * do that.
  */
 
-static void _hdelete(const char *key, struct hsearch_data *htab, ENTRY *ep,
-	int idx)
+static void _hdelete(struct hsearch_data *htab, unsigned int idx)
 {
+	_ENTRY *ent = &htab->table[idx - 1];
+	ENTRY *ep = &ent->entry;
+	unsigned int slot, pos;
+
+	/* remove it from the index and the sorted list */
+	debug("hdelete: DELETING key \"%s\"\n", ep->key);
+	find_slot(htab, ep->key, ent->hval, &slot);
+	remove_slot(htab, slot);
+	pos = sorted_pos(htab, ep->key);
+	--htab->filled;
+	memmove(&htab->sorted[pos], &htab->sorted[pos + 1],
+		(htab->filled - pos) * sizeof(htab->sorted[0]));
+
 	/* free used ENTRY */
-	debug("hdelete: DELETING key \"%s\"\n", key);
 	free((void *)ep->key);
 	free(ep->data);
+	ep->key = NULL;
 	ep->callback = NULL;
 	ep->flags = 0;
-	htab->table[idx].used = -1;
-
-	--htab->filled;
+	ent->hval = htab->free;
+	htab->free = idx;
 }
 
 int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
@@ -464,15 +540,15 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
 	}
 
 	/* If there is a callback, call it */
-	if (htab->table[idx].entry.callback &&
-	    htab->table[idx].entry.callback(key, NULL, env_op_delete, flag)) {
+	if (ep->callback && ep->callback(key, NULL, env_op_delete, flag)) {
 		debug("callback() rejected deleting variable "
 			"%s, skipping it!\n", key);
 		__set_errno(EINVAL);
 		return 0;
 	}
 
-	_hdelete(key, htab, ep, idx);
+	env_callback_changed(key);
+	_hdelete(htab, idx);
 
 	return 1;
 }
@@ -520,14 +596,6 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
  *		bytes in the string will be '\0'-padded.
  */
 
-static int cmpkey(const void *p1, const void *p2)
-{
-	ENTRY *e1 = *(ENTRY **) p1;
-	ENTRY *e2 = *(ENTRY **) p2;
-
-	return (strcmp(e1->key, e2->key));
-}
-
 static int match_string(int flag, const char *str, const char *pat, void *priv)
 {
 	switch (flag & H_MATCH_METHOD) {
@@ -587,14 +655,24 @@ static int match_entry(ENTRY *ep, int flag,
 	return 0;
 }
 
+static int export_entry(ENTRY *ep, int flag, int argc, char * const argv[])
+{
+	if ((argc > 0) && !match_entry(ep, flag, argc, argv))
+		return 0;
+
+	if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
+		return 0;
+
+	return 1;
+}
+
 ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		 char **resp, size_t size,
 		 int argc, char * const argv[])
 {
-	ENTRY *list[htab->size];
 	char *res, *p;
 	size_t totlen;
-	int i, n;
+	unsigned int pos;
 
 	/* Test for correct arguments.  */
 	if ((resp == NULL) || (htab == NULL)) {
@@ -606,54 +684,33 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		"size = %zu\n", htab, htab->size, htab->filled, size);
 	/*
 	 * Pass 1:
-	 * search used entries,
-	 * save addresses and compute total length
+	 * compute total length of the entries to export, which are
+	 * already in key order
 	 */
-	for (i = 1, n = 0, totlen = 0; i <= htab->size; ++i) {
-
-		if (htab->table[i].used > 0) {
-			ENTRY *ep = &htab->table[i].entry;
-			int found = match_entry(ep, flag, argc, argv);
-
-			if ((argc > 0) && (found == 0))
-				continue;
-
-			if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
-				continue;
+	for (pos = 0, totlen = 0; pos < htab->filled; ++pos) {
+		ENTRY *ep = sorted_entry(htab, pos);
 
-			list[n++] = ep;
+		if (!export_entry(ep, flag, argc, argv))
+			continue;
 
-			totlen += strlen(ep->key) + 2;
+		totlen += strlen(ep->key) + 2;
 
-			if (sep == '\0') {
-				totlen += strlen(ep->data);
-			} else {	/* check if escapes are needed */
-				char *s = ep->data;
+		if (sep == '\0') {
+			totlen += strlen(ep->data);
+		} else {	/* check if escapes are needed */
+			char *s = ep->data;
 
-				while (*s) {
+			while (*s) {
+				++totlen;
+				/* add room for needed escape chars */
+				if ((*s == sep) || (*s == '\\'))
 					++totlen;
-					/* add room for needed escape chars */
-					if ((*s == sep) || (*s == '\\'))
-						++totlen;
-					++s;
-				}
+				++s;
 			}
-			totlen += 2;	/* for '=' and 'sep' char */
 		}
+		totlen += 2;	/* for '=' and 'sep' char */
 	}
 
-#ifdef DEBUG
-	/* Pass 1a: print unsorted list */
-	printf("Unsorted: n=%d\n", n);
-	for (i = 0; i < n; ++i) {
-		printf("\t%3d: %p ==> %-10s => %s\n",
-		       i, list[i], list[i]->key, list[i]->data);
-	}
-#endif
-
-	/* Sort list by keys */
-	qsort(list, n, sizeof(ENTRY *), cmpkey);
-
 	/* Check if the user supplied buffer size is sufficient */
 	if (size) {
 		if (size < totlen + 1) {	/* provided buffer too small */
@@ -683,15 +740,19 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 	 * Pass 2:
 	 * export sorted list of result data
 	 */
-	for (i = 0, p = res; i < n; ++i) {
+	for (pos = 0, p = res; pos < htab->filled; ++pos) {
+		ENTRY *ep = sorted_entry(htab, pos);
 		const char *s;
 
-		s = list[i]->key;
+		if (!export_entry(ep, flag, argc, argv))
+			continue;
+
+		s = ep->key;
 		while (*s)
 			*p++ = *s++;
 		*p++ = '=';
 
-		s = list[i]->data;
+		s = ep->data;
 
 		while (*s) {
 			if ((*s == sep) || (*s == '\\'))
@@ -824,7 +885,8 @@ int himport_r(struct hsearch_data *htab,
 	 * envrionment size), so we clip it to a reasonable value.
 	 * On the other hand we need to add some more entries for free
 	 * space when importing very small buffers. Both boundaries can
-	 * be overwritten in the board config file if needed.
+	 * be overwritten in the board config file if needed. As the
+	 * table grows when it fills up, this is only a starting size.
 	 */
 
 	if (!htab->table) {
@@ -942,20 +1004,18 @@ int himport_r(struct hsearch_data *htab,
  */
 
 /*
- * Walk all of the entries in the hash, calling the callback for each one.
+ * Walk all of the entries in key order, calling the callback for each one.
  * this allows some generic operation to be performed on each element.
  */
 int hwalk_r(struct hsearch_data *htab, int (*callback)(ENTRY *))
 {
-	int i;
+	unsigned int pos;
 	int retval;
 
-	for (i = 1; i <= htab->size; ++i) {
-		if (htab->table[i].used > 0) {
-			retval = callback(&htab->table[i].entry);
-			if (retval)
-				return retval;
-		}
+	for (pos = 0; pos < htab->filled; ++pos) {
+		retval = callback(sorted_entry(htab, pos));
+		if (retval)
+			return retval;
 	}
 
 	return 0;
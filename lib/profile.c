@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <profile.h>
+#include <trace.h>
+#include <asm/sections.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Number of words in each slot of the ring: frame count, then frames */
+#define SLOT_WORDS	(1 + CONFIG_SAMPLE_PROFILE_DEPTH)
+
+static volatile char profile_enabled;
+
+/* Information about the samples, kept until the next profile_start() */
+struct profile_hdr {
+	uint32_t *ring;		/* Ring of CONFIG_SAMPLE_PROFILE_SAMPLES slots */
+	ulong sample_count;	/* Total samples taken, including overwritten */
+	ulong outside_count;	/* Samples with the PC outside U-Boot */
+	int max_depth;		/* Most frames seen in one sample */
+	uint hz;		/* Sample rate */
+	ulong start_us;		/* Time when sampling started */
+	ulong elapsed_us;	/* Time spent sampling, once stopped */
+};
+
+static struct profile_hdr hdr;
+
+/**
+ * Convert an address to an offset into U-Boot's code
+ *
+ * This matches the offsets used for function tracing, so that tools can
+ * look them up in System.map.
+ *
+ * @param addr	Address to convert
+ * @return offset, or PROFILE_OUTSIDE if the address is not in U-Boot
+ */
+static uint32_t addr_to_offset(ulong addr)
+{
+	ulong base;
+
+#ifdef CONFIG_SANDBOX
+	base = (ulong)&_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		base = gd->relocaddr;
+	else
+		base = CONFIG_SYS_TEXT_BASE;
+#endif
+	if (addr < base || addr - base >= gd->mon_len)
+		return PROFILE_OUTSIDE;
+
+	return addr - base;
+}
+
+void profile_sample(const ulong *frames, int count)
+{
+	uint32_t *slot;
+	int i;
+
+	if (!profile_enabled)
+		return;
+	if (count > CONFIG_SAMPLE_PROFILE_DEPTH)
+		count = CONFIG_SAMPLE_PROFILE_DEPTH;
+	slot = &hdr.ring[(hdr.sample_count % CONFIG_SAMPLE_PROFILE_SAMPLES) *
+			 SLOT_WORDS];
+	slot[0] = count;
+
+	/*
+	 * Callers are recorded at their return address less one, so that
+	 * a call at the very end of a function is not attributed to the
+	 * function after it.
+	 */
+	for (i = 0; i < count; i++)
+		slot[1 + i] = addr_to_offset(frames[i] - (i ? 1 : 0));
+	if (count && slot[1] == PROFILE_OUTSIDE)
+		hdr.outside_count++;
+	if (count > hdr.max_depth)
+		hdr.max_depth = count;
+	hdr.sample_count++;
+}
+
+__weak int profile_timer_start(uint hz, int depth)
+{
+	return -ENOSYS;
+}
+
+__weak void profile_timer_stop(void)
+{
+}
+
+int profile_init(void)
+{
+	if (hdr.ring)
+		return 0;
+	hdr.ring = calloc(CONFIG_SAMPLE_PROFILE_SAMPLES,
+			  SLOT_WORDS * sizeof(uint32_t));
+	if (!hdr.ring)
+		return -ENOMEM;
+
+	return 0;
+}
+
+int profile_start(uint hz)
+{
+	int depth = 1;
+	int ret;
+
+	ret = profile_init();
+	if (ret)
+		return ret;
+	if (!hz)
+		hz = CONFIG_SAMPLE_PROFILE_HZ;
+	profile_stop();
+	hdr.sample_count = 0;
+	hdr.outside_count = 0;
+	hdr.max_depth = 0;
+	hdr.hz = hz;
+	hdr.elapsed_us = 0;
+	hdr.start_us = timer_get_us();
+#ifdef CONFIG_SAMPLE_PROFILE_UNWIND
+	depth = CONFIG_SAMPLE_PROFILE_DEPTH;
+#endif
+	profile_enabled = 1;
+	ret = profile_timer_start(hz, depth);
+	if (ret) {
+		profile_enabled = 0;
+		return ret;
+	}
+
+	return 0;
+}
+
+void profile_stop(void)
+{
+	if (!profile_enabled)
+		return;
+	profile_timer_stop();
+	profile_enabled = 0;
+	hdr.elapsed_us = timer_get_us() - hdr.start_us;
+}
+
+void profile_print_stats(void)
+{
+	ulong elapsed_us, kept;
+
+	if (!hdr.ring || !hdr.hz) {
+		puts("Profiling has not been started\n");
+		return;
+	}
+	elapsed_us = profile_enabled ? timer_get_us() - hdr.start_us :
+		hdr.elapsed_us;
+	printf("Profiling %s at %u Hz for %lu ms\n",
+	       profile_enabled ? "running" : "stopped", hdr.hz,
+	       elapsed_us / 1000);
+	print_grouped_ull(hdr.sample_count, 10);
+	puts(" samples taken\n");
+	kept = min(hdr.sample_count, (ulong)CONFIG_SAMPLE_PROFILE_SAMPLES);
+	print_grouped_ull(kept, 10);
+	puts(" samples in buffer");
+	if (hdr.sample_count > kept)
+		printf(" (%lu oldest overwritten)", hdr.sample_count - kept);
+	puts("\n");
+	print_grouped_ull(hdr.outside_count, 10);
+	puts(" samples outside U-Boot\n");
+	printf("%15d maximum frames per sample\n", hdr.max_depth);
+}
+
+int profile_list_samples(void *buff, int buff_size, unsigned int *needed)
+{
+	struct trace_output_hdr *output_hdr = NULL;
+	void *end, *ptr = buff;
+	ulong first, rec, count;
+	char was_enabled;
+	int upto;
+
+	end = buff ? buff + buff_size : NULL;
+
+	/* Don't let the timer overwrite samples while we copy them */
+	was_enabled = profile_enabled;
+	profile_enabled = 0;
+
+	/* Place some header information */
+	if (ptr + sizeof(struct trace_output_hdr) < end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	/* Add each sample, oldest first */
+	count = min(hdr.sample_count, (ulong)CONFIG_SAMPLE_PROFILE_SAMPLES);
+	first = hdr.sample_count - count;
+	for (rec = first, upto = 0; hdr.ring && rec < hdr.sample_count; rec++) {
+		uint32_t *slot = &hdr.ring[(rec % CONFIG_SAMPLE_PROFILE_SAMPLES)
+					   * SLOT_WORDS];
+		int size = (1 + slot[0]) * sizeof(uint32_t);
+
+		if (ptr + size < end) {
+			memcpy(ptr, slot, size);
+			upto++;
+		}
+		ptr += size;
+	}
+	profile_enabled = was_enabled;
+
+	/* Update the header */
+	if (output_hdr) {
+		output_hdr->rec_count = upto;
+		output_hdr->type = TRACE_CHUNK_SAMPLES;
+	}
+
+	/* Work out how much of the buffer we used */
+	*needed = ptr - buff;
+	if (ptr > end)
+		return -1;
+	return 0;
+}
@@ -8,4 +8,13 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/* U-boot: the input and output space inflate_fast() needs to be called */
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+#define INFLATE_FAST_MIN_INPUT  (2 * sizeof(unsigned long) + 6)
+#define INFLATE_FAST_MIN_OUTPUT (258 + sizeof(unsigned long))
+#else
+#define INFLATE_FAST_MIN_INPUT  6
+#define INFLATE_FAST_MIN_OUTPUT 258
+#endif
+
 void inflate_fast OF((z_streamp strm, unsigned start));
@@ -0,0 +1,314 @@
+/* inffast_chunk.c -- fast decoding with word-sized refills and match copies
+ * Copyright (C) 1995-2004 Mark Adler
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* U-boot: this replaces inffast.c when CONFIG_ZLIB_INFLATE_FAST is defined.
+
+   It decodes the same way, with the following changes along the lines of
+   the modern zlib forks:
+
+   - The bit buffer is refilled a whole machine word at a time, without a
+     branch or a loop per byte. After a refill it holds at least
+     INFFAST_WORD_BITS - 8 bits, which on a 64-bit machine is enough for
+     a complete length/distance pair.
+
+   - Matches at least a word back are copied a word at a time, and the
+     last word is allowed to run past the end of the match. The extra
+     bytes are overwritten by the output which follows.
+
+   - Runs of a single repeated byte (distance 1) use memset().
+
+   Reading ahead and writing past the match need some slack at the end of
+   the input and output buffers, so inflate() only calls inflate_fast()
+   when at least INFLATE_FAST_MIN_INPUT bytes of input and
+   INFLATE_FAST_MIN_OUTPUT bytes of output space are available (see
+   inffast.h). */
+
+#define INFFAST_WORD_BITS (8 * sizeof(unsigned long))
+
+/* Load the next word of the input, least significant byte first */
+static inline unsigned long inffast_load(const unsigned char FAR *in)
+{
+    if (sizeof(unsigned long) == 8)
+        return (unsigned long)get_unaligned_le64(in);
+    return get_unaligned_le32(in);
+}
+
+/* Fill the bit buffer up to at least INFFAST_WORD_BITS - 8 bits. Any partial
+   byte loaded above that is loaded again at the same position next time, so
+   it is harmless to OR it in. */
+#define REFILL() \
+    do { \
+        hold |= inffast_load(in) << bits; \
+        in += (INFFAST_WORD_BITS - 1 - bits) >> 3; \
+        bits |= INFFAST_WORD_BITS - 8; \
+    } while (0)
+
+/* Add one more byte to the bit buffer */
+#define PULLBYTE() \
+    do { \
+        hold |= (unsigned long)(*in++) << bits; \
+        bits += 8; \
+    } while (0)
+
+/* Copy len bytes from earlier in the output, dist >= sizeof(unsigned long)
+   bytes back. Up to sizeof(unsigned long) - 1 bytes past the end are
+   written too. */
+static inline unsigned char FAR *chunk_copy(unsigned char FAR *out,
+                                           const unsigned char FAR *from,
+                                           unsigned len)
+{
+    unsigned char FAR *end = out + len;
+
+    do {
+        put_unaligned(get_unaligned((unsigned long *)from),
+                      (unsigned long *)out);
+        out += sizeof(unsigned long);
+        from += sizeof(unsigned long);
+    } while (out < end);
+
+    return end;
+}
+
+/*
+   Decode literal, length, and distance codes and write out the resulting
+   literal and match bytes until either not enough input or output is
+   available, an end-of-block is encountered, or a data error is encountered.
+
+   Entry assumptions:
+
+        state->mode == LEN
+        strm->avail_in >= INFLATE_FAST_MIN_INPUT
+        strm->avail_out >= INFLATE_FAST_MIN_OUTPUT
+        start >= strm->avail_out
+        state->bits < 8
+
+   On return, state->mode is one of:
+
+        LEN -- ran out of enough output space or enough available input
+        TYPE -- reached end of block code, inflate() to interpret next block
+        BAD -- error in block data
+
+   Notes:
+
+    - A length/distance pair uses at most 48 bits, or six bytes of input.
+      The bit buffer holds up to another word which has been loaded but not
+      yet used, and a refill reads a word beyond that. So if there are at
+      least 2 * sizeof(unsigned long) + 6 bytes of input at the start of
+      the loop, no loads go past the end of the input.
+
+    - The maximum bytes that a single length/distance pair can output is 258
+      bytes, and a word-sized copy may write sizeof(unsigned long) - 1 bytes
+      more. So the loop continues while that much output space is left.
+ */
+void inflate_fast(z_streamp strm, unsigned start)
+/* start: inflate()'s starting value for strm->avail_out */
+{
+    struct inflate_state FAR *state;
+    unsigned char FAR *in;      /* local strm->next_in */
+    unsigned char FAR *last;    /* while in < last, enough input available */
+    unsigned char FAR *out;     /* local strm->next_out */
+    unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
+    unsigned char FAR *end;     /* while out < end, enough space available */
+#ifdef INFLATE_STRICT
+    unsigned dmax;              /* maximum distance from zlib header */
+#endif
+    unsigned wsize;             /* window size or zero if not using window */
+    unsigned whave;             /* valid bytes in the window */
+    unsigned write;             /* window write index */
+    unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    unsigned long hold;         /* local strm->hold */
+    unsigned bits;              /* local strm->bits */
+    code const FAR *lcode;      /* local strm->lencode */
+    code const FAR *dcode;      /* local strm->distcode */
+    unsigned lmask;             /* mask for first level of length codes */
+    unsigned dmask;             /* mask for first level of distance codes */
+    code this;                  /* retrieved table entry */
+    unsigned op;                /* code bits, operation, extra bits, or */
+                                /*  window position, window bytes to copy */
+    unsigned len;               /* match length, unused bytes */
+    unsigned dist;              /* match distance */
+    unsigned char FAR *from;    /* where to copy match from */
+
+    /* copy state to local variables */
+    state = (struct inflate_state FAR *)strm->state;
+    in = strm->next_in;
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_INPUT - 1));
+    if (in > last && strm->avail_in > INFLATE_FAST_MIN_INPUT - 1) {
+        /*
+         * overflow detected, limit strm->avail_in to the
+         * max. possible size and recalculate last
+         */
+        strm->avail_in = 0xffffffff - (uintptr_t)in;
+        last = in + (strm->avail_in - (INFLATE_FAST_MIN_INPUT - 1));
+    }
+    out = strm->next_out;
+    beg = out - (start - strm->avail_out);
+    end = out + (strm->avail_out - (INFLATE_FAST_MIN_OUTPUT - 1));
+#ifdef INFLATE_STRICT
+    dmax = state->dmax;
+#endif
+    wsize = state->wsize;
+    whave = state->whave;
+    write = state->write;
+    window = state->window;
+    hold = state->hold;
+    bits = state->bits;
+    lcode = state->lencode;
+    dcode = state->distcode;
+    lmask = (1U << state->lenbits) - 1;
+    dmask = (1U << state->distbits) - 1;
+
+    /* decode literals and length/distances until end-of-block or not enough
+       input data or output space */
+    do {
+        if (bits < 15)
+            REFILL();
+        this = lcode[hold & lmask];
+      dolen:
+        op = (unsigned)(this.bits);
+        hold >>= op;
+        bits -= op;
+        op = (unsigned)(this.op);
+        if (op == 0) {                          /* literal */
+            Tracevv((stderr, this.val >= 0x20 && this.val < 0x7f ?
+                    "inflate:         literal '%c'\n" :
+                    "inflate:         literal 0x%02x\n", this.val));
+            *out++ = (unsigned char)(this.val);
+        }
+        else if (op & 16) {                     /* length base */
+            len = (unsigned)(this.val);
+            op &= 15;                           /* number of extra bits */
+            if (op) {
+                if (bits < op)
+                    PULLBYTE();
+                len += (unsigned)hold & ((1U << op) - 1);
+                hold >>= op;
+                bits -= op;
+            }
+            Tracevv((stderr, "inflate:         length %u\n", len));
+            if (bits < 15)
+                REFILL();
+            this = dcode[hold & dmask];
+          dodist:
+            op = (unsigned)(this.bits);
+            hold >>= op;
+            bits -= op;
+            op = (unsigned)(this.op);
+            if (op & 16) {                      /* distance base */
+                dist = (unsigned)(this.val);
+                op &= 15;                       /* number of extra bits */
+                if (bits < op) {
+                    PULLBYTE();
+                    if (bits < op)
+                        PULLBYTE();
+                }
+                dist += (unsigned)hold & ((1U << op) - 1);
+#ifdef INFLATE_STRICT
+                if (dist > dmax) {
+                    strm->msg = (char *)"invalid distance too far back";
+                    state->mode = BAD;
+                    break;
+                }
+#endif
+                hold >>= op;
+                bits -= op;
+                Tracevv((stderr, "inflate:         distance %u\n", dist));
+                op = (unsigned)(out - beg);     /* max distance in output */
+                if (dist > op) {                /* see if copy from window */
+                    op = dist - op;             /* distance back in window */
+                    if (op > whave) {
+                        strm->msg = (char *)"invalid distance too far back";
+                        state->mode = BAD;
+                        break;
+                    }
+                    from = window;
+                    if (write == 0) {           /* very common case */
+                        from += wsize - op;
+                    }
+                    else if (write < op) {      /* wrap around window */
+                        from += wsize + write - op;
+                        op -= write;
+                        if (op < len) {         /* some from end of window */
+                            len -= op;
+                            memcpy(out, from, op);
+                            out += op;
+                            from = window;
+                            op = write;
+                        }
+                    }
+                    else {                      /* contiguous in window */
+                        from += write - op;
+                    }
+                    if (op < len) {             /* some from window */
+                        len -= op;
+                        memcpy(out, from, op);
+                        out += op;
+                        from = out - dist;      /* rest from output */
+                        if (dist >= sizeof(unsigned long)) {
+                            out = chunk_copy(out, from, len);
+                            len = 0;
+                        }
+                    }
+                    while (len--)
+                        *out++ = *from++;
+                }
+                else if (dist >= sizeof(unsigned long)) {
+                    out = chunk_copy(out, out - dist, len);
+                }
+                else if (dist == 1) {           /* run of one byte */
+                    memset(out, out[-1], len);
+                    out += len;
+                }
+                else {                          /* short overlapped copy */
+                    from = out - dist;
+                    do {
+                        *out++ = *from++;
+                    } while (--len);
+                }
+            }
+            else if ((op & 64) == 0) {          /* 2nd level distance code */
+                this = dcode[this.val + (hold & ((1U << op) - 1))];
+                goto dodist;
+            }
+            else {
+                strm->msg = (char *)"invalid distance code";
+                state->mode = BAD;
+                break;
+            }
+        }
+        else if ((op & 64) == 0) {              /* 2nd level length code */
+            this = lcode[this.val + (hold & ((1U << op) - 1))];
+            goto dolen;
+        }
+        else if (op & 32) {                     /* end-of-block */
+            Tracevv((stderr, "inflate:         end of block\n"));
+            state->mode = TYPE;
+            break;
+        }
+        else {
+            strm->msg = (char *)"invalid literal/length code";
+            state->mode = BAD;
+            break;
+        }
+    } while (in < last && out < end);
+
+    /* return unused bytes (the bit buffer may hold up to a word of them) */
+    len = bits >> 3;
+    in -= len;
+    bits -= len << 3;
+    hold &= (1UL << bits) - 1;
+
+    /* update state and return */
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(last - in + (INFLATE_FAST_MIN_INPUT - 1));
+    strm->avail_out = (unsigned)(end - out + (INFLATE_FAST_MIN_OUTPUT - 1));
+    state->hold = hold;
+    state->bits = bits;
+    return;
+}
+
+#undef REFILL
+#undef PULLBYTE
@@ -231,6 +231,9 @@ int eth_register(struct eth_device *dev)
 	dev->state = ETH_STATE_INIT;
 	dev->next  = eth_devices;
 	dev->index = index++;
+	dev->rx_packets = 0;
+	dev->rx_dropped = 0;
+	dev->rx_overruns = 0;
 
 	return 0;
 }
@@ -429,6 +432,7 @@ void eth_halt(void)
 		return;
 
 	eth_current->halt(eth_current);
+	net_rx_post_reset();
 
 	eth_current->state = ETH_STATE_PASSIVE;
 }
@@ -449,6 +453,106 @@ int eth_rx(void)
 	return eth_current->recv(eth_current);
 }
 
+#ifdef CONFIG_NET_RX_POST
+#define RX_POST_HDR_MAX	64
+
+/*
+ * The buffer for payload k sits at base + k * stride - hdr_len, so its
+ * headers land on the tail of payload k - 1. Only one buffer is handed
+ * out at a time, for the payload expected next, and only when the
+ * hardware fills it before any other: the tail it lands on is then
+ * stored already and is kept in tail[] to be put back. With two buffers
+ * out, or frames still to be handled before the posted one, the headers
+ * of one frame could land on a payload which is not stored yet, or be
+ * overwritten by one being stored.
+ */
+static struct {
+	uchar *base;
+	int hdr_len;
+	int stride;
+	ulong limit;
+	ulong next;		/* payload expected next */
+	int active;		/* buffers may be handed out */
+	int posted;		/* a buffer is handed out and not received */
+	uchar tail[RX_POST_HDR_MAX];	/* end of payload next - 1 */
+} rx_post;
+
+void net_rx_post_start(uchar *base, int hdr_len, int stride, ulong limit,
+		       ulong next)
+{
+	if (hdr_len > RX_POST_HDR_MAX || stride <= hdr_len)
+		return;
+	/* buffers already handed out must keep their meaning */
+	if (rx_post.posted && (base != rx_post.base ||
+			       hdr_len != rx_post.hdr_len ||
+			       stride != rx_post.stride))
+		return;
+	rx_post.base = base;
+	rx_post.hdr_len = hdr_len;
+	rx_post.stride = stride;
+	rx_post.limit = limit;
+	rx_post.active = 1;
+	net_rx_post_next(next);
+}
+
+void net_rx_post_next(ulong next)
+{
+	if (!rx_post.active)
+		return;
+	rx_post.next = next;
+	if (next)
+		memcpy(rx_post.tail, rx_post.base + next * rx_post.stride -
+		       rx_post.hdr_len, rx_post.hdr_len);
+}
+
+void net_rx_post_stop(void)
+{
+	rx_post.active = 0;
+}
+
+uchar *net_rx_post_get(int ahead, int size, int align)
+{
+	ulong start = rx_post.next * rx_post.stride;
+	uchar *buf;
+
+	if (!rx_post.active || !rx_post.next || ahead || rx_post.posted ||
+	    start + size - rx_post.hdr_len > rx_post.limit)
+		return NULL;
+	buf = rx_post.base + start - rx_post.hdr_len;
+	if ((ulong)buf & (align - 1))
+		return NULL;
+	rx_post.posted = 1;
+
+	return buf;
+}
+
+/*
+ * The buffer from net_rx_post_get() must be passed back here once the
+ * hardware has written to it, with @len 0 if the frame is to be dropped,
+ * so that the payload under its headers can be put back.
+ */
+void net_rx_post_receive(uchar *buf, int len)
+{
+	uchar tail[RX_POST_HDR_MAX];
+	ulong k = (buf - rx_post.base + rx_post.hdr_len) / rx_post.stride;
+	int restore = k == rx_post.next;
+
+	rx_post.posted = 0;
+	if (restore)
+		memcpy(tail, rx_post.tail, rx_post.hdr_len);
+	if (len > 0)
+		NetReceive(buf, len);
+	if (restore)
+		memcpy(buf, tail, rx_post.hdr_len);
+}
+
+void net_rx_post_reset(void)
+{
+	rx_post.active = 0;
+	rx_post.posted = 0;
+}
+#endif /* CONFIG_NET_RX_POST */
+
 #ifdef CONFIG_API
 static void eth_save_packet(void *packet, int length)
 {
@@ -104,6 +104,10 @@
 #include "sntp.h"
 #endif
 #include "tftp.h"
+#if defined(CONFIG_CMD_WGET)
+#include "tcp.h"
+#include "wget.h"
+#endif
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -433,6 +437,11 @@ restart:
 		case LINKLOCAL:
 			link_local_start();
 			break;
+#endif
+#if defined(CONFIG_CMD_WGET)
+		case WGET:
+			wget_start();
+			break;
 #endif
 		default:
 			break;
@@ -682,32 +691,16 @@ NetSetTimeout(ulong iv, thand_f *f)
 	}
 }
 
-int NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport, int sport,
-		int payload_len)
+int net_send_ip_packet(uchar *ether, IPaddr_t dest, int len)
 {
-	uchar *pkt;
 	int eth_hdr_size;
-	int pkt_hdr_size;
 
 	/* make sure the NetTxPacket is initialized (NetInit() was called) */
 	assert(NetTxPacket != NULL);
 	if (NetTxPacket == NULL)
 		return -1;
 
-	/* convert to new style broadcast */
-	if (dest == 0)
-		dest = 0xFFFFFFFF;
-
-	/* if broadcast, make the ether address a broadcast and don't do ARP */
-	if (dest == 0xFFFFFFFF)
-		ether = NetBcastAddr;
-
-	pkt = (uchar *)NetTxPacket;
-
-	eth_hdr_size = NetSetEther(pkt, ether, PROT_IP);
-	pkt += eth_hdr_size;
-	net_set_udp_header(pkt, dest, dport, sport, payload_len);
-	pkt_hdr_size = eth_hdr_size + IP_UDP_HDR_SIZE;
+	eth_hdr_size = NetSetEther(NetTxPacket, ether, PROT_IP);
 
 	/* if MAC address was not discovered yet, do an ARP request */
 	if (memcmp(ether, NetEtherNullAddr, 6) == 0) {
@@ -718,7 +711,7 @@ int NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport, int sport,
 		NetArpWaitPacketMAC = ether;
 
 		/* size of the waiting packet */
-		NetArpWaitTxPacketSize = pkt_hdr_size + payload_len;
+		NetArpWaitTxPacketSize = eth_hdr_size + len;
 
 		/* and do the ARP request */
 		NetArpWaitTry = 1;
@@ -726,31 +719,61 @@ int NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport, int sport,
 		ArpRequest();
 		return 1;	/* waiting */
 	} else {
-		debug_cond(DEBUG_DEV_PKT, "sending UDP to %pI4/%pM\n",
+		debug_cond(DEBUG_DEV_PKT, "sending IP to %pI4/%pM\n",
 			&dest, ether);
-		NetSendPacket(NetTxPacket, pkt_hdr_size + payload_len);
+		NetSendPacket(NetTxPacket, eth_hdr_size + len);
 		return 0;	/* transmitted */
 	}
 }
 
+int NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport, int sport,
+		int payload_len)
+{
+	/* make sure the NetTxPacket is initialized (NetInit() was called) */
+	assert(NetTxPacket != NULL);
+	if (NetTxPacket == NULL)
+		return -1;
+
+	/* convert to new style broadcast */
+	if (dest == 0)
+		dest = 0xFFFFFFFF;
+
+	/* if broadcast, make the ether address a broadcast and don't do ARP */
+	if (dest == 0xFFFFFFFF)
+		ether = NetBcastAddr;
+
+	net_set_udp_header(NetTxPacket + NetEthHdrSize(), dest, dport, sport,
+			   payload_len);
+
+	return net_send_ip_packet(ether, dest, IP_UDP_HDR_SIZE + payload_len);
+}
+
 #ifdef CONFIG_IP_DEFRAG
 /*
- * This function collects fragments in a single packet, according
- * to the algorithm in RFC815. It returns NULL or the pointer to
- * a complete packet, in static storage
+ * This function collects fragments in a packet, according to the
+ * algorithm in RFC815. Several packets may be collected at once, each in
+ * its own context. It returns NULL or the pointer to a complete packet,
+ * in static storage
  */
 #ifndef CONFIG_NET_MAXDEFRAG
 #define CONFIG_NET_MAXDEFRAG 16384
 #endif
+#ifndef CONFIG_NET_DEFRAG_CONTEXTS
+#define CONFIG_NET_DEFRAG_CONTEXTS 1
+#endif
+#ifndef CONFIG_NET_DEFRAG_TIMEOUT
+#define CONFIG_NET_DEFRAG_TIMEOUT 2000UL
+#endif
 /*
  * MAXDEFRAG, above, is chosen in the config file and  is real data
- * so we need to add the NFS overhead, which is more than TFTP.
+ * so we need to add the IP, UDP and NFS overhead, which is more than TFTP.
  * To use sizeof in the internal unnamed structures, we need a real
  * instance (can't do "sizeof(struct rpc_t.u.reply))", unfortunately).
  * The compiler doesn't complain nor allocates the actual structure
  */
 static struct rpc_t rpc_specimen;
-#define IP_PKTSIZE (CONFIG_NET_MAXDEFRAG + sizeof(rpc_specimen.u.reply))
+#define IP_PKTSIZE (CONFIG_NET_MAXDEFRAG + IP_UDP_HDR_SIZE + \
+		    sizeof(rpc_specimen.u.reply))
 
 #define IP_MAXUDP (IP_PKTSIZE - IP_HDR_SIZE)
 
@@ -766,37 +789,93 @@ struct hole {
 	u16 unused;
 };
 
+/* A packet being reassembled */
+struct defrag_ctx {
+	uchar pkt_buff[IP_PKTSIZE] __aligned(PKTALIGN);
+	u16 first_hole;
+	u16 total_len;		/* 0 if the context is free */
+	ulong time;		/* when the last fragment arrived */
+};
+
+static struct defrag_ctx defrag_ctxs[CONFIG_NET_DEFRAG_CONTEXTS];
+static struct net_defrag_stats defrag_stats;
+
+/*
+ * Find the context collecting the packet @ip is a fragment of, or set
+ * one up. Contexts which have waited too long for a fragment are freed,
+ * and if none is free the one which has waited longest is taken.
+ */
+static struct defrag_ctx *defrag_find(struct ip_udp_hdr *ip, ulong now)
+{
+	struct defrag_ctx *ctx, *found = NULL, *oldest = NULL;
+	struct ip_udp_hdr *localip;
+	struct hole *payload;
+
+	for (ctx = defrag_ctxs; ctx < defrag_ctxs + CONFIG_NET_DEFRAG_CONTEXTS;
+	     ctx++) {
+		if (ctx->total_len &&
+		    now - ctx->time > CONFIG_NET_DEFRAG_TIMEOUT) {
+			ctx->total_len = 0;
+			defrag_stats.timeouts++;
+		}
+		if (!ctx->total_len) {
+			if (!found)
+				found = ctx;
+			continue;
+		}
+		localip = (struct ip_udp_hdr *)ctx->pkt_buff;
+		if (localip->ip_id == ip->ip_id && localip->ip_p == ip->ip_p &&
+		    NetReadIP(&localip->ip_src) == NetReadIP(&ip->ip_src))
+			return ctx;
+		if (!oldest || (long)(ctx->time - oldest->time) < 0)
+			oldest = ctx;
+	}
+	if (!found) {
+		found = oldest;
+		defrag_stats.dropped++;
+	}
+
+	/* new packet, reset structs */
+	ctx = found;
+	payload = (struct hole *)(ctx->pkt_buff + IP_HDR_SIZE);
+	ctx->total_len = 0xffff;
+	payload[0].last_byte = ~0;
+	payload[0].next_hole = 0;
+	payload[0].prev_hole = 0;
+	ctx->first_hole = 0;
+	/* any IP header will work, copy the first we received */
+	memcpy(ctx->pkt_buff, ip, IP_HDR_SIZE);
+
+	return ctx;
+}
+
 static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 {
-	static uchar pkt_buff[IP_PKTSIZE] __aligned(PKTALIGN);
-	static u16 first_hole, total_len;
+	struct defrag_ctx *ctx;
 	struct hole *payload, *thisfrag, *h, *newh;
-	struct ip_udp_hdr *localip = (struct ip_udp_hdr *)pkt_buff;
+	struct ip_udp_hdr *localip;
 	uchar *indata = (uchar *)ip;
 	int offset8, start, len, done = 0;
 	u16 ip_off = ntohs(ip->ip_off);
+	ulong now;
 
-	/* payload starts after IP header, this fragment is in there */
-	payload = (struct hole *)(pkt_buff + IP_HDR_SIZE);
 	offset8 =  (ip_off & IP_OFFS);
-	thisfrag = payload + offset8;
 	start = offset8 * 8;
 	len = ntohs(ip->ip_len) - IP_HDR_SIZE;
 
-	if (start + len > IP_MAXUDP) /* fragment extends too far */
+	if (start + len > IP_MAXUDP) { /* fragment extends too far */
+		defrag_stats.dropped++;
 		return NULL;
-
-	if (!total_len || localip->ip_id != ip->ip_id) {
-		/* new (or different) packet, reset structs */
-		total_len = 0xffff;
-		payload[0].last_byte = ~0;
-		payload[0].next_hole = 0;
-		payload[0].prev_hole = 0;
-		first_hole = 0;
-		/* any IP header will work, copy the first we received */
-		memcpy(localip, ip, IP_HDR_SIZE);
 	}
 
+	now = get_timer(0);
+	ctx = defrag_find(ip, now);
+	ctx->time = now;
+	localip = (struct ip_udp_hdr *)ctx->pkt_buff;
+	/* payload starts after IP header, this fragment is in there */
+	payload = (struct hole *)(ctx->pkt_buff + IP_HDR_SIZE);
+	thisfrag = payload + offset8;
+
 	/*
 	 * What follows is the reassembly algorithm. We use the payload
 	 * array as a linked list of hole descriptors, as each hole starts
@@ -804,7 +883,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 	 * so it is represented as byte count, not as 8-byte blocks.
 	 */
 
-	h = payload + first_hole;
+	h = payload + ctx->first_hole;
 	while (h->last_byte < start) {
 		if (!h->next_hole) {
 			/* no hole that far away */
@@ -821,7 +900,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 
 	if (!(ip_off & IP_FLAGS_MFRAG)) {
 		/* no more fragmentss: truncate this (last) hole */
-		total_len = start + len;
+		ctx->total_len = start + len;
 		h->last_byte = start + len;
 	}
 
@@ -838,7 +917,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 			done = 1;
 		} else if (!h->prev_hole) {
 			/* first hole */
-			first_hole = h->next_hole;
+			ctx->first_hole = h->next_hole;
 			payload[h->next_hole].prev_hole = 0;
 		} else if (!h->next_hole) {
 			/* last hole */
@@ -863,7 +942,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 		if (h->prev_hole)
 			payload[h->prev_hole].next_hole = (h - payload);
 		else
-			first_hole = (h - payload);
+			ctx->first_hole = (h - payload);
 
 	} else {
 		/* fragment sits in the middle: split the hole */
@@ -881,8 +960,10 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 	if (!done)
 		return NULL;
 
-	localip->ip_len = htons(total_len);
-	*lenp = total_len + IP_HDR_SIZE;
+	localip->ip_len = htons(ctx->total_len);
+	*lenp = ctx->total_len + IP_HDR_SIZE;
+	ctx->total_len = 0;
+	defrag_stats.reassembled++;
 	return localip;
 }
 
@@ -894,6 +975,24 @@ static inline struct ip_udp_hdr *NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 	return __NetDefragment(ip, lenp);
 }
 
+void net_defrag_get_stats(struct net_defrag_stats *st)
+{
+	int i;
+
+	*st = defrag_stats;
+	st->contexts = CONFIG_NET_DEFRAG_CONTEXTS;
+	st->in_use = 0;
+	for (i = 0; i < CONFIG_NET_DEFRAG_CONTEXTS; i++) {
+		if (defrag_ctxs[i].total_len)
+			st->in_use++;
+	}
+}
+
+void net_defrag_reset_stats(void)
+{
+	memset(&defrag_stats, 0, sizeof(defrag_stats));
+}
+
 #else /* !CONFIG_IP_DEFRAG */
 
 static inline struct ip_udp_hdr *NetDefragment(struct ip_udp_hdr *ip, int *lenp)
@@ -959,6 +1058,8 @@ NetReceive(uchar *inpkt, int len)
 	/* too small packet? */
 	if (len < ETHER_HDR_SIZE)
 		return;
+	if (eth_current)
+		eth_current->rx_packets++;
 
 #ifdef CONFIG_API
 	if (push_packet) {
@@ -1120,6 +1221,11 @@ NetReceive(uchar *inpkt, int len)
 		if (ip->ip_p == IPPROTO_ICMP) {
 			receive_icmp(ip, len, src_ip, et);
 			return;
+#ifdef CONFIG_CMD_WGET
+		} else if (ip->ip_p == IPPROTO_TCP) {
+			tcp_receive((struct ip_tcp_hdr *)ip, len, src_ip);
+			return;
+#endif
 		} else if (ip->ip_p != IPPROTO_UDP) {	/* Only UDP packets */
 			return;
 		}
@@ -1223,6 +1329,9 @@ static int net_check_prereq(enum proto_t protocol)
 #endif
 #if defined(CONFIG_CMD_NFS)
 	case NFS:
+#endif
+#if defined(CONFIG_CMD_WGET)
+	case WGET:
 #endif
 	case TFTPGET:
 	case TFTPPUT:
@@ -1299,6 +1408,25 @@ NetCksum(uchar *ptr, int len)
 	return xsum & 0xffff;
 }
 
+uint net_tcp_cksum(struct ip_tcp_hdr *ip, int len)
+{
+	ulong xsum;
+	uchar *seg = (uchar *)ip + IP_HDR_SIZE;
+	ushort last = 0;
+
+	/* pseudo header: addresses, protocol and TCP length */
+	xsum = NetCksum((uchar *)&ip->ip_src, 4);
+	xsum += htons(IPPROTO_TCP) + htons(len);
+	xsum += NetCksum(seg, len >> 1);
+	if (len & 1) {
+		*(uchar *)&last = seg[len - 1];
+		xsum += last;
+	}
+	xsum = (xsum & 0xffff) + (xsum >> 16);
+	xsum = (xsum & 0xffff) + (xsum >> 16);
+	return xsum & 0xffff;
+}
+
 int
 NetEthHdrSize(void)
 {
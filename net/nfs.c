@@ -22,10 +22,17 @@
  * possible, maximum 16 steps). There is no clearing of ".."'s inside the
  * path, so please DON'T DO THAT. thx. */
 
+/* NOTE 4: NFSv3 is used when the server offers it, falling back to NFSv2.
+ * The file is read with several READ calls in flight at once, each for its
+ * own part of the file, so that the transfer is not bound by the round
+ * trip time. Replies are matched to calls by their RPC id and stored at
+ * their offset as they arrive, in whatever order. */
+
 #include <common.h>
 #include <command.h>
 #include <net.h>
 #include <malloc.h>
+#include <asm/io.h>
 #include "nfs.h"
 #include "bootp.h"
 
@@ -37,17 +44,43 @@
 # define NFS_TIMEOUT CONFIG_NFS_TIMEOUT
 #endif
 
+#ifndef CONFIG_NFS_READ_WINDOW
+# define CONFIG_NFS_READ_WINDOW 4
+#endif
+#define NFS_MAX_READS	16	/* largest number of READs in flight */
+#define NFS_HASH_BYTES	(NFS_READ_SIZE / 2 * 10)	/* data per '#' */
+
 #define NFS_RPC_ERR	1
 #define NFS_RPC_DROP	124
 
+/* A READ call in flight, for the bytes [offset, end) of the file */
+struct nfs_read {
+	unsigned long id;	/* RPC id of the latest call */
+	unsigned offset;	/* next byte still wanted */
+	unsigned end;
+};
+
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
 static ulong nfs_timeout = NFS_TIMEOUT;
-
-static char dirfh[NFS_FHSIZE];	/* file handle of directory */
-static char filefh[NFS_FHSIZE]; /* file handle of kernel image */
+static int nfs_version;		/* protocol version in use, 2 or 3 */
+
+static char dirfh[NFS3_FHSIZE];	/* file handle of directory */
+static unsigned dirfh_len;
+static char filefh[NFS3_FHSIZE]; /* file handle of kernel image */
+static unsigned filefh_len;
+static int nfs_file_type;
+static unsigned nfs_file_size;	/* ~0 if the server did not say */
+
+static struct nfs_read nfs_reads[NFS_MAX_READS];	/* ring, oldest first */
+static int nfs_read_head;
+static int nfs_read_count;
+static unsigned nfs_window;	/* READs to keep in flight */
+static unsigned nfs_rsize;	/* bytes asked for in each READ */
+static unsigned nfs_next_offset; /* where the next READ starts */
+static unsigned nfs_done_offset; /* file stored in order up to here */
+static int nfs_hashes;
+static ulong nfs_read_start;	/* time the first READ was sent */
 
 static enum net_loop_state nfs_download_state;
 static IPaddr_t NfsServerIP;
@@ -63,6 +96,7 @@ static int	NfsState;
 #define STATE_LOOKUP_REQ		5
 #define STATE_READ_REQ			6
 #define STATE_READLINK_REQ		7
+#define STATE_FSINFO_REQ		8
 
 static char default_filename[64];
 static char *nfs_filename;
@@ -93,7 +127,10 @@ store_block(uchar *src, unsigned offset, unsigned len)
 	} else
 #endif /* CONFIG_SYS_DIRECT_FLASH_NFS */
 	{
-		(void)memcpy((void *)(load_addr + offset), src, len);
+		void *ptr = map_sysmem(load_addr + offset, len);
+
+		memcpy(ptr, src, len);
+		unmap_sysmem(ptr);
 	}
 
 	if (NetBootFileXferSize < (offset+len))
@@ -131,7 +168,7 @@ dirname(char *path)
 /**************************************************************************
 RPC_ADD_CREDENTIALS - Add RPC authentication/verifier entries
 **************************************************************************/
-static long *rpc_add_credentials(long *p)
+static uint32_t *rpc_add_credentials(uint32_t *p)
 {
 	int hl;
 	int hostnamelen;
@@ -171,6 +208,20 @@ static long *rpc_add_credentials(long *p)
 	return p;
 }
 
+/**************************************************************************
+RPC_ADD_FH - Add a file handle, which has a length only in NFSv3
+**************************************************************************/
+static uint32_t *rpc_add_fh(uint32_t *p, const char *fh, unsigned fhlen)
+{
+	if (nfs_version == 3)
+		*p++ = htonl(fhlen);
+	if (fhlen & 3)
+		*(p + fhlen / 4) = 0;
+	memcpy(p, fh, fhlen);
+
+	return p + (fhlen + 3) / 4;
+}
+
 /**************************************************************************
 RPC_LOOKUP - Lookup RPC Port numbers
 **************************************************************************/
@@ -188,7 +239,8 @@ rpc_req(int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
 	pkt.u.call.type = htonl(MSG_CALL);
 	pkt.u.call.rpcvers = htonl(2);	/* use RPC version 2 */
 	pkt.u.call.prog = htonl(rpc_prog);
-	pkt.u.call.vers = htonl(2);	/* portmapper is version 2 */
+	/* portmapper is version 2, the others follow the NFS version */
+	pkt.u.call.vers = htonl(rpc_prog == PROG_PORTMAP ? 2 : nfs_version);
 	pkt.u.call.proc = htonl(rpc_proc);
 	p = (uint32_t *)&(pkt.u.call.data);
 
@@ -243,7 +295,7 @@ nfs_mount_req(char *path)
 	pathlen = strlen(path);
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	*p++ = htonl(pathlen);
 	if (pathlen & 3)
@@ -271,7 +323,7 @@ nfs_umountall_req(void)
 		return;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
@@ -293,14 +345,13 @@ nfs_readlink_req(void)
 	int len;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
-
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = rpc_add_credentials(p);
+	p = rpc_add_fh(p, filefh, filefh_len);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_READLINK, data, len);
+	rpc_req(PROG_NFS, nfs_version == 3 ? NFS3PROC_READLINK : NFS_READLINK,
+		data, len);
 }
 
 /**************************************************************************
@@ -317,10 +368,8 @@ nfs_lookup_req(char *fname)
 	fnamelen = strlen(fname);
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
-
-	memcpy(p, dirfh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = rpc_add_credentials(p);
+	p = rpc_add_fh(p, dirfh, dirfh_len);
 	*p++ = htonl(fnamelen);
 	if (fnamelen & 3)
 		*(p + fnamelen / 4) = 0;
@@ -329,31 +378,67 @@ nfs_lookup_req(char *fname)
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_LOOKUP, data, len);
+	rpc_req(PROG_NFS, nfs_version == 3 ? NFS3PROC_LOOKUP : NFS_LOOKUP,
+		data, len);
 }
 
 /**************************************************************************
-NFS_READ - Read File on NFS Server
+NFS_FSINFO - Ask an NFSv3 server for its largest read size
 **************************************************************************/
 static void
-nfs_read_req(int offset, int readlen)
+nfs_fsinfo_req(void)
 {
 	uint32_t data[1024];
 	uint32_t *p;
 	int len;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
+	p = rpc_add_fh(p, filefh, filefh_len);
+
+	len = (uint32_t *)p - (uint32_t *)&(data[0]);
+
+	rpc_req(PROG_NFS, NFS3PROC_FSINFO, data, len);
+}
+
+/**************************************************************************
+NFS_READ - Read File on NFS Server
+**************************************************************************/
+static void
+nfs_read_req(struct nfs_read *rd)
+{
+	uint32_t data[1024];
+	uint32_t *p;
+	int len;
 
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
-	*p++ = htonl(offset);
-	*p++ = htonl(readlen);
-	*p++ = 0;
+	p = &(data[0]);
+	p = rpc_add_credentials(p);
+	p = rpc_add_fh(p, filefh, filefh_len);
+	if (nfs_version == 3)
+		*p++ = 0;		/* upper half of the 64-bit offset */
+	*p++ = htonl(rd->offset);
+	*p++ = htonl(rd->end - rd->offset);
+	if (nfs_version == 2)
+		*p++ = 0;		/* unused totalcount */
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
 	rpc_req(PROG_NFS, NFS_READ, data, len);
+	rd->id = rpc_id;
+}
+
+/* Send again each READ that has not been answered in full */
+static void
+nfs_read_resend(void)
+{
+	struct nfs_read *rd;
+	int i;
+
+	for (i = 0; i < nfs_read_count; i++) {
+		rd = &nfs_reads[(nfs_read_head + i) % NFS_MAX_READS];
+		if (rd->offset < rd->end)
+			nfs_read_req(rd);
+	}
 }
 
 /**************************************************************************
@@ -367,10 +452,10 @@ NfsSend(void)
 
 	switch (NfsState) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
-		rpc_lookup_req(PROG_MOUNT, 1);
+		rpc_lookup_req(PROG_MOUNT, nfs_version == 3 ? 3 : 1);
 		break;
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
-		rpc_lookup_req(PROG_NFS, 2);
+		rpc_lookup_req(PROG_NFS, nfs_version);
 		break;
 	case STATE_MOUNT_REQ:
 		nfs_mount_req(nfs_path);
@@ -381,8 +466,11 @@ NfsSend(void)
 	case STATE_LOOKUP_REQ:
 		nfs_lookup_req(nfs_filename);
 		break;
+	case STATE_FSINFO_REQ:
+		nfs_fsinfo_req();
+		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_resend();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -394,6 +482,12 @@ NfsSend(void)
 Handlers for the reply from server
 **************************************************************************/
 
+/* Skip the attributes in an NFSv3 reply, which are present if *p is set */
+static uint32_t *nfs3_skip_attr(uint32_t *p)
+{
+	return p + 1 + (*p ? NFS3_FATTR_WORDS : 0);
+}
+
 static int
 rpc_lookup_reply(int prog, uchar *pkt, unsigned len)
 {
@@ -445,8 +539,16 @@ nfs_mount_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
+	if (nfs_version == 3) {
+		dirfh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (dirfh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 2, dirfh_len);
+	} else {
+		dirfh_len = NFS_FHSIZE;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	}
 	fs_mounted = 1;
-	memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
 
 	return 0;
 }
@@ -480,6 +582,54 @@ static int
 nfs_lookup_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	uint32_t *p;
+
+	debug("%s\n", __func__);
+
+	memcpy((unsigned char *)&rpc_pkt, pkt, len);
+
+	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
+		return -NFS_RPC_ERR;
+	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+		return -NFS_RPC_DROP;
+
+	if (rpc_pkt.u.reply.rstatus  ||
+	    rpc_pkt.u.reply.verifier ||
+	    rpc_pkt.u.reply.astatus  ||
+	    rpc_pkt.u.reply.data[0])
+		return -1;
+
+	/* the file handle is followed by the file's attributes */
+	nfs_file_type = NFREG;
+	nfs_file_size = ~0U;
+	if (nfs_version == 3) {
+		filefh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (filefh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(filefh, rpc_pkt.u.reply.data + 2, filefh_len);
+		p = rpc_pkt.u.reply.data + 2 + (filefh_len + 3) / 4;
+		if (!*p++)
+			return 0;
+		if (p[5])	/* upper half of the 64-bit size */
+			return -1;
+		nfs_file_size = ntohl(p[6]);
+	} else {
+		filefh_len = NFS_FHSIZE;
+		memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+		p = rpc_pkt.u.reply.data + 1 + NFS_FHSIZE / 4;
+		nfs_file_size = ntohl(p[5]);
+	}
+	nfs_file_type = ntohl(p[0]);
+
+	return 0;
+}
+
+static int
+nfs_fsinfo_reply(uchar *pkt, unsigned len)
+{
+	struct rpc_t rpc_pkt;
+	uint32_t *p;
+	unsigned rtmax;
 
 	debug("%s\n", __func__);
 
@@ -496,7 +646,10 @@ nfs_lookup_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	p = nfs3_skip_attr(rpc_pkt.u.reply.data + 1);
+	rtmax = ntohl(p[0]);
+	if (rtmax && rtmax < nfs_rsize)
+		nfs_rsize = rtmax;
 
 	return 0;
 }
@@ -505,6 +658,7 @@ static int
 nfs_readlink_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	uint32_t *p;
 	int rlen;
 
 	debug("%s\n", __func__);
@@ -522,35 +676,69 @@ nfs_readlink_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	rlen = ntohl(rpc_pkt.u.reply.data[1]); /* new path length */
+	p = rpc_pkt.u.reply.data + 1;
+	if (nfs_version == 3)
+		p = nfs3_skip_attr(p);
+	rlen = ntohl(p[0]); /* new path length */
 
-	if (*((char *)&(rpc_pkt.u.reply.data[2])) != '/') {
+	if (*((char *)&p[1]) != '/') {
 		int pathlen;
 		strcat(nfs_path, "/");
 		pathlen = strlen(nfs_path);
-		memcpy(nfs_path + pathlen, (uchar *)&(rpc_pkt.u.reply.data[2]),
-			rlen);
+		memcpy(nfs_path + pathlen, (uchar *)&p[1], rlen);
 		nfs_path[pathlen + rlen] = 0;
 	} else {
-		memcpy(nfs_path, (uchar *)&(rpc_pkt.u.reply.data[2]), rlen);
+		memcpy(nfs_path, (uchar *)&p[1], rlen);
 		nfs_path[rlen] = 0;
 	}
 	return 0;
 }
 
+static struct nfs_read *
+nfs_find_read(unsigned long id)
+{
+	struct nfs_read *rd;
+	int i;
+
+	for (i = 0; i < nfs_read_count; i++) {
+		rd = &nfs_reads[(nfs_read_head + i) % NFS_MAX_READS];
+		if (rd->id == id && rd->offset < rd->end)
+			return rd;
+	}
+
+	return NULL;
+}
+
+/* The file turned out to end at @size: stop reading beyond it */
+static void
+nfs_read_truncate(unsigned size)
+{
+	struct nfs_read *rd;
+	int i;
+
+	nfs_file_size = size;
+	nfs_next_offset = min(nfs_next_offset, size);
+	for (i = 0; i < nfs_read_count; i++) {
+		rd = &nfs_reads[(nfs_read_head + i) % NFS_MAX_READS];
+		rd->end = max(rd->offset, min(rd->end, size));
+	}
+}
+
 static int
 nfs_read_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
+	struct nfs_read *rd;
+	uint32_t *p;
+	unsigned rlen, hlen;
+	int eof = 0;
 
 	debug("%s\n", __func__);
 
-	memcpy((uchar *)&rpc_pkt, pkt, sizeof(rpc_pkt.u.reply));
+	memcpy((uchar *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt.u.reply)));
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	rd = nfs_find_read(ntohl(rpc_pkt.u.reply.id));
+	if (!rd)
 		return -NFS_RPC_DROP;
 
 	if (rpc_pkt.u.reply.rstatus  ||
@@ -564,20 +752,120 @@ nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
+	if (nfs_version == 3) {
+		p = nfs3_skip_attr(rpc_pkt.u.reply.data + 1);
+		rlen = ntohl(p[0]);
+		eof = ntohl(p[1]);
+		p += 3;		/* count, eof and the length of the data */
+	} else {
+		p = rpc_pkt.u.reply.data + 1 + NFS_FATTR_WORDS;
+		rlen = ntohl(*p++);
+	}
+	hlen = (uchar *)p - (uchar *)&rpc_pkt;
+	if (hlen + rlen > len || rlen > rd->end - rd->offset)
+		return -NFS_RPC_DROP;
 
-	rlen = ntohl(rpc_pkt.u.reply.data[18]);
-	if (store_block((uchar *)pkt + sizeof(rpc_pkt.u.reply),
-			nfs_offset, rlen))
+	if (store_block(pkt + hlen, rd->offset, rlen))
 		return -9999;
+	rd->offset += rlen;
+
+	if (!rlen || (eof && rd->offset < rd->end))
+		nfs_read_truncate(rd->offset);
+	else if (rd->offset < rd->end)
+		nfs_read_req(rd);	/* short read, ask for the rest */
 
 	return rlen;
 }
 
+/* Print a '#' for each NFS_HASH_BYTES of the file stored in order */
+static void
+nfs_show_progress(unsigned from, unsigned to)
+{
+	unsigned marks = to / NFS_HASH_BYTES - from / NFS_HASH_BYTES;
+
+	if (!from && to)
+		marks++;
+	for (; marks; marks--) {
+		putc('#');
+		if (++nfs_hashes == HASHES_PER_LINE) {
+			puts("\n\t ");
+			nfs_hashes = 0;
+		}
+	}
+}
+
+/*
+ * Retire the READs that are complete in order and keep the window full.
+ * Returns 1 once the whole file has been read.
+ */
+static int
+nfs_read_advance(void)
+{
+	unsigned done = nfs_done_offset;
+	struct nfs_read *rd;
+
+	while (nfs_read_count) {
+		rd = &nfs_reads[nfs_read_head];
+		if (rd->offset < rd->end)
+			break;
+		nfs_done_offset = max(nfs_done_offset,
+				      min(rd->end, nfs_file_size));
+		nfs_read_head = (nfs_read_head + 1) % NFS_MAX_READS;
+		nfs_read_count--;
+	}
+	if (nfs_done_offset > done)
+		nfs_show_progress(done, nfs_done_offset);
+
+	while (nfs_read_count < nfs_window &&
+	       nfs_next_offset < nfs_file_size) {
+		rd = &nfs_reads[(nfs_read_head + nfs_read_count++) %
+				NFS_MAX_READS];
+		rd->offset = nfs_next_offset;
+		rd->end = rd->offset + min(nfs_rsize,
+					   nfs_file_size - rd->offset);
+		nfs_next_offset = rd->end;
+		nfs_read_req(rd);
+	}
+
+	return !nfs_read_count;
+}
+
+/* The whole file has been read: report the rate and unmount */
+static void
+nfs_read_done(void)
+{
+	ulong time = get_timer(nfs_read_start);
+
+	if (time > 0) {
+		puts("\n\t ");	/* Line up with "Loading: " */
+		print_size(NetBootFileXferSize / time * 1000, "/s");
+	}
+	nfs_download_state = NETLOOP_SUCCESS;
+	NfsState = STATE_UMOUNT_REQ;
+	NfsSend();
+}
+
+/* Start reading the file, or follow it if it is a symbolic link */
+static void
+nfs_start_read(void)
+{
+	if (nfs_file_type == NFLNK) {
+		NfsState = STATE_READLINK_REQ;
+		NfsSend();
+		return;
+	}
+
+	NfsState = STATE_READ_REQ;
+	nfs_read_head = 0;
+	nfs_read_count = 0;
+	nfs_next_offset = 0;
+	nfs_done_offset = 0;
+	nfs_hashes = 0;
+	nfs_read_start = get_timer(0);
+	if (nfs_read_advance())
+		nfs_read_done();
+}
+
 /**************************************************************************
 Interfaces of U-BOOT
 **************************************************************************/
@@ -611,6 +899,12 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
 		if (rpc_lookup_reply(PROG_MOUNT, pkt, len) == -NFS_RPC_DROP)
 			break;
+		if (!NfsSrvMountPort && nfs_version == 3) {
+			/* no NFSv3 on the server, so fall back to NFSv2 */
+			nfs_version = 2;
+			NfsSend();
+			break;
+		}
 		NfsState = STATE_PRCLOOKUP_PROG_NFS_REQ;
 		NfsSend();
 		break;
@@ -618,6 +912,12 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
 		if (rpc_lookup_reply(PROG_NFS, pkt, len) == -NFS_RPC_DROP)
 			break;
+		if (!NfsSrvNfsPort && nfs_version == 3) {
+			nfs_version = 2;
+			NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+			NfsSend();
+			break;
+		}
 		NfsState = STATE_MOUNT_REQ;
 		NfsSend();
 		break;
@@ -658,14 +958,25 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 			puts("*** ERROR: File lookup fail\n");
 			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
-		} else {
-			NfsState = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
+		} else if (nfs_version == 3 && nfs_file_type != NFLNK) {
+			nfs_rsize = NFS_READ_SIZE;
+			NfsState = STATE_FSINFO_REQ;
 			NfsSend();
+		} else {
+			nfs_rsize = min(NFS_READ_SIZE, NFS_MAXDATA);
+			nfs_start_read();
 		}
 		break;
 
+	case STATE_FSINFO_REQ:
+		reply = nfs_fsinfo_reply(pkt, len);
+		if (reply == -NFS_RPC_DROP)
+			break;
+		/* without an answer, keep to the size we would ask for */
+		debug("NFSv3 read size %u\n", nfs_rsize);
+		nfs_start_read();
+		break;
+
 	case STATE_READLINK_REQ:
 		reply = nfs_readlink_reply(pkt, len);
 		if (reply == -NFS_RPC_DROP)
@@ -686,17 +997,19 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 
 	case STATE_READ_REQ:
 		rlen = nfs_read_reply(pkt, len);
+		if (rlen == -NFS_RPC_DROP)
+			break;
 		NetSetTimeout(nfs_timeout, NfsTimeout);
-		if (rlen > 0) {
-			nfs_offset += rlen;
-			NfsSend();
+		if (rlen >= 0) {
+			/* the server is answering, so restart the retry count */
+			NfsTimeoutCount = 0;
+			if (nfs_read_advance())
+				nfs_read_done();
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			NfsState = STATE_READLINK_REQ;
 			NfsSend();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
 			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
 		}
@@ -775,6 +1088,9 @@ NfsStart(void)
 
 	NfsTimeoutCount = 0;
 	NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+	nfs_version = 3;
+	nfs_window = getenv_ulong("nfswindowsize", 10, CONFIG_NFS_READ_WINDOW);
+	nfs_window = max(1U, min(nfs_window, (unsigned)NFS_MAX_READS));
 
 	/*NfsOurPort = 4096 + (get_ticks() % 3072);*/
 	/*FIX ME !!!*/
@@ -25,7 +25,23 @@
 #define NFS_READLINK    5
 #define NFS_READ        6
 
+#define NFS3PROC_LOOKUP		3
+#define NFS3PROC_READLINK	5
+#define NFS3PROC_READ		6
+#define NFS3PROC_FSINFO		19
+
 #define NFS_FHSIZE      32
+#define NFS3_FHSIZE	64
+
+#define NFS_MAXDATA	8192	/* largest NFSv2 READ */
+
+/* File types in attributes, the same in NFSv2 and NFSv3 */
+#define NFREG		1
+#define NFLNK		5
+
+/* Size in words of file attributes; the file size starts at word 5 */
+#define NFS_FATTR_WORDS		17
+#define NFS3_FATTR_WORDS	21
 
 #define NFSERR_PERM     1
 #define NFSERR_NOENT    2
@@ -37,6 +53,8 @@
  * headers) must fit within a single Ethernet frame to avoid fragmentation.
  * However, if CONFIG_IP_DEFRAG is set, the config file may want to use a
  * bigger value. In any case, most NFS servers are optimized for a power of 2.
+ * With NFSv3 this is lowered to the largest read the server allows; NFSv2
+ * reads are limited to NFS_MAXDATA.
  */
 #ifdef CONFIG_NFS_READ_SIZE
 #define NFS_READ_SIZE CONFIG_NFS_READ_SIZE
@@ -65,7 +83,7 @@ struct rpc_t {
 			uint32_t verifier;
 			uint32_t v2;
 			uint32_t astatus;
-			uint32_t data[19];
+			uint32_t data[26];	/* up to NFSv3 READ data */
 		} reply;
 	} u;
 };
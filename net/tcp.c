@@ -0,0 +1,635 @@
+/*
+ * Minimal TCP for downloads
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * This is a client-side TCP (RFC 793) with a single connection, aimed at
+ * fetching large files at the speed of the link:
+ *
+ *  - Received data is passed to the application as it arrives, so that it
+ *    can be written straight to its destination. Since nothing is
+ *    buffered here, a large receive window can be offered using window
+ *    scaling (RFC 7323). Data arriving after a lost segment is kept, and
+ *    acknowledged as soon as the gap is filled.
+ *  - ACKs are delayed (RFC 1122, RFC 5681): every second segment is
+ *    acknowledged at once, a lone segment after TCP_DELACK_MS.
+ *    Out-of-order and duplicate segments are acknowledged at once so that
+ *    the sender sees duplicate ACKs and retransmits the missing segment
+ *    without waiting for its timer. There is no SACK.
+ *  - Our own data is retransmitted on a timer set from the measured round
+ *    trip time (RFC 6298), or after three duplicate ACKs.
+ *
+ * Our own sending is limited to small requests, so it has no congestion
+ * control, and TIME-WAIT is not implemented.
+ */
+
+#include <common.h>
+#include <net.h>
+#include <asm/unaligned.h>
+#include "tcp.h"
+
+#define TCP_MSS		(1500 - IP_TCP_HDR_SIZE)	/* Ethernet MTU */
+#define TCP_MIN_MSS	536		/* MSS if the peer gives none */
+#define TCP_TICK_MS	10		/* resolution of our timers */
+#define TCP_DELACK_MS	40		/* longest delay before an ACK */
+#define TCP_RTO_INIT	1000		/* retransmit timeouts in ms */
+#define TCP_RTO_MIN	200
+#define TCP_RTO_MAX	8000
+#define TCP_RETRIES	8		/* retransmissions before giving up */
+#define TCP_IDLE_MS	30000		/* give up if the peer goes quiet */
+#define TCP_SNDBUF	2048		/* our data not yet acknowledged */
+#define TCP_OOO_MAX	8		/* out-of-order ranges remembered */
+#define TCP_DUPACKS	3		/* duplicate ACKs to retransmit */
+
+/* TCP options */
+#define TCPOPT_EOL	0
+#define TCPOPT_NOP	1
+#define TCPOPT_MSS	2
+#define TCPOPT_WSCALE	3
+
+/* Compare sequence numbers, allowing for wrap-around */
+#define SEQ_LT(a, b)	((int)((a) - (b)) < 0)
+#define SEQ_LEQ(a, b)	((int)((a) - (b)) <= 0)
+
+enum tcp_state {
+	TCP_CLOSED,
+	TCP_SYN_SENT,
+	TCP_ESTABLISHED,
+	TCP_FIN_WAIT_1,
+	TCP_FIN_WAIT_2,
+	TCP_CLOSE_WAIT,
+	TCP_CLOSING,
+	TCP_LAST_ACK,
+};
+
+/* Part of the stream received out of order */
+struct tcp_range {
+	u32 start;
+	u32 end;
+};
+
+static struct tcp_conn {
+	enum tcp_state state;
+	IPaddr_t remote_ip;
+	unsigned remote_port;
+	unsigned local_port;
+	uchar ether[6];		/* MAC address of peer or gateway */
+	tcp_rx_f *rx;
+	tcp_event_f *event;
+
+	/* sending */
+	u32 iss;		/* our initial sequence number */
+	u32 snd_una;		/* oldest unacknowledged sequence number */
+	u32 snd_nxt;		/* next sequence number to send */
+	u32 snd_wnd;		/* window offered by the peer */
+	unsigned snd_mss;	/* largest segment the peer accepts */
+	int snd_wscale;		/* scale of the peer's window */
+	unsigned dupacks;	/* duplicate ACKs seen in a row */
+	uchar sndbuf[TCP_SNDBUF];
+	u32 buf_seq;		/* sequence number of sndbuf[0] */
+	unsigned snd_len;	/* bytes in sndbuf */
+	int fin_queued;		/* FIN follows the data in sndbuf */
+
+	/* retransmission timer (RFC 6298) */
+	ulong rto;		/* timeout in ms */
+	ulong rto_deadline;	/* when it expires, 0 if not running */
+	int retries;		/* retransmissions without progress */
+	int rtt_active;		/* timing a segment */
+	u32 rtt_seq;		/* ACK that ends the timing */
+	ulong rtt_start;
+	int rtt_samples;
+	long srtt;		/* smoothed round trip time in ms */
+	long rttvar;		/* round trip time variation in ms */
+
+	/* receiving */
+	u32 irs;		/* peer's initial sequence number */
+	u32 rcv_nxt;		/* next sequence number expected */
+	u32 rcv_wnd;		/* window we offer */
+	int rcv_wscale;		/* scale of the window we offer */
+	int fin_rcvd;		/* peer has sent FIN */
+	unsigned unacked_segs;	/* segments received since our last ACK */
+	ulong delack_deadline;	/* when an ACK is due, 0 if none */
+	ulong last_rx;		/* when a segment last arrived */
+	struct tcp_range ooo[TCP_OOO_MAX];	/* sorted, not touching */
+	int ooo_count;
+
+	/* statistics */
+	ulong segs_in;		/* segments received */
+	ulong segs_ooo;		/* segments received out of order */
+	ulong segs_dup;		/* segments received twice */
+	ulong acks_out;		/* pure ACKs sent */
+	ulong retrans;		/* segments retransmitted */
+} tcp;
+
+static void tcp_send_segment(u32 seq, uchar flags, const uchar *data,
+			     unsigned len)
+{
+	struct ip_tcp_hdr *ip;
+	uchar *opt;
+	unsigned optlen = 0, seglen;
+
+	ip = (struct ip_tcp_hdr *)(NetTxPacket + NetEthHdrSize());
+	opt = (uchar *)ip + IP_TCP_HDR_SIZE;
+	if (flags & TCP_SYN) {
+		opt[0] = TCPOPT_MSS;
+		opt[1] = 4;
+		put_unaligned_be16(TCP_MSS, opt + 2);
+		opt[4] = TCPOPT_NOP;
+		opt[5] = TCPOPT_WSCALE;
+		opt[6] = 3;
+		opt[7] = tcp.rcv_wscale;
+		optlen = 8;
+	}
+	if (len)
+		memcpy(opt + optlen, data, len);
+	seglen = TCP_HDR_SIZE + optlen + len;
+
+	net_set_ip_header((uchar *)ip, tcp.remote_ip, NetOurIP);
+	ip->ip_len = htons(IP_HDR_SIZE + seglen);
+	ip->ip_p = IPPROTO_TCP;
+	ip->ip_sum = ~NetCksum((uchar *)ip, IP_HDR_SIZE >> 1);
+
+	ip->tcp_src = htons(tcp.local_port);
+	ip->tcp_dst = htons(tcp.remote_port);
+	put_unaligned_be32(seq, &ip->tcp_seq);
+	put_unaligned_be32(flags & TCP_ACK ? tcp.rcv_nxt : 0, &ip->tcp_ack);
+	ip->tcp_hlen = (TCP_HDR_SIZE + optlen) << 2;
+	ip->tcp_flags = flags;
+	/* the window in a SYN is never scaled */
+	if (flags & TCP_SYN)
+		ip->tcp_win = htons(min(tcp.rcv_wnd, 0xffffU));
+	else
+		ip->tcp_win = htons(tcp.rcv_wnd >> tcp.rcv_wscale);
+	ip->tcp_urg = 0;
+	ip->tcp_xsum = 0;
+	ip->tcp_xsum = ~net_tcp_cksum(ip, seglen);
+
+	/* every segment we send acknowledges what we have received */
+	if (flags & TCP_ACK) {
+		tcp.unacked_segs = 0;
+		tcp.delack_deadline = 0;
+	}
+	net_send_ip_packet(tcp.ether, tcp.remote_ip, IP_HDR_SIZE + seglen);
+}
+
+static void tcp_send_ack(void)
+{
+	tcp.acks_out++;
+	tcp_send_segment(tcp.snd_nxt, TCP_ACK, NULL, 0);
+}
+
+/*
+ * Send the segment starting at @seq, with at most @room bytes of data.
+ * This returns the amount of sequence space it used, 0 if there is
+ * nothing to send there.
+ */
+static unsigned tcp_send_seq(u32 seq, unsigned room)
+{
+	u32 end = tcp.buf_seq + tcp.snd_len;
+	unsigned len;
+
+	if (tcp.state == TCP_SYN_SENT) {
+		if (seq != tcp.iss)
+			return 0;
+		tcp_send_segment(tcp.iss, TCP_SYN, NULL, 0);
+		return 1;
+	}
+	if (SEQ_LT(seq, end)) {
+		len = min(min(end - seq, (u32)tcp.snd_mss), (u32)room);
+		if (len)
+			tcp_send_segment(seq, TCP_ACK | TCP_PUSH,
+					 tcp.sndbuf + (seq - tcp.buf_seq), len);
+		return len;
+	}
+	if (tcp.fin_queued && seq == end) {
+		tcp_send_segment(seq, TCP_ACK | TCP_FIN, NULL, 0);
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Send any new data, and then FIN, that the peer's window allows */
+static void tcp_output(void)
+{
+	u32 wnd_end;
+	unsigned sent;
+
+	for (;;) {
+		wnd_end = tcp.snd_una + tcp.snd_wnd;
+		sent = tcp_send_seq(tcp.snd_nxt, SEQ_LT(tcp.snd_nxt, wnd_end) ?
+				    wnd_end - tcp.snd_nxt : 0);
+		if (!sent)
+			break;
+		if (!tcp.rtt_active) {
+			tcp.rtt_active = 1;
+			tcp.rtt_seq = tcp.snd_nxt + sent;
+			tcp.rtt_start = get_timer(0);
+		}
+		tcp.snd_nxt += sent;
+		if (!tcp.rto_deadline)
+			tcp.rto_deadline = get_timer(0) + tcp.rto;
+	}
+}
+
+static void tcp_stop(void)
+{
+	tcp.state = TCP_CLOSED;
+	NetSetTimeout(0, NULL);
+}
+
+static void tcp_fail(enum tcp_event event)
+{
+	tcp_stop();
+	tcp.event(event);
+}
+
+static void tcp_rtt_sample(long rtt)
+{
+	if (!tcp.rtt_samples++) {
+		tcp.srtt = rtt;
+		tcp.rttvar = rtt / 2;
+	} else {
+		tcp.rttvar = (3 * tcp.rttvar + abs(tcp.srtt - rtt)) / 4;
+		tcp.srtt = (7 * tcp.srtt + rtt) / 8;
+	}
+	tcp.rto = tcp.srtt + max(4 * tcp.rttvar, (long)TCP_TICK_MS);
+	tcp.rto = min(max(tcp.rto, (ulong)TCP_RTO_MIN), (ulong)TCP_RTO_MAX);
+}
+
+static void tcp_tick(void)
+{
+	ulong now = get_timer(0);
+
+	if (tcp.delack_deadline && now >= tcp.delack_deadline)
+		tcp_send_ack();
+
+	if (tcp.rto_deadline && now >= tcp.rto_deadline) {
+		if (++tcp.retries > TCP_RETRIES) {
+			tcp_fail(TCP_EV_TIMEOUT);
+			return;
+		}
+		/* go back to the oldest unacknowledged segment (Karn) */
+		tcp.rtt_active = 0;
+		tcp.dupacks = 0;
+		tcp.snd_nxt = tcp.snd_una;
+		tcp.snd_nxt += tcp_send_seq(tcp.snd_una, tcp.snd_mss);
+		tcp.retrans++;
+		tcp.rto = min(tcp.rto * 2, (ulong)TCP_RTO_MAX);
+		tcp.rto_deadline = now + tcp.rto;
+	} else if (!tcp.rto_deadline && now - tcp.last_rx > TCP_IDLE_MS) {
+		tcp_fail(TCP_EV_TIMEOUT);
+		return;
+	}
+
+	NetSetTimeout(TCP_TICK_MS, tcp_tick);
+}
+
+static void tcp_parse_syn_options(uchar *opt, int len)
+{
+	int wscale = -1;
+
+	tcp.snd_mss = TCP_MIN_MSS;
+	while (len > 0 && opt[0] != TCPOPT_EOL) {
+		if (opt[0] == TCPOPT_NOP) {
+			opt++;
+			len--;
+			continue;
+		}
+		if (len < 2 || opt[1] < 2 || opt[1] > len)
+			break;
+		if (opt[0] == TCPOPT_MSS && opt[1] == 4)
+			tcp.snd_mss = min(get_unaligned_be16(opt + 2),
+					  (u16)TCP_MSS);
+		else if (opt[0] == TCPOPT_WSCALE && opt[1] == 3)
+			wscale = min(opt[2], (uchar)14);
+		len -= opt[1];
+		opt += opt[1];
+	}
+
+	/* window scaling is only used if both sides ask for it */
+	if (wscale < 0) {
+		tcp.snd_wscale = 0;
+		tcp.rcv_wscale = 0;
+	} else {
+		tcp.snd_wscale = wscale;
+	}
+	tcp.rcv_wnd = min((u32)CONFIG_TCP_WINDOW, 0xffffU << tcp.rcv_wscale);
+}
+
+/* Remember that [start, end) has been received out of order */
+static void tcp_ooo_add(u32 start, u32 end)
+{
+	struct tcp_range *r = tcp.ooo;
+	int i, j;
+
+	for (i = 0; i < tcp.ooo_count && SEQ_LT(r[i].end, start); i++)
+		;
+	/* merge with every range this overlaps or touches */
+	for (j = i; j < tcp.ooo_count && SEQ_LEQ(r[j].start, end); j++) {
+		if (SEQ_LT(r[j].start, start))
+			start = r[j].start;
+		if (SEQ_LT(end, r[j].end))
+			end = r[j].end;
+	}
+	if (j == i) {
+		/* if there is no room the sender will send it again */
+		if (tcp.ooo_count == TCP_OOO_MAX)
+			return;
+		memmove(&r[i + 1], &r[i], (tcp.ooo_count - i) * sizeof(*r));
+		tcp.ooo_count++;
+	} else {
+		memmove(&r[i + 1], &r[j], (tcp.ooo_count - j) * sizeof(*r));
+		tcp.ooo_count -= j - i - 1;
+	}
+	r[i].start = start;
+	r[i].end = end;
+}
+
+/* Move rcv_nxt past data already received out of order */
+static void tcp_ooo_advance(void)
+{
+	while (tcp.ooo_count && SEQ_LEQ(tcp.ooo[0].start, tcp.rcv_nxt)) {
+		if (SEQ_LT(tcp.rcv_nxt, tcp.ooo[0].end))
+			tcp.rcv_nxt = tcp.ooo[0].end;
+		tcp.ooo_count--;
+		memmove(&tcp.ooo[0], &tcp.ooo[1],
+			tcp.ooo_count * sizeof(tcp.ooo[0]));
+	}
+}
+
+static void tcp_ack_received(u32 ack, u32 wnd, int has_payload)
+{
+	unsigned acked;
+
+	/* ignore an ACK for something we have not sent */
+	if (SEQ_LT(tcp.snd_nxt, ack))
+		return;
+
+	if (SEQ_LT(tcp.snd_una, ack)) {
+		if (tcp.rtt_active && SEQ_LEQ(tcp.rtt_seq, ack)) {
+			tcp.rtt_active = 0;
+			tcp_rtt_sample(get_timer(tcp.rtt_start));
+		}
+		acked = min(ack - tcp.buf_seq, (u32)tcp.snd_len);
+		tcp.snd_len -= acked;
+		memmove(tcp.sndbuf, tcp.sndbuf + acked, tcp.snd_len);
+		tcp.buf_seq += acked;
+		tcp.snd_una = ack;
+		tcp.snd_wnd = wnd;
+		tcp.dupacks = 0;
+		tcp.retries = 0;
+		tcp.rto_deadline = ack == tcp.snd_nxt ? 0 :
+			get_timer(0) + tcp.rto;
+
+		/* FIN is the last thing in the sequence space */
+		if (tcp.fin_queued && ack == tcp.snd_nxt && !tcp.snd_len &&
+		    ack == tcp.buf_seq + 1) {
+			if (tcp.state == TCP_FIN_WAIT_1) {
+				tcp.state = TCP_FIN_WAIT_2;
+			} else {
+				/* CLOSING or LAST_ACK, so both sides are done */
+				tcp_stop();
+			}
+			tcp.event(TCP_EV_CLOSED);
+		}
+		return;
+	}
+
+	/* fast retransmit (RFC 5681) */
+	if (ack == tcp.snd_una && tcp.snd_una != tcp.snd_nxt &&
+	    !has_payload && wnd == tcp.snd_wnd &&
+	    ++tcp.dupacks == TCP_DUPACKS) {
+		tcp.rtt_active = 0;
+		tcp_send_seq(tcp.snd_una, tcp.snd_mss);
+		tcp.retrans++;
+	}
+	tcp.snd_wnd = wnd;
+}
+
+static void tcp_data(u32 seq, uchar *data, unsigned len)
+{
+	u32 skip, wnd_end = tcp.rcv_nxt + tcp.rcv_wnd;
+	int had_ooo = tcp.ooo_count;
+
+	/* drop what we already have */
+	if (SEQ_LT(seq, tcp.rcv_nxt)) {
+		skip = tcp.rcv_nxt - seq;
+		if (skip >= len) {
+			/* probably our ACK was lost, so send another */
+			tcp.segs_dup++;
+			tcp_send_ack();
+			return;
+		}
+		seq += skip;
+		data += skip;
+		len -= skip;
+	}
+	/* and anything beyond the window */
+	if (!SEQ_LT(seq, wnd_end)) {
+		tcp_send_ack();
+		return;
+	}
+	len = min(len, wnd_end - seq);
+
+	if (seq != tcp.rcv_nxt) {
+		/* keep it if we can, and send a duplicate ACK at once */
+		tcp.segs_ooo++;
+		if (!tcp.rx(seq - tcp.irs - 1, data, len))
+			tcp_ooo_add(seq, seq + len);
+		if (tcp.state != TCP_CLOSED)
+			tcp_send_ack();
+		return;
+	}
+
+	tcp.rx(seq - tcp.irs - 1, data, len);
+	if (tcp.state == TCP_CLOSED)
+		return;
+	tcp.rcv_nxt += len;
+	tcp_ooo_advance();
+
+	/* ACK every second segment, and at once if a gap was filled */
+	if (had_ooo || ++tcp.unacked_segs >= 2)
+		tcp_send_ack();
+	else if (!tcp.delack_deadline)
+		tcp.delack_deadline = get_timer(0) + TCP_DELACK_MS;
+	tcp.event(TCP_EV_DATA);
+}
+
+static void tcp_fin(u32 seq)
+{
+	if (tcp.fin_rcvd) {
+		tcp_send_ack();
+		return;
+	}
+	/* wait for the data before it */
+	if (seq != tcp.rcv_nxt)
+		return;
+
+	tcp.fin_rcvd = 1;
+	tcp.rcv_nxt++;
+	tcp_send_ack();
+	switch (tcp.state) {
+	case TCP_ESTABLISHED:
+		tcp.state = TCP_CLOSE_WAIT;
+		tcp.event(TCP_EV_PEER_CLOSED);
+		break;
+	case TCP_FIN_WAIT_1:
+		tcp.state = TCP_CLOSING;
+		break;
+	case TCP_FIN_WAIT_2:
+		tcp_stop();
+		break;
+	default:
+		break;
+	}
+}
+
+void tcp_receive(struct ip_tcp_hdr *ip, unsigned len, IPaddr_t src_ip)
+{
+	unsigned hlen, dlen;
+	uchar flags, *data;
+	u32 seq, ack;
+
+	if (tcp.state == TCP_CLOSED || len < IP_TCP_HDR_SIZE ||
+	    src_ip != tcp.remote_ip ||
+	    ntohs(ip->tcp_src) != tcp.remote_port ||
+	    ntohs(ip->tcp_dst) != tcp.local_port)
+		return;
+	hlen = (ip->tcp_hlen >> 4) * 4;
+	if (hlen < TCP_HDR_SIZE || IP_HDR_SIZE + hlen > len)
+		return;
+	if (net_tcp_cksum(ip, len - IP_HDR_SIZE) != 0xffff) {
+		debug("tcp: bad checksum\n");
+		return;
+	}
+
+	tcp.segs_in++;
+	tcp.last_rx = get_timer(0);
+	seq = get_unaligned_be32(&ip->tcp_seq);
+	ack = get_unaligned_be32(&ip->tcp_ack);
+	flags = ip->tcp_flags;
+	data = (uchar *)ip + IP_HDR_SIZE + hlen;
+	dlen = len - IP_HDR_SIZE - hlen;
+
+	if (tcp.state == TCP_SYN_SENT) {
+		if (!(flags & TCP_ACK) || ack != tcp.iss + 1)
+			return;
+		if (flags & TCP_RST) {
+			tcp_fail(TCP_EV_RESET);
+			return;
+		}
+		if (!(flags & TCP_SYN))
+			return;
+		tcp_parse_syn_options((uchar *)ip + IP_TCP_HDR_SIZE,
+				      hlen - TCP_HDR_SIZE);
+		tcp.irs = seq;
+		tcp.rcv_nxt = seq + 1;
+		tcp.snd_una = ack;
+		tcp.buf_seq = ack;
+		tcp.snd_wnd = ntohs(ip->tcp_win);
+		tcp.state = TCP_ESTABLISHED;
+		tcp.rto_deadline = 0;
+		tcp.retries = 0;
+		if (tcp.rtt_active) {
+			tcp.rtt_active = 0;
+			tcp_rtt_sample(get_timer(tcp.rtt_start));
+		}
+		tcp_send_ack();
+		tcp.event(TCP_EV_ESTABLISHED);
+		return;
+	}
+
+	if (flags & TCP_RST) {
+		if (SEQ_LEQ(tcp.rcv_nxt, seq) &&
+		    SEQ_LT(seq, tcp.rcv_nxt + tcp.rcv_wnd))
+			tcp_fail(TCP_EV_RESET);
+		return;
+	}
+	/* a repeated SYN means our ACK of it was lost */
+	if ((flags & TCP_SYN) || !(flags & TCP_ACK)) {
+		tcp_send_ack();
+		return;
+	}
+
+	tcp_ack_received(ack, ntohs(ip->tcp_win) << tcp.snd_wscale,
+			 dlen || (flags & TCP_FIN));
+	if (dlen && tcp.state != TCP_CLOSED)
+		tcp_data(seq, data, dlen);
+	if ((flags & TCP_FIN) && tcp.state != TCP_CLOSED)
+		tcp_fin(seq + dlen);
+	if (tcp.state != TCP_CLOSED)
+		tcp_output();
+}
+
+void tcp_connect(IPaddr_t dest, unsigned dport, tcp_rx_f *rx,
+		 tcp_event_f *event)
+{
+	memset(&tcp, '\0', sizeof(tcp));
+	tcp.remote_ip = dest;
+	tcp.remote_port = dport;
+	tcp.local_port = 1024 + (get_timer(0) % 3072);
+	tcp.rx = rx;
+	tcp.event = event;
+	tcp.iss = get_timer(0) * 250;	/* RFC 793's 4us clock */
+	tcp.snd_una = tcp.iss;
+	tcp.snd_nxt = tcp.iss;
+	tcp.snd_mss = TCP_MIN_MSS;
+	tcp.rto = TCP_RTO_INIT;
+	while ((CONFIG_TCP_WINDOW >> tcp.rcv_wscale) > 0xffff)
+		tcp.rcv_wscale++;
+	tcp.rcv_wnd = CONFIG_TCP_WINDOW;
+	tcp.last_rx = get_timer(0);
+	tcp.state = TCP_SYN_SENT;
+
+	tcp_output();
+	NetSetTimeout(TCP_TICK_MS, tcp_tick);
+}
+
+int tcp_send(const void *data, unsigned len)
+{
+	if ((tcp.state != TCP_ESTABLISHED && tcp.state != TCP_CLOSE_WAIT) ||
+	    tcp.snd_len + len > TCP_SNDBUF)
+		return -1;
+	memcpy(tcp.sndbuf + tcp.snd_len, data, len);
+	tcp.snd_len += len;
+	tcp_output();
+
+	return 0;
+}
+
+void tcp_close(void)
+{
+	if (tcp.state == TCP_ESTABLISHED)
+		tcp.state = TCP_FIN_WAIT_1;
+	else if (tcp.state == TCP_CLOSE_WAIT)
+		tcp.state = TCP_LAST_ACK;
+	else
+		return;
+	tcp.fin_queued = 1;
+	tcp_output();
+}
+
+void tcp_abort(void)
+{
+	if (tcp.state == TCP_CLOSED)
+		return;
+	tcp_send_segment(tcp.snd_nxt, TCP_RST | TCP_ACK, NULL, 0);
+	tcp_stop();
+}
+
+ulong tcp_received(void)
+{
+	if (tcp.state == TCP_SYN_SENT)
+		return 0;
+	return tcp.rcv_nxt - tcp.irs - 1 - tcp.fin_rcvd;
+}
+
+void tcp_print_stats(void)
+{
+	printf("TCP: %lu segments received, %lu out of order, %lu duplicate; "
+	       "%lu ACKs sent, %lu retransmitted\n", tcp.segs_in, tcp.segs_ooo,
+	       tcp.segs_dup, tcp.acks_out, tcp.retrans);
+}
@@ -0,0 +1,94 @@
+/*
+ * Minimal TCP for downloads
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __TCP_H__
+#define __TCP_H__
+
+#include <common.h>
+#include <net.h>
+
+/* Size of the receive window offered to the peer */
+#ifndef CONFIG_TCP_WINDOW
+#define CONFIG_TCP_WINDOW	(256 << 10)
+#endif
+
+/* Connection events reported to the application */
+enum tcp_event {
+	TCP_EV_ESTABLISHED,	/* connection is open, tcp_send() may be used */
+	TCP_EV_DATA,		/* more of the stream has arrived in order */
+	TCP_EV_PEER_CLOSED,	/* peer sent FIN, so the stream is complete */
+	TCP_EV_CLOSED,		/* our FIN was acknowledged */
+	TCP_EV_RESET,		/* peer reset the connection */
+	TCP_EV_TIMEOUT,		/* peer stopped responding */
+};
+
+/**
+ * tcp_rx_f - Accept data received on the connection
+ *
+ * Data is passed on as it arrives, which may be out of order, so that it
+ * can be placed directly at its final location. Data in order is always
+ * passed on first, and may be passed on again if it is retransmitted.
+ *
+ * @offset:	Offset of the data in the received stream
+ * @data:	Data received
+ * @len:	Number of bytes of data
+ * @return 0 if the data was stored, -1 if it cannot be accepted yet, in
+ * which case it is dropped and must be retransmitted by the peer. Data in
+ * order is never dropped.
+ */
+typedef int tcp_rx_f(ulong offset, uchar *data, unsigned len);
+
+/* Receive a connection event */
+typedef void tcp_event_f(enum tcp_event event);
+
+/**
+ * tcp_connect() - Open a connection
+ *
+ * This sets the NetLoop timeout handler, which TCP uses for its timers,
+ * until the connection is closed.
+ *
+ * @dest:	IP address to connect to
+ * @dport:	Port to connect to
+ * @rx:		Function to receive data
+ * @event:	Function to receive connection events
+ */
+void tcp_connect(IPaddr_t dest, unsigned dport, tcp_rx_f *rx,
+		 tcp_event_f *event);
+
+/**
+ * tcp_send() - Send data on an open connection
+ *
+ * @data:	Data to send, which is copied
+ * @len:	Number of bytes to send
+ * @return 0 if ok, -1 if the connection is not open or there is not
+ * enough space left to hold the data until it is acknowledged
+ */
+int tcp_send(const void *data, unsigned len);
+
+/* Close our side of the connection by sending FIN */
+void tcp_close(void);
+
+/* Abandon the connection, sending a reset to the peer */
+void tcp_abort(void);
+
+/* Number of bytes of the stream received in order so far */
+ulong tcp_received(void);
+
+/* Print statistics about the connection */
+void tcp_print_stats(void);
+
+/**
+ * tcp_receive() - Handle a received TCP segment
+ *
+ * @ip:		IP packet holding the segment, with a valid IP header
+ * @len:	Length of the IP packet
+ * @src_ip:	Source IP address
+ */
+void tcp_receive(struct ip_tcp_hdr *ip, unsigned len, IPaddr_t src_ip);
+
+#endif /* __TCP_H__ */
@@ -9,6 +9,7 @@
 #include <common.h>
 #include <command.h>
 #include <net.h>
+#include <asm/io.h>
 #include "tftp.h"
 #include "bootp.h"
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
@@ -130,6 +131,23 @@ static char tftp_filename[MAX_LEN];
 static unsigned short TftpBlkSize = TFTP_BLOCK_SIZE;
 static unsigned short TftpBlkSizeOption = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440 windowsize: the number of data blocks the server may send before
+ * waiting for an ACK. A window of 1 is the classic RFC 1350 lockstep mode.
+ */
+#ifdef CONFIG_TFTP_WINDOWSIZE
+#define TFTP_WINDOWSIZE CONFIG_TFTP_WINDOWSIZE
+#else
+#define TFTP_WINDOWSIZE 1
+#endif
+
+static unsigned short TftpWindowSize = 1;
+static unsigned short TftpWindowSizeOption = TFTP_WINDOWSIZE;
+/* block number which completes the current window and must be ACKed */
+static ulong	TftpNextAck;
+/* 1 if we have asked the server to restart the window after a loss */
+static int	TftpWindowResync;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -184,7 +202,15 @@ store_block(int block, uchar *src, unsigned len)
 	} else
 #endif /* CONFIG_SYS_DIRECT_FLASH_TFTP */
 	{
-		(void)memcpy((void *)(load_addr + offset), src, len);
+		uchar *ptr = map_sysmem(load_addr + offset, len);
+
+		/* a block received in place needs no copy */
+		if (src + len <= ptr || src >= ptr + len)
+			memcpy(ptr, src, len);
+		else if (src != ptr)
+			memmove(ptr, src, len);
+		unmap_sysmem(ptr);
+		net_rx_post_next(offset / TftpBlkSize + 1);
 	}
 #ifdef CONFIG_MCAST_TFTP
 	if (Multicast)
@@ -195,12 +221,32 @@ store_block(int block, uchar *src, unsigned len)
 		NetBootFileXferSize = newsize;
 }
 
+/*
+ * With a window, blocks are only stored in order, so once the size of the
+ * file is known the rest of it can be received in place
+ */
+static void tftp_post_start(void)
+{
+#if defined(CONFIG_TFTP_TSIZE) && !defined(CONFIG_SYS_DIRECT_FLASH_TFTP)
+#ifdef CONFIG_MCAST_TFTP
+	if (Multicast)
+		return;
+#endif
+	if (TftpWindowSize > 1 && TftpTsize)
+		net_rx_post_start(map_sysmem(load_addr, TftpTsize),
+				  ETHER_HDR_SIZE + IP_UDP_HDR_SIZE + 4,
+				  TftpBlkSize, TftpTsize, 0);
+#endif
+}
+
 /* Clear our state ready for a new transfer */
 static void new_transfer(void)
 {
 	TftpLastBlock = 0;
 	TftpBlockWrap = 0;
 	TftpBlockWrapOffset = 0;
+	TftpNextAck = TftpWindowSize;
+	TftpWindowResync = 0;
 #ifdef CONFIG_CMD_TFTPPUT
 	TftpFinalBlock = 0;
 #endif
@@ -221,8 +267,12 @@ static int load_block(unsigned block, uchar *dst, unsigned len)
 	ulong offset = ((int)block - 1) * len + TftpBlockWrapOffset;
 	ulong tosend = len;
 
+	void *ptr;
+
 	tosend = min(NetBootFileXferSize - offset, tosend);
-	(void)memcpy(dst, (void *)(save_addr + offset), tosend);
+	ptr = map_sysmem(save_addr + offset, tosend);
+	memcpy(dst, ptr, tosend);
+	unmap_sysmem(ptr);
 	debug("%s: block=%d, offset=%ld, len=%d, tosend=%ld\n", __func__,
 		block, offset, len, tosend);
 	return tosend;
@@ -232,6 +282,26 @@ static int load_block(unsigned block, uchar *dst, unsigned len)
 static void TftpSend(void);
 static void TftpTimeout(void);
 
+/**
+ * Ask the server to resend the window after a lost or out-of-order block
+ *
+ * RFC 7440 says the receiver should acknowledge the last block it received
+ * in sequence, from which point the server starts a new window. Only one
+ * such ACK is sent per loss, so the remaining blocks of the broken window
+ * do not each trigger another restart.
+ */
+static void window_resync(void)
+{
+	debug("TFTP block %ld out of sequence, expected %ld\n", TftpBlock,
+	      (TftpLastBlock + 1) & 0xffff);
+	TftpBlock = TftpLastBlock;
+	if (TftpWindowResync)
+		return;
+	TftpWindowResync = 1;
+	TftpNextAck = (TftpBlock + TftpWindowSize) & 0xffff;
+	TftpSend();
+}
+
 /**********************************************************************/
 
 static void show_block_marker(void)
@@ -307,6 +377,7 @@ static void tftp_complete(void)
 			time_start * 1000, "/s");
 	}
 	puts("\ndone\n");
+	net_rx_post_stop();
 	net_set_state(NETLOOP_SUCCESS);
 }
 
@@ -359,6 +430,10 @@ TftpSend(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, TftpBlkSizeOption, 0);
+		/* ask for a sliding window if configured */
+		if (TftpWindowSizeOption > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, TftpWindowSizeOption, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!ProhibitMcast) {
@@ -515,6 +590,8 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 			pkt + strlen((char *)pkt) + 1);
 		TftpState = STATE_OACK;
 		TftpRemotePort = src;
+		/* nothing received yet; a window must start at block 1 */
+		TftpLastBlock = 0;
 		/*
 		 * Check for 'blksize' option.
 		 * Careful: "i" is signed, "len" is unsigned, thus
@@ -528,6 +605,13 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 				debug("Blocksize ack: %s, %d\n",
 					(char *)pkt+i+8, TftpBlkSize);
 			}
+			if (strcmp((char *)pkt+i, "windowsize") == 0) {
+				TftpWindowSize = (unsigned short)
+					simple_strtoul((char *)pkt+i+11, NULL,
+						       10);
+				debug("Windowsize ack: %s, %d\n",
+					(char *)pkt+i+11, TftpWindowSize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				TftpTsize = simple_strtoul((char *)pkt+i+6,
@@ -558,6 +642,18 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		len -= 2;
 		TftpBlock = ntohs(*(__be16 *)pkt);
 
+		/*
+		 * With a window open, anything but the next block in
+		 * sequence means a block was lost or reordered: drop it
+		 * before it can disturb the wrap accounting.
+		 */
+		if ((TftpState == STATE_DATA || TftpState == STATE_OACK) &&
+		    TftpWindowSize > 1 &&
+		    TftpBlock != ((TftpLastBlock + 1) & 0xffff)) {
+			window_resync();
+			break;
+		}
+
 		update_block_number();
 
 		if (TftpState == STATE_SEND_RRQ)
@@ -583,6 +679,7 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 				NetStartAgain();
 				break;
 			}
+			tftp_post_start();
 		}
 
 		if (TftpBlock == TftpLastBlock) {
@@ -593,11 +690,23 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		}
 
 		TftpLastBlock = TftpBlock;
+		TftpWindowResync = 0;
+		/* progress was made, so only count consecutive timeouts */
+		TftpTimeoutCount = 0;
 		TftpTimeoutCountMax = TIMEOUT_COUNT;
 		NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
 
 		store_block(TftpBlock - 1, pkt + 2, len);
 
+		/*
+		 * Inside a window only the last block (or a short, final
+		 * block) is acknowledged; the rest just get stored.
+		 */
+		if (TftpWindowSize > 1 && TftpBlock != TftpNextAck &&
+		    len == TftpBlkSize)
+			break;
+		TftpNextAck = (TftpBlock + TftpWindowSize) & 0xffff;
+
 		/*
 		 *	Acknowledge the block just received, which will prompt
 		 *	the remote for the next one.
@@ -679,6 +788,11 @@ TftpTimeout(void)
 	} else {
 		puts("T ");
 		NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
+		/* the server restarts its window after our last good block */
+		if (TftpState == STATE_DATA) {
+			TftpNextAck = (TftpBlock + TftpWindowSize) & 0xffff;
+			TftpWindowResync = 0;
+		}
 		if (TftpState != STATE_RECV_WRQ)
 			TftpSend();
 	}
@@ -697,6 +811,10 @@ void TftpStart(enum proto_t protocol)
 	if (ep != NULL)
 		TftpBlkSizeOption = simple_strtol(ep, NULL, 10);
 
+	ep = getenv("tftpwindowsize");
+	if (ep != NULL)
+		TftpWindowSizeOption = simple_strtol(ep, NULL, 10);
+
 	ep = getenv("tftptimeout");
 	if (ep != NULL)
 		TftpTimeoutMSecs = simple_strtol(ep, NULL, 10);
@@ -708,8 +826,8 @@ void TftpStart(enum proto_t protocol)
 		TftpTimeoutMSecs = 1000;
 	}
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-		TftpBlkSizeOption, TftpTimeoutMSecs);
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+		TftpBlkSizeOption, TftpWindowSizeOption, TftpTimeoutMSecs);
 
 	TftpRemoteIP = NetServerIP;
 	if (BootFile[0] == '\0') {
@@ -807,8 +925,9 @@ void TftpStart(enum proto_t protocol)
 
 	/* zero out server ether in case the server ip has changed */
 	memset(NetServerEther, 0, 6);
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -837,8 +956,9 @@ TftpStartServer(void)
 	TftpTimeoutMSecs = TIMEOUT;
 	NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
 
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 	TftpBlock = 0;
 	TftpOurPort = WELL_KNOWN_PORT;
 
@@ -0,0 +1,265 @@
+/*
+ * HTTP download
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * This fetches a file with an HTTP/1.1 GET and writes the body to
+ * load_addr as it arrives. Once the response header has been seen, each
+ * segment is stored at its place in the file, even if it arrives out of
+ * order, so the data is copied only once. Only responses with status 200
+ * are accepted; chunked encoding and redirects are not supported.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <net.h>
+#include <asm/io.h>
+#include "tcp.h"
+#include "wget.h"
+
+#define WGET_HTTP_PORT		80
+#define WGET_HDR_MAX		2048	/* longest response header */
+#define WGET_HASH_BYTES		(64 << 10)	/* data per progress mark */
+#define HASHES_PER_LINE		65
+
+static IPaddr_t wget_ip;
+static unsigned wget_port;
+static char *wget_path;
+static char wget_hdr[WGET_HDR_MAX + 1];	/* response header, terminated */
+static unsigned wget_hdr_len;
+static ulong wget_body_offset;	/* start of the body in the stream, or 0 */
+static ulong wget_content_len;	/* from the header, ~0 if not given */
+static ulong wget_streamed;	/* bytes of body in order so far */
+static ulong wget_start_time;
+static int wget_hashes;
+
+/* Give up, after printing @msg if not NULL */
+static void wget_fail(const char *msg)
+{
+	if (msg)
+		printf("\n%s\n", msg);
+	tcp_abort();
+	net_set_state(NETLOOP_FAIL);
+}
+
+/* Find a header field, returning its value or NULL if not present */
+static char *wget_field(const char *name)
+{
+	char *end = wget_hdr + wget_body_offset;
+	int len = strlen(name);
+	char *p;
+
+	for (p = strstr(wget_hdr, "\r\n"); p && p < end;
+	     p = strstr(p + 2, "\r\n")) {
+		if (!strncasecmp(p + 2, name, len) && p[2 + len] == ':') {
+			for (p += 3 + len; *p == ' ' || *p == '\t'; p++)
+				;
+			return p;
+		}
+	}
+
+	return NULL;
+}
+
+static int wget_parse_header(void)
+{
+	char *p;
+
+	p = strchr(wget_hdr, '\r');
+	*p = '\0';
+	if (strncmp(wget_hdr, "HTTP/1.", 7) || strlen(wget_hdr) < 12 ||
+	    strncmp(wget_hdr + 8, " 200", 4)) {
+		printf("\nHTTP error: %s\n", wget_hdr);
+		wget_fail(NULL);
+		return -1;
+	}
+	*p = '\r';
+
+	p = wget_field("Transfer-Encoding");
+	if (p && strncasecmp(p, "identity", 8)) {
+		wget_fail("HTTP transfer encoding not supported");
+		return -1;
+	}
+	p = wget_field("Content-Length");
+	wget_content_len = p ? simple_strtoul(p, NULL, 10) : ~0UL;
+
+	return 0;
+}
+
+static void wget_store(ulong offset, uchar *data, unsigned len)
+{
+	void *ptr;
+
+	if (offset >= wget_content_len)
+		return;
+	len = min((ulong)len, wget_content_len - offset);
+	ptr = map_sysmem(load_addr + offset, len);
+	memcpy(ptr, data, len);
+	unmap_sysmem(ptr);
+}
+
+static int wget_rx(ulong offset, uchar *data, unsigned len)
+{
+	unsigned n, skip;
+	char *end;
+
+	if (wget_body_offset) {
+		if (offset < wget_body_offset) {
+			skip = min((ulong)len, wget_body_offset - offset);
+			offset += skip;
+			data += skip;
+			len -= skip;
+		}
+		wget_store(offset - wget_body_offset, data, len);
+		return 0;
+	}
+
+	/* collect the header in order */
+	if (offset != wget_hdr_len)
+		return -1;
+	n = min(len, WGET_HDR_MAX - wget_hdr_len);
+	memcpy(wget_hdr + wget_hdr_len, data, n);
+	wget_hdr_len += n;
+	wget_hdr[wget_hdr_len] = '\0';
+	end = strstr(wget_hdr, "\r\n\r\n");
+	if (!end) {
+		if (wget_hdr_len == WGET_HDR_MAX)
+			wget_fail("HTTP header too long");
+		return 0;
+	}
+	wget_body_offset = end + 4 - wget_hdr;
+	if (wget_parse_header())
+		return 0;
+
+	/* the rest is the start of the body */
+	skip = wget_body_offset - offset;
+	if (skip < len)
+		wget_store(0, data + skip, len - skip);
+
+	return 0;
+}
+
+/* Account for body data received in order */
+static void wget_progress(void)
+{
+	ulong body, marks;
+
+	if (!wget_body_offset)
+		return;
+	body = min(tcp_received() - wget_body_offset, wget_content_len);
+	if (body <= wget_streamed)
+		return;
+	marks = body / WGET_HASH_BYTES - wget_streamed / WGET_HASH_BYTES;
+	for (; marks; marks--) {
+		putc('#');
+		if (++wget_hashes == HASHES_PER_LINE) {
+			puts("\n\t ");
+			wget_hashes = 0;
+		}
+	}
+	wget_streamed = body;
+	NetBootFileXferSize = body;
+}
+
+static void wget_done(void)
+{
+	ulong time;
+
+	if (!wget_body_offset) {
+		wget_fail("HTTP response incomplete");
+		return;
+	}
+	if (wget_content_len != ~0UL && wget_streamed < wget_content_len) {
+		printf("\nConnection closed after %lu of %lu bytes\n",
+		       wget_streamed, wget_content_len);
+		wget_fail(NULL);
+		return;
+	}
+
+	time = get_timer(wget_start_time);
+	if (time > 0) {
+		puts("\n\t ");	/* Line up with "Loading: " */
+		print_size(NetBootFileXferSize / time * 1000, "/s");
+	}
+	puts("\ndone\n");
+	tcp_print_stats();
+	net_set_state(NETLOOP_SUCCESS);
+}
+
+static void wget_send_request(void)
+{
+	char req[sizeof(BootFile) + 128];
+	char host[16];
+
+	ip_to_string(wget_ip, host);
+	sprintf(req, "GET %s%s HTTP/1.1\r\nHost: %s",
+		*wget_path == '/' ? "" : "/", wget_path, host);
+	if (wget_port != WGET_HTTP_PORT)
+		sprintf(req + strlen(req), ":%u", wget_port);
+	strcat(req, "\r\nUser-Agent: U-Boot\r\nConnection: close\r\n\r\n");
+	if (tcp_send(req, strlen(req)))
+		wget_fail("Cannot send HTTP request");
+}
+
+static void wget_event(enum tcp_event event)
+{
+	switch (event) {
+	case TCP_EV_ESTABLISHED:
+		wget_send_request();
+		break;
+	case TCP_EV_DATA:
+		wget_progress();
+		if (wget_streamed == wget_content_len)
+			tcp_close();
+		break;
+	case TCP_EV_PEER_CLOSED:
+		tcp_close();
+		break;
+	case TCP_EV_CLOSED:
+		wget_done();
+		break;
+	case TCP_EV_RESET:
+		wget_fail("Connection reset by server");
+		break;
+	case TCP_EV_TIMEOUT:
+		wget_fail("Connection timed out");
+		break;
+	}
+}
+
+void wget_start(void)
+{
+	char *p;
+
+	wget_ip = NetServerIP;
+	wget_path = BootFile;
+	p = strchr(BootFile, ':');
+	if (p) {
+		wget_ip = string_to_ip(BootFile);
+		wget_path = p + 1;
+	}
+	if (!*wget_path) {
+		puts("*** ERROR: no file name given\n");
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	p = getenv("httpdstp");
+	wget_port = p ? simple_strtoul(p, NULL, 10) : WGET_HTTP_PORT;
+
+	printf("Using %s device\n", eth_get_name());
+	printf("HTTP from server %pI4; our IP address is %pI4\n", &wget_ip,
+	       &NetOurIP);
+	printf("Filename '%s'.\n", wget_path);
+	printf("Load address: 0x%lx\n", load_addr);
+	puts("Loading: *\b");
+
+	wget_hdr_len = 0;
+	wget_body_offset = 0;
+	wget_content_len = ~0UL;
+	wget_streamed = 0;
+	wget_hashes = 0;
+	wget_start_time = get_timer(0);
+	tcp_connect(wget_ip, wget_port, wget_rx, wget_event);
+}
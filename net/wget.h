@@ -0,0 +1,15 @@
+/*
+ * HTTP download
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __WGET_H__
+#define __WGET_H__
+
+/* Begin an HTTP GET of BootFile to load_addr */
+void wget_start(void);
+
+#endif /* __WGET_H__ */
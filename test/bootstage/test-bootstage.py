@@ -0,0 +1,129 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# Bootstage timeline test using sandbox
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# This times some nested activities with the 'bootstage' command over a few
+# runs of sandbox, exports the timeline of each and checks that
+# tools/bootstage can convert it to a Chrome trace and compare the runs,
+# both from the exports and from the console output of 'bootstage report'.
+#
+# To run this:
+#
+# make O=sandbox sandbox_config
+# make O=sandbox
+# ./test/bootstage/test-bootstage.py -u sandbox/u-boot
+
+from __future__ import print_function
+
+import json
+from optparse import OptionParser
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+RUNS = 3
+
+# Within 'load', 'crc' runs twice, and 'open' is never finished
+base_script = '''
+bootstage start load;
+bootstage start crc;
+crc32 0 %(size)x;
+bootstage accum crc;
+bootstage start crc;
+crc32 0 %(size)x;
+bootstage accum crc;
+bootstage accum load;
+bootstage start open;
+bootstage export 1000000 10000;
+sb save host 0 %(fname)s 1000000 ${filesize};
+bootstage report;
+reset
+'''
+
+def fail(msg, stdout):
+    """Raise an error with a helpful failure message
+
+    Args:
+        msg: Message to display
+        stdout: Output from U-Boot or the tool
+    """
+    print(stdout)
+    raise ValueError("Test failed: %s" % msg)
+
+def run_tool(*args):
+    """Run tools/bootstage and return its output"""
+    tool = os.path.join(os.path.dirname(os.path.realpath(__file__)),
+                        '../../tools/bootstage/bootstage.py')
+    return subprocess.check_output([sys.executable, tool] +
+                                   list(args)).decode('ascii')
+
+def check_trace(fname):
+    """Check the Chrome trace of an export shows the nesting"""
+    trace = json.loads(run_tool('trace', fname))
+    spans = [ev for ev in trace['traceEvents'] if ev['ph'] == 'X']
+    names = [ev['name'] for ev in spans]
+    if names != ['load', 'crc', 'crc', 'open']:
+        fail('wrong intervals %s' % names, json.dumps(trace, indent=1))
+    load, crc1, crc2 = spans[:3]
+    for crc in (crc1, crc2):
+        if (crc['args']['depth'] != 1 or crc['ts'] < load['ts'] or
+                crc['ts'] + crc['dur'] > load['ts'] + load['dur']):
+            fail('crc not within load', json.dumps(trace, indent=1))
+    if crc1['ts'] + crc1['dur'] > crc2['ts']:
+        fail('crc intervals overlap', json.dumps(trace, indent=1))
+    if trace['otherData']['accumulated_us']['crc'] < crc1['dur']:
+        fail('accumulated time too small', json.dumps(trace, indent=1))
+
+def check_compare(files, count):
+    """Check the comparison of several runs lists the right stages"""
+    out = run_tool('compare', *files)
+    if '%d boots' % count not in out:
+        fail('wrong boot count', out)
+    for name in ('load', 'crc'):
+        if not [line for line in out.splitlines()
+                if line.split()[-1] == name and line.split()[0] == str(count)]:
+            fail('stage %s missing' % name, out)
+    return out
+
+def run_tests():
+    """Parse options, run sandbox a few times and check the results"""
+    parser = OptionParser()
+    parser.add_option('-u', '--u-boot', default='sandbox/u-boot',
+            help='Select U-Boot sandbox binary')
+    (options, args) = parser.parse_args()
+
+    base_dir = tempfile.mkdtemp()
+    try:
+        exports = []
+        log = os.path.join(base_dir, 'console.log')
+        with open(log, 'wb') as fd:
+            for run in range(RUNS):
+                fname = os.path.join(base_dir, 'boot%d.bin' % run)
+                cmd = base_script % {'fname' : fname,
+                                     'size' : (run + 1) << 24}
+                stdout = subprocess.Popen([options.u_boot, '-c', cmd],
+                        stdout=subprocess.PIPE).communicate()[0]
+                if b'Exported' not in stdout or not os.path.exists(fname):
+                    fail('no export', stdout.decode('ascii', 'replace'))
+                fd.write(stdout)
+                exports.append(fname)
+
+        check_trace(exports[0])
+        dump = run_tool('dump', exports[0])
+        if '    crc' not in dump or 'running  open' not in dump:
+            fail('nesting not shown', dump)
+        check_compare(exports, RUNS)
+        check_compare([log], RUNS)
+        print(run_tool('compare', '-b', exports[0], *exports[1:]))
+    finally:
+        shutil.rmtree(base_dir)
+
+    print('Test passed')
+
+run_tests()
@@ -58,6 +58,51 @@ static int do_ut_cmd(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		"setenv list ${list}3", strlen("setenv list 1"), 0);
 	assert(!strcmp("1", getenv("list")));
 
+#ifdef CONFIG_SYS_HUSH_PARSER
+	/* scripts run several times, which may come from the parse cache */
+	run_command("setenv list", 0);
+	run_command("setenv script 'setenv list ${list}a'", 0);
+	run_command("run script; run script; run script", 0);
+	assert(!strcmp("aaa", getenv("list")));
+
+	/* a changed script is parsed again */
+	run_command("setenv script 'setenv list ${list}b'", 0);
+	run_command("run script", 0);
+	assert(!strcmp("aaab", getenv("list")));
+
+	/* and so is one deleted and set again */
+	run_command("setenv script; setenv script 'setenv list c'", 0);
+	run_command("run script", 0);
+	assert(!strcmp("c", getenv("list")));
+
+	/* a script may change itself while running */
+	run_command("setenv script 'setenv list ${list}d; "
+		    "setenv script setenv list e'", 0);
+	run_command("run script", 0);
+	assert(!strcmp("cd", getenv("list")));
+	run_command("run script", 0);
+	assert(!strcmp("e", getenv("list")));
+
+	/* or run itself */
+	run_command("setenv list; setenv script 'setenv list ${list}f; "
+		    "if test ${list} != fff; then run script; fi'", 0);
+	run_command("run script", 0);
+	assert(!strcmp("fff", getenv("list")));
+
+	/* loops run again from the start */
+	run_command("setenv list; setenv script 'for i in 1 2 3; do "
+		    "setenv list ${list}${i}; done'", 0);
+	run_command("run script; run script", 0);
+	assert(!strcmp("123123", getenv("list")));
+
+	/* even when one was left early */
+	run_command("setenv list; setenv script 'for i in 1 2 3; do "
+		    "setenv list ${list}${i}; exit; done'", 0);
+	run_command("run script; run script", 0);
+	assert(!strcmp("11", getenv("list")));
+	run_command("setenv list; setenv script", 0);
+#endif
+
 	printf("%s: Everything went swimmingly\n", __func__);
 	return 0;
 }
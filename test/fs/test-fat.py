@@ -0,0 +1,199 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# FAT read benchmark using sandbox
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# This builds FAT32 images holding a contiguous file, a fragmented file and
+# a file whose clusters alternate between two distant areas of the disk (as
+# happens when two files grow at the same time). Each is loaded with fatload
+# from a sandbox host block device and checked, and the number of disk
+# reads needed is reported.
+#
+# To run this:
+#
+# make O=sandbox sandbox_config
+# make O=sandbox
+# ./test/fs/test-fat.py -u sandbox/u-boot
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import os
+import random
+import re
+import shutil
+import struct
+import subprocess
+import tempfile
+import zlib
+
+SECTOR_SIZE = 512
+TOTAL_SECTORS = 262144		# 128MB
+RESERVED_SECTORS = 32
+FILE_SIZE = 6000000
+EOC = 0x0fffffff
+
+# Name, allocation pattern
+files = (
+    ('CONT    BIN', 'contiguous'),
+    ('FRAG    BIN', 'fragmented'),
+    ('SPLIT   BIN', 'interleaved'),
+)
+
+base_script = '''
+sb bind 0 %(image)s;
+fatload hostblk 0:0 1000000 %(fname)s;
+crc32 1000000 ${filesize};
+sb info;
+reset
+'''
+
+class FatImage:
+    """A FAT32 image laid out by hand so that fragmentation is controlled"""
+    def __init__(self, fname, clust_size):
+        self.fname = fname
+        self.clust_size = clust_size
+        self.nclust = (TOTAL_SECTORS - RESERVED_SECTORS) // clust_size
+        self.fat_length = (self.nclust * 4 + SECTOR_SIZE - 1) // SECTOR_SIZE
+        self.data_sect = RESERVED_SECTORS + 2 * self.fat_length
+        self.fat = [0] * (self.nclust + 2)
+        self.fat[0:3] = [0x0ffffff8, EOC, EOC]	# cluster 2 is the root
+        self.next = 3
+        self.dirents = b''
+        self.fd = open(fname, 'wb')
+        self.fd.truncate(TOTAL_SECTORS * SECTOR_SIZE)
+
+    def alloc(self, count, pattern):
+        """Allocate a cluster chain
+
+        Args:
+            count: Number of clusters needed
+            pattern: 'contiguous', 'fragmented' or 'interleaved'
+        Return:
+            List of clusters in chain order
+        """
+        chain = []
+        other = self.next + count * 2
+        while len(chain) < count:
+            run = count
+            if pattern != 'contiguous':
+                run = random.randint(1, 16)
+            run = min(run, count - len(chain))
+            chain += range(self.next, self.next + run)
+            self.next += run
+            if pattern == 'fragmented':
+                self.next += random.randint(1, 8)
+            elif pattern == 'interleaved':
+                self.next, other = other, self.next
+        self.next = max(self.next, other)
+        for clust, next_clust in zip(chain, chain[1:]):
+            self.fat[clust] = next_clust
+        self.fat[chain[-1]] = EOC
+        return chain
+
+    def add_file(self, name, data, pattern):
+        """Add a file to the root directory
+
+        Args:
+            name: 8.3 name, space padded to 11 characters
+            data: File contents
+            pattern: Allocation pattern, see alloc()
+        """
+        bytes_per_clust = self.clust_size * SECTOR_SIZE
+        count = (len(data) + bytes_per_clust - 1) // bytes_per_clust
+        chain = self.alloc(count, pattern)
+        for i, clust in enumerate(chain):
+            self.fd.seek((self.data_sect + (clust - 2) * self.clust_size) *
+                    SECTOR_SIZE)
+            self.fd.write(data[i * bytes_per_clust:(i + 1) * bytes_per_clust])
+        self.dirents += name.encode('ascii') + struct.pack('<BBBHHHHHHHI',
+                0x20, 0, 0, 0, 0, 0, chain[0] >> 16, 0, 0, chain[0] & 0xffff,
+                len(data))
+
+    def close(self):
+        """Write the boot sector, FATs and root directory"""
+        bs = bytearray(SECTOR_SIZE)
+        bs[0:11] = b'\xeb\x58\x90MSWIN4.1'
+        struct.pack_into('<HBHBHHBHHHII', bs, 11, SECTOR_SIZE,
+                self.clust_size, RESERVED_SECTORS, 2, 0, 0, 0xf8, 0, 32, 64,
+                0, TOTAL_SECTORS)
+        struct.pack_into('<IHHIHH', bs, 36, self.fat_length, 0, 0, 2, 1, 6)
+        bs[64] = 0x80
+        bs[66] = 0x29
+        bs[71:90] = b'NO NAME    FAT32   '
+        bs[510:512] = b'\x55\xaa'
+        self.fd.seek(0)
+        self.fd.write(bs)
+        fat = struct.pack('<%dI' % len(self.fat), *self.fat)
+        for i in range(2):
+            self.fd.seek((RESERVED_SECTORS + i * self.fat_length) *
+                    SECTOR_SIZE)
+            self.fd.write(fat)
+        self.fd.seek(self.data_sect * SECTOR_SIZE)
+        self.fd.write(self.dirents)
+        self.fd.close()
+
+def fail(msg, stdout):
+    """Raise an error with a helpful failure message
+
+    Args:
+        msg: Message to display
+    """
+    print(stdout)
+    raise ValueError("Test failed: %s" % msg)
+
+def run_fat_test(u_boot, base_dir, clust_size):
+    """Load each file from an image with the given cluster size
+
+    Args:
+        u_boot: Path to the sandbox binary
+        base_dir: Directory for temporary files
+        clust_size: Sectors per cluster
+    """
+    image = os.path.join(base_dir, 'fat.img')
+    fat = FatImage(image, clust_size)
+    crcs = {}
+    for name, pattern in files:
+        data = os.urandom(FILE_SIZE)
+        crcs[name] = zlib.crc32(data) & 0xffffffff
+        fat.add_file(name, data, pattern)
+    fat.close()
+
+    print('%d byte clusters:' % (clust_size * SECTOR_SIZE))
+    for name, pattern in files:
+        fname = name[:8].strip().lower() + '.' + name[8:].strip().lower()
+        cmd = base_script % {'image' : image, 'fname' : fname}
+        stdout = subprocess.Popen([u_boot, '-c', cmd],
+                stdout=subprocess.PIPE).communicate()[0].decode('ascii')
+        crc = re.search('==> ([0-9a-f]+)', stdout)
+        if not crc or int(crc.group(1), 16) != crcs[name]:
+            fail('%s not loaded correctly' % fname, stdout)
+        reads = re.search(r'^ +0 +\d+ +(\d+) +(\d+)', stdout, re.MULTILINE)
+        rate = re.search('bytes read in (.*)', stdout)
+        print('   %-12s %6s disk reads, %s' % (pattern, reads.group(1),
+                rate.group(1)))
+
+def run_tests():
+    """Parse options, run the FAT benchmark and print the result"""
+    parser = OptionParser()
+    parser.add_option('-u', '--u-boot', default='sandbox/u-boot',
+            help='Select U-Boot sandbox binary')
+    (options, args) = parser.parse_args()
+
+    title = 'FAT read benchmark'
+    print(title)
+    print('=' * len(title))
+
+    random.seed(1)
+    base_dir = tempfile.mkdtemp()
+    try:
+        for clust_size in (1, 8):
+            run_fat_test(options.u_boot, base_dir, clust_size)
+    finally:
+        shutil.rmtree(base_dir)
+    print('\nTest passed')
+
+run_tests()
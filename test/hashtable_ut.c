@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#define DEBUG
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <search.h>
+
+#define NUM_KEYS	1000
+
+static void make_key(char *key, int i)
+{
+	sprintf(key, "var%04d", i);
+}
+
+/* Enter a key whose value is the key reversed, returning the entry number */
+static int enter_key(struct hsearch_data *htab, int i)
+{
+	char key[16], data[16];
+	ENTRY e, *ep;
+	int idx, len, j;
+
+	make_key(key, i);
+	len = strlen(key);
+	for (j = 0; j < len; j++)
+		data[j] = key[len - 1 - j];
+	data[len] = '\0';
+	e.key = key;
+	e.data = data;
+	idx = hsearch_r(e, ENTER, &ep, htab, 0);
+	assert(idx > 0 && ep && !strcmp(ep->key, key));
+
+	return idx;
+}
+
+static ENTRY *find_key(struct hsearch_data *htab, int i)
+{
+	char key[16];
+	ENTRY e, *ep;
+
+	make_key(key, i);
+	e.key = key;
+	e.data = NULL;
+	hsearch_r(e, FIND, &ep, htab, 0);
+
+	return ep;
+}
+
+/* Check the export is sorted and holds exactly the keys in present[] */
+static void check_export(struct hsearch_data *htab, const char *present)
+{
+	char *res = NULL, *p, *end;
+	char key[16];
+	ssize_t len;
+	int i;
+
+	len = hexport_r(htab, '\n', 0, &res, 0, 0, NULL);
+	assert(len > 0);
+	p = res;
+	for (i = 0; i < NUM_KEYS; i++) {
+		if (!present[i])
+			continue;
+		make_key(key, i);
+		assert(!strncmp(p, key, strlen(key)));
+		assert(p[strlen(key)] == '=');
+		end = strchr(p, '\n');
+		assert(end);
+		p = end + 1;
+	}
+	assert(*p == '\0');
+	free(res);
+}
+
+static int count_entry(ENTRY *ep)
+{
+	static const char *last;
+
+	if (!ep) {
+		last = NULL;
+		return 0;
+	}
+	assert(!last || strcmp(last, ep->key) < 0);
+	last = ep->key;
+
+	return 0;
+}
+
+static int do_ut_hashtable(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	struct hsearch_data htab;
+	char present[NUM_KEYS];
+	ulong start, msecs;
+	unsigned long count;
+	ENTRY e, *ep;
+	int i, j, idx;
+
+	printf("%s: Testing hashtable\n", __func__);
+	memset(&htab, '\0', sizeof(htab));
+	memset(present, '\0', sizeof(present));
+
+	/* start tiny so that the table has to grow several times */
+	assert(hcreate_r(4, &htab));
+	assert(!find_key(&htab, 0));
+
+	/* enter in a scrambled order; 7 is coprime with NUM_KEYS */
+	for (i = 0; i < NUM_KEYS; i++) {
+		j = (i * 7) % NUM_KEYS;
+		enter_key(&htab, j);
+		present[j] = 1;
+	}
+	assert(htab.filled == NUM_KEYS);
+	assert(htab.size >= NUM_KEYS);
+	for (i = 0; i < NUM_KEYS; i++) {
+		ep = find_key(&htab, i);
+		assert(ep && !strncmp(ep->data + 3, "0rav", 4));
+	}
+	check_export(&htab, present);
+
+	/* overwriting keeps the entry, and the count */
+	e.key = "var0123";
+	e.data = "new value";
+	idx = hsearch_r(e, ENTER, &ep, &htab, 0);
+	assert(idx > 0 && !strcmp(ep->data, "new value"));
+	assert(htab.filled == NUM_KEYS);
+	assert(find_key(&htab, 123) == ep);
+
+	/* delete every third key, then check the others are still found */
+	for (i = 0; i < NUM_KEYS; i += 3) {
+		assert(hdelete_r(find_key(&htab, i)->key, &htab, 0));
+		present[i] = 0;
+	}
+	assert(!hdelete_r("var0000", &htab, 0));
+	for (i = 0; i < NUM_KEYS; i++)
+		assert(!find_key(&htab, i) == !present[i]);
+	check_export(&htab, present);
+
+	/* deleted entries are reused rather than growing the table */
+	j = htab.size;
+	for (i = 0; i < NUM_KEYS; i += 3) {
+		enter_key(&htab, i);
+		present[i] = 1;
+	}
+	assert(htab.size == j);
+	check_export(&htab, present);
+
+	/* prefix matches come back in key order */
+	idx = 0;
+	j = 0;
+	while ((idx = hmatch_r("var01", idx, &ep, &htab))) {
+		char key[16];
+
+		make_key(key, 100 + j++);
+		assert(!strcmp(ep->key, key));
+	}
+	assert(j == 100);
+	assert(!hmatch_r("vaz", 0, &ep, &htab) && !ep);
+
+	/* hwalk_r() goes in key order too */
+	count_entry(NULL);
+	assert(!hwalk_r(&htab, count_entry));
+
+	/* lookups and exports, repeating for long enough to time them */
+	count = 0;
+	start = get_timer(0);
+	do {
+		for (i = 0; i < NUM_KEYS; i++)
+			assert(find_key(&htab, i));
+		count += NUM_KEYS;
+		msecs = get_timer(start);
+	} while (msecs < 100);
+	printf("%s: %lu lookups in %lu ms\n", __func__, count, msecs);
+
+	count = 0;
+	start = get_timer(0);
+	do {
+		char *res = NULL;
+
+		assert(hexport_r(&htab, '\0', 0, &res, 0, 0, NULL) > 0);
+		free(res);
+		count++;
+		msecs = get_timer(start);
+	} while (msecs < 100);
+	printf("%s: %lu exports of %u entries in %lu ms\n", __func__, count,
+	       htab.filled, msecs);
+
+	hdestroy_r(&htab);
+	assert(!htab.table && !htab.filled);
+
+	printf("%s: Everything went swimmingly\n", __func__);
+	return 0;
+}
+
+U_BOOT_CMD(
+	ut_hashtable,	1,	1,	do_ut_hashtable,
+	"Check the hash table used for the environment",
+	""
+);
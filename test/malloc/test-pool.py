@@ -0,0 +1,175 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# malloc() pool benchmark using sandbox
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# This runs a scripted boot workload (listing and loading lots of small
+# files from an ext4 image, and setting and testing environment variables
+# through hush) once with small allocations served from the size-class
+# pools of CONFIG_SYS_MALLOC_POOL and once with them all passed to
+# dlmalloc ('mpool off'). It reports the allocation counts from 'mpool'
+# and the time taken by the shell and filesystem parts, which is the best
+# of a few runs of each. The filesystem part is mostly host file I/O.
+#
+# To run this:
+#
+# make O=sandbox sandbox_config
+# make O=sandbox
+# ./test/malloc/test-pool.py -u sandbox/u-boot
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import os
+import random
+import re
+import shutil
+import subprocess
+import tempfile
+
+DIRS = 16
+FILES_PER_DIR = 16
+VARS = 24
+SHELL_LOOPS = 200
+FS_LOOPS = 10
+RUNS = 3
+
+base_script = '''
+setenv fs '%(fs)s';
+setenv shell '%(shell)s';
+setenv fs_loop '%(fs_loop)s';
+setenv shell_loop '%(shell_loop)s';
+sb bind 0 %(image)s;
+mpool %(mode)s;
+mpool reset;
+time run fs_loop;
+time run shell_loop;
+mpool;
+reset
+'''
+
+def fail(msg, stdout):
+    """Raise an error with a helpful failure message
+
+    Args:
+        msg: Message to display
+        stdout: Output from U-Boot
+    """
+    print(stdout)
+    raise ValueError("Test failed: %s" % msg)
+
+def make_image(base_dir):
+    """Make an ext4 image holding lots of small files
+
+    Args:
+        base_dir: Directory for temporary files
+    Return:
+        Tuple: (image filename, list of paths of files within the image)
+    """
+    root = os.path.join(base_dir, 'root')
+    paths = []
+    for d in range(DIRS):
+        dname = 'dir%d' % d
+        os.makedirs(os.path.join(root, dname))
+        for f in range(FILES_PER_DIR):
+            path = '%s/file%d' % (dname, f)
+            with open(os.path.join(root, path), 'wb') as fd:
+                fd.write(os.urandom(random.randint(100, 20000)))
+            paths.append(path)
+    image = os.path.join(base_dir, 'ext4.img')
+    with open(os.devnull, 'w') as null:
+        subprocess.check_call(['mkfs.ext4', '-q', '-b', '1024', '-d', root,
+                image, '16M'], stdout=null)
+    return image, paths
+
+def make_bench(paths):
+    """Make the workload scripts
+
+    Args:
+        paths: Files to load from the ext4 image
+    Return:
+        Dict of scripts: the filesystem and shell parts of the workload,
+        and for each a script to run it repeatedly
+    """
+    fs = []
+    for d in range(DIRS):
+        fs.append('ext4ls hostblk 0 /dir%d' % d)
+    for path in paths:
+        fs.append('ext4load hostblk 0 2000000 /%s' % path)
+    shell = []
+    for v in range(VARS):
+        shell.append('setenv var%d value-of-variable-%d' % (v, v))
+        shell.append('if test "${var%d}" = "value-of-variable-%d"; then '
+                     'setenv ok%d 1; else echo bad var%d; fi' % (v, v, v, v))
+    return {
+        'fs' : '; '.join(fs),
+        'shell' : '; '.join(shell),
+        'fs_loop' : '; '.join(['run fs'] * FS_LOOPS),
+        'shell_loop' : '; '.join(['run shell'] * SHELL_LOOPS),
+    }
+
+def run_bench(u_boot, image, bench, mode):
+    """Run the workload in U-Boot
+
+    Args:
+        u_boot: Path to the sandbox binary
+        image: ext4 image to bind as host device 0
+        bench: Workload scripts from make_bench()
+        mode: 'on' to use the pool, 'off' to use only dlmalloc
+    Return:
+        Tuple: (shell time in seconds, filesystem time in seconds,
+                allocations from the pool, all allocations, 'mpool' output)
+    """
+    args = dict(bench)
+    args.update({'image' : image, 'mode' : mode})
+    cmd = base_script % args
+    stdout = subprocess.Popen([u_boot, '-c', cmd],
+            stdout=subprocess.PIPE).communicate()[0].decode('ascii',
+            'replace')
+    if 'bad var' in stdout or 'Error' in stdout:
+        fail('workload failed with the pool %s' % mode, stdout)
+    secs = re.findall(r'time: (\d+\.\d+) seconds', stdout)
+    counts = re.search(r'(\d+) of (\d+) allocations from the pool', stdout)
+    if len(secs) != 2 or not counts:
+        fail('no results with the pool %s' % mode, stdout)
+    table = stdout[stdout.index('Pool '):counts.end()]
+    return (float(secs[1]), float(secs[0]), int(counts.group(1)),
+            int(counts.group(2)), table)
+
+def run_tests():
+    """Parse options, run the benchmark and print the result"""
+    parser = OptionParser()
+    parser.add_option('-u', '--u-boot', default='sandbox/u-boot',
+            help='Select U-Boot sandbox binary')
+    (options, args) = parser.parse_args()
+
+    base_dir = tempfile.mkdtemp()
+    try:
+        image, paths = make_image(base_dir)
+        bench = make_bench(paths)
+        # take the fastest of a few runs, as the times are noisy
+        on = min(run_bench(options.u_boot, image, bench, 'on')
+                 for i in range(RUNS))
+        off = min(run_bench(options.u_boot, image, bench, 'off')
+                  for i in range(RUNS))
+    finally:
+        shutil.rmtree(base_dir)
+
+    print(on[4])
+    print()
+    title = 'malloc() pool benchmark'
+    print(title)
+    print('=' * len(title))
+    print('%-6s %10s %10s %10s %10s' % ('pool', 'allocs', 'from pool',
+                                        'shell s', 'fs s'))
+    for mode, result in (('on', on), ('off', off)):
+        print('%-6s %10d %10d %10.3f %10.3f' % (mode, result[3], result[2],
+                                               result[0], result[1]))
+    if on[2] < on[3] * 9 // 10 or off[2]:
+        raise ValueError('Test failed: pool not used as expected')
+    print('\nTest passed')
+
+run_tests()
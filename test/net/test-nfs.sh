@@ -0,0 +1,94 @@
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+
+# NFS throughput test using sandbox
+#
+# The sandbox Ethernet driver contains a small NFS server stand-in which
+# serves files from the host over NFSv3, or NFSv2 only when asked. This
+# loads the same file with a range of READ window sizes over a link with
+# some latency, and optionally packet loss, checks that what arrived is
+# intact and reports the throughput. Each load is repeated with the IP
+# fragments of several READ replies interleaved, which needs as many IP
+# reassembly contexts (CONFIG_NET_DEFRAG_CONTEXTS).
+
+OUTPUT_DIR=sandbox
+WINDOW_SIZES="1 2 4 8 16"
+NFS_VERSIONS="3 2"
+# Number of READ replies whose fragments are interleaved
+INTERLEAVE="1 4"
+# Milliseconds of latency added by the stand-in to each reply
+LATENCY=5
+# Drop one in every N data frames (0 for no loss); each loss costs an
+# NFS timeout
+DROP=0
+
+fail() {
+	echo "Test failed: $1"
+	if [ -n ${tmp} ]; then
+		rm ${tmp}
+	fi
+	if [ -n ${file} ]; then
+		rm ${file}
+	fi
+	exit 1
+}
+
+build_uboot() {
+	echo "Build sandbox"
+	OPTS="O=${OUTPUT_DIR}"
+	NUM_CPUS=$(grep -c processor /proc/cpuinfo)
+	make ${OPTS} sandbox_config
+	make ${OPTS} -s -j${NUM_CPUS}
+}
+
+# Load ${file} over NFS and from the host, printing the CRC32 of each
+# Args:
+#	$1:	NFS READ window size
+#	$2:	Highest NFS version offered by the stand-in
+#	$3:	Latency in milliseconds
+#	$4:	Frame drop interval
+#	$5:	Number of READ replies interleaved
+run_nfs() {
+	./${OUTPUT_DIR}/u-boot -c "
+setenv ipaddr 10.0.0.2;
+setenv serverip 10.0.0.1;
+setenv sbeth_latency $3;
+setenv sbeth_drop $4;
+setenv sbeth_nfsvers $2;
+setenv sbeth_interleave $5;
+setenv nfswindowsize $1;
+nfs 1000000 ${file};
+crc32 1000000 \${filesize};
+sb load host 0 2000000 ${file};
+crc32 2000000 \${filesize};
+reset"
+}
+
+check_results() {
+	# Both loads must produce the same CRC32
+	crcs="$(awk '/^crc32 for/ { print $NF }' ${tmp} | sort -u | wc -l)"
+	if [ $(grep -c "^crc32 for" ${tmp}) -ne 2 ] || [ ${crcs} -ne 1 ]; then
+		cat ${tmp}
+		fail "data loaded over NFS does not match"
+	fi
+}
+
+echo "NFS READ window throughput test using sandbox"
+echo
+tmp="$(tempfile)"
+file="$(tempfile)"
+head -c 4000000 /dev/urandom >${file}
+build_uboot
+for vers in ${NFS_VERSIONS}; do
+	for size in ${WINDOW_SIZES}; do
+		for il in ${INTERLEAVE}; do
+			run_nfs ${size} ${vers} ${LATENCY} ${DROP} ${il} >${tmp}
+			check_results
+			rate="$(awk '/\/s$/ { print $1, $2 }' ${tmp})"
+			echo "NFSv${vers} window ${size} interleave ${il}: ${rate}"
+		done
+	done
+done
+rm ${tmp} ${file}
+echo "Test passed"
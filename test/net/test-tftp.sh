@@ -0,0 +1,80 @@
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+
+# TFTP throughput test using sandbox
+#
+# The sandbox Ethernet driver contains a small TFTP server stand-in which
+# serves files from the host. This loads the same file with a range of
+# TFTP window sizes over a link with some latency, and optionally packet
+# loss, checks that what arrived is intact and reports the throughput.
+
+OUTPUT_DIR=sandbox
+WINDOW_SIZES="1 2 4 8 16 32"
+# Milliseconds of latency added by the stand-in to each reply
+LATENCY=1
+# Drop one in every N data frames (0 for no loss)
+DROP=0
+
+fail() {
+	echo "Test failed: $1"
+	if [ -n ${tmp} ]; then
+		rm ${tmp}
+	fi
+	if [ -n ${file} ]; then
+		rm ${file}
+	fi
+	exit 1
+}
+
+build_uboot() {
+	echo "Build sandbox"
+	OPTS="O=${OUTPUT_DIR}"
+	NUM_CPUS=$(grep -c processor /proc/cpuinfo)
+	make ${OPTS} sandbox_config
+	make ${OPTS} -s -j${NUM_CPUS}
+}
+
+# Load ${file} over TFTP and from the host, printing the CRC32 of each
+# Args:
+#	$1:	TFTP window size
+#	$2:	Latency in milliseconds
+#	$3:	Frame drop interval
+run_tftp() {
+	./${OUTPUT_DIR}/u-boot -c "
+setenv ipaddr 10.0.0.2;
+setenv serverip 10.0.0.1;
+setenv tftptimeout 1000;
+setenv sbeth_latency $2;
+setenv sbeth_drop $3;
+setenv tftpwindowsize $1;
+tftp 1000000 ${file};
+crc32 1000000 \${filesize};
+sb load host 0 2000000 ${file};
+crc32 2000000 \${filesize};
+reset"
+}
+
+check_results() {
+	# Both loads must produce the same CRC32
+	crcs="$(awk '/^crc32 for/ { print $NF }' ${tmp} | sort -u | wc -l)"
+	if [ $(grep -c "^crc32 for" ${tmp}) -ne 2 ] || [ ${crcs} -ne 1 ]; then
+		cat ${tmp}
+		fail "data loaded over TFTP does not match"
+	fi
+}
+
+echo "TFTP windowsize throughput test using sandbox"
+echo
+tmp="$(tempfile)"
+file="$(tempfile)"
+head -c 4000000 /dev/urandom >${file}
+build_uboot
+for size in ${WINDOW_SIZES}; do
+	run_tftp ${size} ${LATENCY} ${DROP} >${tmp}
+	check_results
+	rate="$(awk '/\/s$/ { print $1, $2 }' ${tmp})"
+	echo "windowsize ${size}: ${rate}"
+done
+rm ${tmp} ${file}
+echo "Test passed"
@@ -0,0 +1,78 @@
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+
+# HTTP download test using sandbox
+#
+# The sandbox Ethernet driver contains a small HTTP server stand-in which
+# serves files from the host. This loads the same file with wget over a
+# link with a range of latencies and packet loss rates, checks that what
+# arrived is intact and reports the throughput.
+
+OUTPUT_DIR=sandbox
+# Milliseconds of latency added by the stand-in to each reply
+LATENCIES="0 1 5"
+# Drop one in every N data frames (0 for no loss)
+DROPS="0 50 10"
+
+fail() {
+	echo "Test failed: $1"
+	if [ -n ${tmp} ]; then
+		rm ${tmp}
+	fi
+	if [ -n ${file} ]; then
+		rm ${file}
+	fi
+	exit 1
+}
+
+build_uboot() {
+	echo "Build sandbox"
+	OPTS="O=${OUTPUT_DIR}"
+	NUM_CPUS=$(grep -c processor /proc/cpuinfo)
+	make ${OPTS} sandbox_config
+	make ${OPTS} -s -j${NUM_CPUS}
+}
+
+# Load ${file} over HTTP and from the host, printing the CRC32 of each
+# Args:
+#	$1:	Latency in milliseconds
+#	$2:	Frame drop interval
+run_wget() {
+	./${OUTPUT_DIR}/u-boot -c "
+setenv ipaddr 10.0.0.2;
+setenv serverip 10.0.0.1;
+setenv sbeth_latency $1;
+setenv sbeth_drop $2;
+wget 1000000 ${file};
+crc32 1000000 \${filesize};
+sb load host 0 2000000 ${file};
+crc32 2000000 \${filesize};
+reset"
+}
+
+check_results() {
+	# Both loads must produce the same CRC32
+	crcs="$(awk '/^crc32 for/ { print $NF }' ${tmp} | sort -u | wc -l)"
+	if [ $(grep -c "^crc32 for" ${tmp}) -ne 2 ] || [ ${crcs} -ne 1 ]; then
+		cat ${tmp}
+		fail "data loaded over HTTP does not match"
+	fi
+}
+
+echo "HTTP download test using sandbox"
+echo
+tmp="$(tempfile)"
+file="$(tempfile)"
+head -c 4000000 /dev/urandom >${file}
+build_uboot
+for latency in ${LATENCIES}; do
+	for drop in ${DROPS}; do
+		run_wget ${latency} ${drop} >${tmp}
+		check_results
+		rate="$(awk '/\/s$/ { print $1, $2 }' ${tmp})"
+		echo "latency ${latency}ms, drop 1/${drop}: ${rate}"
+	done
+done
+rm ${tmp} ${file}
+echo "Test passed"
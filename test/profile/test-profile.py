@@ -0,0 +1,156 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# Sampling profiler test using sandbox
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# This profiles a CRC of a large area of memory with the 'profile' command,
+# saves the samples to a file and checks that proftool finds the time
+# spent in the CRC code, both in the flat profile and the call graph.
+#
+# To run this:
+#
+# make PROFILE_UNWIND=1 O=sandbox sandbox_config
+# make PROFILE_UNWIND=1 O=sandbox
+# make O=sandbox tools
+# ./test/profile/test-profile.py -u sandbox/u-boot
+#
+# Without PROFILE_UNWIND=1 only the sampled function is recorded, so the
+# checks on its callers and the call graph are skipped.
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import os
+import re
+import shutil
+import subprocess
+import tempfile
+
+HZ = 2000
+
+base_script = '''
+profile start %(hz)d;
+crc32 0 4000000;
+crc32 0 4000000;
+profile stop;
+profile stats;
+profile samples 1000000 100000;
+sb save host 0 %(fname)s 1000000 ${filesize};
+reset
+'''
+
+def fail(msg, stdout):
+    """Raise an error with a helpful failure message
+
+    Args:
+        msg: Message to display
+        stdout: Output from U-Boot or proftool
+    """
+    print(stdout)
+    raise ValueError("Test failed: %s" % msg)
+
+def make_map(u_boot, base_dir):
+    """Make a System.map for U-Boot in the same way as the Makefile"""
+    fname = os.path.join(base_dir, 'System.map')
+    out = subprocess.check_output(['nm', u_boot]).decode('ascii')
+    syms = [line for line in out.splitlines()
+            if not re.search(r'(compiled)|(\.o$)|( [aUw] )|(\.\.ng$)|'
+                             r'(LASH[RL]DI)', line)]
+    with open(fname, 'w') as fd:
+        fd.write('\n'.join(sorted(syms)) + '\n')
+    return fname
+
+def run_proftool(options, map_fname, prof_fname, cmd):
+    """Run proftool and return its output"""
+    return subprocess.check_output([options.proftool, '-v', '0', '-m',
+                                    map_fname, '-p', prof_fname,
+                                    cmd]).decode('ascii')
+
+def has_callers(graph):
+    """Check whether the call graph has any stack deeper than one frame"""
+    return any(';' in line for line in graph.splitlines())
+
+def check_profile(out, callers_seen):
+    """Check the flat profile puts the time in the CRC code
+
+    Args:
+        out: Flat profile from proftool
+        callers_seen: True to check that the callers of the CRC code appear
+    """
+    m = re.search(r'# Flat profile: (\d+) samples', out)
+    if not m:
+        fail('no flat profile', out)
+    total = int(m.group(1))
+    rows = [line.split() for line in out.splitlines()
+            if not line.startswith('#')]
+    if not rows or rows[0][-1] != 'crc32_no_comp':
+        fail('crc32_no_comp is not the top function', out)
+    if int(rows[0][0]) < total * 8 // 10:
+        fail('too few samples in crc32_no_comp', out)
+    if not callers_seen:
+        return
+    callers = dict((row[-1], int(row[2])) for row in rows if len(row) == 5)
+    for name in ('hash_command', 'cmd_process'):
+        if callers.get(name, 0) < total * 8 // 10:
+            fail('%s not seen as a caller' % name, out)
+
+def check_callgraph(out):
+    """Check the call graph has the stack leading to the CRC code"""
+    counts = {}
+    for line in out.splitlines():
+        stack, count = line.rsplit(' ', 1)
+        counts[stack] = int(count)
+    if not counts:
+        fail('no call graph', out)
+    stack = max(counts, key=counts.get)
+    frames = stack.split(';')
+    if frames[-1] != 'crc32_no_comp' or 'hash_command' not in frames:
+        fail('wrong stack for crc32_no_comp', out)
+    if frames.index('cmd_process') > frames.index('hash_command'):
+        fail('stack is not outermost first', out)
+
+def run_tests():
+    """Parse options, run sandbox and check the profile"""
+    parser = OptionParser()
+    parser.add_option('-u', '--u-boot', default='sandbox/u-boot',
+            help='Select U-Boot sandbox binary')
+    parser.add_option('-p', '--proftool',
+            help='Select proftool binary (default tools/ by U-Boot)')
+    (options, args) = parser.parse_args()
+    if not options.proftool:
+        options.proftool = os.path.join(os.path.dirname(options.u_boot),
+                                        'tools', 'proftool')
+
+    base_dir = tempfile.mkdtemp()
+    try:
+        fname = os.path.join(base_dir, 'prof.bin')
+        cmd = base_script % {'hz' : HZ, 'fname' : fname}
+        stdout = subprocess.Popen([options.u_boot, '-c', cmd],
+                stdout=subprocess.PIPE).communicate()[0].decode('ascii',
+                'replace')
+        m = re.search(r'([\d,]+) samples taken', stdout)
+        if not m or not os.path.exists(fname):
+            fail('no samples', stdout)
+        if int(m.group(1).replace(',', '')) < 20:
+            fail('too few samples', stdout)
+
+        map_fname = make_map(options.u_boot, base_dir)
+        out = run_proftool(options, map_fname, fname, 'dump-profile')
+        graph = run_proftool(options, map_fname, fname, 'dump-callgraph')
+        callers_seen = has_callers(graph)
+        check_profile(out, callers_seen)
+        print(out)
+        if callers_seen:
+            check_callgraph(graph)
+        else:
+            print('No call stacks recorded (build without PROFILE_UNWIND=1):'
+                  ' skipping caller and call graph checks')
+    finally:
+        shutil.rmtree(base_dir)
+
+    print('Test passed')
+
+run_tests()
@@ -0,0 +1,135 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# SPI flash update test using sandbox
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# This runs 'sf update' against the sandbox SPI flash emulator (--spi_sf)
+# and checks both the flash contents left in the backing file and the
+# number of page programs and erases of each size the emulator counted:
+# an update with unchanged data should do nothing, one which only clears
+# bits should not erase, and a large change should use 64KiB and 32KiB
+# erases where it can. Data either side of an unaligned update must
+# survive.
+#
+# To run this:
+#
+# make O=sandbox sandbox_config
+# make O=sandbox
+# ./test/sf/test-sf.py -u sandbox/u-boot
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+FLASH_SIZE = 4 << 20
+DATA_SIZE = 300000
+
+base_script = '''
+sf probe;
+sb load host 0 1000000 %(fname)s;
+sf update 1000000 %(offset)x ${filesize};
+sf probe;
+reset
+'''
+
+def fail(msg, stdout):
+    """Raise an error with a helpful failure message
+
+    Args:
+        msg: Message to display
+        stdout: Output from U-Boot
+    """
+    print(stdout)
+    raise ValueError("Test failed: %s" % msg)
+
+def run_update(u_boot, flash, fname, offset):
+    """Update the flash from a file with sandbox
+
+    Args:
+        u_boot: Path to the sandbox binary
+        flash: Backing file for the emulated flash
+        fname: File to write to the flash
+        offset: Flash offset to write it at
+    Return:
+        Tuple: (page programs, 4K erases, 32K erases, 64K erases)
+    """
+    cmd = base_script % {'fname' : fname, 'offset' : offset}
+    stdout = subprocess.Popen([u_boot, '--spi_sf', '0:0:%s' % flash,
+            '-c', cmd], stdout=subprocess.PIPE).communicate()[0]
+    stdout = stdout.decode('ascii', 'replace')
+    if 'bytes written' not in stdout:
+        fail('update of %s failed' % fname, stdout)
+    counts = re.search(r'(\d+) page programs, (\d+)/(\d+)/(\d+)', stdout)
+    if not counts:
+        fail('no statistics from emulator', stdout)
+    return tuple(int(n) for n in counts.groups())
+
+def check_flash(flash, expect):
+    """Check the contents of the emulated flash
+
+    Args:
+        flash: Backing file for the emulated flash
+        expect: Expected contents
+    """
+    with open(flash, 'rb') as fd:
+        data = fd.read()
+    if data != expect:
+        diff = [i for i in range(len(data)) if data[i] != expect[i]]
+        raise ValueError('Test failed: flash differs at %#x' % diff[0])
+
+def run_tests():
+    """Parse options and run the tests"""
+    parser = OptionParser()
+    parser.add_option('-u', '--u-boot', default='sandbox/u-boot',
+            help='Select U-Boot sandbox binary')
+    (options, args) = parser.parse_args()
+
+    base_dir = tempfile.mkdtemp()
+    try:
+        flash = os.path.join(base_dir, 'flash.bin')
+        fname = os.path.join(base_dir, 'data.bin')
+        expect = bytearray(b'\xff' * FLASH_SIZE)
+
+        def update(data, offset, expect_counts, title):
+            with open(fname, 'wb') as fd:
+                fd.write(data)
+            counts = run_update(options.u_boot, flash, fname, offset)
+            expect[offset:offset + len(data)] = data
+            check_flash(flash, expect)
+            if counts != expect_counts:
+                raise ValueError('Test failed: %s: expected %s, got %s' %
+                        (title, expect_counts, counts))
+            print('%-32s %5d programs, %d/%d/%d 4K/32K/64K erases' %
+                  ((title,) + counts))
+
+        pages = (DATA_SIZE + 255) // 256
+        data = bytearray(os.urandom(DATA_SIZE))
+        update(data, 0, (pages, 0, 0, 0), 'Blank flash')
+        update(data, 0, (0, 0, 0, 0), 'Same data')
+
+        # Only clearing bits in one page needs no erase
+        for i in range(5000, 5100):
+            data[i] &= 0x0f
+        update(data, 0, (1, 0, 0, 0), 'Bits cleared')
+
+        # 74 sectors: 4 x 64K, 1 x 32K and 2 x 4K
+        data = bytearray(os.urandom(DATA_SIZE))
+        update(data, 0, (pages, 2, 1, 4), 'New data')
+
+        # Unaligned, in the middle of a sector, keeping the rest of it
+        data = bytearray(os.urandom(0x100))
+        update(data, 0x1180, (16, 1, 0, 0), 'Part of a sector')
+    finally:
+        shutil.rmtree(base_dir)
+    print('\nTest passed')
+
+run_tests()
@@ -0,0 +1,187 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# Sparse image test using sandbox
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# This builds an Android sparse image with raw, fill, don't-care and CRC32
+# chunks, writes it to a sandbox host block device with 'sparse write' and
+# checks the device contents: raw and fill chunks must be written and
+# don't-care regions left as they were, since host devices cannot erase.
+# A raw chunk larger than the staging buffer is included, as is a corrupt
+# image, which must be rejected.
+#
+# To run this:
+#
+# make O=sandbox sandbox_config
+# make O=sandbox
+# ./test/sparse/test-sparse.py -u sandbox/u-boot
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import os
+import random
+import re
+import shutil
+import struct
+import subprocess
+import tempfile
+import zlib
+
+BLK_SZ = 4096
+DISK_BLKS = 1024
+
+SPARSE_MAGIC = 0xed26ff3a
+CHUNK_RAW = 0xcac1
+CHUNK_FILL = 0xcac2
+CHUNK_DONT_CARE = 0xcac3
+CHUNK_CRC32 = 0xcac4
+
+base_script = '''
+sb bind 0 %(disk)s;
+sb load host 0 1000000 %(fname)s;
+sparse info 1000000;
+sparse write hostblk 0 1000000;
+reset
+'''
+
+def fail(msg, stdout):
+    """Raise an error with a helpful failure message
+
+    Args:
+        msg: Message to display
+        stdout: Output from U-Boot
+    """
+    print(stdout)
+    raise ValueError("Test failed: %s" % msg)
+
+def make_image(layout, rand):
+    """Build a sparse image and the data it describes
+
+    Args:
+        layout: List of (chunk type, number of blocks)
+        rand: Random number generator for the raw data
+
+    Returns:
+        Tuple (sparse image, list of (start block, data or None for
+        don't-care))
+    """
+    chunks = []
+    regions = []
+    blk = 0
+    crc = 0
+    for ctype, count in layout:
+        if ctype == CHUNK_RAW:
+            data = bytes(bytearray(rand.getrandbits(8)
+                                   for i in range(count * BLK_SZ)))
+            payload = data
+        elif ctype == CHUNK_FILL:
+            value = rand.getrandbits(32)
+            data = struct.pack('<I', value) * (count * BLK_SZ // 4)
+            payload = struct.pack('<I', value)
+        elif ctype == CHUNK_DONT_CARE:
+            data = None
+            payload = b''
+        else:
+            data = None
+            payload = struct.pack('<I', crc & 0xffffffff)
+        if data is not None:
+            crc = zlib.crc32(data, crc)
+        chunks.append(struct.pack('<HHII', ctype, 0, count,
+                                  12 + len(payload)) + payload)
+        if count:
+            regions.append((blk, data))
+        blk += count
+    hdr = struct.pack('<IHHHHIIII', SPARSE_MAGIC, 1, 0, 28, 12, BLK_SZ,
+                      blk, len(chunks), 0)
+    return hdr + b''.join(chunks), regions
+
+def run_sparse(u_boot, base_dir, image, old):
+    """Write a sparse image to a host device with sandbox
+
+    Args:
+        u_boot: Path to the sandbox binary
+        base_dir: Directory for temporary files
+        image: Sparse image to write
+        old: Contents of the device beforehand
+
+    Returns:
+        Tuple (output from U-Boot, contents of the device afterwards)
+    """
+    fname = os.path.join(base_dir, 'image.simg')
+    disk = os.path.join(base_dir, 'disk.img')
+    with open(fname, 'wb') as fd:
+        fd.write(image)
+    with open(disk, 'wb') as fd:
+        fd.write(old)
+    cmd = base_script % {'disk' : disk, 'fname' : fname}
+    stdout = subprocess.Popen([u_boot, '-c', cmd],
+            stdout=subprocess.PIPE).communicate()[0].decode('ascii',
+            'replace')
+    with open(disk, 'rb') as fd:
+        return stdout, fd.read()
+
+def check_written(stdout, old, new, regions):
+    """Check the device holds the image, with don't-care regions intact"""
+    expect = bytearray(old)
+    for blk, data in regions:
+        if data is not None:
+            expect[blk * BLK_SZ:blk * BLK_SZ + len(data)] = data
+    if new != bytes(expect):
+        for blk in range(DISK_BLKS):
+            pos = blk * BLK_SZ
+            if new[pos:pos + BLK_SZ] != bytes(expect[pos:pos + BLK_SZ]):
+                fail('block %d has the wrong data' % blk, stdout)
+
+def run_tests():
+    """Parse options, run sandbox and check the device contents"""
+    parser = OptionParser()
+    parser.add_option('-u', '--u-boot', default='sandbox/u-boot',
+            help='Select U-Boot sandbox binary')
+    (options, args) = parser.parse_args()
+
+    rand = random.Random(0)
+    layout = [(CHUNK_RAW, 3), (CHUNK_DONT_CARE, 100), (CHUNK_FILL, 20),
+              (CHUNK_CRC32, 0), (CHUNK_RAW, 300), (CHUNK_FILL, 1),
+              (CHUNK_DONT_CARE, 400), (CHUNK_RAW, 1), (CHUNK_CRC32, 0),
+              (CHUNK_DONT_CARE, DISK_BLKS - 825)]
+    image, regions = make_image(layout, rand)
+    old = bytes(bytearray(rand.getrandbits(8)
+                          for i in range(DISK_BLKS * BLK_SZ)))
+
+    base_dir = tempfile.mkdtemp()
+    try:
+        stdout, new = run_sparse(options.u_boot, base_dir, image, old)
+        if not re.search(r'Sparse image v1.0, %d blocks of %d bytes in %d '
+                         'chunks' % (DISK_BLKS, BLK_SZ, len(layout)),
+                         stdout):
+            fail('sparse info did not show the header', stdout)
+        m = re.findall(r'sparse: %d chunks, (\d+) blocks of (\d+) bytes: '
+                       r'(\d+) written, (\d+) filled, (\d+) erased, '
+                       r'(\d+) skipped' % len(layout), stdout)
+        counts = [sum(count for ctype, count in layout if ctype == want)
+                  for want in (CHUNK_RAW, CHUNK_FILL)]
+        ratio = BLK_SZ // 512
+        expect = [(DISK_BLKS, BLK_SZ, counts[0], counts[1], 0,
+                   DISK_BLKS - sum(counts)),
+                  (DISK_BLKS * ratio, 512, counts[0] * ratio,
+                   counts[1] * ratio, 0, (DISK_BLKS - sum(counts)) * ratio)]
+        if [tuple(int(n) for n in row) for row in m] != expect:
+            fail('wrong summary', stdout)
+        check_written(stdout, old, new, regions)
+
+        # Make the second raw chunk one block too short
+        pos = image.index(struct.pack('<HHI', CHUNK_RAW, 0, 300))
+        bad = image[:pos + 4] + struct.pack('<I', 299) + image[pos + 8:]
+        stdout, new = run_sparse(options.u_boot, base_dir, bad, old)
+        if 'sparse: Chunk 5 has size' not in stdout:
+            fail('corrupt image accepted', stdout)
+    finally:
+        shutil.rmtree(base_dir)
+
+    print('Test passed')
+
+run_tests()
@@ -0,0 +1,115 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# Inflate benchmark using sandbox
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# Each file given (typically uncompressed kernel images, such as vmlinux or
+# arch/arm/boot/Image) is compressed with gzip -9 as a kernel build would,
+# loaded into sandbox and decompressed repeatedly with 'ut_zlib', which
+# checks the result against the gzip CRC and reports the throughput. If a
+# second U-Boot is given with -b, it is timed too, so that a build with
+# CONFIG_ZLIB_INFLATE_FAST can be compared against one without.
+#
+# To run this:
+#
+# make O=sandbox sandbox_config
+# make O=sandbox
+# ./test/zlib/test-inflate.py -u sandbox/u-boot -b sandbox-stock/u-boot \
+#	vmlinux ...
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import gzip
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+base_script = '''
+sb load host 0 1000000 %(fname)s;
+ut_zlib 1000000 ${filesize} 4000000;
+reset
+'''
+
+def fail(msg, stdout):
+    """Raise an error with a helpful failure message
+
+    Args:
+        msg: Message to display
+    """
+    print(stdout)
+    raise ValueError("Test failed: %s" % msg)
+
+def make_gzip(base_dir, fname):
+    """Compress a file as a kernel build would
+
+    Args:
+        base_dir: Directory for temporary files
+        fname: File to compress
+    Return:
+        Filename of compressed file
+    """
+    out = os.path.join(base_dir, os.path.basename(fname) + '.gz')
+    with open(fname, 'rb') as inf:
+        with gzip.GzipFile(out, 'wb', 9) as outf:
+            shutil.copyfileobj(inf, outf)
+    return out
+
+def run_inflate(u_boot, fname):
+    """Time decompression of a gzip file in U-Boot
+
+    Args:
+        u_boot: Path to the sandbox binary
+        fname: Compressed file to use
+    Return:
+        Throughput in MB/s
+    """
+    cmd = base_script % {'fname' : fname}
+    stdout = subprocess.Popen([u_boot, '-c', cmd],
+            stdout=subprocess.PIPE).communicate()[0].decode('ascii')
+    if 'Everything went swimmingly' not in stdout:
+        fail('%s not decompressed correctly' % fname, stdout)
+    rate = re.search(r'(\d+) KiB/s', stdout)
+    return int(rate.group(1)) / 1024.0
+
+def run_tests():
+    """Parse options, run the inflate benchmark and print the result"""
+    parser = OptionParser(usage='%prog [options] <file>...')
+    parser.add_option('-u', '--u-boot', default='sandbox/u-boot',
+            help='Select U-Boot sandbox binary')
+    parser.add_option('-b', '--baseline',
+            help='Select a second U-Boot sandbox binary to compare against')
+    (options, args) = parser.parse_args()
+    if not args:
+        parser.error('Please give at least one file to compress')
+
+    title = 'Inflate benchmark'
+    print(title)
+    print('=' * len(title))
+    header = '%-24s %10s %10s' % ('file', 'size', 'MB/s')
+    if options.baseline:
+        header += ' %10s %8s' % ('base MB/s', 'speedup')
+    print(header)
+
+    base_dir = tempfile.mkdtemp()
+    try:
+        for fname in args:
+            gz = make_gzip(base_dir, fname)
+            rate = run_inflate(options.u_boot, gz)
+            line = '%-24s %10d %10.1f' % (os.path.basename(fname)[:24],
+                    os.stat(fname).st_size, rate)
+            if options.baseline:
+                base_rate = run_inflate(options.baseline, gz)
+                line += ' %10.1f %7.2fx' % (base_rate, rate / base_rate)
+            print(line)
+    finally:
+        shutil.rmtree(base_dir)
+    print('\nTest passed')
+
+run_tests()
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#define DEBUG
+
+#include <common.h>
+#include <command.h>
+#include <u-boot/crc.h>
+#include <asm/io.h>
+#include <asm/unaligned.h>
+
+static int do_ut_zlib(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char * const argv[])
+{
+	unsigned long src_addr, size, dst_addr, len;
+	unsigned long long total;
+	ulong start, msecs;
+	void *src, *dst;
+	uint32_t crc;
+	int ret;
+
+	if (argc < 4)
+		return CMD_RET_USAGE;
+	src_addr = simple_strtoul(argv[1], NULL, 16);
+	size = simple_strtoul(argv[2], NULL, 16);
+	dst_addr = simple_strtoul(argv[3], NULL, 16);
+	if (size < 18) {
+		printf("Too small for a gzip file\n");
+		return CMD_RET_FAILURE;
+	}
+
+	printf("%s: Testing inflate (%s)\n", __func__,
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+	       "fast"
+#else
+	       "stock"
+#endif
+	       );
+	src = map_sysmem(src_addr, size);
+
+	/* the gzip trailer holds the uncompressed size */
+	len = get_unaligned_le32(src + size - 4);
+	dst = map_sysmem(dst_addr, len);
+
+	/* throughput, repeating for long enough to get a stable figure */
+	total = 0;
+	start = get_timer(0);
+	do {
+		unsigned long out_len = size;
+
+		ret = gunzip(dst, len, src, &out_len);
+		if (ret || out_len != len) {
+			printf("%s: gunzip failed (%d, %lu of %lu bytes)\n",
+			       __func__, ret, out_len, len);
+			return CMD_RET_FAILURE;
+		}
+		total += len;
+		msecs = get_timer(start);
+	} while (msecs < 250);
+
+	/* the trailer also has a CRC, so check it */
+	crc = crc32(0, dst, len);
+	assert(crc == get_unaligned_le32(src + size - 8));
+
+	printf("%s: %llu bytes in %lu ms, %llu KiB/s (crc %08x)\n", __func__,
+	       total, msecs, total / 1024 * 1000 / msecs, crc);
+	unmap_sysmem(dst);
+	unmap_sysmem(src);
+	setenv_hex("filesize", len);
+
+	printf("%s: Everything went swimmingly\n", __func__);
+	return 0;
+}
+
+U_BOOT_CMD(
+	ut_zlib,	4,	1,	do_ut_zlib,
+	"Check and time inflate on a gzip file in memory",
+	"<addr> <size> <dst>\n"
+	"    - decompress gzip data at <addr> to <dst> repeatedly, checking\n"
+	"      the result and reporting the throughput"
+);
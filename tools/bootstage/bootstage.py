@@ -0,0 +1,370 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2026 agent <agent@local>
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+
+"""Convert and compare U-Boot bootstage timelines
+
+See README for more information.
+"""
+
+from __future__ import print_function
+
+import json
+from optparse import OptionParser
+import re
+import struct
+import sys
+
+EXPORT_MAGIC = 0xb0075e11
+EXPORT_VERSION = 1
+EXPORT_ACCUM = 1 << 31
+EXPORT_NONE = 0xffffffff
+BOOTSTAGEF_ERROR = 1 << 0
+
+HDR_WORDS = 8
+MARK_WORDS = 4
+INTERVAL_WORDS = 5
+
+
+class Mark:
+    """A bootstage record: a point in time, or an accumulated time
+
+    Properties:
+        name: Name of the record
+        id: Bootstage ID
+        time_us: Time of the mark, or total time for an accumulator
+        accum: True if this is an accumulator
+        error: True if this marks an error
+    """
+    def __init__(self, name, id, time_us, accum=False, error=False):
+        self.name = name
+        self.id = id
+        self.time_us = time_us
+        self.accum = accum
+        self.error = error
+
+
+class Interval:
+    """A timed activity, from bootstage_start() to bootstage_accum()
+
+    Properties:
+        name: Name of the activity
+        id: Bootstage ID
+        start_us: Start time
+        end_us: End time, or None if it had not finished
+        parent: Index of the interval this one is within, or None
+        depth: Nesting depth, 0 for an outermost interval
+    """
+    def __init__(self, name, id, start_us, end_us, parent):
+        self.name = name
+        self.id = id
+        self.start_us = start_us
+        self.end_us = end_us
+        self.parent = parent
+        self.depth = 0
+
+
+class Boot:
+    """The bootstage information from one boot
+
+    Properties:
+        source: Where this came from, for messages
+        time_us: Time when it was captured, if known
+        marks: List of Mark objects
+        intervals: List of Interval objects, in order of starting
+        dropped: Number of intervals which did not fit in U-Boot's log
+    """
+    def __init__(self, source):
+        self.source = source
+        self.time_us = None
+        self.marks = []
+        self.intervals = []
+        self.dropped = 0
+
+    def Stages(self):
+        """Get the time of each stage in this boot
+
+        Returns:
+            Dict: name -> time in microseconds. For marks this is the time
+            since reset, and for accumulators and intervals it is the total
+            time taken.
+        """
+        stages = {}
+        for mark in self.marks:
+            stages[mark.name] = mark.time_us
+        if self.intervals:
+            totals = {}
+            for iv in self.intervals:
+                if iv.end_us is not None:
+                    totals[iv.name] = (totals.get(iv.name, 0) + iv.end_us -
+                                       iv.start_us)
+            stages.update(totals)
+        return stages
+
+
+def ReadExport(fname, data):
+    """Decode the output of 'bootstage export'
+
+    Args:
+        fname: Filename, for messages
+        data: Contents of the file
+    Returns:
+        Boot object
+    """
+    for order in '<>':
+        if len(data) >= HDR_WORDS * 4:
+            hdr = struct.unpack(order + 'I' * HDR_WORDS, data[:HDR_WORDS * 4])
+            if hdr[0] == EXPORT_MAGIC:
+                break
+    else:
+        raise ValueError('%s: Not a bootstage export' % fname)
+    magic, version, size, time_us, mark_count, interval_count, dropped = (
+            hdr[:7])
+    if version != EXPORT_VERSION:
+        raise ValueError('%s: Unknown version %d' % (fname, version))
+    if size > len(data):
+        raise ValueError('%s: Truncated (%d of %d bytes)' %
+                         (fname, len(data), size))
+    pos = HDR_WORDS * 4
+    marks = []
+    for i in range(mark_count):
+        marks.append(struct.unpack_from(order + 'I' * MARK_WORDS, data, pos))
+        pos += MARK_WORDS * 4
+    intervals = []
+    for i in range(interval_count):
+        intervals.append(struct.unpack_from(order + 'I' * INTERVAL_WORDS,
+                                            data, pos))
+        pos += INTERVAL_WORDS * 4
+    strings = data[pos:size]
+
+    def GetName(offset):
+        return strings[offset:strings.index(b'\0', offset)].decode('ascii',
+                                                                  'replace')
+
+    boot = Boot(fname)
+    boot.time_us = time_us
+    boot.dropped = dropped
+    for time_us, id, flags, name in marks:
+        boot.marks.append(Mark(GetName(name), id, time_us,
+                               bool(flags & EXPORT_ACCUM),
+                               bool(flags & BOOTSTAGEF_ERROR)))
+    for start_us, end_us, id, parent, name in intervals:
+        iv = Interval(GetName(name), id, start_us, end_us or None,
+                      None if parent == EXPORT_NONE else parent)
+        if iv.parent is not None:
+            iv.depth = boot.intervals[iv.parent].depth + 1
+        boot.intervals.append(iv)
+    return boot
+
+def ReadLog(fname, data):
+    """Find the output of 'bootstage report' in a console log
+
+    A log may hold any number of reports, e.g. from a board which was
+    rebooted many times with its console captured to one file.
+
+    Args:
+        fname: Filename, for messages
+        data: Contents of the file
+    Returns:
+        List of Boot objects, one for each report
+    """
+    boots = []
+    boot = None
+    accum = False
+    for line in data.decode('ascii', 'replace').splitlines():
+        if 'Timer summary in microseconds:' in line:
+            boot = Boot('%s:%d' % (fname, len(boots) + 1))
+            boots.append(boot)
+            accum = False
+            continue
+        if not boot:
+            continue
+        if line.startswith('Accumulated time:'):
+            accum = True
+            continue
+        if accum:
+            m = re.match(r'\s+([\d,]+)  (.*)$', line)
+        else:
+            m = re.match(r'\s+([\d,]+)\s+[\d,]+  (.*)$', line)
+        if m:
+            boot.marks.append(Mark(m.group(2), None,
+                                   int(m.group(1).replace(',', '')), accum))
+        elif line.strip() and not line.lstrip().startswith('Mark'):
+            boot = None
+    return boots
+
+def ReadBoots(fname):
+    """Read the boots recorded in a file
+
+    Args:
+        fname: File holding either the output of 'bootstage export' or a
+            console log with the output of 'bootstage report'
+    Returns:
+        List of Boot objects
+    """
+    with open(fname, 'rb') as fd:
+        data = fd.read()
+    if data[:4] in (struct.pack('<I', EXPORT_MAGIC),
+                    struct.pack('>I', EXPORT_MAGIC)):
+        return [ReadExport(fname, data)]
+    return ReadLog(fname, data)
+
+def ReadExportFile(fname):
+    """Read a file which must hold the output of 'bootstage export'"""
+    with open(fname, 'rb') as fd:
+        return ReadExport(fname, fd.read())
+
+def Dump(boot):
+    """Print a boot's timeline, showing the nesting of intervals"""
+    events = [(mark.time_us, 0, mark) for mark in boot.marks
+              if not mark.accum]
+    events += [(iv.start_us, 1, iv) for iv in boot.intervals]
+    print('%11s %11s  %s' % ('Start', 'Duration', 'Stage'))
+    for time_us, kind, item in sorted(events, key=lambda e: e[:2]):
+        if kind:
+            if item.end_us is None:
+                duration = 'running'
+            else:
+                duration = '{:,}'.format(item.end_us - item.start_us)
+            print('%11s %11s  %s%s' % ('{:,}'.format(time_us), duration,
+                                       '  ' * item.depth, item.name))
+        else:
+            print('%11s %11s  %s%s' % ('{:,}'.format(time_us), '',
+                                       item.name,
+                                       ' (error)' if item.error else ''))
+    accums = [mark for mark in boot.marks if mark.accum]
+    if accums:
+        print('\nAccumulated time:')
+        for mark in accums:
+            print('%23s  %s' % ('{:,}'.format(mark.time_us), mark.name))
+    if boot.dropped:
+        print('\n%d intervals were not logged' % boot.dropped)
+
+def ChromeTrace(boot):
+    """Convert a boot's timeline to Chrome's trace event format
+
+    The result can be loaded into chrome://tracing or Perfetto. Times there
+    are in microseconds, as here. Intervals which had not finished are
+    shown as running until the time of the export.
+
+    Returns:
+        Dict ready to be written as JSON
+    """
+    events = [{'name': 'process_name', 'ph': 'M', 'pid': 1,
+               'args': {'name': 'U-Boot'}}]
+    for mark in boot.marks:
+        if mark.accum:
+            continue
+        events.append({'name': mark.name, 'ph': 'i', 's': 'g',
+                       'ts': mark.time_us, 'pid': 1, 'tid': 1,
+                       'args': {'id': mark.id, 'error': mark.error}})
+    for iv in boot.intervals:
+        end_us = iv.end_us if iv.end_us is not None else boot.time_us
+        events.append({'name': iv.name, 'ph': 'X', 'ts': iv.start_us,
+                       'dur': end_us - iv.start_us, 'pid': 1, 'tid': 1,
+                       'args': {'id': iv.id, 'depth': iv.depth}})
+    accum = dict((mark.name, mark.time_us) for mark in boot.marks
+                 if mark.accum)
+    return {'traceEvents': events, 'displayTimeUnit': 'ms',
+            'otherData': {'accumulated_us': accum,
+                          'dropped_intervals': boot.dropped}}
+
+def Percentile(values, pct):
+    """Get a percentile of a sorted list, interpolating between values"""
+    pos = (len(values) - 1) * pct / 100.0
+    lower = int(pos)
+    upper = min(lower + 1, len(values) - 1)
+    return values[lower] + (values[upper] - values[lower]) * (pos - lower)
+
+def Distribution(boots):
+    """Collect the times of each stage across many boots
+
+    Returns:
+        Dict: name -> sorted list of times in microseconds
+    """
+    dist = {}
+    for boot in boots:
+        for name, time_us in boot.Stages().items():
+            dist.setdefault(name, []).append(time_us)
+    for times in dist.values():
+        times.sort()
+    return dist
+
+def Compare(boots, base_boots):
+    """Print the distribution of each stage's time, and any change
+
+    Args:
+        boots: List of Boot objects to report on
+        base_boots: List of Boot objects to compare against, or []
+    """
+    dist = Distribution(boots)
+    base = Distribution(base_boots)
+    names = sorted(dist, key=lambda name: (Percentile(dist[name], 50), name))
+    print('%d boots%s, times in microseconds' % (len(boots),
+          ' against %d' % len(base_boots) if base_boots else ''))
+    cols = ('Count', 'Min', 'Median', 'P90', 'Max')
+    if base:
+        cols += ('Base med', 'Change')
+    print(('%6s' + ' %11s' * (len(cols) - 1) + '  %s') % (cols + ('Stage',)))
+    for name in names:
+        times = dist[name]
+        line = '%6d' % len(times)
+        for value in (times[0], Percentile(times, 50), Percentile(times, 90),
+                      times[-1]):
+            line += ' %11s' % '{:,}'.format(int(value))
+        if base:
+            if name in base:
+                base_med = Percentile(base[name], 50)
+                change = Percentile(times, 50) - base_med
+                line += ' %11s %11s' % ('{:,}'.format(int(base_med)),
+                                        '{:+,}'.format(int(change)))
+            else:
+                line += ' %11s %11s' % ('-', 'new')
+        print('%s  %s' % (line, name))
+    for name in sorted(set(base) - set(dist)):
+        print('%6d %11s  %s (only in base)' % (0, '-', name))
+
+def Main():
+    """Parse the command line and run the requested command"""
+    parser = OptionParser(usage='''%prog dump <export>
+       %prog trace [-o <json>] <export>
+       %prog compare [-b <base>]... <file>...
+
+Files given to 'compare' may be exports or console logs with the output
+of 'bootstage report'.''')
+    parser.add_option('-b', '--base', action='append', default=[],
+            help='Add a file to compare against (may be repeated)')
+    parser.add_option('-o', '--output', help='Output file for trace')
+    (options, args) = parser.parse_args()
+    if not args:
+        parser.error('Please give a command')
+    cmd, args = args[0], args[1:]
+
+    if cmd == 'dump' and len(args) == 1:
+        Dump(ReadExportFile(args[0]))
+    elif cmd == 'trace' and len(args) == 1:
+        trace = ChromeTrace(ReadExportFile(args[0]))
+        if options.output:
+            with open(options.output, 'w') as fd:
+                json.dump(trace, fd, indent=1)
+        else:
+            json.dump(trace, sys.stdout, indent=1)
+            print()
+    elif cmd == 'compare' and args:
+        boots = []
+        for fname in args:
+            boots += ReadBoots(fname)
+        base_boots = []
+        for fname in options.base:
+            base_boots += ReadBoots(fname)
+        if not boots:
+            parser.error('No bootstage data found')
+        Compare(boots, base_boots)
+    else:
+        parser.error('Unknown command or wrong arguments')
+
+if __name__ == '__main__':
+    Main()
@@ -18,6 +18,7 @@
 #include <sys/param.h>
 
 #include <compiler.h>
+#include <profile.h>
 #include <trace.h>
 
 #define MAX_LINE_LEN 500
@@ -31,6 +32,8 @@ struct func_info {
 	const char *name;
 	unsigned long code_size;
 	unsigned long call_count;
+	unsigned long self_samples;	/* samples with the PC in here */
+	unsigned long total_samples;	/* samples with this on the stack */
 	unsigned flags;
 	/* the section this function is in */
 	struct objsection_info *objsection;
@@ -55,6 +58,9 @@ struct func_info *func_list;
 int func_count;
 struct trace_call *call_list;
 int call_count;
+uint32_t *sample_list;	/* each sample is a frame count, then frames */
+int sample_count;
+int sample_words;	/* number of words in sample_list */
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
@@ -85,9 +91,12 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-profile\t\tDump a flat profile from sampled data\n"
+		"   dump-callgraph\tDump sampled call stacks in folded format\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
+		"   -p <prof>\tSpecify profile data file (from U-Boot)\n"
 		"   -t <trace>\tSpecific trace data file (from U-Boot)\n"
 		"   -v <0-4>\tSpecify verbosity\n");
 	exit(EXIT_FAILURE);
@@ -201,6 +210,8 @@ static struct func_info *find_caller_by_offset(uint32_t offset)
 		else
 			return &func_list[mid];
 	}
+	if (high > low && h_cmp_offset(&key, &func_list[high]) >= 0)
+		return &func_list[high];
 
 	return low >= 0 ? &func_list[low] : NULL;
 }
@@ -226,6 +237,40 @@ static int read_calls(FILE *fin, int count)
 	return 0;
 }
 
+static int read_samples(FILE *fin, int count)
+{
+	uint32_t frames;
+	int alloced = 0;
+	int i;
+
+	notice("sample count: %d\n", count);
+	for (i = 0; i < count; i++) {
+		if (read_data(fin, &frames, sizeof(frames)))
+			return 1;
+		if (frames > 1000) {
+			error("Invalid sample at pos %ld\n", ftell(fin));
+			return -1;
+		}
+		if (sample_words + 1 + (int)frames > alloced) {
+			alloced = (alloced + 1 + frames) * 2;
+			sample_list = realloc(sample_list,
+					      alloced * sizeof(uint32_t));
+			if (!sample_list) {
+				error("Cannot allocate sample_list\n");
+				return -1;
+			}
+		}
+		sample_list[sample_words++] = frames;
+		if (frames && read_data(fin, &sample_list[sample_words],
+					frames * sizeof(uint32_t)))
+			return 1;
+		sample_words += frames;
+	}
+	sample_count += count;
+
+	return 0;
+}
+
 static int read_profile(FILE *fin, int *not_found)
 {
 	struct trace_output_hdr hdr;
@@ -249,6 +294,11 @@ static int read_profile(FILE *fin, int *not_found)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -531,6 +581,189 @@ static int make_ftrace(void)
 	return 0;
 }
 
+/* Find the function containing a sampled offset, or NULL if none */
+static struct func_info *find_sample_func(uint32_t offset)
+{
+	struct func_info *func;
+
+	if (offset == PROFILE_OUTSIDE || !func_count)
+		return NULL;
+	func = find_caller_by_offset(offset);
+	if (func && (offset < func->offset ||
+		     (func->code_size &&
+		      offset >= func->offset + func->code_size)))
+		return NULL;
+
+	return func;
+}
+
+/* Get the name of a sampled offset, or its address if it is not known */
+static const char *sample_name(uint32_t offset, char *buff, int size)
+{
+	struct func_info *func = find_sample_func(offset);
+
+	if (func)
+		return func->name;
+	if (offset == PROFILE_OUTSIDE)
+		return "[outside]";
+	snprintf(buff, size, "%lx", text_offset + offset);
+
+	return buff;
+}
+
+static int h_cmp_samples(const void *v1, const void *v2)
+{
+	const struct func_info *f1 = *(struct func_info **)v1;
+	const struct func_info *f2 = *(struct func_info **)v2;
+
+	if (f1->self_samples != f2->self_samples)
+		return f1->self_samples < f2->self_samples ? 1 : -1;
+	if (f1->total_samples != f2->total_samples)
+		return f1->total_samples < f2->total_samples ? 1 : -1;
+
+	return strcmp(f1->name, f2->name);
+}
+
+/*
+ * #     Self      %    Total      %  Function
+ *        812  40.60     1700  85.00  crc32_no_comp
+ *
+ * Self counts samples taken in the function, and Total those taken with
+ * the function anywhere on the stack.
+ */
+static int make_flat_profile(void)
+{
+	struct func_info **sorted, *func;
+	unsigned long outside = 0, unknown = 0;
+	uint32_t *sample;
+	int i, j, k, upto;
+
+	if (!sample_count) {
+		error("No samples found: use 'profile samples' in U-Boot\n");
+		return -1;
+	}
+	for (i = 0, sample = sample_list; i < sample_count;
+	     i++, sample += 1 + sample[0]) {
+		for (j = 0; j < sample[0]; j++) {
+			func = find_sample_func(sample[1 + j]);
+			if (!func) {
+				if (!j && sample[1] == PROFILE_OUTSIDE)
+					outside++;
+				else if (!j)
+					unknown++;
+				continue;
+			}
+			if (!j)
+				func->self_samples++;
+
+			/* Count recursive functions only once per sample */
+			for (k = 0; k < j; k++) {
+				if (find_sample_func(sample[1 + k]) == func)
+					break;
+			}
+			if (k == j)
+				func->total_samples++;
+		}
+	}
+
+	sorted = calloc(func_count, sizeof(*sorted));
+	if (!sorted) {
+		error("Cannot allocate sorted function list\n");
+		return -1;
+	}
+	for (i = upto = 0; i < func_count; i++) {
+		if (func_list[i].total_samples)
+			sorted[upto++] = &func_list[i];
+	}
+	qsort(sorted, upto, sizeof(*sorted), h_cmp_samples);
+
+	printf("# Flat profile: %d samples\n", sample_count);
+	printf("# %8s %6s %8s %6s  %s\n", "Self", "%", "Total", "%",
+	       "Function");
+	for (i = 0; i < upto; i++) {
+		func = sorted[i];
+		printf("  %8lu %6.2f %8lu %6.2f  %s\n", func->self_samples,
+		       100.0 * func->self_samples / sample_count,
+		       func->total_samples,
+		       100.0 * func->total_samples / sample_count,
+		       func->name);
+	}
+	if (outside) {
+		printf("  %8lu %6.2f %8s %6s  [outside]\n", outside,
+		       100.0 * outside / sample_count, "", "");
+	}
+	if (unknown) {
+		printf("  %8lu %6.2f %8s %6s  [unknown]\n", unknown,
+		       100.0 * unknown / sample_count, "", "");
+	}
+	free(sorted);
+
+	return 0;
+}
+
+static int h_cmp_string(const void *v1, const void *v2)
+{
+	return strcmp(*(char **)v1, *(char **)v2);
+}
+
+/*
+ * Output each distinct call stack with the number of samples in it,
+ * outermost function first, as used by flame graph tools:
+ *
+ * main_loop;run_command;do_mem_crc;crc32_wd;crc32_no_comp 812
+ */
+static int make_callgraph(void)
+{
+	char **stacks;
+	uint32_t *sample;
+	char buff[20];
+	int i, j, count;
+
+	if (!sample_count) {
+		error("No samples found: use 'profile samples' in U-Boot\n");
+		return -1;
+	}
+	stacks = calloc(sample_count, sizeof(*stacks));
+	if (!stacks) {
+		error("Cannot allocate stack list\n");
+		return -1;
+	}
+	for (i = 0, sample = sample_list; i < sample_count;
+	     i++, sample += 1 + sample[0]) {
+		int len = 0;
+
+		for (j = 0; j < sample[0]; j++)
+			len += strlen(sample_name(sample[1 + j], buff,
+						  sizeof(buff))) + 1;
+		stacks[i] = malloc(len + 1);
+		if (!stacks[i]) {
+			error("Cannot allocate stack\n");
+			return -1;
+		}
+		*stacks[i] = '\0';
+		for (j = sample[0] - 1; j >= 0; j--) {
+			strcat(stacks[i], sample_name(sample[1 + j], buff,
+						      sizeof(buff)));
+			if (j)
+				strcat(stacks[i], ";");
+		}
+	}
+	qsort(stacks, sample_count, sizeof(*stacks), h_cmp_string);
+
+	for (i = 0; i < sample_count; i += count) {
+		for (count = 1; i + count < sample_count; count++) {
+			if (strcmp(stacks[i], stacks[i + count]))
+				break;
+		}
+		printf("%s %d\n", stacks[i], count);
+	}
+	for (i = 0; i < sample_count; i++)
+		free(stacks[i]);
+	free(stacks);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
 		     const char *trace_config_fname)
@@ -551,6 +784,10 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-profile"))
+			err = make_flat_profile();
+		else if (0 == strcmp(cmd, "dump-callgraph"))
+			err = make_callgraph();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}